@@ -18,18 +18,80 @@
 #define TRUE 1                                  // Costante per il vero
 #define FALSE 0                                 // Costante per il falso
 
-#define MAX_INPUT_SIZE 256                      // Non puoi scrivere comandi più lunghi di 256 caratteri.
-
-#define MAX_TOKENS      20                      // Numero massimo di parole che può contenere un comando
+#define MAX_INPUT_SIZE 256                      // Lunghezza massima di un comando salvato (definizione di una vista, chiave della cache). I comandi inseriti possono essere lunghi quanto serve.
 
 #define DEFINE_INIT_TOKENS      2               // Numero di token iniziali per il comando DEFINE
 #define CREATE_INIT_TOKENS      2               // Numero di token iniziali per il comando DEFINE
+#define FIND_INIT_TOKENS        2               // Numero di token iniziali per il comando FIND
+#define READ_INIT_TOKENS        2               // Numero di token iniziali per il comando READ
+#define AGGREGATE_INIT_TOKENS   2               // Numero di token iniziali per il comando AGGREGATE
+#define JOIN_INIT_TOKENS        3               // Numero di token iniziali per il comando JOIN
+#define ANALYZE_INIT_TOKENS     2               // Numero di token del comando ANALYZE
+#define EXPLAIN_INIT_TOKENS     1               // Numero di token iniziali per il comando EXPLAIN, prima della query da spiegare
+#define MATERIALIZE_INIT_TOKENS 3               // Numero di token iniziali per il comando MATERIALIZE, prima dell'AGGREGATE
+#define PREPARE_INIT_TOKENS     3               // Numero di token iniziali per il comando PREPARE, prima del comando da preparare
+#define EXECUTE_INIT_TOKENS     2               // Numero di token iniziali per il comando EXECUTE, prima dei parametri
+#define LOAD_INIT_TOKENS        4               // Numero di token del comando LOAD
+#define TRANSFER_INIT_TOKENS    6               // Numero di token dei comandi EXPORT e IMPORT
+#define DELETE_INIT_TOKENS      3               // Numero di token del comando DELETE
+#define UPDATE_INIT_TOKENS      3               // Numero di token iniziali per il comando UPDATE, prima dei campo:valore
+#define TRANSACTION_INIT_TOKENS 1               // Numero di token dei comandi BEGIN, COMMIT e ROLLBACK
 
 
 #define MAX_TABLES      100                     // Numero massimo di tabelle che possono essere definite
 #define MAX_FIELDS      10                      // Numero massimo di campi che può contenere una tabella
 #define TABLES_DIR      "./tables"               // Cartella in cui verranno salvate le tabelle
 #define SCHEMA_FILE     "schema.bin"            // File in cui verranno salvate le definizioni delle tabelle
+#define VIEWS_FILE      "materialized.bin"      // File in cui verranno salvate le definizioni delle aggregazioni materializzate
+#define MAX_VIEWS       100                     // Numero massimo di aggregazioni materializzate
+
+#define MAX_LAYOUT_COLUMNS      (2 * MAX_FIELDS)  // Colonne massime di un layout (due tabelle affiancate, ad esempio in una JOIN)
+#define MAX_PREDICATE_NODES     64              // Numero massimo di nodi di un predicato compilato
+#define MAX_PREDICATE_DEPTH     64              // Numero massimo di parentesi e NOT annidati in un predicato
+#define PREDICATE_POOL_SIZE     4096            // Byte disponibili per le costanti già convertite di un predicato
+#define SCAN_BATCH_BYTES        (1 << 20)       // Byte letti in un colpo solo durante la scansione di una tabella
+#define MAX_AGGREGATES          10              // Numero massimo di funzioni di aggregazione in un comando
+#define GROUP_BY_MEMORY_BUDGET  (64L << 20)     // Memoria massima della tabella hash di una GROUP BY, oltre si scrive su disco
+#define GROUP_SPILL_PARTITIONS  16              // In quante partizioni vengono divisi i record che non entrano in memoria
+#define GROUP_MAX_SPILL_LEVEL   6               // Profondità massima delle partizioni ricorsive
+#define SORT_MEMORY_BUDGET      (64L << 20)     // Memoria massima per ordinare in RAM, oltre si scrivono run ordinati su disco
+#define SORT_MAX_RUNS           512             // Numero massimo di run ordinati fusi insieme
+#define JOIN_MEMORY_BUDGET      (64L << 20)     // Memoria massima per il lato di build di una JOIN, oltre si partiziona su disco
+#define JOIN_CACHE_BYTES        (256 << 10)     // Dimensione a cui puntano le partizioni in memoria di una JOIN, per restare in cache
+#define JOIN_MAX_RADIX_BITS     10              // Al massimo 2^10 partizioni in memoria
+#define JOIN_SPILL_PARTITIONS   16              // In quante partizioni su disco vengono divisi i record che non entrano in memoria
+#define JOIN_MAX_SPILL_LEVEL    4               // Profondità massima delle partizioni ricorsive su disco
+#define SAMPLE_BLOCK_BYTES      (64 << 10)      // Dimensione dei blocchi letti con SAMPLE (arrotondata a un numero intero di record)
+#define HLL_PRECISION           14              // APPROX_COUNT_DISTINCT: 2^14 registri (16KB), errore standard circa 0.8%
+#define TDIGEST_COMPRESSION     200             // APPROX_PERCENTILE: compressione del t-digest, circa 100 centroidi dopo la compressione
+#define TDIGEST_CAPACITY        512             // APPROX_PERCENTILE: centroidi massimi prima di comprimere (8KB)
+#define STATS_VERSION           1               // Versione del formato dei file tables/<T>.stats scritti da ANALYZE
+#define STATS_HISTOGRAM_BUCKETS 32              // Intervalli dell'istogramma equi-depth di ogni colonna numerica
+#define DEFAULT_DISTINCT        200             // Valori distinti supposti per una colonna senza statistiche
+#define COST_PAGE_BYTES         4096.0          // Dimensione di una pagina per il modello dei costi
+#define COST_SEQ_PAGE           1.0             // Costo di leggere una pagina in sequenza
+#define COST_RANDOM_PAGE        4.0             // Costo di leggere una pagina in una posizione qualsiasi (ad esempio in una ricerca binaria)
+#define COST_RECORD             0.01            // Costo di valutare il predicato su un record
+#define VIEW_VERSION            1               // Versione del formato dei file tables/<V>.view scritti da MATERIALIZE
+#define RESULT_CACHE_BYTES      (16L << 20)     // Memoria massima della cache dei risultati (modificabile con CACHE LIMIT), 0 = disattivata
+#define RESULT_CACHE_ENTRIES    128             // Numero massimo di risultati nella cache
+#define LOAD_BATCH_BYTES        (64L << 20)     // Byte del CSV convertiti in memoria prima di scriverli nella tabella
+#define LOAD_MAX_THREADS        8               // Thread massimi che convertono le righe del CSV
+#define LOAD_MIN_THREAD_BYTES   (1 << 20)       // Byte minimi del CSV per ogni thread: sotto non conviene dividere
+#define LOAD_FIELD_SIZE         1024            // Lunghezza massima di un campo del CSV
+#define COLUMNAR_VERSION        1               // Versione del formato dei file scritti da EXPORT … FORMAT COLUMNAR
+#define COLUMNAR_MAX_BLOCK_ROWS (1 << 20)       // Record massimi di un blocco di un file COLUMNAR letto da IMPORT
+#define OUTPUT_BUFFER_BYTES     (1 << 20)       // Buffer dello stdout: i risultati vengono scritti con una write ogni OUTPUT_BUFFER_BYTES
+#define OUTPUT_COLUMN_WIDTH     12              // Larghezza minima di una colonna nell'output OUTPUT TABLE
+#define TOMBSTONE_VERSION       1               // Versione del formato dei file tables/<T>.del scritti da DELETE
+#define COMPACT_BLOCK_BYTES     (64 << 10)      // Dimensione dei blocchi in cui si contano i record eliminati (arrotondata a un numero intero di record)
+#define COMPACT_DEAD_FRACTION   0.25            // Frazione di record eliminati in un blocco oltre la quale la tabella viene compattata
+#define WAL_FILE                "wal.log"       // Log in cui vengono scritte le modifiche prima di applicarle ai file (write-ahead log)
+#define WAL_BUFFER_BYTES        (1 << 20)       // Buffer del log: i record vengono scritti nel file a blocchi, e al più tardi al commit
+#define WAL_GROUP_COMMIT_US     2000            // Attesa massima (in microsecondi) di un commit per raggruppare gli altri commit in corso in un solo fdatasync
+#define WAL_CHECKPOINT_BYTES    (64L << 20)     // Dimensione del log oltre la quale si fa un checkpoint: tabelle durevoli con fsync e log svuotato
+#define ARENA_CHUNK_BYTES       (256 << 10)     // Memoria dell'arena di ogni comando, tenuta tra un comando e l'altro (oltre si allocano blocchi extra)
+#define MAX_PREPARED            32              // Numero massimo di comandi preparati con PREPARE
 
 
 typedef enum {                                  // Lista di tutti i comandi supportati dal nostro sistema
@@ -41,9 +103,41 @@ typedef enum {                                  // Lista di tutti i comandi supp
   CMD_UPDATE,
   CMD_FIND,
   CMD_DELETE,
+  CMD_AGGREGATE,
+  CMD_JOIN,
+  CMD_ANALYZE,
+  CMD_EXPLAIN,
+  CMD_MATERIALIZE,
+  CMD_CACHE,
+  CMD_PREPARE,
+  CMD_EXECUTE,
+  CMD_LOAD,
+  CMD_EXPORT,
+  CMD_IMPORT,
+  CMD_OUTPUT,
+  CMD_BEGIN,
+  CMD_COMMIT,
+  CMD_ROLLBACK,
   CMD_UNKNOWN
 } CommandType;
 
+typedef enum {                                  // Tipologia "interna" di una colonna, ricavata una volta sola dal nome del tipo
+  KIND_INT,
+  KIND_CHAR,
+  KIND_FLOAT,
+  KIND_DOUBLE,
+  KIND_BOOL,
+  KIND_TIMESTAMP,
+  KIND_UNKNOWN
+} ColumnKind;
+
+typedef enum {                                  // OutputMode: come vengono stampati i risultati (comando OUTPUT)
+  OUTPUT_TSV,                                   // TSV: valori separati da tab, il formato di sempre
+  OUTPUT_TABLE,                                 // TABLE: colonne allineate, per leggere a colpo d'occhio
+  OUTPUT_CSV,                                   // CSV: valori separati da virgole, rileggibile con LOAD
+  OUTPUT_JSON                                   // JSON: un oggetto JSON per riga (newline-delimited JSON)
+} OutputMode;
+
 typedef bool (*ConvertFunc)(const char *input, void *output);
 
 /** 
@@ -66,11 +160,6 @@ typedef struct {                                // ColumnDefinition: struct per
   ColumnType tipo;                              // tipo: ColumnType
 } ColumnDefinition;
 
-typedef struct {                                // ColumnValueDefinition: struct per definire una coppia <campo>:<valore>
-  ColumnDefinition campo;                       // nome_colonna: ad esempio: "nome"
-  void *valore;                                 // valore: valore del campo (puntatore perchè può essere di diverso tipo)
-} ColumnValueDefinition;
-
 typedef struct {                                // TableDefinition: struct per definire una tabella
   char nome_tabella[50];                        // nome_tabella: ad esempio "Utenti"
   int num_colonne;                              // num_colonne: indica quanti campi ha
@@ -83,5 +172,196 @@ typedef struct {                                // Schema: struct per definire l
   pthread_mutex_t mutex;                        // Mutex per proteggere l'accesso
 } Schema;
 
+typedef struct {                                // MaterializedView: un'aggregazione materializzata, salvata in VIEWS_FILE
+  char nome[50];                                // nome: il nome con cui si legge, ad esempio "OrdiniPerStato"
+  char tabella[50];                             // tabella: la tabella aggregata, i suoi CREATE aggiornano la vista
+  char definizione[MAX_INPUT_SIZE];             // definizione: il comando AGGREGATE, rivalidato ogni volta che serve
+} MaterializedView;
+
+
+/**
+ * Le struct qui sotto non vengono mai scritte su file: servono solo durante l'esecuzione di un comando.
+ * Il RecordLayout descrive dove si trova ogni colonna all'interno del buffer di un record,
+ * così chi legge i record non deve ricalcolare gli offset o confrontare i nomi dei tipi per ogni riga.
+ */
+
+typedef struct {                                // LayoutColumn: una colonna con la sua posizione nel record
+  char nome[101];                               // nome: ad esempio "nome", oppure "Utente.nome" se il layout è qualificato
+  ColumnType tipo;                              // tipo: ColumnType della colonna
+  ColumnKind kind;                              // kind: tipologia interna, per evitare strcmp durante la scansione
+  size_t offset;                                // offset: posizione del primo byte della colonna nel record
+} LayoutColumn;
+
+typedef struct {                                // RecordLayout: disposizione delle colonne di un record
+  int num_colonne;                              // num_colonne: quante colonne ci sono nel layout
+  LayoutColumn colonne[MAX_LAYOUT_COLUMNS];     // colonne: array di LayoutColumn
+  size_t record_size;                           // record_size: dimensione totale del record
+} RecordLayout;
+
+typedef enum {                                  // Operazioni dei nodi di un predicato
+  PRED_AND,
+  PRED_OR,
+  PRED_NOT,
+  PRED_CMP
+} PredicateOp;
+
+typedef enum {                                  // Operatori di confronto
+  CMP_EQ,
+  CMP_NE,
+  CMP_LT,
+  CMP_LE,
+  CMP_GT,
+  CMP_GE
+} CompareOp;
+
+typedef struct {                                // PredicateNode: un nodo dell'albero compilato di un predicato
+  PredicateOp op;                               // op: AND, OR, NOT oppure un confronto
+  CompareOp cmp;                                // cmp: operatore di confronto (solo per PRED_CMP)
+  ColumnKind kind;                              // kind: tipologia della colonna confrontata
+  size_t offset;                                // offset: posizione della colonna nel record
+  size_t length;                                // length: lunghezza della colonna
+  int constant;                                 // constant: posizione della costante già convertita nel pool
+  int first_child;                              // first_child: indice del primo figlio (AND, OR, NOT)
+  int num_children;                             // num_children: numero di figli
+  int cost;                                     // cost: costo stimato per valutare il nodo
+} PredicateNode;
+
+typedef struct {                                // Predicate: predicato compilato, pronto per essere valutato su ogni record
+  PredicateNode nodi[MAX_PREDICATE_NODES];      // nodi: array di nodi, i figli di un nodo sono sempre contigui
+  int children[MAX_PREDICATE_NODES];            // children: indici dei figli, riordinati dal più economico al più costoso
+  int num_nodi;                                 // num_nodi: numero di nodi usati
+  int num_children;                             // num_children: numero di elementi usati in children
+  int root;                                     // root: indice del nodo radice, -1 se il predicato è vuoto (sempre vero)
+  char pool[PREDICATE_POOL_SIZE];               // pool: costanti già convertite con la ConvertFunc della colonna
+  size_t pool_used;                             // pool_used: byte usati nel pool
+} Predicate;
+
+typedef struct {                                // Projection: colonne da restituire, nell'ordine richiesto
+  int num_colonne;                              // num_colonne: quante colonne restituire
+  int colonne[MAX_LAYOUT_COLUMNS];              // colonne: indici delle colonne nel RecordLayout
+} Projection;
+
+typedef struct {                                // SampleSpec: campionamento richiesto con SAMPLE <n>% [SEED <s>]
+  bool enabled;                                 // enabled: true se si legge solo un campione della tabella
+  double percent;                               // percent: percentuale di blocchi da leggere, tra 0 (escluso) e 100
+  unsigned long long seed;                      // seed: seme del generatore casuale, con lo stesso seme si ottiene lo stesso campione
+} SampleSpec;
+
+typedef struct {                                // ReadQuery: tutto quello che serve per eseguire una READ o una FIND
+  char nome_tabella[50];                        // nome_tabella: la tabella da leggere
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  Projection projection;                        // projection: colonne da stampare
+  Predicate predicate;                          // predicate: filtro già compilato (vuoto = tutti i record)
+  long limit;                                   // limit: numero massimo di record da restituire, -1 = nessun limite
+  bool has_cursor;                              // has_cursor: true se la lettura riprende da un cursore (AFTER)
+  int after_id;                                 // after_id: ultimo id visto nella pagina precedente
+  int order_column;                             // order_column: indice della colonna di ORDER BY nel layout, -1 = ordine di inserimento
+  bool order_desc;                              // order_desc: true per ORDER BY ... DESC
+  SampleSpec sample;                            // sample: campionamento a blocchi (SAMPLE), disattivato di default
+} ReadQuery;
+
+typedef enum {                                  // Funzioni di aggregazione supportate
+  AGG_COUNT,
+  AGG_SUM,
+  AGG_MIN,
+  AGG_MAX,
+  AGG_AVG,
+  AGG_APPROX_COUNT_DISTINCT,                    // Stima dei valori distinti (HyperLogLog, vedi sketch.c)
+  AGG_APPROX_PERCENTILE                         // Stima di un percentile (t-digest, vedi sketch.c)
+} AggregateFunc;
+
+typedef struct {                                // AggregateSpec: una funzione di aggregazione richiesta, ad esempio SUM(totale)
+  AggregateFunc func;                           // func: la funzione
+  int column;                                   // column: indice della colonna nel layout, -1 per COUNT(*)
+  double percentile;                            // percentile: per APPROX_PERCENTILE, la frazione richiesta tra 0 e 1
+  char label[110];                              // label: testo da stampare come intestazione
+} AggregateSpec;
+
+typedef struct {                                // AggregateState: stato parziale di una funzione di aggregazione
+  long long count;                              // count: valori (non NULL) accumulati
+  long long sum_int;                            // sum_int: somma esatta per int, timestamp e bool
+  double sum_float;                             // sum_float: somma per float e double
+  long long min_int, max_int;                   // min_int / max_int: minimo e massimo per int, timestamp e bool
+  double min_float, max_float;                  // min_float / max_float: minimo e massimo per float e double
+  char min_char[256], max_char[256];            // min_char / max_char: minimo e massimo per char
+} AggregateState;
+
+typedef struct {                                // AggregateQuery: tutto quello che serve per eseguire un AGGREGATE
+  char nome_tabella[50];                        // nome_tabella: la tabella da aggregare
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  AggregateSpec specs[MAX_AGGREGATES];          // specs: funzioni di aggregazione richieste
+  int num_specs;                                // num_specs: quante funzioni
+  Predicate predicate;                          // predicate: filtro già compilato (vuoto = tutti i record)
+  Projection group_by;                          // group_by: colonne di raggruppamento (nessuna = un solo gruppo)
+  SampleSpec sample;                            // sample: campionamento a blocchi (SAMPLE), disattivato di default
+} AggregateQuery;
+
+typedef struct {                                // JoinQuery: tutto quello che serve per eseguire una JOIN
+  char tabelle[2][50];                          // tabelle: le due tabelle, nell'ordine del comando
+  RecordLayout layout;                          // layout: colonne delle due tabelle affiancate e qualificate (A.col, B.col)
+  size_t record_sizes[2];                       // record_sizes: dimensione del record di ogni tabella, nel record unito B segue A
+  int key_columns[2];                           // key_columns: indice nel layout della colonna di join di ogni tabella
+  Projection projection;                        // projection: colonne da stampare
+  Predicate predicate;                          // predicate: filtro sul record unito (vuoto = tutte le coppie)
+  long limit;                                   // limit: numero massimo di record da restituire, -1 = nessun limite
+} JoinQuery;
+
+typedef struct {                                // CreateQuery: un CREATE già abbinato alle colonne, con i record pronti da scrivere
+  char nome_tabella[50];                        // nome_tabella: la tabella in cui inserire
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  int created_at_column;                        // created_at_column: indice di created_at nel layout
+  int num_records;                              // num_records: record da inserire (uno per ogni riga tra parentesi)
+  char *records;                                // records: i record uno dopo l'altro (nell'arena), mancano solo id e created_at
+} CreateQuery;
+
+typedef struct {                                // LoadQuery: un LOAD già risolto sullo schema
+  char nome_tabella[50];                        // nome_tabella: la tabella in cui caricare
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  int created_at_column;                        // created_at_column: indice di created_at nel layout
+  char path[MAX_INPUT_SIZE];                    // path: il file CSV, senza apici
+} LoadQuery;
+
+typedef struct {                                // ColumnarQuery: un EXPORT o un IMPORT … FORMAT COLUMNAR già risolto sullo schema
+  char nome_tabella[50];                        // nome_tabella: la tabella da esportare o in cui importare
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  char path[MAX_INPUT_SIZE];                    // path: il file, senza apici
+} ColumnarQuery;
+
+typedef struct {                                // UpdateQuery: un UPDATE già risolto sullo schema, con i nuovi valori già convertiti
+  char nome_tabella[50];                        // nome_tabella: la tabella da aggiornare
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  bool by_id;                                   // by_id: true per UPDATE <T> <ID> …, false per UPDATE <T> [WHERE …] SET …
+  int id;                                       // id: il record da aggiornare (solo con by_id)
+  Predicate predicate;                          // predicate: i record da aggiornare (solo senza by_id, vuoto = tutti)
+  int num_changes;                              // num_changes: quante colonne cambiano
+  int columns[MAX_FIELDS];                      // columns: indice nel layout di ogni colonna che cambia
+  char *values;                                 // values: un record (nell'arena) con i nuovi valori, già convertiti, alle loro posizioni
+  int updated_at_column;                        // updated_at_column: indice di updated_at nel layout
+} UpdateQuery;
+
+typedef struct {                                // DeleteQuery: un DELETE già risolto sullo schema
+  char nome_tabella[50];                        // nome_tabella: la tabella da cui eliminare
+  int id;                                       // id: l'id del record da eliminare
+} DeleteQuery;
+
+typedef struct {                                // PreparedStatement: un CREATE preparato con PREPARE, già risolto sullo schema
+  char nome[50];                                // nome: il nome usato da EXECUTE
+  char nome_tabella[50];                        // nome_tabella: la tabella in cui inserire
+  RecordLayout layout;                          // layout: disposizione delle colonne nel record
+  char *template_record;                        // template_record: record con i valori costanti già convertiti e i NULL
+  char *record;                                 // record: buffer riutilizzato da ogni EXECUTE, senza allocare nulla per record
+  int num_params;                               // num_params: quanti ? ci sono, cioè quanti valori vuole EXECUTE
+  int params[MAX_FIELDS];                       // params: colonna del layout di ogni ?, nell'ordine del comando
+  int created_at_column;                        // created_at_column: indice di created_at nel layout, valorizzato a ogni EXECUTE
+  unsigned long known_version;                  // known_version / next_id: versione della tabella dopo l'ultimo EXECUTE e il prossimo id,
+  int next_id;                                  // così se nessun altro ha scritto non serve rileggere l'ultimo record
+} PreparedStatement;
+
+typedef struct {                                // ExplainQuery: la query di cui EXPLAIN mostra il piano
+  CommandType command;                          // command: CMD_READ, CMD_FIND oppure CMD_AGGREGATE
+  ReadQuery read;                               // read: la query, per READ e FIND
+  AggregateQuery aggregate;                     // aggregate: la query, per AGGREGATE
+} ExplainQuery;
+
 
-#endif
\ No newline at end of file
+#endif
@@ -10,7 +10,7 @@
   Main.c è il file principale del programma. Si occupa di:
   * Dare il benvenuto all'utente: Spiega anche i comandi che può usare.
   * Genera il Loop principale: Continua a chiedere comandi fino a che l'utente non digita EXIT.
-  * Riceve l'input: Usa fgets() per leggere il comando e rimuove il \n finale, in modo da lavorare sulla stringa pulita.
+  * Riceve l'input: Usa getline() per leggere il comando, di qualsiasi lunghezza, e rimuove il \n finale, in modo da lavorare sulla stringa pulita.
   * Passa il comando al parser: Chiama process_command(input); per elaborare il comando inserito dall'utente.
 
 */
@@ -22,6 +22,11 @@
 #include "src/schema.h"
 #include "src/parser.h"
 #include "src/utils.h"
+#include "src/arena.h"
+#include "src/output.h"
+#include "src/compact.h"
+#include "src/wal.h"
+#include "src/transaction.h"
 
 
 /* Funzione principale del programma
@@ -29,6 +34,7 @@
   * Prende in input il comando dell'utente e lo processa.
 */
 int main () {
+  init_output();                                // Lo stdout ha un buffer grande: va impostato prima di stampare qualsiasi cosa
   printf("...\n");
   printf("avvio il progetto...\n");
 
@@ -45,7 +51,11 @@ int main () {
     fix_conversion_functions();                  // Corregge le funzioni di conversione per i tipi di dati
   }
 
-  char input[MAX_INPUT_SIZE];                   // Dichiaro un array di caratteri per contenere l'input dell'utente
+  start_compaction_thread();                    // Thread che recupera in background lo spazio dei record eliminati con DELETE
+  recover_compactions();                        // Compattazioni interrotte o rimaste in coda alla chiusura precedente
+
+  char *input = NULL;                           // Buffer per l'input dell'utente: getline lo alloca e lo ingrandisce se serve
+  size_t input_capacity = 0;
 
   printf("\n");
   printf("📂 Benvenuto nel database!\n");       // Messaggio di benvenuto
@@ -55,29 +65,46 @@ int main () {
   printf("▪️ DEFINE Utente nome:char eta:int ...\n");
   printf("▪️ READ DEFINES\n");
   printf("▪️ CREATE Utente nome:'Luca' eta:32 ...\n");
-  printf("▪️ READ Utente\n");
+  printf("▪️ CREATE Utente (nome:'Luca' eta:32) (nome:'Anna' eta:27) ...\n");
+  printf("▪️ READ Utente [nome,eta]\n");
   printf("▪️ UPDATE Utente 1 nome:'Mario'\n");
-  printf("▪️ FIND Utente nome:'Luca'\n");
+  printf("▪️ UPDATE Utente WHERE eta<18 SET nome:'Minore'\n");
+  printf("▪️ FIND Utente nome:'Luca' AND (eta>30 OR eta<18)\n");
   printf("▪️ DELETE Utente 1\n");
+  printf("▪️ AGGREGATE Utente COUNT(*) AVG(eta) WHERE nome:'Luca'\n");
+  printf("▪️ AGGREGATE Utente COUNT(*) AVG(eta) SAMPLE 5%% SEED 42\n");
+  printf("▪️ AGGREGATE Utente APPROX_COUNT_DISTINCT(nome) APPROX_PERCENTILE(eta,0.9)\n");
+  printf("▪️ JOIN Ordine Utente ON Ordine.utente = Utente.id\n");
+  printf("▪️ ANALYZE Utente\n");
+  printf("▪️ EXPLAIN FIND Utente id>=100 AND id<200 AND eta>30\n");
+  printf("▪️ MATERIALIZE UtentiPerEta AS AGGREGATE Utente COUNT(*) GROUP BY eta\n");
+  printf("▪️ CACHE [CLEAR | LIMIT 1048576]\n");
+  printf("▪️ PREPARE NuovoUtente AS CREATE Utente nome:? eta:?\n");
+  printf("▪️ EXECUTE NuovoUtente 'Luca' 32\n");
+  printf("▪️ LOAD Utente FROM 'utenti.csv'\n");
+  printf("▪️ EXPORT Utente TO 'utenti.col' FORMAT COLUMNAR\n");
+  printf("▪️ IMPORT Utente FROM 'utenti.col' FORMAT COLUMNAR\n");
+  printf("▪️ OUTPUT [TSV | TABLE | CSV | JSON]\n");
+  printf("▪️ BEGIN … COMMIT | ROLLBACK\n");
   printf("\n");
   printf("Inserisci un comando oppure 'EXIT' per uscire.\n");
 
   while(TRUE) {                                    // Ciclo infinito. Il programma termina solo se l'utente inserisce 'EXIT'
     printf("👉 ");
+    fflush(stdout);                             // Lo stdout non va a capo da solo: mostro il prompt (e l'output precedente) prima di aspettare
 
     // Leggo l'input dell'utente
-    if(fgets(input, MAX_INPUT_SIZE, stdin) == NULL) {
-      printf("Errore durante la lettura dell'input\n");
-      continue;
+    // getline legge tutta la riga, qualsiasi sia la sua lunghezza, riutilizzando (e se serve ingrandendo) lo stesso buffer.
+    if (getline(&input, &input_capacity, stdin) == -1) {
+      printf("\n👋 Fine dell'input... Arrivederci!\n");   // Fine dello stdin (ad esempio comandi da un file): esco
+      break;
     }
 
 
     // Rimuovo il carattere \n dalla fine dell'input
     // strcspn restituisce la posizione del primo carattere \n nell'array di caratteri.
     // Una volta trovata la posizione del \n, lo sostituisce con 0 (che in C è equivalente a '\0', il terminatore di stringa).
-
-    // Se input è una stringa letta da fgets(), questa riga assicura che il \n non venga incluso, poiché fgets() inserisce il carattere di nuova riga se c'è spazio nel buffer.
-    input[strcspn(input, "\n")] = 0;
+    input[strcspn(input, "\r\n")] = 0;
 
 
     // Se l'utente ha inserito 'EXIT' esco dal programma
@@ -86,8 +113,19 @@ int main () {
       break;
     }
 
+    lock_table_files();                       // Durante il comando la compattazione non può sostituire i file delle tabelle
     process_command(input);                   // Processo il comando dell'utente
+    unlock_table_files();
+    arena_reset();                            // La memoria temporanea del comando si riusa per il prossimo
+  }
+
+  if (in_transaction()) {                       // Una transazione non confermata viene annullata: i file non sono stati toccati
+    rollback_transaction();
+    printf("↩️ Transazione non confermata annullata\n");
   }
 
+  stop_compaction_thread();
+  wal_close();                                  // Ultimo checkpoint: le tabelle sono durevoli e il log resta vuoto
+  free(input);
   return SUCCESS;       // Ritorno 0 per indicare che il programma è terminato correttamente
 }
\ No newline at end of file
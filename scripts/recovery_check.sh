@@ -0,0 +1,100 @@
+#!/bin/bash
+#
+#  Recovery_check.sh è lo script che verifica il recupero dopo un crash (vedi src/wal.c).
+#  Uso: ./scripts/recovery_check.sh [eseguibile]      (di solito con: make recovery-check)
+#
+#  Come funziona?
+#  Tutto avviene in una cartella temporanea, con tre esecuzioni del programma:
+#    1. crea le tabelle e le riempie, poi esce normalmente: il checkpoint finale rende le tabelle durevoli e svuota il log.
+#       Le tabelle vengono copiate da parte.
+#    2. esegue CREATE, UPDATE, DELETE e una transazione, poi legge le tabelle e viene ucciso con kill -9 subito dopo
+#       l'ultima risposta: i commit sono nel log, ma il checkpoint di uscita non c'è mai stato.
+#       Le tabelle vengono riportate alla copia del punto 1, come se le scritture non ancora rese durevoli con fsync
+#       fossero andate perse insieme alla cache del sistema operativo. Resta solo il log.
+#    3. all'avvio riapplica il log e rilegge le tabelle, che devono essere identiche a quelle lette nel punto 2.
+#  Le stesse letture confrontano anche gli id, created_at e updated_at: il recupero deve riscrivere i record interi.
+#
+
+BIN=$(realpath "${1:-./main}")
+DIR=$(mktemp -d /tmp/recovery_check.XXXXXX)
+trap 'rm -rf "$DIR"' EXIT
+mkdir -p "$DIR/tables"
+cd "$DIR" || exit 1
+
+
+# Le letture alla fine del punto 2 e nel punto 3
+READS='READ Ordine
+READ Cliente'
+
+
+# Punto 1: tabelle iniziali. Abbastanza record perchè le DELETE del punto 2 non facciano partire una compattazione
+{ echo "stato,totale"; for i in $(seq 1 3000); do echo "s$((i % 7)),$i"; done; } > ordini.csv
+"$BIN" > setup.txt <<EOF
+DEFINE Ordine stato:char totale:int
+DEFINE Cliente nome:char eta:int
+LOAD Ordine FROM 'ordini.csv'
+CREATE Cliente nome:'Luca' eta:32
+CREATE Cliente nome:'Anna' eta:27
+EOF
+mkdir snapshot
+cp -p tables/* snapshot/
+
+
+# Punto 2: modifiche confermate nel log, lettura e kill -9 dopo l'ultima risposta
+cat > workload.txt <<EOF
+CREATE Ordine stato:'nuovo' totale:5000
+CREATE Cliente (nome:'Marco' eta:41) (nome:'Sara' eta:19)
+UPDATE Ordine 10 totale:-1
+UPDATE Ordine WHERE stato='s3' AND totale<100 SET stato:'s3bis'
+DELETE Ordine 20
+BEGIN
+CREATE Ordine stato:'tx' totale:1
+UPDATE Cliente 2 eta:28
+DELETE Ordine 30
+COMMIT
+$READS
+EOF
+COMMANDS=$(wc -l < workload.txt)
+
+mkfifo input
+"$BIN" < input > before.txt 2>&1 &
+PID=$!
+exec 3> input
+cat workload.txt >&3
+
+for _ in $(seq 1 300); do                                 # Aspetto il prompt dopo l'ultimo comando (al massimo 30 secondi)
+  [ "$(grep -o '👉' before.txt | wc -l)" -gt "$COMMANDS" ] && break
+  sleep 0.1
+done
+{ kill -9 "$PID"; wait "$PID"; } 2>/dev/null                # Il crash: niente checkpoint di uscita
+exec 3>&-
+
+if [ ! -s wal.log ]; then
+  echo "❌ Errore: il log è vuoto dopo il kill, il recupero non verrebbe verificato"
+  exit 1
+fi
+
+rm -f tables/*
+cp -p snapshot/* tables/
+
+
+# Punto 3: riavvio, recupero e confronto
+echo "$READS" | "$BIN" > after.txt 2>&1
+
+extract_tables() {                                        # Solo le letture: dal primo titolo di tabella in poi, senza prompt
+  sed -n '/Tabella: /,$p' "$1" | sed 's/^👉 //' | grep -v '👋\|^$'
+}
+
+if ! grep -q 'Tabella: Ordine' before.txt; then
+  echo "❌ Errore: il programma non ha risposto a tutti i comandi prima del kill"
+  exit 1
+fi
+
+if diff <(extract_tables before.txt) <(extract_tables after.txt) > diff.txt; then
+  echo "✅ Recupero verificato: le tabelle dopo il riavvio sono identiche a quelle lette prima del crash"
+  exit 0
+fi
+
+echo "❌ Errore: le tabelle dopo il riavvio sono diverse da quelle lette prima del crash"
+cat diff.txt
+exit 1
@@ -0,0 +1,519 @@
+/*
+
+
+  Aggregate.c è il file che si occupa di calcolare le funzioni di aggregazione: COUNT, SUM, MIN, MAX, AVG,
+  APPROX_COUNT_DISTINCT e APPROX_PERCENTILE.
+  Le funzioni descritte in questo file sono:
+    - is_aggregate_token:     verifica se un token è una funzione di aggregazione, ad esempio SUM(totale).
+    - parse_aggregate_spec:   trasforma un token in un AggregateSpec, risolvendo la colonna nel layout.
+    - init_aggregate_state:   inizializza lo stato parziale di un'aggregazione.
+    - create_aggregate_state: alloca e inizializza lo stato di un'aggregazione, della dimensione che le serve.
+    - aggregate_state_size:   ottiene la dimensione minima dello stato per una funzione.
+    - accumulate_batch:       accumula un batch di record nello stato.
+    - merge_aggregate_state:  unisce due stati parziali (ad esempio calcolati su parti diverse della tabella).
+    - subtract_aggregate_state: toglie da uno stato i record di un altro, quando è possibile (aggregazioni materializzate).
+    - print_aggregate_value:  stampa il risultato finale.
+    - get_aggregate_total:    ottiene il totale accumulato (conteggio per COUNT, somma per SUM e AVG), usato dalle stime di SAMPLE.
+    - print_aggregate_estimate: stampa il risultato stimato su un campione, scalato e con il suo intervallo di confidenza.
+
+  Come funziona l'accumulo?
+  Invece di decodificare un record alla volta e chiedersi ogni volta di che tipo è la colonna,
+  si lavora su un batch di record così come è stato letto dal file: il valore della colonna si trova
+  sempre allo stesso offset, ogni record_size byte (stride).
+  Per ogni tipologia di colonna c'è un "kernel", un ciclo stretto che legge i valori a passo fisso
+  e aggiorna count, somma, minimo e massimo in variabili locali.
+  Se c'è un filtro, il kernel riceve un vettore di selezione con le posizioni dei record che lo soddisfano.
+
+  I valori NULL (vedi get_null_value) non vengono considerati, come in SQL.
+  Fanno eccezione i bool, per cui il NULL coincide con false.
+
+  Le funzioni approssimate:
+  APPROX_COUNT_DISTINCT(<campo>) e APPROX_PERCENTILE(<campo>,<p>) non tengono tutti i valori in memoria,
+  ma uno sketch di dimensione fissa (HyperLogLog e t-digest, vedi sketch.c).
+  Lo sketch è salvato subito dopo la parte numerica dell'AggregateState (al posto di min_char e max_char),
+  per questo aggregate_state_size ne tiene conto, e chi alloca gli stati usa sempre quella dimensione.
+  Come per gli altri stati, due sketch calcolati su parti diverse della tabella si uniscono con merge_aggregate_state.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, strtod
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncmp, memcpy, strnlen
+#include <limits.h>                 // LLONG_MIN, LLONG_MAX
+#include <float.h>                  // DBL_MAX
+#include <stddef.h>                 // offsetof
+
+#include "aggregate.h"
+#include "schema.h"
+#include "arena.h"
+#include "sketch.h"
+#include "utils.h"
+#include "output.h"
+
+
+#define SKETCH_OFFSET ((offsetof(AggregateState, min_char) + 7) & ~(size_t)7)   // Dove inizia lo sketch nello stato
+
+
+static HyperLogLog *state_hll(AggregateState *state) { return (HyperLogLog *)((char *)state + SKETCH_OFFSET); }
+static TDigest *state_tdigest(AggregateState *state) { return (TDigest *)((char *)state + SKETCH_OFFSET); }
+
+
+/**
+ * Funzione che verifica se un token ha la forma di una funzione di aggregazione: NOME(colonna)
+ */
+bool is_aggregate_token(const char *token) {
+  const char *open = strchr(token, '(');
+  size_t len = strlen(token);
+
+  if (!open || len < 4 || token[len - 1] != ')') { return false; }
+
+  size_t name_len = open - token;
+  return (name_len == 5 && strncmp(token, "COUNT", 5) == SUCCESS) ||
+         (name_len == 3 && strncmp(token, "SUM", 3) == SUCCESS) ||
+         (name_len == 3 && strncmp(token, "MIN", 3) == SUCCESS) ||
+         (name_len == 3 && strncmp(token, "MAX", 3) == SUCCESS) ||
+         (name_len == 3 && strncmp(token, "AVG", 3) == SUCCESS) ||
+         (name_len == 21 && strncmp(token, "APPROX_COUNT_DISTINCT", 21) == SUCCESS) ||
+         (name_len == 17 && strncmp(token, "APPROX_PERCENTILE", 17) == SUCCESS);
+}
+
+
+/**
+ * Funzione che trasforma un token come SUM(totale) in un AggregateSpec.
+ * La colonna viene risolta una volta sola nel layout; COUNT(*) non ha colonna.
+ * SUM e AVG non sono ammesse sulle colonne char, APPROX_PERCENTILE nemmeno sulle bool.
+ * APPROX_PERCENTILE ha un secondo argomento, separato da una virgola senza spazi: APPROX_PERCENTILE(totale,0.95)
+ * 
+ * @return SUCCESS se il token è valido, FAILURE altrimenti
+ */
+int parse_aggregate_spec(const RecordLayout *layout, const char *token, AggregateSpec *spec) {
+  if (!is_aggregate_token(token)) {
+    printf("❌ Errore: '%s' non è una funzione di aggregazione valida\n", token);
+    return FAILURE;
+  }
+
+  const char *open = strchr(token, '(');
+  size_t name_len = open - token;
+
+  if      (strncmp(token, "COUNT", name_len) == SUCCESS) { spec->func = AGG_COUNT; }
+  else if (strncmp(token, "SUM", name_len)   == SUCCESS) { spec->func = AGG_SUM; }
+  else if (strncmp(token, "MIN", name_len)   == SUCCESS) { spec->func = AGG_MIN; }
+  else if (strncmp(token, "MAX", name_len)   == SUCCESS) { spec->func = AGG_MAX; }
+  else if (strncmp(token, "AVG", name_len)   == SUCCESS) { spec->func = AGG_AVG; }
+  else if (strncmp(token, "APPROX_COUNT_DISTINCT", name_len) == SUCCESS) { spec->func = AGG_APPROX_COUNT_DISTINCT; }
+  else                                                    { spec->func = AGG_APPROX_PERCENTILE; }
+
+  char column[101];
+  size_t column_len = strlen(open + 1) - 1;                               // Tolgo la parentesi chiusa finale
+  if (column_len == 0 || column_len >= sizeof(column)) {
+    printf("❌ Errore: colonna mancante in '%s'\n", token);
+    return FAILURE;
+  }
+  memcpy(column, open + 1, column_len);
+  column[column_len] = '\0';
+
+  spec->percentile = 0;
+  char *comma = strchr(column, ',');
+  if ((spec->func == AGG_APPROX_PERCENTILE) != (comma != NULL)) {
+    printf("❌ Errore: sintassi non valida in '%s'. Usa APPROX_PERCENTILE(<campo>,<p>) con p tra 0 e 1\n", token);
+    return FAILURE;
+  }
+  if (comma) {
+    char *endptr;
+    *comma = '\0';                                                        // column ora contiene solo il nome della colonna
+    spec->percentile = strtod(comma + 1, &endptr);
+    if (endptr == comma + 1 || *endptr != '\0' || spec->percentile < 0 || spec->percentile > 1) {
+      printf("❌ Errore: il percentile di '%s' deve essere un numero tra 0 e 1\n", token);
+      return FAILURE;
+    }
+  }
+
+  snprintf(spec->label, sizeof(spec->label), "%s", token);
+
+  if (strcmp(column, "*") == SUCCESS) {
+    if (spec->func != AGG_COUNT) {
+      printf("❌ Errore: '*' è ammesso solo in COUNT(*)\n");
+      return FAILURE;
+    }
+    spec->column = -1;
+    return SUCCESS;
+  }
+
+  spec->column = get_layout_column_index(layout, column);
+  if (spec->column < 0) {
+    printf("❌ Errore: il campo '%s' non esiste\n", column);
+    return FAILURE;
+  }
+
+  ColumnKind kind = layout->colonne[spec->column].kind;
+  if (kind == KIND_CHAR && (spec->func == AGG_SUM || spec->func == AGG_AVG)) {
+    printf("❌ Errore: %s non è ammessa sul campo char '%s'\n", spec->func == AGG_SUM ? "SUM" : "AVG", column);
+    return FAILURE;
+  }
+  if ((kind == KIND_CHAR || kind == KIND_BOOL) && spec->func == AGG_APPROX_PERCENTILE) {
+    printf("❌ Errore: APPROX_PERCENTILE non è ammessa sul campo %s '%s'\n", layout->colonne[spec->column].tipo.name, column);
+    return FAILURE;
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che inizializza lo stato di un'aggregazione: nessun valore, minimo e massimo "vuoti", sketch vuoto.
+ * min_char e max_char non vengono toccati: si leggono solo quando count > 0, cioè dopo averli scritti.
+ * Così chi aggrega tanti gruppi può allocare lo stato "compatto" (senza i campi char) per le colonne numeriche.
+ */
+void init_aggregate_state(const AggregateSpec *spec, AggregateState *state) {
+  state->count = 0;
+  state->sum_int = 0;
+  state->sum_float = 0.0;
+  state->min_int = LLONG_MAX;
+  state->max_int = LLONG_MIN;
+  state->min_float = DBL_MAX;
+  state->max_float = -DBL_MAX;
+
+  if (spec->func == AGG_APPROX_COUNT_DISTINCT) { init_hll(state_hll(state)); }
+  if (spec->func == AGG_APPROX_PERCENTILE)     { init_tdigest(state_tdigest(state)); }
+}
+
+
+/**
+ * Funzione che verifica se lo stato di un'aggregazione usa i campi min_char e max_char:
+ * succede solo per MIN e MAX sulle colonne char.
+ */
+static bool needs_char_state(const RecordLayout *layout, const AggregateSpec *spec) {
+  return spec->column >= 0 && layout->colonne[spec->column].kind == KIND_CHAR &&
+         (spec->func == AGG_MIN || spec->func == AGG_MAX);
+}
+
+
+/**
+ * Funzione che ottiene quanti byte servono per lo stato di un'aggregazione.
+ * Solo MIN e MAX sulle colonne char hanno bisogno dei campi min_char e max_char,
+ * le funzioni approssimate hanno bisogno dello spazio per il loro sketch.
+ */
+size_t aggregate_state_size(const RecordLayout *layout, const AggregateSpec *spec) {
+  size_t size = needs_char_state(layout, spec) ? sizeof(AggregateState) : offsetof(AggregateState, min_char);
+
+  if (spec->func == AGG_APPROX_COUNT_DISTINCT) { size = SKETCH_OFFSET + sizeof(HyperLogLog); }
+  if (spec->func == AGG_APPROX_PERCENTILE)     { size = SKETCH_OFFSET + sizeof(TDigest); }
+
+  return (size + 7) & ~(size_t)7;                                         // Allineo a 8 byte
+}
+
+
+/**
+ * Funzione che alloca nell'arena del comando e inizializza lo stato di un'aggregazione,
+ * della dimensione data da aggregate_state_size. Non va liberato: vive fino alla fine del comando.
+ *
+ * @return Lo stato, NULL se non c'è memoria
+ */
+AggregateState *create_aggregate_state(const RecordLayout *layout, const AggregateSpec *spec) {
+  AggregateState *state = arena_alloc(aggregate_state_size(layout, spec));
+  if (!state) { return NULL; }
+
+  init_aggregate_state(spec, state);
+  return state;
+}
+
+
+/**
+ * Kernel per le colonne numeriche.
+ * Ogni kernel legge i valori a passo fisso (stride) a partire da base, opzionalmente solo nelle posizioni di sel,
+ * e accumula in variabili locali che vengono scritte nello stato solo alla fine del batch.
+ */
+#define NUMERIC_KERNEL(NAME, TYPE, ACC, SUM_FIELD, MIN_FIELD, MAX_FIELD, SKIP_NULL, NULL_VALUE)   \
+static void NAME(AggregateState *state, const char *base, size_t stride, const int *sel, size_t count) { \
+  long long n = 0;                                                                                \
+  ACC sum = 0;                                                                                    \
+  ACC min = state->MIN_FIELD, max = state->MAX_FIELD;                                             \
+                                                                                                  \
+  for (size_t i = 0; i < count; i++) {                                                            \
+    TYPE value;                                                                                   \
+    memcpy(&value, base + (sel ? (size_t)sel[i] : i) * stride, sizeof(TYPE));                     \
+    if (SKIP_NULL && value == (NULL_VALUE)) { continue; }                                         \
+    n++;                                                                                          \
+    sum += value;                                                                                 \
+    if (value < min) { min = value; }                                                             \
+    if (value > max) { max = value; }                                                             \
+  }                                                                                               \
+                                                                                                  \
+  state->count += n;                                                                              \
+  state->SUM_FIELD += sum;                                                                        \
+  state->MIN_FIELD = min;                                                                         \
+  state->MAX_FIELD = max;                                                                         \
+}
+
+NUMERIC_KERNEL(kernel_int,       int,    long long, sum_int,   min_int,   max_int,   1, -1)
+NUMERIC_KERNEL(kernel_timestamp, long,   long long, sum_int,   min_int,   max_int,   1, 0)
+NUMERIC_KERNEL(kernel_bool,      bool,   long long, sum_int,   min_int,   max_int,   0, false)
+NUMERIC_KERNEL(kernel_float,     float,  double,    sum_float, min_float, max_float, 1, -1.0f)
+NUMERIC_KERNEL(kernel_double,    double, double,    sum_float, min_float, max_float, 1, -1.0)
+
+
+/**
+ * Kernel per le colonne char: servono solo count, minimo e massimo.
+ * Minimo e massimo si scrivono solo per MIN e MAX (extremes): per COUNT lo stato non ha i campi min_char e max_char
+ * (vedi aggregate_state_size).
+ */
+static void kernel_char(AggregateState *state, const char *base, size_t stride, size_t length, bool extremes, const int *sel, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const char *value = base + (sel ? (size_t)sel[i] : i) * stride;
+    if (value[0] == '\0') { continue; }                                   // Stringa vuota = NULL
+    if (!extremes) {
+      state->count++;
+      continue;
+    }
+
+    if (state->count == 0 || strncmp(value, state->min_char, length) < 0) {
+      snprintf(state->min_char, sizeof(state->min_char), "%.*s", (int)length, value);
+    }
+    if (state->count == 0 || strncmp(value, state->max_char, length) > 0) {
+      snprintf(state->max_char, sizeof(state->max_char), "%.*s", (int)length, value);
+    }
+    state->count++;
+  }
+}
+
+
+/**
+ * Kernel per le funzioni approssimate: ogni valore non NULL viene aggiunto allo sketch.
+ * Per APPROX_COUNT_DISTINCT si aggiunge l'hash dei byte del valore, per APPROX_PERCENTILE il valore stesso.
+ */
+#define SKETCH_KERNEL(NAME, TYPE, SKIP_NULL, NULL_VALUE)                                         \
+static void NAME(const AggregateSpec *spec, AggregateState *state, const char *base, size_t stride, const int *sel, size_t count) { \
+  bool distinct = spec->func == AGG_APPROX_COUNT_DISTINCT;                                        \
+  long long n = 0;                                                                                \
+                                                                                                  \
+  for (size_t i = 0; i < count; i++) {                                                            \
+    TYPE value;                                                                                   \
+    memcpy(&value, base + (sel ? (size_t)sel[i] : i) * stride, sizeof(TYPE));                     \
+    if (SKIP_NULL && value == (NULL_VALUE)) { continue; }                                         \
+    n++;                                                                                          \
+    if (distinct) { add_hll_hash(state_hll(state), hash_bytes((const char *)&value, sizeof(TYPE), 0)); } \
+    else          { add_tdigest(state_tdigest(state), (double)value); }                          \
+  }                                                                                               \
+                                                                                                  \
+  state->count += n;                                                                              \
+}
+
+SKETCH_KERNEL(sketch_int,       int,    1, -1)
+SKETCH_KERNEL(sketch_timestamp, long,   1, 0)
+SKETCH_KERNEL(sketch_bool,      bool,   0, false)
+SKETCH_KERNEL(sketch_float,     float,  1, -1.0f)
+SKETCH_KERNEL(sketch_double,    double, 1, -1.0)
+
+
+/**
+ * Kernel per APPROX_COUNT_DISTINCT sulle colonne char: l'hash copre solo i caratteri fino al terminatore.
+ */
+static void sketch_char(AggregateState *state, const char *base, size_t stride, size_t length, const int *sel, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    const char *value = base + (sel ? (size_t)sel[i] : i) * stride;
+    if (value[0] == '\0') { continue; }                                   // Stringa vuota = NULL
+
+    add_hll_hash(state_hll(state), hash_bytes(value, strnlen(value, length), 0));
+    state->count++;
+  }
+}
+
+
+/**
+ * Funzione che accumula un batch di record nello stato di un'aggregazione.
+ * 
+ * @param layout Il layout dei record
+ * @param spec La funzione di aggregazione
+ * @param state Lo stato da aggiornare
+ * @param buffer Il primo record del batch
+ * @param stride La distanza in byte tra un record e il successivo
+ * @param sel Le posizioni dei record da considerare, NULL per considerarli tutti
+ * @param count Il numero di record (o di posizioni in sel)
+ */
+void accumulate_batch(const RecordLayout *layout, const AggregateSpec *spec, AggregateState *state, const char *buffer, size_t stride, const int *sel, size_t count) {
+  if (spec->column < 0) {                                                 // COUNT(*): conta le righe, non serve leggere nulla
+    state->count += count;
+    return;
+  }
+
+  const LayoutColumn *col = &layout->colonne[spec->column];
+  const char *base = buffer + col->offset;
+
+  if (spec->func == AGG_APPROX_COUNT_DISTINCT || spec->func == AGG_APPROX_PERCENTILE) {
+    switch (col->kind) {
+      case KIND_INT:       sketch_int(spec, state, base, stride, sel, count); break;
+      case KIND_TIMESTAMP: sketch_timestamp(spec, state, base, stride, sel, count); break;
+      case KIND_BOOL:      sketch_bool(spec, state, base, stride, sel, count); break;
+      case KIND_FLOAT:     sketch_float(spec, state, base, stride, sel, count); break;
+      case KIND_DOUBLE:    sketch_double(spec, state, base, stride, sel, count); break;
+      case KIND_CHAR:      sketch_char(state, base, stride, col->tipo.length, sel, count); break;
+      default: break;
+    }
+    return;
+  }
+
+  switch (col->kind) {
+    case KIND_INT:       kernel_int(state, base, stride, sel, count); break;
+    case KIND_TIMESTAMP: kernel_timestamp(state, base, stride, sel, count); break;
+    case KIND_BOOL:      kernel_bool(state, base, stride, sel, count); break;
+    case KIND_FLOAT:     kernel_float(state, base, stride, sel, count); break;
+    case KIND_DOUBLE:    kernel_double(state, base, stride, sel, count); break;
+    case KIND_CHAR:      kernel_char(state, base, stride, col->tipo.length, needs_char_state(layout, spec), sel, count); break;
+    default: break;
+  }
+}
+
+
+/**
+ * Funzione che unisce lo stato from nello stato into.
+ * Gli sketch delle funzioni approssimate si uniscono senza perdere precisione rispetto a un unico sketch.
+ */
+void merge_aggregate_state(const RecordLayout *layout, const AggregateSpec *spec, AggregateState *into, const AggregateState *from) {
+  if (spec->func == AGG_APPROX_COUNT_DISTINCT) { merge_hll(state_hll(into), state_hll((AggregateState *)from)); }
+  if (spec->func == AGG_APPROX_PERCENTILE)     { merge_tdigest(state_tdigest(into), state_tdigest((AggregateState *)from)); }
+
+  if (needs_char_state(layout, spec) && from->count > 0) {
+    if (into->count == 0 || strcmp(from->min_char, into->min_char) < 0) { strcpy(into->min_char, from->min_char); }
+    if (into->count == 0 || strcmp(from->max_char, into->max_char) > 0) { strcpy(into->max_char, from->max_char); }
+  }
+
+  into->count += from->count;
+  into->sum_int += from->sum_int;
+  into->sum_float += from->sum_float;
+  if (from->min_int < into->min_int) { into->min_int = from->min_int; }
+  if (from->max_int > into->max_int) { into->max_int = from->max_int; }
+  if (from->min_float < into->min_float) { into->min_float = from->min_float; }
+  if (from->max_float > into->max_float) { into->max_float = from->max_float; }
+}
+
+
+/**
+ * Funzione che toglie da uno stato i record accumulati in un altro (ad esempio un record eliminato).
+ * COUNT, SUM e AVG si possono sempre sottrarre. MIN e MAX no: se il valore tolto è proprio il minimo (o il massimo),
+ * il nuovo estremo non si può conoscere senza rileggere i record, e lo stato va ricalcolato.
+ * Le funzioni approssimate non si possono mai sottrarre.
+ *
+ * @return SUCCESS se lo stato è stato aggiornato, FAILURE se va ricalcolato da capo
+ */
+int subtract_aggregate_state(const RecordLayout *layout, const AggregateSpec *spec, AggregateState *into, const AggregateState *from) {
+  if (spec->func == AGG_APPROX_COUNT_DISTINCT || spec->func == AGG_APPROX_PERCENTILE) { return FAILURE; }
+  if (from->count == 0) { return SUCCESS; }
+
+  if (spec->func == AGG_MIN || spec->func == AGG_MAX) {
+    bool is_min = spec->func == AGG_MIN;
+    ColumnKind kind = layout->colonne[spec->column].kind;
+    bool extreme;
+
+    if (kind == KIND_CHAR)                               { extreme = is_min ? strcmp(from->min_char, into->min_char) <= 0 : strcmp(from->max_char, into->max_char) >= 0; }
+    else if (kind == KIND_FLOAT || kind == KIND_DOUBLE)  { extreme = is_min ? from->min_float <= into->min_float : from->max_float >= into->max_float; }
+    else                                                 { extreme = is_min ? from->min_int <= into->min_int : from->max_int >= into->max_int; }
+
+    if (extreme) { return FAILURE; }
+  }
+
+  into->count -= from->count;
+  into->sum_int -= from->sum_int;
+  into->sum_float -= from->sum_float;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che stampa il risultato finale di un'aggregazione.
+ * Se non ci sono valori, MIN, MAX, AVG e APPROX_PERCENTILE stampano NULL.
+ */
+void print_aggregate_value(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state) {
+  const char *label = spec->label;
+
+  if (spec->func == AGG_COUNT) {
+    output_int(label, state->count);
+    return;
+  }
+
+  if (spec->func == AGG_APPROX_COUNT_DISTINCT) {
+    output_float(label, estimate_hll(state_hll((AggregateState *)state)), 0);
+    return;
+  }
+
+  ColumnKind kind = layout->colonne[spec->column].kind;
+  bool is_float = (kind == KIND_FLOAT || kind == KIND_DOUBLE);
+
+  if (state->count == 0 && spec->func != AGG_SUM) {
+    output_null(label);
+    return;
+  }
+
+  switch (spec->func) {
+    case AGG_SUM:
+      if (is_float) { output_float(label, state->sum_float, 2); } else { output_int(label, state->sum_int); }
+      break;
+
+    case AGG_AVG:
+      output_float(label, (is_float ? state->sum_float : (double)state->sum_int) / (double)state->count, 2);
+      break;
+
+    case AGG_APPROX_PERCENTILE: {
+      double value = estimate_tdigest_quantile(state_tdigest((AggregateState *)state), spec->percentile);
+      output_float(label, value, kind == KIND_TIMESTAMP ? 0 : 2);
+      break;
+    }
+
+    case AGG_MIN:
+    case AGG_MAX: {
+      bool is_min = spec->func == AGG_MIN;
+      if (kind == KIND_CHAR)      { output_string(label, is_min ? state->min_char : state->max_char, sizeof(state->min_char)); }
+      else if (kind == KIND_BOOL) { output_bool(label, (is_min ? state->min_int : state->max_int) != 0); }
+      else if (is_float)          { output_float(label, is_min ? state->min_float : state->max_float, 2); }
+      else                        { output_int(label, is_min ? state->min_int : state->max_int); }
+      break;
+    }
+
+    default:
+      output_null(label);
+  }
+}
+
+
+/**
+ * Funzione che ottiene il totale accumulato da un'aggregazione: il conteggio per COUNT, la somma per SUM e AVG.
+ * È la quantità che, su un campione, va riportata all'intera tabella.
+ */
+double get_aggregate_total(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state) {
+  if (spec->func == AGG_COUNT) { return (double)state->count; }
+
+  ColumnKind kind = layout->colonne[spec->column].kind;
+  return (kind == KIND_FLOAT || kind == KIND_DOUBLE) ? state->sum_float : (double)state->sum_int;
+}
+
+
+/**
+ * Funzione che stampa il risultato di un'aggregazione calcolata su un campione.
+ * COUNT e SUM vengono moltiplicati per scale (record della tabella / record letti), AVG, MIN e MAX no.
+ * MIN e MAX sono quelli del campione: non esiste una stima con intervallo di confidenza per gli estremi.
+ * Anche APPROX_PERCENTILE è quello del campione, senza intervallo.
+ * 
+ * @param scale Il fattore per riportare COUNT e SUM all'intera tabella
+ * @param half_width La semiampiezza dell'intervallo di confidenza, negativa se non è nota
+ */
+void print_aggregate_estimate(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state, double scale, double half_width) {
+  if (spec->func == AGG_MIN || spec->func == AGG_MAX || spec->func == AGG_APPROX_PERCENTILE || (spec->func == AGG_AVG && state->count == 0)) {
+    print_aggregate_value(layout, spec, state);
+    return;
+  }
+
+  double value = get_aggregate_total(layout, spec, state);
+  bool is_float = spec->func != AGG_COUNT && (layout->colonne[spec->column].kind == KIND_FLOAT || layout->colonne[spec->column].kind == KIND_DOUBLE);
+
+  double estimate = spec->func == AGG_AVG ? value / (double)state->count : value * scale;
+  int decimals = (spec->func == AGG_AVG || is_float) ? 2 : 0;
+
+  if (half_width < 0) {
+    output_float(spec->label, estimate, decimals);
+    return;
+  }
+
+  char text[96];                                                  // Con l'intervallo il valore diventa un testo: "1200 ±35.20"
+  snprintf(text, sizeof(text), "%.*f ±%.2f", decimals, estimate, half_width);
+  output_string(spec->label, text, sizeof(text));
+}
@@ -0,0 +1,24 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Aggregate
+bool is_aggregate_token(const char *token);
+int parse_aggregate_spec(const RecordLayout *layout, const char *token, AggregateSpec *spec);
+
+void init_aggregate_state(const AggregateSpec *spec, AggregateState *state);
+size_t aggregate_state_size(const RecordLayout *layout, const AggregateSpec *spec);
+AggregateState *create_aggregate_state(const RecordLayout *layout, const AggregateSpec *spec);
+void accumulate_batch(const RecordLayout *layout, const AggregateSpec *spec, AggregateState *state, const char *buffer, size_t stride, const int *sel, size_t count);
+void merge_aggregate_state(const RecordLayout *layout, const AggregateSpec *spec, AggregateState *into, const AggregateState *from);
+int subtract_aggregate_state(const RecordLayout *layout, const AggregateSpec *spec, AggregateState *into, const AggregateState *from);
+void print_aggregate_value(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state);
+double get_aggregate_total(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state);
+void print_aggregate_estimate(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state, double scale, double half_width);
+
+
+
+#endif
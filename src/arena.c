@@ -0,0 +1,150 @@
+/*
+
+
+  Arena.c è il file che si occupa della memoria temporanea di ogni comando.
+  Le funzioni descritte in questo file sono:
+    - arena_alloc:    restituisce un blocco di memoria dell'arena, valido fino alla fine del comando.
+    - arena_mark:     si segna la posizione attuale dell'arena.
+    - arena_release:  torna a una posizione segnata, liberando tutto quello che è stato allocato dopo.
+    - arena_reset:    svuota l'arena, alla fine di ogni comando.
+
+  Perchè?
+  Un comando ha bisogno di tanti piccoli buffer che vivono solo finché il comando è in esecuzione: il testo di un predicato,
+  gli stati delle aggregazioni, le chiavi e i gruppi di una vista, le statistiche delle colonne...
+  Con malloc e free ognuno ha la sua gestione degli errori e il suo free da non dimenticare.
+  L'arena invece è un blocco di ARENA_CHUNK_BYTES da cui si prende memoria spostando un indice (bump allocation):
+  non c'è niente da liberare, perchè alla fine di ogni comando il parser azzera l'indice e il blocco si riusa.
+  Se un comando ha bisogno di più memoria si allocano dei blocchi extra, che vengono liberati alla fine del comando,
+  così la memoria tenuta tra un comando e l'altro è sempre la stessa.
+
+  Chi alloca qualcosa per ogni record (ad esempio per ogni CREATE di un comando con tanti record) usa arena_mark
+  e arena_release, così la memoria di un record viene riusata da quello dopo.
+
+  Restano fuori dall'arena la memoria che vive oltre il comando (cache dei risultati, comandi preparati) e i buffer grandi
+  con un loro budget (scansioni, GROUP BY, ORDER BY, JOIN), che vengono già allocati una volta per comando.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+
+#include "arena.h"
+
+
+#define ARENA_ALIGNMENT 16                      // Ogni blocco è allineato a 16 byte, va bene per qualsiasi tipo
+
+struct ArenaChunk {                             // ArenaChunk: un blocco di memoria dell'arena
+  ArenaChunk *next;                             // next: il blocco allocato dopo, NULL se è l'ultimo
+  size_t size;                                  // size: byte disponibili in data
+  size_t used;                                  // used: byte già dati via
+  _Alignas(ARENA_ALIGNMENT) char data[];        // data: la memoria vera e propria
+};
+
+static ArenaChunk *first = NULL;                // Il primo blocco, di ARENA_CHUNK_BYTES, tenuto per sempre
+static ArenaChunk *current = NULL;              // Il blocco da cui si sta allocando
+
+
+/**
+ * Funzione che alloca un nuovo blocco e lo mette in fondo alla lista.
+ * @return Il blocco, NULL se la malloc fallisce
+ */
+static ArenaChunk *add_chunk(size_t size) {
+  if (size < ARENA_CHUNK_BYTES) { size = ARENA_CHUNK_BYTES; }
+
+  ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + size);
+  if (!chunk) { return NULL; }
+
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+
+  if (current) { current->next = chunk; }
+  else { first = chunk; }
+  return chunk;
+}
+
+
+/**
+ * Funzione che libera tutti i blocchi dopo quello dato.
+ */
+static void free_chunks_after(ArenaChunk *chunk) {
+  ArenaChunk *next = chunk->next;
+  chunk->next = NULL;
+
+  while (next) {
+    ArenaChunk *following = next->next;
+    free(next);
+    next = following;
+  }
+}
+
+
+/**
+ * Funzione che restituisce size byte dell'arena, allineati a ARENA_ALIGNMENT.
+ * La memoria non va liberata: resta valida fino ad arena_release o alla fine del comando.
+ *
+ * @param size I byte richiesti
+ * @return La memoria, NULL se non è stato possibile allocarla
+ */
+void *arena_alloc(size_t size) {
+  size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+  if (!current || current->size - current->used < size) {
+    ArenaChunk *chunk = add_chunk(size);
+    if (!chunk) {
+      printf("Errore: malloc fallita per l'arena del comando\n");
+      return NULL;
+    }
+    current = chunk;
+  }
+
+  void *memory = current->data + current->used;
+  current->used += size;
+  return memory;
+}
+
+
+/**
+ * Funzione che si segna la posizione attuale dell'arena.
+ * @return La posizione, da passare ad arena_release
+ */
+ArenaMark arena_mark() {
+  ArenaMark mark = { current, current ? current->used : 0 };
+  return mark;
+}
+
+
+/**
+ * Funzione che torna a una posizione segnata con arena_mark: tutto quello allocato dopo non è più valido.
+ */
+void arena_release(ArenaMark mark) {
+  if (!mark.chunk) {                                              // Il segno è stato preso quando l'arena era vuota
+    arena_reset();
+    return;
+  }
+
+  free_chunks_after(mark.chunk);
+  current = mark.chunk;
+  current->used = mark.used;
+}
+
+
+/**
+ * Funzione che svuota l'arena alla fine di un comando.
+ * Il primo blocco viene tenuto per il comando successivo, i blocchi extra vengono liberati.
+ */
+void arena_reset() {
+  if (!first) { return; }
+
+  free_chunks_after(first);
+  if (first->size > ARENA_CHUNK_BYTES) {                          // Il primo blocco era più grande del solito: non lo tengo
+    free(first);
+    first = NULL;
+    current = NULL;
+    return;
+  }
+
+  current = first;
+  current->used = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+// Config Header
+#include "../config.h"
+
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {                                // ArenaMark: posizione dell'arena, a cui tornare con arena_release
+  ArenaChunk *chunk;                            // chunk: il blocco in uso al momento del segno
+  size_t used;                                  // used: byte usati del blocco al momento del segno
+} ArenaMark;
+
+
+// Functions Available including the Arena
+void *arena_alloc(size_t size);
+ArenaMark arena_mark();
+void arena_release(ArenaMark mark);
+void arena_reset();
+
+
+
+#endif
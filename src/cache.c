@@ -0,0 +1,342 @@
+/*
+
+
+  Cache.c è il file che si occupa della cache dei risultati di READ, FIND, AGGREGATE e JOIN.
+  Le funzioni descritte in questo file sono:
+    - bump_table_version:       incrementa la versione di una tabella, a ogni scrittura su tables/<T>.bin.
+    - bump_schema_version:      incrementa la versione dello schema, a ogni tabella o vista definita.
+    - get_table_version:        ottiene la versione di una tabella, per sapere se è stata scritta da un certo momento.
+    - lookup_result_cache:      cerca un comando nella cache: se c'è lo stampa, altrimenti inizia a catturarne l'output.
+    - store_result_cache:       finisce di catturare l'output di un comando e lo salva nella cache.
+    - clear_result_cache:       svuota la cache.
+    - set_result_cache_limit:   cambia la memoria massima della cache (CACHE LIMIT).
+    - print_result_cache_stats: stampa hit, miss e memoria usata (CACHE).
+
+  Come funziona?
+  La chiave di un risultato è il comando normalizzato: i token separati da un solo spazio, come li vede il parser.
+  Ogni tabella ha una versione, che cresce a ogni scrittura sul suo file (vedi open_table_file), e c'è una versione
+  dello schema, che cresce a ogni DEFINE o MATERIALIZE. Un risultato viene salvato insieme alle versioni delle tabelle
+  che legge: se al momento della ricerca una di queste versioni è cambiata, il risultato non è più valido e viene scartato.
+  Così l'invalidazione costa un confronto di interi, e non si butta via mai un risultato che è ancora giusto.
+
+  Per non toccare i comandi, l'output viene catturato dallo stdout: durante l'esecuzione stdout diventa uno stream
+  (fopencookie) che passa ogni scrittura allo stdout vero e intanto ne tiene una copia in memoria. L'output arriva
+  quindi subito a chi lo legge, come senza cache; se la copia supera il limite di memoria della cache viene buttata
+  e il resto dell'output passa e basta, senza essere né copiato né salvato.
+  Quando la memoria (o il numero di risultati) supera il limite, si scarta il risultato usato meno di recente.
+
+  Non vengono messi in cache i comandi che scrivono e SAMPLE senza SEED, che dà un campione diverso a ogni esecuzione.
+  Le versioni vivono solo in memoria: la cache è vuota a ogni avvio, quindi non servono su disco.
+
+
+*/
+
+#define _GNU_SOURCE                 // fopencookie
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fwrite, fopencookie, fflush
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, realloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memcpy
+#include <stdint.h>                 // uint64_t
+
+#include "cache.h"
+#include "materialize.h"
+#include "utils.h"
+
+
+typedef struct {                                // TableVersion: versione di una tabella
+  char nome[50];                                // nome: la tabella
+  unsigned long version;                        // version: valore dell'orologio all'ultima scrittura
+} TableVersion;
+
+typedef struct {                                // CacheEntry: un risultato in cache
+  bool used;                                    // used: true se l'elemento contiene un risultato
+  uint64_t hash;                                // hash: hash della chiave, per confrontare le chiavi solo se serve
+  char key[MAX_INPUT_SIZE];                     // key: il comando normalizzato
+  char tabelle[2][50];                          // tabelle / num_tabelle / versions / schema_version: come in CachedCommand
+  int num_tabelle;
+  unsigned long versions[2];
+  unsigned long schema_version;
+  char *output;                                 // output: l'output del comando
+  size_t length;                                // length: byte dell'output
+  unsigned long last_used;                      // last_used: valore dell'orologio all'ultimo utilizzo, per scartare il meno recente
+} CacheEntry;
+
+static TableVersion versions[MAX_TABLES + MAX_VIEWS];
+static int num_versions = 0;
+static unsigned long version_clock = 0;          // Orologio comune a tutte le versioni: ogni scrittura ha un valore nuovo
+static unsigned long schema_version = 0;
+
+static CacheEntry entries[RESULT_CACHE_ENTRIES];
+static size_t cache_bytes = 0;
+static long cache_limit = RESULT_CACHE_BYTES;
+static unsigned long cache_clock = 0;
+static unsigned long cache_hits = 0, cache_misses = 0;
+
+
+/**
+ * Funzione che incrementa la versione di una tabella: i risultati che la leggono non sono più validi.
+ */
+void bump_table_version(const char *table_name) {
+  version_clock++;
+
+  for (int i = 0; i < num_versions; i++) {
+    if (strcmp(versions[i].nome, table_name) == SUCCESS) {
+      versions[i].version = version_clock;
+      return;
+    }
+  }
+
+  if (num_versions == MAX_TABLES + MAX_VIEWS) {                   // Elenco pieno (non dovrebbe succedere): invalido tutto
+    schema_version++;
+    return;
+  }
+  strncpy(versions[num_versions].nome, table_name, sizeof(versions[num_versions].nome) - 1);
+  versions[num_versions].version = version_clock;
+  num_versions++;
+}
+
+
+/**
+ * Funzione che incrementa la versione dello schema: nessun risultato salvato prima è più valido.
+ */
+void bump_schema_version() {
+  schema_version++;
+}
+
+
+/**
+ * Funzione che ottiene la versione di una tabella (0 se non è mai stata scritta da quando il programma è partito).
+ */
+unsigned long get_table_version(const char *table_name) {
+  for (int i = 0; i < num_versions; i++) {
+    if (strcmp(versions[i].nome, table_name) == SUCCESS) { return versions[i].version; }
+  }
+  return 0;
+}
+
+
+/**
+ * Funzione che scarta un risultato.
+ */
+static void evict_entry(CacheEntry *entry) {
+  cache_bytes -= entry->length;
+  free(entry->output);
+  entry->output = NULL;
+  entry->used = false;
+}
+
+
+/**
+ * Funzione che ricava le tabelle lette da un comando.
+ * @return FALSE se il comando non si può mettere in cache, TRUE altrimenti
+ */
+static int get_command_tables(char *tokens[], int token_count, CachedCommand *command) {
+  command->num_tabelle = 0;
+  if (token_count < 2) { return FALSE; }
+
+  bool read_only = strcmp(tokens[0], "READ") == SUCCESS || strcmp(tokens[0], "FIND") == SUCCESS || strcmp(tokens[0], "AGGREGATE") == SUCCESS;
+  bool join = strcmp(tokens[0], "JOIN") == SUCCESS && token_count >= 3;
+  if (!read_only && !join) { return FALSE; }
+
+  bool sample = false, seed = false;
+  for (int i = 0; i < token_count; i++) {
+    if (strcmp(tokens[i], "SAMPLE") == SUCCESS) { sample = true; }
+    if (strcmp(tokens[i], "SEED") == SUCCESS)   { seed = true; }
+  }
+  if (sample && !seed) { return FALSE; }
+
+  strncpy(command->tabelle[command->num_tabelle++], tokens[1], sizeof(command->tabelle[0]) - 1);
+
+  MaterializedView view;
+  if (join) {
+    strncpy(command->tabelle[command->num_tabelle++], tokens[2], sizeof(command->tabelle[0]) - 1);
+  } else if (find_materialized_view(tokens[1], &view) == SUCCESS) {   // Una vista cambia quando cambia la sua tabella
+    strncpy(command->tabelle[command->num_tabelle++], view.tabella, sizeof(command->tabelle[0]) - 1);
+  }
+  return TRUE;
+}
+
+
+/**
+ * Funzione che riceve le scritture sullo stdout durante un comando da mettere in cache (vedi fopencookie).
+ * Le passa allo stdout vero e ne tiene una copia finchè sta nel limite della cache; oltre, la copia viene buttata.
+ *
+ * @return I byte scritti, 0 in caso di errore
+ */
+static ssize_t capture_write(void *cookie, const char *data, size_t size) {
+  CachedCommand *command = cookie;
+  if (fwrite(data, 1, size, command->stdout_file) != size) { return 0; }
+  if (!command->capturing) { return (ssize_t)size; }
+
+  if (command->length + size > (size_t)cache_limit) {             // Troppo grande per la cache: da qui in poi passa e basta
+    free(command->output);
+    command->output = NULL;
+    command->capturing = false;
+    return (ssize_t)size;
+  }
+
+  if (command->length + size > command->capacity) {
+    size_t capacity = command->capacity > 0 ? command->capacity : 4096;
+    while (capacity < command->length + size) { capacity *= 2; }
+    if (capacity > (size_t)cache_limit) { capacity = (size_t)cache_limit; }
+
+    char *output = realloc(command->output, capacity);
+    if (!output) {
+      free(command->output);
+      command->output = NULL;
+      command->capturing = false;
+      return (ssize_t)size;
+    }
+    command->output = output;
+    command->capacity = capacity;
+  }
+
+  memcpy(command->output + command->length, data, size);
+  command->length += size;
+  return (ssize_t)size;
+}
+
+
+/**
+ * Funzione che cerca un comando nella cache.
+ * Se il risultato c'è ed è ancora valido lo stampa. Altrimenti, se il comando si può mettere in cache,
+ * inizia a catturare lo stdout: dopo aver eseguito il comando bisogna chiamare store_result_cache.
+ *
+ * @param tokens Array di token del comando
+ * @param token_count Numero di token
+ * @param command Il comando da valorizzare
+ * @return CACHE_HIT, CACHE_MISS oppure CACHE_SKIP
+ */
+CacheLookup lookup_result_cache(char *tokens[], int token_count, CachedCommand *command) {
+  memset(command, 0, sizeof(CachedCommand));
+  if (cache_limit <= 0 || !get_command_tables(tokens, token_count, command)) { return CACHE_SKIP; }
+
+  size_t length = 0;
+  for (int i = 0; i < token_count; i++) {                         // Chiave: i token separati da un solo spazio
+    size_t token_length = strlen(tokens[i]);
+    if (length + token_length + 1 >= sizeof(command->key)) { return CACHE_SKIP; }   // Troppo lunga: una chiave tagliata confonderebbe due comandi
+
+    if (i > 0) { command->key[length++] = ' '; }
+    memcpy(command->key + length, tokens[i], token_length + 1);
+    length += token_length;
+  }
+  for (int t = 0; t < command->num_tabelle; t++) { command->versions[t] = get_table_version(command->tabelle[t]); }
+  command->schema_version = schema_version;
+
+  uint64_t hash = hash_bytes(command->key, strlen(command->key), 0);
+
+  for (int i = 0; i < RESULT_CACHE_ENTRIES; i++) {
+    CacheEntry *entry = &entries[i];
+    if (!entry->used || entry->hash != hash || strcmp(entry->key, command->key) != SUCCESS) { continue; }
+
+    bool valid = entry->schema_version == command->schema_version;
+    for (int t = 0; t < entry->num_tabelle && valid; t++) { valid = entry->versions[t] == command->versions[t]; }
+
+    if (!valid) {                                                 // Una tabella è cambiata: il risultato va ricalcolato
+      evict_entry(entry);
+      break;
+    }
+
+    fwrite(entry->output, 1, entry->length, stdout);
+    entry->last_used = ++cache_clock;
+    cache_hits++;
+    return CACHE_HIT;
+  }
+
+  cache_misses++;
+
+  cookie_io_functions_t functions = { .write = capture_write };
+  FILE *capture = fopencookie(command, "w", functions);
+  if (!capture) { return CACHE_SKIP; }
+
+  fflush(stdout);
+  command->stdout_file = stdout;
+  command->capturing = true;
+  stdout = capture;
+  return CACHE_MISS;
+}
+
+
+/**
+ * Funzione che finisce di catturare l'output di un comando: ripristina lo stdout e salva l'output nella cache,
+ * scartando i risultati usati meno di recente se serve spazio. L'output è già stato stampato durante il comando.
+ */
+void store_result_cache(CachedCommand *command) {
+  FILE *capture = stdout;
+  stdout = command->stdout_file;
+  fclose(capture);                                                // Passa allo stdout vero le ultime scritture
+
+  char *output = command->output;
+  size_t length = command->length;
+  if (!command->capturing || length == 0) {                       // Troppo grande per la cache, oppure vuoto
+    free(output);
+    return;
+  }
+
+  CacheEntry *slot = NULL;
+  while (true) {
+    CacheEntry *oldest = NULL;
+    slot = NULL;
+    for (int i = 0; i < RESULT_CACHE_ENTRIES; i++) {
+      if (!entries[i].used) { if (!slot) { slot = &entries[i]; } continue; }
+      if (!oldest || entries[i].last_used < oldest->last_used) { oldest = &entries[i]; }
+    }
+
+    if (slot && cache_bytes + length <= (size_t)cache_limit) { break; }
+    evict_entry(oldest);                                          // oldest c'è sempre: length <= cache_limit
+  }
+
+  slot->used = true;
+  slot->hash = hash_bytes(command->key, strlen(command->key), 0);
+  memcpy(slot->key, command->key, sizeof(slot->key));
+  memcpy(slot->tabelle, command->tabelle, sizeof(slot->tabelle));
+  slot->num_tabelle = command->num_tabelle;
+  memcpy(slot->versions, command->versions, sizeof(slot->versions));
+  slot->schema_version = command->schema_version;
+  slot->output = output;
+  slot->length = length;
+  slot->last_used = ++cache_clock;
+  cache_bytes += length;
+}
+
+
+/**
+ * Funzione che svuota la cache (i contatori di hit e miss restano).
+ */
+void clear_result_cache() {
+  for (int i = 0; i < RESULT_CACHE_ENTRIES; i++) {
+    if (entries[i].used) { evict_entry(&entries[i]); }
+  }
+}
+
+
+/**
+ * Funzione che cambia la memoria massima della cache, scartando i risultati che non ci stanno più.
+ * Con 0 la cache è disattivata.
+ */
+void set_result_cache_limit(long bytes) {
+  cache_limit = bytes;
+
+  while (cache_bytes > (size_t)(bytes > 0 ? bytes : 0)) {
+    CacheEntry *oldest = NULL;
+    for (int i = 0; i < RESULT_CACHE_ENTRIES; i++) {
+      if (entries[i].used && (!oldest || entries[i].last_used < oldest->last_used)) { oldest = &entries[i]; }
+    }
+    evict_entry(oldest);
+  }
+}
+
+
+/**
+ * Funzione che stampa lo stato della cache: risultati salvati, memoria usata, hit e miss.
+ */
+void print_result_cache_stats() {
+  int used = 0;
+  for (int i = 0; i < RESULT_CACHE_ENTRIES; i++) { used += entries[i].used; }
+
+  unsigned long lookups = cache_hits + cache_misses;
+  printf("Cache dei risultati: %s\n", cache_limit > 0 ? "attiva" : "disattivata");
+  printf("Risultati\tMemoria\tLimite\tHit\tMiss\tHit rate\n");
+  printf("%d/%d\t%zu\t%ld\t%lu\t%lu\t%.1f%%\n", used, RESULT_CACHE_ENTRIES, cache_bytes, cache_limit, cache_hits, cache_misses,
+         lookups > 0 ? 100.0 * (double)cache_hits / (double)lookups : 0.0);
+}
@@ -0,0 +1,40 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+// Config Header
+#include "../config.h"
+
+
+typedef enum {                                  // Esito della ricerca di un comando nella cache dei risultati
+  CACHE_SKIP,                                   // Il comando non si può mettere in cache (ad esempio CREATE, o SAMPLE senza SEED)
+  CACHE_HIT,                                    // Il risultato era in cache ed è già stato stampato
+  CACHE_MISS                                    // Il risultato non c'era: l'output del comando viene catturato fino a store_result_cache
+} CacheLookup;
+
+typedef struct {                                // CachedCommand: un comando di cui si sta catturando il risultato
+  char key[MAX_INPUT_SIZE];                     // key: il comando normalizzato (token separati da un solo spazio)
+  char tabelle[2][50];                          // tabelle: le tabelle lette dal comando (due per una JOIN)
+  int num_tabelle;                              // num_tabelle: quante tabelle
+  unsigned long versions[2];                    // versions: versione di ogni tabella prima di eseguire il comando
+  unsigned long schema_version;                 // schema_version: versione dello schema prima di eseguire il comando
+  FILE *stdout_file;                            // stdout_file: lo stdout originale, da ripristinare
+  char *output;                                 // output: copia dell'output del comando
+  size_t length;                                // length: byte copiati
+  size_t capacity;                              // capacity: byte allocati per output
+  bool capturing;                               // capturing: false se l'output ha superato il limite e non viene più copiato
+} CachedCommand;
+
+
+// Functions Available including the Cache
+void bump_table_version(const char *table_name);
+void bump_schema_version();
+unsigned long get_table_version(const char *table_name);
+CacheLookup lookup_result_cache(char *tokens[], int token_count, CachedCommand *command);
+void store_result_cache(CachedCommand *command);
+void clear_result_cache();
+void set_result_cache_limit(long bytes);
+void print_result_cache_stats();
+
+
+
+#endif
@@ -0,0 +1,434 @@
+/*
+
+
+  Columnar.c è il file che si occupa del formato COLUMNAR, usato da EXPORT e IMPORT per spostare i dati di una tabella
+  tra un database e l'altro (o verso uno strumento di analisi) senza passare dal testo.
+  Le funzioni descritte in questo file sono:
+    - export_columnar_file: scrive tutti i record di una tabella in un file COLUMNAR.
+    - import_columnar_file: aggiunge in fondo a una tabella tutti i record di un file COLUMNAR.
+
+  Com'è fatto il file?
+  Il file si descrive da solo, così chi lo legge non ha bisogno dello schema del database che l'ha scritto:
+    [ ColumnarHeader | ColumnarColumn per ogni colonna | blocco | blocco | … ]
+  Ogni blocco contiene i record di un batch della scansione, divisi per colonna:
+    [ record del blocco (uint32) | ColumnarChunk + valori della colonna 1 | ColumnarChunk + valori della colonna 2 | … ]
+  I valori sono quelli del record, byte per byte: nessuna conversione in testo e ritorno.
+  Ogni colonna di ogni blocco viene scritta con la codifica più piccola tra PLAIN, RLE e STRING (vedi columnar.h):
+  i valori di una colonna si somigliano tra loro molto più di quelli di un record, ad esempio i created_at
+  di un CREATE con più righe sono tutti uguali, e una colonna char da 255 byte di solito ne usa pochi.
+
+  Come funziona?
+  EXPORT legge la tabella con una scansione a batch e, per ogni batch, copia ogni colonna in un buffer contiguo
+  e la scrive con la sua codifica. Il numero di record viene scritto nell'intestazione alla fine.
+  IMPORT abbina le colonne del file a quelle della tabella per nome (con lo stesso tipo), ricostruisce i record
+  di ogni blocco partendo da un record modello con i NULL e li scrive con una sola fwrite per blocco.
+  Se la tabella è vuota, gli id e created_at restano quelli del file: EXPORT seguito da IMPORT in una tabella nuova
+  copia la tabella così com'è (gli id del file devono essere crescenti, come in ogni tabella).
+  Altrimenti gli id vengono riassegnati in fondo alla tabella e created_at diventa il momento dell'IMPORT, come per LOAD.
+  updated_at resta sempre quello del file.
+  Se qualcosa va storto la tabella torna alla dimensione che aveva prima dell'IMPORT.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fread, fwrite, fseek
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, realloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memcmp, strnlen, strcmp
+#include <unistd.h>                 // ftruncate, fsync
+
+#include "columnar.h"
+#include "scan.h"
+#include "schema.h"
+#include "utils.h"
+
+
+/**
+ * Funzione che calcola quanti byte occupa una colonna di un blocco con la codifica RLE.
+ */
+static size_t rle_size(const char *values, size_t rows, size_t length) {
+  size_t runs = 1;
+  for (size_t r = 1; r < rows; r++) {
+    if (memcmp(values + r * length, values + (r - 1) * length, length) != 0) { runs++; }
+  }
+  return runs * (sizeof(uint32_t) + length);
+}
+
+
+/**
+ * Funzione che calcola quanti byte occupa una colonna char di un blocco con la codifica STRING.
+ */
+static size_t string_size(const char *values, size_t rows, size_t length) {
+  size_t size = 0;
+  for (size_t r = 0; r < rows; r++) { size += 1 + strnlen(values + r * length, length); }
+  return size;
+}
+
+
+/**
+ * Funzione che sceglie la codifica più piccola per i valori di una colonna e, se non è PLAIN, li codifica in out.
+ * out deve avere spazio per rows * length byte: la codifica scelta non occupa mai più di PLAIN.
+ *
+ * @param col La colonna
+ * @param values I valori della colonna, uno dopo l'altro
+ * @param rows Il numero di valori
+ * @param out Il buffer in cui codificare
+ * @param chunk L'intestazione da valorizzare con la codifica e la dimensione
+ * @return I byte da scrivere dopo l'intestazione (values oppure out)
+ */
+static const char *encode_column(const LayoutColumn *col, const char *values, size_t rows, char *out, ColumnarChunk *chunk) {
+  size_t length = (size_t)col->tipo.length;
+  size_t plain = rows * length;
+  size_t rle = rle_size(values, rows, length);
+  size_t string = (col->kind == KIND_CHAR && length <= UINT8_MAX) ? string_size(values, rows, length) : plain;
+
+  if (rle < plain && rle <= string) {
+    char *p = out;
+    for (size_t r = 0; r < rows; ) {
+      size_t run = 1;
+      while (r + run < rows && memcmp(values + (r + run) * length, values + r * length, length) == 0) { run++; }
+      uint32_t count = (uint32_t)run;
+      memcpy(p, &count, sizeof(uint32_t));
+      memcpy(p + sizeof(uint32_t), values + r * length, length);
+      p += sizeof(uint32_t) + length;
+      r += run;
+    }
+    chunk->encoding = COLUMNAR_RLE;
+    chunk->stored_size = (uint32_t)rle;
+    return out;
+  }
+
+  if (string < plain) {
+    char *p = out;
+    for (size_t r = 0; r < rows; r++) {
+      size_t len = strnlen(values + r * length, length);
+      *p++ = (char)(uint8_t)len;
+      memcpy(p, values + r * length, len);
+      p += len;
+    }
+    chunk->encoding = COLUMNAR_STRING;
+    chunk->stored_size = (uint32_t)string;
+    return out;
+  }
+
+  chunk->encoding = COLUMNAR_PLAIN;
+  chunk->stored_size = (uint32_t)plain;
+  return values;
+}
+
+
+/**
+ * Funzione che decodifica i valori di una colonna di un blocco direttamente nei record, al suo offset.
+ * Controlla che i valori siano esattamente rows: un file rovinato non può scrivere fuori dai record.
+ *
+ * @param chunk L'intestazione dei valori
+ * @param data I valori codificati
+ * @param rows I record del blocco
+ * @param length I byte di un valore
+ * @param records I record del blocco, uno dopo l'altro
+ * @param record_size La dimensione di un record
+ * @param offset La posizione della colonna nel record
+ * @return SUCCESS se i valori sono validi, FAILURE altrimenti
+ */
+static int decode_column(const ColumnarChunk *chunk, const char *data, size_t rows, size_t length, char *records, size_t record_size, size_t offset) {
+  const char *p = data;
+  const char *end = data + chunk->stored_size;
+  size_t r = 0;
+
+  switch (chunk->encoding) {
+    case COLUMNAR_PLAIN:
+      if (chunk->stored_size != rows * length) { return FAILURE; }
+      for (r = 0; r < rows; r++) { memcpy(records + r * record_size + offset, data + r * length, length); }
+      return SUCCESS;
+
+    case COLUMNAR_RLE:
+      while (p < end) {
+        if ((size_t)(end - p) < sizeof(uint32_t) + length) { return FAILURE; }
+        uint32_t run;
+        memcpy(&run, p, sizeof(uint32_t));
+        p += sizeof(uint32_t);
+        if (run == 0 || run > rows - r) { return FAILURE; }
+        for (uint32_t k = 0; k < run; k++, r++) { memcpy(records + r * record_size + offset, p, length); }
+        p += length;
+      }
+      return r == rows ? SUCCESS : FAILURE;
+
+    case COLUMNAR_STRING:
+      for (r = 0; r < rows; r++) {
+        if (p >= end) { return FAILURE; }
+        size_t len = (uint8_t)*p++;
+        if (len > length || len > (size_t)(end - p)) { return FAILURE; }
+        char *value = records + r * record_size + offset;
+        memcpy(value, p, len);
+        memset(value + len, 0, length - len);
+        p += len;
+      }
+      return p == end ? SUCCESS : FAILURE;
+  }
+
+  return FAILURE;
+}
+
+
+/**
+ * Funzione che scrive tutti i record di una tabella in un file COLUMNAR.
+ * La tabella viene letta una volta sola, a batch, e ogni batch diventa un blocco del file.
+ *
+ * @param query L'EXPORT da eseguire
+ * @return Il numero di record esportati, -1 in caso di errore
+ */
+long export_columnar_file(const ColumnarQuery *query) {
+  const RecordLayout *layout = &query->layout;
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return -1; }
+
+  FILE *file = fopen(query->path, "wb");
+  if (!file) {
+    printf("❌ Errore: impossibile creare il file %s\n", query->path);
+    close_table_scan(&scan);
+    return -1;
+  }
+
+  size_t max_length = 0;
+  for (int c = 0; c < layout->num_colonne; c++) {
+    if ((size_t)layout->colonne[c].tipo.length > max_length) { max_length = (size_t)layout->colonne[c].tipo.length; }
+  }
+  char *values = malloc(scan.batch_records * max_length);        // I valori di una colonna del batch, uno dopo l'altro
+  char *encoded = malloc(scan.batch_records * max_length);       // Gli stessi valori codificati
+
+  ColumnarHeader header;
+  memset(&header, 0, sizeof(ColumnarHeader));
+  memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+  header.version = COLUMNAR_VERSION;
+  header.num_columns = (uint32_t)layout->num_colonne;
+
+  bool ok = values && encoded && fwrite(&header, sizeof(ColumnarHeader), 1, file) == 1;
+
+  for (int c = 0; ok && c < layout->num_colonne; c++) {
+    ColumnarColumn column;
+    memset(&column, 0, sizeof(ColumnarColumn));
+    strncpy(column.nome, layout->colonne[c].nome, sizeof(column.nome) - 1);
+    strncpy(column.tipo, layout->colonne[c].tipo.name, sizeof(column.tipo) - 1);
+    column.length = (uint32_t)layout->colonne[c].tipo.length;
+    ok = fwrite(&column, sizeof(ColumnarColumn), 1, file) == 1;
+  }
+
+  size_t rows;
+  while (ok && (rows = read_scan_batch(&scan)) > 0) {
+    uint32_t block_rows = (uint32_t)rows;
+    ok = fwrite(&block_rows, sizeof(uint32_t), 1, file) == 1;
+
+    for (int c = 0; ok && c < layout->num_colonne; c++) {
+      const LayoutColumn *col = &layout->colonne[c];
+      size_t length = (size_t)col->tipo.length;
+      for (size_t r = 0; r < rows; r++) {                         // Da record a colonna
+        memcpy(values + r * length, scan.buffer + r * scan.record_size + col->offset, length);
+      }
+
+      ColumnarChunk chunk;
+      const char *data = encode_column(col, values, rows, encoded, &chunk);
+      ok = fwrite(&chunk, sizeof(ColumnarChunk), 1, file) == 1 && fwrite(data, 1, chunk.stored_size, file) == chunk.stored_size;
+    }
+    header.num_rows += rows;
+  }
+
+  if (ok) {                                                       // Ora il numero di record è noto: lo scrivo nell'intestazione
+    ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(ColumnarHeader), 1, file) == 1;
+  }
+  ok = fclose(file) == 0 && ok;
+
+  free(values);
+  free(encoded);
+  close_table_scan(&scan);
+
+  if (!ok) {
+    printf("❌ Errore: impossibile scrivere il file %s\n", query->path);
+    remove(query->path);
+    return -1;
+  }
+  return (long)header.num_rows;
+}
+
+
+/**
+ * Funzione che legge l'intestazione di un file COLUMNAR e abbina le sue colonne a quelle della tabella.
+ * Le colonne devono esistere nella tabella con lo stesso tipo; quelle della tabella che mancano nel file restano NULL.
+ *
+ * @param file Il file, all'inizio
+ * @param query L'IMPORT da eseguire
+ * @param keep_automatic true se l'id e created_at vanno copiati dal file, false se vengono riassegnati
+ * @param header L'intestazione da valorizzare
+ * @param columns Le colonne da valorizzare
+ * @param targets Per ogni colonna del file, l'indice nel layout, -1 se non va copiata
+ * @return SUCCESS se il file è valido per la tabella, FAILURE altrimenti
+ */
+static int read_columnar_header(FILE *file, const ColumnarQuery *query, bool keep_automatic, ColumnarHeader *header, ColumnarColumn *columns, int *targets) {
+  const RecordLayout *layout = &query->layout;
+
+  if (fread(header, sizeof(ColumnarHeader), 1, file) != 1 || memcmp(header->magic, COLUMNAR_MAGIC, sizeof(header->magic)) != 0) {
+    printf("❌ Errore: il file %s non è un file COLUMNAR\n", query->path);
+    return FAILURE;
+  }
+  if (header->version != COLUMNAR_VERSION || header->num_columns == 0 || header->num_columns > MAX_LAYOUT_COLUMNS) {
+    printf("❌ Errore: la versione del file %s non è supportata\n", query->path);
+    return FAILURE;
+  }
+  if (fread(columns, sizeof(ColumnarColumn), header->num_columns, file) != header->num_columns) {
+    printf("❌ Errore: il file %s è incompleto\n", query->path);
+    return FAILURE;
+  }
+
+  bool assigned[MAX_LAYOUT_COLUMNS] = { false };
+  for (uint32_t c = 0; c < header->num_columns; c++) {
+    ColumnarColumn *column = &columns[c];
+    column->nome[sizeof(column->nome) - 1] = '\0';
+    column->tipo[sizeof(column->tipo) - 1] = '\0';
+
+    int index = get_layout_column_index(layout, column->nome);
+    if (index < 0) {
+      printf("❌ Errore: la colonna '%s' non esiste nella tabella %s\n", column->nome, query->nome_tabella);
+      return FAILURE;
+    }
+    const LayoutColumn *col = &layout->colonne[index];
+    if (strcmp(col->tipo.name, column->tipo) != SUCCESS || (uint32_t)col->tipo.length != column->length) {
+      printf("❌ Errore: la colonna '%s' è di tipo %s nel file e %s nella tabella\n", column->nome, column->tipo, col->tipo.name);
+      return FAILURE;
+    }
+    if (assigned[index]) {
+      printf("❌ Errore: la colonna '%s' è ripetuta nel file\n", column->nome);
+      return FAILURE;
+    }
+    assigned[index] = true;
+    bool automatic = index == 0 || strcmp(column->nome, "created_at") == SUCCESS;   // L'id è sempre la colonna 0
+    targets[c] = automatic && !keep_automatic ? -1 : index;
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che aggiunge in fondo a una tabella tutti i record di un file COLUMNAR.
+ * Se qualcosa va storto la tabella torna com'era prima.
+ *
+ * @param query L'IMPORT da eseguire
+ * @return Il numero di record importati, -1 in caso di errore
+ */
+long import_columnar_file(const ColumnarQuery *query) {
+  const RecordLayout *layout = &query->layout;
+  size_t record_size = layout->record_size;
+
+  FILE *file = fopen(query->path, "rb");
+  if (!file) {
+    printf("❌ Errore: impossibile aprire il file %s\n", query->path);
+    return -1;
+  }
+
+  char *template_record = get_table_record_buffer(query->nome_tabella);   // Il record modello: NULL e created_at di adesso
+  FILE *table = template_record ? open_table_file(query->nome_tabella, "a+b") : NULL;
+  if (!table) {
+    fclose(file);
+    return -1;
+  }
+
+  fseek(table, 0, SEEK_END);
+  long original_size = ftell(table);
+  bool keep_automatic = original_size == 0;                       // Tabella vuota: id e created_at restano quelli del file
+
+  ColumnarHeader header;
+  ColumnarColumn columns[MAX_LAYOUT_COLUMNS];
+  int targets[MAX_LAYOUT_COLUMNS];
+  if (read_columnar_header(file, query, keep_automatic, &header, columns, targets) != SUCCESS) {
+    fclose(table);
+    fclose(file);
+    return -1;
+  }
+  bool file_ids = false;                                          // true se gli id vengono dal file
+  for (uint32_t c = 0; c < header.num_columns; c++) { file_ids = file_ids || targets[c] == 0; }
+  for (int c = 0; c < layout->num_colonne; c++) {
+    const LayoutColumn *col = &layout->colonne[c];
+    memcpy(template_record + col->offset, get_null_value(col->tipo), col->tipo.length);
+  }
+  int created_at_column = get_layout_column_index(layout, "created_at");
+  if (created_at_column >= 0) {
+    long timestamp = get_current_timestamp();
+    memcpy(template_record + layout->colonne[created_at_column].offset, &timestamp, sizeof(long));
+  }
+
+  int next_id = read_next_id(table, original_size, record_size);
+  int last_id = 0;
+
+  char *records = NULL;                                           // I record di un blocco, ricostruiti dalle colonne
+  char *data = NULL;                                              // I valori codificati di una colonna
+  size_t records_capacity = 0, data_capacity = 0;
+  uint64_t imported = 0;
+  const char *error = NULL;
+
+  while (!error && imported < header.num_rows) {
+    uint32_t rows;
+    if (fread(&rows, sizeof(uint32_t), 1, file) != 1) { error = "il file è incompleto"; break; }
+    if (rows == 0 || rows > COLUMNAR_MAX_BLOCK_ROWS || rows > header.num_rows - imported) { error = "un blocco non è valido"; break; }
+
+    if ((size_t)rows * record_size > records_capacity) {
+      records_capacity = (size_t)rows * record_size;
+      char *grown = realloc(records, records_capacity);
+      if (!grown) { error = "memoria insufficiente"; break; }
+      records = grown;
+    }
+    for (uint32_t r = 0; r < rows; r++) { memcpy(records + (size_t)r * record_size, template_record, record_size); }
+
+    for (uint32_t c = 0; !error && c < header.num_columns; c++) {
+      ColumnarChunk chunk;
+      size_t length = columns[c].length;
+      if (fread(&chunk, sizeof(ColumnarChunk), 1, file) != 1) { error = "il file è incompleto"; break; }
+      if (chunk.stored_size > (size_t)rows * (sizeof(uint32_t) + length)) { error = "una colonna non è valida"; break; }
+
+      if (chunk.stored_size > data_capacity) {
+        data_capacity = chunk.stored_size;
+        char *grown = realloc(data, data_capacity);
+        if (!grown) { error = "memoria insufficiente"; break; }
+        data = grown;
+      }
+      if (fread(data, 1, chunk.stored_size, file) != chunk.stored_size) { error = "il file è incompleto"; break; }
+      if (targets[c] < 0) { continue; }
+
+      if (decode_column(&chunk, data, rows, length, records, record_size, layout->colonne[targets[c]].offset) != SUCCESS) {
+        error = "una colonna non è valida";
+      }
+    }
+    if (error) { break; }
+
+    for (uint32_t r = 0; r < rows && !error; r++) {
+      char *record = records + (size_t)r * record_size;           // L'id è sempre il primo campo del record
+      if (!file_ids) {
+        int id = next_id++;
+        memcpy(record, &id, sizeof(int));
+        continue;
+      }
+
+      int id;                                                     // Gli id del file: la ricerca per id li vuole crescenti
+      memcpy(&id, record, sizeof(int));
+      if (id <= last_id) { error = "gli id del file non sono crescenti"; }
+      last_id = id;
+    }
+    if (error) { break; }
+    if (fwrite(records, record_size, rows, table) != rows) { error = "impossibile scrivere nella tabella"; break; }
+    imported += rows;
+  }
+
+  if (!error && (fflush(table) != 0 || fsync(fileno(table)) != 0)) {    // IMPORT non passa dal log (vedi wal.c): un solo fsync alla fine
+    error = "impossibile rendere durevole la tabella";
+  }
+
+  if (error) {                                                    // Riporto la tabella a prima dell'IMPORT
+    printf("❌ Errore: %s (%s)\n", error, query->path);
+    fflush(table);
+    if (ftruncate(fileno(table), original_size) != 0) { printf("❌ Errore: impossibile ripristinare la tabella %s\n", query->nome_tabella); }
+  }
+
+  fclose(table);
+  fclose(file);
+  free(records);
+  free(data);
+  return error ? -1 : (long)imported;
+}
@@ -0,0 +1,43 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <stdint.h>
+
+// Config Header
+#include "../config.h"
+
+
+#define COLUMNAR_MAGIC "MDBCOLS"                // I primi 8 byte di un file COLUMNAR (compreso lo '\0')
+
+typedef enum {                                  // ColumnarEncoding: come sono scritti i valori di una colonna in un blocco
+  COLUMNAR_PLAIN,                               // PLAIN: i valori uno dopo l'altro, a dimensione fissa
+  COLUMNAR_RLE,                                 // RLE: coppie [ripetizioni (uint32) | valore], per valori uguali consecutivi
+  COLUMNAR_STRING                               // STRING: solo per char, coppie [lunghezza (uint8) | caratteri], senza gli zeri finali
+} ColumnarEncoding;
+
+typedef struct {                                // ColumnarHeader: intestazione di un file COLUMNAR
+  char magic[8];                                // magic: COLUMNAR_MAGIC, per riconoscere il formato
+  uint32_t version;                             // version: COLUMNAR_VERSION
+  uint32_t num_columns;                         // num_columns: colonne descritte dopo l'intestazione
+  uint64_t num_rows;                            // num_rows: record in tutti i blocchi
+} ColumnarHeader;
+
+typedef struct {                                // ColumnarColumn: descrizione di una colonna, uguale alla sua definizione nello schema
+  char nome[50];                                // nome: il nome della colonna
+  char tipo[50];                                // tipo: il nome del tipo, ad esempio "int" o "char"
+  uint32_t length;                              // length: byte di un valore
+} ColumnarColumn;
+
+typedef struct {                                // ColumnarChunk: intestazione dei valori di una colonna in un blocco
+  uint32_t encoding;                            // encoding: un ColumnarEncoding
+  uint32_t stored_size;                         // stored_size: byte dei valori scritti dopo l'intestazione
+} ColumnarChunk;
+
+
+// Functions Available including the Columnar
+long export_columnar_file(const ColumnarQuery *query);
+long import_columnar_file(const ColumnarQuery *query);
+
+
+
+#endif
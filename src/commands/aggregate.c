@@ -0,0 +1,238 @@
+/* 
+
+
+  Aggregate.c (commands) è il file che racchiude le funzioni relative al comando AGGREGATE.
+  Le funzioni descritte in questo file sono:
+    - validate_aggregate: si occupa di validare il comando AGGREGATE e di preparare l'AggregateQuery.
+    - execute_aggregate: si occupa di eseguire il comando AGGREGATE.
+
+  Il comando AGGREGATE calcola delle funzioni di aggregazione sui record di una tabella.
+  Ad esempio:
+    AGGREGATE Ordine COUNT(*)
+    AGGREGATE Ordine SUM(totale) MIN(created_at) COUNT(*)
+    AGGREGATE Ordine SUM(totale) AVG(totale) WHERE stato:'open'
+    AGGREGATE Ordine COUNT(*) SUM(totale) GROUP BY stato,urgente
+    AGGREGATE Ordine COUNT(*) SUM(totale) WHERE stato:'open' SAMPLE 5% SEED 42
+    AGGREGATE Ordine APPROX_COUNT_DISTINCT(cliente) APPROX_PERCENTILE(totale,0.99) GROUP BY stato
+
+  Il comando AGGREGATE accetta dai 3 token in su:
+    - Il primo token deve essere AGGREGATE
+    - Il secondo token deve essere il nome della tabella
+    - I token successivi sono le funzioni: COUNT(*), COUNT(<campo>), SUM(<campo>), MIN(<campo>), MAX(<campo>), AVG(<campo>),
+      APPROX_COUNT_DISTINCT(<campo>) e APPROX_PERCENTILE(<campo>,<p>), con p tra 0 e 1 e senza spazi
+    - Dopo le funzioni si può aggiungere un filtro, opzionalmente preceduto da WHERE (vedi predicate.c per la grammatica)
+    - In fondo si può aggiungere GROUP BY <campo>,<campo>,… per ottenere una riga per ogni gruppo (vedi groupby.c)
+    - Per ultima si può aggiungere SAMPLE <n>% [SEED <s>] per calcolare una stima leggendo solo una parte della tabella (vedi sample.c)
+
+  Il calcolo vero e proprio è fatto da aggregate.c, con un kernel per ogni tipologia di colonna.
+  Un COUNT(*) senza filtro non legge nemmeno i record: il numero di righe si ricava dalla dimensione del file.
+  Con SAMPLE, COUNT e SUM vengono riportati all'intera tabella e stampati con il loro intervallo di confidenza al 95%.
+  APPROX_COUNT_DISTINCT non si può usare con SAMPLE: i valori distinti di un campione non si riportano alla tabella moltiplicando.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp
+
+#include "aggregate.h"
+#include "read.h"
+#include "../aggregate.h"
+#include "../groupby.h"
+#include "../schema.h"
+#include "../scan.h"
+#include "../predicate.h"
+#include "../sample.h"
+#include "../planner.h"
+#include "../arena.h"
+#include "../output.h"
+
+
+/**
+ * Funzione che valida i token del comando AGGREGATE e prepara la query.
+ * Devono essere almeno AGGREGATE_INIT_TOKENS + 1 token
+ * - Controlla che il primo token sia AGGREGATE
+ * - Controlla che la tabella esista nello schema
+ * - Controlla che ci sia almeno una funzione di aggregazione valida
+ * - Se presente, compila il filtro
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query La query da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_aggregate(char *tokens[], int token_count, AggregateQuery *query) {
+  if (token_count < AGGREGATE_INIT_TOKENS + 1) {
+    printf("❌ Errore: sintassi non valida. Usa AGGREGATE <NomeTabella> SUM(<campo>) COUNT(*) … [WHERE <predicato>] [GROUP BY <campo>,…] [SAMPLE <n>%%]\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "AGGREGATE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  TableDefinition *table = get_table_from_schema(tokens[1]);
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1]);
+    return FALSE;
+  }
+
+  memset(&query->layout, 0, sizeof(RecordLayout));
+  if (build_record_layout(table, NULL, &query->layout) != SUCCESS) { return FALSE; }
+
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  query->nome_tabella[sizeof(query->nome_tabella) - 1] = '\0';
+  query->num_specs = 0;
+  query->sample.enabled = false;
+
+  int i = AGGREGATE_INIT_TOKENS;
+  for (; i < token_count && is_aggregate_token(tokens[i]); i++) {
+    if (query->num_specs >= MAX_AGGREGATES) {
+      printf("❌ Errore: troppe funzioni di aggregazione (massimo %d)\n", MAX_AGGREGATES);
+      return FALSE;
+    }
+    if (parse_aggregate_spec(&query->layout, tokens[i], &query->specs[query->num_specs]) != SUCCESS) { return FALSE; }
+    query->num_specs++;
+  }
+
+  if (query->num_specs == 0) {
+    printf("❌ Errore: serve almeno una funzione di aggregazione, ad esempio COUNT(*)\n");
+    return FALSE;
+  }
+
+  for (int j = i; j < token_count; j++) {                         // SAMPLE è sempre l'ultima clausola
+    if (strcmp(tokens[j], "SAMPLE") != SUCCESS) { continue; }
+
+    int used = parse_sample_clause(tokens, j, token_count, &query->sample);
+    if (used < 0) { return FALSE; }
+    if (j + used != token_count) {
+      printf("❌ Errore: SAMPLE deve essere l'ultima clausola del comando\n");
+      return FALSE;
+    }
+    token_count = j;
+    break;
+  }
+
+  for (int j = 0; j < query->num_specs && query->sample.enabled; j++) {
+    if (query->specs[j].func == AGG_APPROX_COUNT_DISTINCT) {
+      printf("❌ Errore: APPROX_COUNT_DISTINCT non può essere stimata su un campione (SAMPLE)\n");
+      return FALSE;
+    }
+  }
+
+  if (i < token_count && strcmp(tokens[i], "WHERE") == SUCCESS) { i++; }
+
+  int end = token_count;                                          // Il filtro finisce dove inizia GROUP BY
+  query->group_by.num_colonne = 0;
+
+  for (int j = i; j < token_count; j++) {
+    if (strcmp(tokens[j], "GROUP") != SUCCESS) { continue; }
+
+    if (j + 3 != token_count || strcmp(tokens[j + 1], "BY") != SUCCESS) {
+      printf("❌ Errore: sintassi non valida. Usa GROUP BY <campo>,<campo>,…\n");
+      return FALSE;
+    }
+    if (parse_projection(&query->layout, tokens[j + 2], &query->group_by) != SUCCESS) { return FALSE; }
+    end = j;
+    break;
+  }
+
+  if (compile_predicate(&query->layout, tokens + i, end - i, &query->predicate) != SUCCESS) { return FALSE; }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che verifica se la query è un semplice COUNT(*) senza filtro (e senza campionamento).
+ */
+static bool is_plain_count(const AggregateQuery *query) {
+  if (query->predicate.root >= 0 || query->sample.enabled) { return false; }
+
+  for (int i = 0; i < query->num_specs; i++) {
+    if (query->specs[i].func != AGG_COUNT || query->specs[i].column != -1) { return false; }
+  }
+  return true;
+}
+
+
+/**
+ * Funzione che esegue il comando AGGREGATE.
+ * La tabella viene letta a batch: se c'è un filtro, per ogni batch si costruisce il vettore di selezione
+ * con le posizioni dei record che lo soddisfano, poi ogni funzione accumula il batch con il suo kernel.
+ * Gli stati sono allocati nell'arena con la dimensione che serve a ogni funzione (gli sketch sono più grandi di un AggregateState).
+ */
+void execute_aggregate(const AggregateQuery *query) {
+  if (query->group_by.num_colonne > 0) {                          // Con GROUP BY si usa la tabella hash dei gruppi
+    execute_group_by(query);
+    return;
+  }
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return; }
+  set_scan_sample(&scan, &query->sample);
+  plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);
+
+  AggregateState *states[MAX_AGGREGATES];
+  SampleMoments moments[MAX_AGGREGATES];                          // Con SAMPLE: totali per blocco, per l'intervallo di confidenza
+  for (int i = 0; i < query->num_specs; i++) {
+    states[i] = create_aggregate_state(&query->layout, &query->specs[i]);
+    if (!states[i]) {
+      close_table_scan(&scan);
+      return;
+    }
+    memset(&moments[i], 0, sizeof(SampleMoments));
+  }
+
+  if (is_plain_count(query)) {                                    // COUNT(*) senza filtro: basta la dimensione del file, meno i record eliminati
+    long rows = count_live_records(&scan);
+    for (int i = 0; i < query->num_specs; i++) { states[i]->count = rows; }
+  } else {
+    const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+    int *sel = arena_alloc(scan.batch_records * sizeof(int));     // Vettore di selezione, riutilizzato per ogni batch
+    if (!sel) {
+      close_table_scan(&scan);
+      return;
+    }
+    size_t count;
+
+    while ((count = read_scan_batch(&scan)) > 0) {
+      const int *batch_sel = NULL;
+      size_t selected = count;
+
+      if (pred) {
+        selected = 0;
+        for (size_t r = 0; r < count; r++) {
+          if (evaluate_predicate(pred, scan.buffer + r * scan.record_size)) { sel[selected++] = (int)r; }
+        }
+        batch_sel = sel;
+      }
+
+      for (int i = 0; i < query->num_specs; i++) {
+        if (!scan.sampling || query->specs[i].func == AGG_APPROX_PERCENTILE) {
+          accumulate_batch(&query->layout, &query->specs[i], states[i], scan.buffer, scan.record_size, batch_sel, selected);
+          continue;
+        }
+
+        AggregateState block;                                     // Con SAMPLE ogni batch è un blocco: serve anche il suo totale
+        init_aggregate_state(&query->specs[i], &block);
+        accumulate_batch(&query->layout, &query->specs[i], &block, scan.buffer, scan.record_size, batch_sel, selected);
+        add_sample_block(&moments[i], get_aggregate_total(&query->layout, &query->specs[i], &block), (double)block.count, (double)count);
+        merge_aggregate_state(&query->layout, &query->specs[i], states[i], &block);
+      }
+    }
+  }
+
+  output_title("Tabella: %s\n", query->nome_tabella);
+  print_sample_summary(&scan);
+  for (int i = 0; i < query->num_specs; i++) { output_column_name(query->specs[i].label); }
+  output_end_row();
+  for (int i = 0; i < query->num_specs; i++) {
+    if (scan.sampling) { print_sample_estimate(&query->layout, &query->specs[i], states[i], &moments[i], &scan); }
+    else               { print_aggregate_value(&query->layout, &query->specs[i], states[i]); }
+  }
+  output_end_row();
+
+  close_table_scan(&scan);
+}
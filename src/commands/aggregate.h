@@ -0,0 +1,14 @@
+#ifndef AGGREGATE_COMMAND_H
+#define AGGREGATE_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the AGGREGATE
+int validate_aggregate(char *tokens[], int token_count, AggregateQuery *query);
+void execute_aggregate(const AggregateQuery *query);
+
+
+
+#endif
@@ -0,0 +1,82 @@
+/*
+
+
+  Analyze.c è il file che racchiude le funzioni relative al comando ANALYZE.
+  Le funzioni descritte in questo file sono:
+    - validate_analyze: si occupa di validare il comando ANALYZE.
+    - execute_analyze: si occupa di eseguire il comando ANALYZE.
+
+  Il comando ANALYZE legge tutta una tabella e ne raccoglie le statistiche (vedi stats.c).
+  Ad esempio:
+    ANALYZE Utente
+
+  Il comando ANALYZE accetta esattamente 2 token:
+    - Il primo token deve essere ANALYZE
+    - Il secondo token deve essere il nome della tabella
+
+  Le statistiche vengono salvate in tables/<T>.stats e usate da READ, FIND, AGGREGATE ed EXPLAIN
+  per scegliere come leggere la tabella. Conviene rieseguire ANALYZE dopo aver inserito molti record.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, memset
+
+#include "analyze.h"
+#include "../schema.h"
+#include "../stats.h"
+
+
+/**
+ * Funzione che valida i token del comando ANALYZE.
+ * Devono essere esattamente ANALYZE_INIT_TOKENS token
+ * - Controlla che il primo token sia ANALYZE
+ * - Controlla che la tabella esista nello schema
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_analyze(char *tokens[], int token_count) {
+  if (token_count != ANALYZE_INIT_TOKENS) {
+    printf("❌ Errore: sintassi non valida. Usa ANALYZE <NomeTabella>\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "ANALYZE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (get_table_from_schema(tokens[1]) == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1]);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando ANALYZE: calcola le statistiche della tabella, le salva e le stampa.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ */
+void execute_analyze(char *tokens[], int token_count) {
+  (void)token_count;
+
+  TableDefinition *table = get_table_from_schema(tokens[1]);
+  if (table == NULL) { return; }
+
+  RecordLayout layout;
+  memset(&layout, 0, sizeof(RecordLayout));
+  if (build_record_layout(table, NULL, &layout) != SUCCESS) { return; }
+
+  TableStats stats;
+  if (analyze_table(table->nome_tabella, &layout, &stats) != SUCCESS) { return; }
+  if (save_table_stats(table->nome_tabella, &stats) != SUCCESS) { return; }
+
+  printf("Tabella: %s\n", table->nome_tabella);
+  print_table_stats(&layout, &stats);
+}
@@ -0,0 +1,14 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the ANALYZE
+int validate_analyze(char *tokens[], int token_count);
+void execute_analyze(char *tokens[], int token_count);
+
+
+
+#endif
@@ -0,0 +1,68 @@
+/*
+
+
+  Cache.c è il file che racchiude le funzioni relative al comando CACHE.
+  Le funzioni descritte in questo file sono:
+    - validate_cache: si occupa di validare il comando CACHE.
+    - execute_cache: si occupa di eseguire il comando CACHE.
+
+  Il comando CACHE mostra e configura la cache dei risultati di READ, FIND, AGGREGATE e JOIN (vedi src/cache.c).
+  Ad esempio:
+    CACHE                   ➝ stampa i risultati salvati, la memoria usata, gli hit e i miss
+    CACHE CLEAR             ➝ svuota la cache
+    CACHE LIMIT 1048576     ➝ usa al massimo 1MB di memoria (0 disattiva la cache)
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // strtol
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp
+
+#include "cache.h"
+#include "../cache.h"
+
+
+/**
+ * Funzione che valida i token del comando CACHE.
+ * - CACHE da solo, oppure CACHE CLEAR, oppure CACHE LIMIT <byte> con un numero intero non negativo
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_cache(char *tokens[], int token_count) {
+  if (strcmp(tokens[0], "CACHE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (token_count == 1) { return TRUE; }
+  if (token_count == 2 && strcmp(tokens[1], "CLEAR") == SUCCESS) { return TRUE; }
+
+  if (token_count == 3 && strcmp(tokens[1], "LIMIT") == SUCCESS) {
+    char *end;
+    long bytes = strtol(tokens[2], &end, 10);
+    if (*end == '\0' && end != tokens[2] && bytes >= 0) { return TRUE; }
+  }
+
+  printf("❌ Errore: sintassi non valida. Usa CACHE, CACHE CLEAR oppure CACHE LIMIT <byte>\n");
+  return FALSE;
+}
+
+
+/**
+ * Funzione che esegue il comando CACHE.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ */
+void execute_cache(char *tokens[], int token_count) {
+  if (token_count == 2) {
+    clear_result_cache();
+    printf("✅ Cache svuotata\n");
+  } else if (token_count == 3) {
+    set_result_cache_limit(strtol(tokens[2], NULL, 10));
+  }
+
+  print_result_cache_stats();
+}
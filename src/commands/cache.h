@@ -0,0 +1,14 @@
+#ifndef CACHE_COMMAND_H
+#define CACHE_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the CACHE
+int validate_cache(char *tokens[], int token_count);
+void execute_cache(char *tokens[], int token_count);
+
+
+
+#endif
@@ -1,6 +1,6 @@
 #include <stdio.h>                  // Funzioni per la gestione di input/output: printf, scanf, fopen, fclose, fread, fwrite, fseek, remove, rename
 #include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free, exit
-#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcpy
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcpy, strncpy, memcpy
 #include <stdbool.h>                // Definisce il tipo di dato bool e le costanti true e false
 #include <ctype.h>                  // Funzioni per la manipolazione dei caratteri: isalpha, isdigit
 #include <unistd.h>                 // Funzioni per access(), F_OK, R_OK, W_OK
@@ -10,102 +10,149 @@
 #include "create.h"
 #include "../schema.h"
 #include "../utils.h"
+#include "../materialize.h"
+#include "../arena.h"
+#include "../wal.h"
+#include "../transaction.h"
 
 
 
 
 
-void execute_create(char *tokens[], int token_count) {
-  if (token_count < 3) {
-    printf("Errore: comando CREATE incompleto\n");
+/**
+ * Funzione che esegue il comando CREATE già validato.
+ * I record sono già stati valorizzati da validate_create: mancano solo i campi automatici.
+ * ID e CreatedAt vengono valorizzati qui, UpdatedAt resta nullo perchè sarà inserito a ogni UPDATE.
+ * Non voglio che l'utente si preoccupi minimamente di aggiungere questi campi alle sue tabelle.
+ *
+ * Con più righe l'ultimo id viene letto una volta sola e i record vengono scritti in un'unica transazione del log
+ * (vedi wal.c), con un solo fdatasync: o vengono aggiunti tutti, o nessuno.
+ * Dentro una transazione i record vengono tenuti fino al COMMIT (vedi transaction.c), che assegna anche gli id.
+ *
+ * @param query Il CREATE da eseguire
+ */
+void execute_create(CreateQuery *query) {
+  size_t record_size = query->layout.record_size;
+
+  if (in_transaction()) {
+    long timestamp = get_current_timestamp();
+    for (int r = 0; r < query->num_records && query->created_at_column >= 0; r++) {
+      memcpy(query->records + (size_t)r * record_size + query->layout.colonne[query->created_at_column].offset, &timestamp, sizeof(long));
+    }
+    if (stage_table_append(query->nome_tabella, record_size, query->records, query->num_records) != SUCCESS) { return; }
+
+    if (query->num_records == 1) { printf("Record aggiunto alla tabella %s\n", query->nome_tabella); }
+    else { printf("%d record aggiunti alla tabella %s\n", query->num_records, query->nome_tabella); }
     return;
   }
 
-  const char *table_name = tokens[1];                                         // Nome della tabella
-  TableDefinition* table = get_table_from_schema(table_name);                 // Ottengo lo schema della tabella
+  FILE* file = open_table_file(query->nome_tabella, "a+b");                 // Step 1: Apro la tabella, in lettura per l'ultimo id e in scrittura in fondo
+  if (!file) { return; }
 
-  void *record = create_table_record_struct(table_name);                      // Step 1: Creo una nuova struct per il record
-  if (record == NULL) {
-    printf("Errore: impossibile creare la struct del record\n");
+  fseek(file, 0, SEEK_END);
+  long original_size = ftell(file);
+  int next_id = read_next_id(file, original_size, record_size);             // Step 2: Imposto gli ID (consecutivi) e CreatedAt con il timestamp di creazione
+  long timestamp = get_current_timestamp();
+
+  for (int r = 0; r < query->num_records; r++) {
+    char *record = query->records + (size_t)r * record_size;
+    int id = next_id + r;
+    memcpy(record, &id, sizeof(int));                                       // L'id è sempre il primo campo del record
+    if (query->created_at_column >= 0) {
+      memcpy(record + query->layout.colonne[query->created_at_column].offset, &timestamp, sizeof(long));
+    }
+  }
+
+  fclose(file);
+
+  WalTransaction txn;                                                       // Step 3: Scrivo tutti i record in fondo alla tabella, passando dal log
+  wal_begin(&txn);
+  wal_log_table_write(&txn, query->nome_tabella, original_size, query->records, (size_t)query->num_records * record_size);
+
+  if (wal_commit(&txn) != SUCCESS) {
+    printf("❌ Errore: impossibile scrivere nella tabella %s\n", query->nome_tabella);
     return;
   }
 
-  size_t offset = 0;
-
-  ColumnDefinition col;
-  ColumnValueDefinition col_val;
-
-  for (int i = 0; i < table->num_colonne; i++) {                              // Step 2: Scorro le colonne della tabella per scrivere i valori nei campi corrispondenti
-    col = table->colonne[i];
-
-    // ID, CreatedAt e UpdatedAt sono i campi che vengono valorizzati in modo automatico
-    // Non voglio che l'utente si preoccupi minimamente di aggiungere questi campi alle sue tabelle
-    if (strcmp(col.nome_colonna, "id") == SUCCESS) {                  // Imposto l'ID
-      int next_id = get_next_id_for_table(table_name);
-      memcpy((char*)record + offset, &next_id, col.tipo.length);
-    } else if (strcmp(col.nome_colonna, "created_at") == SUCCESS) {   // Imposto CreatedAt con il timestamp di creazione
-      long timestamp = get_current_timestamp();
-      memcpy((char*)record + offset, &timestamp, col.tipo.length);
-      continue;
-    } else if (strcmp(col.nome_colonna, "updated_at") == SUCCESS) {   // UpdatedAt è nullo perchè sarà inserito a ogni UPDATE
-      memcpy((char*)record + offset, get_null_value(col.tipo), col.tipo.length);
-      continue;
-    } else {
-
-
-      // Cerco tra i token il valore per questa colonna
-      int found = FALSE;
-
-      for (int j = CREATE_INIT_TOKENS; j < token_count; j++) {
-        col_val = parse_column_value_definition(table, tokens[j]);
-
-        if (col_val.valore && strcmp(col_val.campo.nome_colonna, col.nome_colonna) == SUCCESS) {
-          memcpy((char*)record + offset, col_val.valore, col.tipo.length);
-          free(col_val.valore); // Libera la memoria allocata in parse_column_value_definition
-          found = TRUE;
-          break;
-        }
-      }
-
-      if (!found) {                                                           // Per tutti gli altri campi, metto il loro NULL
-        memcpy((char*)record + offset, get_null_value(col.tipo), col.tipo.length);
-      }
+  if (query->num_records == 1) { printf("Record aggiunto alla tabella %s\n", query->nome_tabella); }
+  else { printf("%d record aggiunti alla tabella %s\n", query->num_records, query->nome_tabella); }
+
+  // Step 4: Aggiorno le viste materializzate della tabella
+  maintain_materialized_views_batch(query->nome_tabella, query->records, query->num_records, record_size, 1);
+}
+
+
+
+/**
+ * Funzione che divide i token di un CREATE con più righe, ognuna tra parentesi: (campo:valore …) (campo:valore …)
+ * Le parentesi vengono tolte dai token e i token vuoti (una parentesi da sola) vengono saltati,
+ * così i token di ogni riga restano consecutivi e si possono passare a bind_column_values.
+ * Un valore senza apici non può finire con ')': va scritto tra apici.
+ *
+ * @param tokens Array di token, che viene compattato
+ * @param token_count Numero di token
+ * @param row_end Per ogni riga, l'indice del token dopo il suo ultimo
+ * @return Il numero di righe, -1 se le parentesi non sono valide
+ */
+static int split_create_rows(char *tokens[], int token_count, int *row_end) {
+  int out = CREATE_INIT_TOKENS;
+  int rows = 0;
+  bool open = false;
+
+  for (int i = CREATE_INIT_TOKENS; i < token_count; i++) {
+    char *token = tokens[i];
+
+    if (*token == '(') {
+      if (open) { printf("❌ Errore: la riga %d non è chiusa da ')'\n", rows + 1); return -1; }
+      open = true;
+      token++;
+    } else if (!open) {
+      printf("❌ Errore: %s è fuori dalle parentesi. Usa CREATE <NomeTabella> (<campo>:<valore> …) (<campo>:<valore> …)\n", token);
+      return -1;
     }
 
-    offset += col.tipo.length;                                                // Aggiorno l'offset con la lunghezza della colonna attuale
-  }
+    size_t length = strlen(token);
+    bool close = length > 0 && token[length - 1] == ')';
+    if (close) { token[length - 1] = '\0'; }
 
-  // Step 3: Scrivo il record nella tabella corrispondente
-  FILE* file = open_table_file(table_name, "a+b");
+    if (*token) { tokens[out++] = token; }
 
-  if (file) {
-    fwrite(record, get_record_size(table_name), 1, file);
-    printf("Record aggiunto alla tabella %s\n", table_name);
+    if (close) {
+      if (out == (rows ? row_end[rows - 1] : CREATE_INIT_TOKENS)) { printf("❌ Errore: la riga %d è vuota\n", rows + 1); return -1; }
+      row_end[rows++] = out;
+      open = false;
+    }
+  }
 
-    free_table_record_struct(record);
-    fclose(file);
+  if (open) {
+    printf("❌ Errore: la riga %d non è chiusa da ')'\n", rows + 1);
+    return -1;
   }
-  
+  return rows;
 }
 
 
 
 /**
- * Funzione che valida i token del comando CREATE.
+ * Funzione che valida i token del comando CREATE e prepara i record da scrivere.
  * Devono essere almeno CREATE_INIT_TOKENS + 1 token
  * - Controlla che il primo token sia CREATE
  * - Controlla che il nome della tabella sia una stringa valida
  * - Controlla che i token successivi siano nella forma campo:valore
- * - Controlla che il campo esista nello schema della tabella
- * - Controlla che il valore non sia vuoto
- * - Controlla che il valore non superi la lunghezza massima
- * - Controlla che il valore sia un numero valido se il tipo è int
+ * - Controlla che il campo esista nello schema della tabella e non sia automatico
+ * - Controlla che il valore sia valido per il tipo del campo
+ *
+ * Ogni token viene letto una volta sola: il valore viene convertito direttamente nel record, all'offset della sua colonna,
+ * così execute_create non deve più guardare i token.
+ * Se il primo campo inizia con '(' il comando ha più righe, una per record: CREATE Utente (nome:'A' eta:1) (nome:'B' eta:2)
+ * La tabella viene cercata una volta sola per tutte le righe.
  *
  * @param tokens Array di token
  * @param token_count Numero di token
+ * @param query Il CREATE da valorizzare
  * @return 1 se il comando è valido, 0 altrimenti
  */
-int validate_create(char *tokens[], int token_count) {
+int validate_create(char *tokens[], int token_count, CreateQuery *query) {
   if (token_count < CREATE_INIT_TOKENS + 1) {
     printf("❌ Errore: sintassi non valida. Usa CREATE <NomeTabella> <campo>:<valore> <campo>:<valore> …\n");
     return FALSE;
@@ -129,20 +176,40 @@ int validate_create(char *tokens[], int token_count) {
     return FALSE;
   }
 
-  // Verifica che tutti i token rimanenti siano nella forma campo:valore
-  ColumnValueDefinition couple;
+  memset(&query->layout, 0, sizeof(RecordLayout));
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  query->nome_tabella[sizeof(query->nome_tabella) - 1] = '\0';
+  if (build_record_layout(table, NULL, &query->layout) != SUCCESS) {
+    printf("Errore: impossibile costruire il record della tabella %s\n", table_name);
+    return FALSE;
+  }
+  query->created_at_column = get_layout_column_index(&query->layout, "created_at");
+
+  // Divido le righe: senza parentesi c'è una riga sola, con tutti i token
+  int *row_end = arena_alloc((size_t)token_count * sizeof(int));
+  if (!row_end) { return FALSE; }
+
+  if (tokens[CREATE_INIT_TOKENS][0] == '(') {
+    query->num_records = split_create_rows(tokens, token_count, row_end);
+    if (query->num_records < 0) { return FALSE; }
+  } else {
+    query->num_records = 1;
+    row_end[0] = token_count;
+  }
 
-  for (int i = CREATE_INIT_TOKENS; i < token_count; i++) {
-    printf("Step hihi dentro for: %i %s\n", i, tokens[i]);
-    couple = parse_column_value_definition(table, tokens[i]);
+  size_t record_size = query->layout.record_size;
+  query->records = arena_alloc((size_t)query->num_records * record_size);
+  if (!query->records) { return FALSE; }
 
-    if (strlen(couple.campo.nome_colonna) == 0) {
-      printf("Errore: token non valido per %s\n", tokens[i]);
+  // Abbino ogni token campo:valore alla sua colonna e lo converto nel record della sua riga
+  for (int r = 0; r < query->num_records; r++) {
+    int start = r ? row_end[r - 1] : CREATE_INIT_TOKENS;
+    if (bind_column_values(&query->layout, tokens, start, row_end[r], query->records + (size_t)r * record_size, NULL, NULL) != SUCCESS) {
+      if (query->num_records > 1) { printf("❌ Errore nella riga %d: nessun record aggiunto\n", r + 1); }
       return FALSE;
     }
   }
 
-
   printf("✅ Comando CREATE valido\n");
   return TRUE;
 }
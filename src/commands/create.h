@@ -6,8 +6,8 @@
 
 
 // Functions Available including the Define
-void execute_create(char *tokens[], int token_count);
-int validate_create(char *tokens[], int token_count);
+void execute_create(CreateQuery *query);
+int validate_create(char *tokens[], int token_count, CreateQuery *query);
 
 void create_tables_directory_if_not_exists();
 
@@ -125,6 +125,11 @@ int validate_define(char *tokens[], int token_count) {
     return FALSE;
   }
 
+  if (token_count - DEFINE_INIT_TOKENS + 3 > MAX_FIELDS) {          // id, created_at e updated_at vengono aggiunti dal sistema
+    printf("❌ Errore: troppi campi (massimo %d, compresi id, created_at e updated_at)\n", MAX_FIELDS);
+    return FALSE;
+  }
+
   ColumnDefinition col;
   for (int i = DEFINE_INIT_TOKENS; i < token_count; i++) { 
     col = parse_column_definition(tokens[i]);
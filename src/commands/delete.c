@@ -0,0 +1,139 @@
+/*
+
+
+  Delete.c è il file che racchiude le funzioni relative al comando DELETE.
+  Le funzioni descritte in questo file sono:
+    - validate_delete: si occupa di validare il comando DELETE.
+    - execute_delete: si occupa di eseguire il comando DELETE.
+
+  Il comando DELETE elimina un record tramite il suo id.
+  Ad esempio:
+    DELETE Utente 1
+
+  Il comando DELETE accetta esattamente 3 token:
+    - Il primo token deve essere DELETE
+    - Il secondo token deve essere il nome della tabella
+    - Il terzo token deve essere l'id del record da eliminare
+
+  Il record non viene tolto dal file: viene segnato come eliminato nella mappa tables/<T>.del (vedi tombstone.c),
+  scrivendo un solo byte, e da quel momento nessuna lettura lo vede più. L'eliminazione passa dal log (vedi wal.c):
+  viene applicata alla mappa solo quando è durevole. Il record viene cercato per id con una ricerca
+  binaria, quindi anche su una tabella grande DELETE non legge quasi nulla.
+  Quando in una parte della tabella ci sono troppi record eliminati, lo spazio viene recuperato in background (vedi compact.c).
+  Dentro una transazione l'eliminazione viene applicata al COMMIT (vedi transaction.c).
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // strtol
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memcpy, memset
+
+#include "delete.h"
+#include "../schema.h"
+#include "../scan.h"
+#include "../compact.h"
+#include "../materialize.h"
+#include "../arena.h"
+#include "../wal.h"
+#include "../transaction.h"
+
+
+/**
+ * Funzione che valida i token del comando DELETE.
+ * Devono essere esattamente DELETE_INIT_TOKENS token
+ * - Controlla che il primo token sia DELETE
+ * - Controlla che la tabella esista nello schema
+ * - Controlla che l'id sia un numero intero positivo
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query Il DELETE da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_delete(char *tokens[], int token_count, DeleteQuery *query) {
+  if (token_count != DELETE_INIT_TOKENS) {
+    printf("❌ Errore: sintassi non valida. Usa DELETE <NomeTabella> <ID>\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "DELETE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  TableDefinition *table = get_table_from_schema(tokens[1]);
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1]);
+    return FALSE;
+  }
+
+  char *endptr;
+  long id = strtol(tokens[2], &endptr, 10);
+  if (*tokens[2] == '\0' || *endptr != '\0' || id < 1 || id > 2147483647L) {
+    printf("❌ Errore: l'id deve essere un numero intero positivo\n");
+    return FALSE;
+  }
+
+  memset(query, 0, sizeof(DeleteQuery));
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  query->id = (int)id;
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando DELETE già validato.
+ * Step 1: cerco il record per id (ricerca binaria, vedi find_position_after_id)
+ * Step 2: scrivo l'eliminazione nel log: il commit la rende durevole e la applica alla mappa della tabella
+ * Step 3: tolgo il record dalle aggregazioni materializzate
+ * Step 4: se nel suo blocco i record eliminati sono troppi, chiedo di compattare la tabella
+ *
+ * Dentro una transazione (vedi transaction.c) l'eliminazione viene solo tenuta fino al COMMIT, che si occupa anche
+ * delle viste e della compattazione. Un record aggiunto dalla stessa transazione viene eliminato dal suo buffer.
+ *
+ * @param query Il DELETE da eseguire
+ */
+void execute_delete(const DeleteQuery *query) {
+  if (in_transaction() && delete_staged_record(query->nome_tabella, query->id) == SUCCESS) {
+    printf("Record %d eliminato dalla tabella %s\n", query->id, query->nome_tabella);
+    return;
+  }
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return; }
+
+  char *record = arena_alloc(scan.record_size);                           // Step 1: cerco il record (un record già eliminato non si legge)
+  long position = find_position_after_id(&scan, query->id - 1);
+  int id = -1;
+  if (record && read_record_at(&scan, position, record) == SUCCESS) { memcpy(&id, record, sizeof(int)); }
+
+  if (id != query->id || is_record_staged_deleted(query->nome_tabella, position)) {
+    printf("❌ Errore: il record %d non esiste nella tabella %s\n", query->id, query->nome_tabella);
+    close_table_scan(&scan);
+    return;
+  }
+
+  if (in_transaction()) {
+    close_table_scan(&scan);
+    if (stage_record_deleted(query->nome_tabella, position) == SUCCESS) { printf("Record %d eliminato dalla tabella %s\n", query->id, query->nome_tabella); }
+    return;
+  }
+
+  WalTransaction txn;                                                     // Step 2: lo segno come eliminato
+  wal_begin(&txn);
+  wal_log_record_deleted(&txn, query->nome_tabella, position);
+
+  if (wal_commit(&txn) != SUCCESS) {
+    printf("❌ Errore: impossibile eliminare il record %d dalla tabella %s\n", query->id, query->nome_tabella);
+    close_table_scan(&scan);
+    return;
+  }
+
+  printf("Record %d eliminato dalla tabella %s\n", query->id, query->nome_tabella);
+
+  maintain_materialized_views(query->nome_tabella, record, -1);          // Step 3: aggiorno le viste materializzate
+
+  request_compaction_if_needed(query->nome_tabella, scan.file, position, count_table_records(&scan), scan.record_size);   // Step 4
+  close_table_scan(&scan);
+}
@@ -0,0 +1,14 @@
+#ifndef DELETE_COMMAND_H
+#define DELETE_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the DELETE
+int validate_delete(char *tokens[], int token_count, DeleteQuery *query);
+void execute_delete(const DeleteQuery *query);
+
+
+
+#endif
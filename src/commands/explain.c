@@ -0,0 +1,157 @@
+/*
+
+
+  Explain.c è il file che racchiude le funzioni relative al comando EXPLAIN.
+  Le funzioni descritte in questo file sono:
+    - validate_explain: si occupa di validare il comando EXPLAIN e la query da spiegare.
+    - execute_explain: si occupa di eseguire il comando EXPLAIN.
+
+  Il comando EXPLAIN mostra come verrebbe eseguita una query READ, FIND o AGGREGATE, con le stime del planner (vedi planner.c).
+  Ad esempio:
+    EXPLAIN FIND Ordine id>=100 AND id<200 AND totale>50
+    EXPLAIN AGGREGATE Ordine COUNT(*) WHERE stato:'open' GROUP BY cliente
+
+  Il comando EXPLAIN accetta dai 3 token in su:
+    - Il primo token deve essere EXPLAIN
+    - I token successivi sono la query da spiegare, scritta come al solito
+
+  Oltre al piano scelto e al suo costo, la query viene eseguita davvero, ma senza stampare i record:
+  si contano i record letti e quelli che soddisfano il predicato, e si confrontano con le stime.
+  Così si vede subito se le statistiche sono da aggiornare (ANALYZE).
+  LIMIT non ferma il conteggio: si contano tutti i record che la query potrebbe restituire.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp
+
+#include "explain.h"
+#include "read.h"
+#include "find.h"
+#include "aggregate.h"
+#include "../scan.h"
+#include "../predicate.h"
+#include "../planner.h"
+#include "../sample.h"
+#include "../sort.h"
+#include "../groupby.h"
+
+
+/**
+ * Funzione che valida i token del comando EXPLAIN e prepara la query da spiegare.
+ * Devono essere almeno EXPLAIN_INIT_TOKENS + 2 token
+ * - Controlla che il primo token sia EXPLAIN
+ * - Controlla che la query sia un READ, un FIND o un AGGREGATE, e la valida con la sua funzione
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query La query da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_explain(char *tokens[], int token_count, ExplainQuery *query) {
+  if (token_count < EXPLAIN_INIT_TOKENS + 2) {
+    printf("❌ Errore: sintassi non valida. Usa EXPLAIN READ|FIND|AGGREGATE …\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "EXPLAIN") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  char **inner = tokens + EXPLAIN_INIT_TOKENS;
+  int inner_count = token_count - EXPLAIN_INIT_TOKENS;
+
+  if (strcmp(inner[0], "READ") == SUCCESS) {
+    query->command = CMD_READ;
+    return validate_read(inner, inner_count, &query->read);
+  }
+  if (strcmp(inner[0], "FIND") == SUCCESS) {
+    query->command = CMD_FIND;
+    return validate_find(inner, inner_count, &query->read);
+  }
+  if (strcmp(inner[0], "AGGREGATE") == SUCCESS) {
+    query->command = CMD_AGGREGATE;
+    return validate_aggregate(inner, inner_count, &query->aggregate);
+  }
+
+  printf("❌ Errore: EXPLAIN supporta solo READ, FIND e AGGREGATE\n");
+  return FALSE;
+}
+
+
+/**
+ * Funzione che stampa come viene eseguito un ORDER BY.
+ */
+static void print_sort_method(const ReadQuery *query) {
+  const char *column = query->layout.colonne[query->order_column].nome;
+  const char *direction = query->order_desc ? " DESC" : "";
+
+  switch (choose_sort_method(query)) {
+    case SORT_INSERTION_ORDER:
+      printf("   Ordinamento: nessuno, ORDER BY %s%s segue l'ordine di inserimento\n", column, direction);
+      break;
+    case SORT_TOP_K:
+      printf("   Ordinamento: top-k su %s%s (heap di %ld record)\n", column, direction, query->limit);
+      break;
+    default:
+      printf("   Ordinamento: ordinamento esterno su %s%s\n", column, direction);
+      break;
+  }
+}
+
+
+/**
+ * Funzione che esegue il comando EXPLAIN: sceglie il piano come farebbe la query, lo stampa,
+ * poi legge la tabella con quel piano contando i record letti e trovati, per confrontarli con le stime.
+ *
+ * @param query La query da spiegare
+ */
+void execute_explain(const ExplainQuery *query) {
+  bool is_read = query->command != CMD_AGGREGATE;
+  const char *table_name = is_read ? query->read.nome_tabella : query->aggregate.nome_tabella;
+  const RecordLayout *layout = is_read ? &query->read.layout : &query->aggregate.layout;
+  const Predicate *predicate = is_read ? &query->read.predicate : &query->aggregate.predicate;
+  const SampleSpec *sample = is_read ? &query->read.sample : &query->aggregate.sample;
+
+  TableScan scan;
+  if (open_table_scan(table_name, &scan) != SUCCESS) { return; }
+  set_scan_sample(&scan, sample);
+
+  AccessPlan plan;
+  choose_access_plan(table_name, layout, predicate, &scan, &plan);
+
+  bool backward = is_read && query->read.order_column >= 0 && query->read.order_desc && choose_sort_method(&query->read) == SORT_INSERTION_ORDER;
+  if (!scan.sampling && !backward && predicate->root >= 0) { apply_access_plan(&scan, &plan); }   // Come plan_table_scan
+
+  if (is_read && query->read.has_cursor && query->read.order_column < 0) {
+    long position = find_position_after_id(&scan, query->read.after_id);
+    seek_table_scan(&scan, position > scan.next_position ? position : scan.next_position);
+  }
+
+  printf("Tabella: %s\n", table_name);
+  print_access_plan(&plan);
+  print_sample_summary(&scan);
+
+  const Predicate *pred = predicate->root >= 0 ? predicate : NULL;
+  long scanned = 0, matched = 0;
+  size_t count;
+
+  while ((count = read_scan_batch(&scan)) > 0) {
+    scanned += (long)count;
+    for (size_t r = 0; r < count; r++) {
+      if (!pred || evaluate_predicate(pred, scan.buffer + r * scan.record_size)) { matched++; }
+    }
+  }
+
+  printf("   Record letti: stimati %.0f, effettivi %ld\n", plan.estimated_scanned, scanned);
+  printf("   Record trovati: stimati %.0f, effettivi %ld\n", plan.estimated_matches, matched);
+
+  if (is_read && query->read.order_column >= 0) { print_sort_method(&query->read); }
+
+  if (!is_read && query->aggregate.group_by.num_colonne > 0) {
+    printf("   Gruppi stimati: %ld (per dimensionare la tabella hash)\n", estimate_group_count(&query->aggregate, plan.rows));
+  }
+
+  close_table_scan(&scan);
+}
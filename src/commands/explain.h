@@ -0,0 +1,14 @@
+#ifndef EXPLAIN_H
+#define EXPLAIN_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the EXPLAIN
+int validate_explain(char *tokens[], int token_count, ExplainQuery *query);
+void execute_explain(const ExplainQuery *query);
+
+
+
+#endif
@@ -0,0 +1,95 @@
+/* 
+
+
+  Find.c è il file che racchiude le funzioni relative al comando FIND.
+  Le funzioni descritte in questo file sono:
+    - validate_find: si occupa di validare il comando FIND e di compilarne il predicato.
+    - execute_find: si occupa di eseguire il comando FIND.
+
+  Il comando FIND cerca i record di una tabella che soddisfano un predicato.
+  Ad esempio:
+    FIND Utente nome:'Luca'
+    FIND Ordine stato:'open' AND (totale>100 OR urgente:true)
+
+    FIND Ordine id,totale totale>100
+
+  Il comando FIND accetta dai 3 token in su:
+    - Il primo token deve essere FIND
+    - Il secondo token deve essere il nome della tabella
+    - Il terzo token, se è una lista di colonne (col1,col2), indica quali colonne stampare
+    - I token successivi formano il predicato (vedi predicate.c per la grammatica)
+    - In fondo si possono aggiungere le clausole di READ: ORDER BY <campo> [DESC], AFTER <cursore> e LIMIT <n>
+
+  Il predicato viene compilato una sola volta in fase di validazione, nella ReadQuery che viene poi eseguita da execute_read.
+  Così durante la scansione della tabella non si fa più nessun parsing: si valutano solo i nodi già pronti.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp
+
+#include "find.h"
+#include "read.h"
+#include "../predicate.h"
+#include "../output.h"
+
+
+/**
+ * Funzione che valida i token del comando FIND e prepara la query.
+ * Devono essere almeno FIND_INIT_TOKENS + 1 token
+ * - Controlla che il primo token sia FIND
+ * - Controlla che la tabella esista nello schema
+ * - Se presente, controlla la lista di colonne da stampare
+ * - Controlla che il predicato sia valido, e lo compila
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query La query da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_find(char *tokens[], int token_count, ReadQuery *query) {
+  if (token_count < FIND_INIT_TOKENS + 1) {
+    printf("❌ Errore: sintassi non valida. Usa FIND <NomeTabella> <campo>:<valore> [AND|OR|NOT ...]\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "FIND") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (prepare_read_query(tokens[1], query) != SUCCESS) { return FALSE; }
+
+  int first = FIND_INIT_TOKENS;                                     // Primo token del predicato
+  if (is_projection_token(tokens[first]) && !is_read_clause_keyword(tokens[first])) {
+    if (parse_projection(&query->layout, tokens[first], &query->projection) != SUCCESS) { return FALSE; }
+    first++;
+  }
+
+  int clauses = find_read_clauses_start(tokens, first, token_count);  // Il predicato finisce dove iniziano ORDER BY/AFTER/LIMIT
+
+  if (first >= clauses) {
+    printf("❌ Errore: manca il predicato. Usa FIND <NomeTabella> [<colonna>,…] <campo>:<valore> … [AFTER <cursore>] [LIMIT <n>]\n");
+    return FALSE;
+  }
+
+  if (compile_predicate(&query->layout, tokens + first, clauses - first, &query->predicate) != SUCCESS) {
+    return FALSE;
+  }
+
+  if (parse_read_clauses(tokens, clauses, token_count, query) != SUCCESS) { return FALSE; }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando FIND.
+ * Scansiona la tabella e stampa solo i record che soddisfano il predicato già compilato.
+ */
+void execute_find(const ReadQuery *query) {
+  long found = execute_read(query);
+  if (found >= 0) {
+    output_title("%ld record trovati\n", found);
+  }
+}
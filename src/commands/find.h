@@ -0,0 +1,14 @@
+#ifndef FIND_H
+#define FIND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the FIND
+int validate_find(char *tokens[], int token_count, ReadQuery *query);
+void execute_find(const ReadQuery *query);
+
+
+
+#endif
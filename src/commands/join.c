@@ -0,0 +1,191 @@
+/*
+
+
+  Join.c è il file che racchiude le funzioni relative al comando JOIN.
+  Le funzioni descritte in questo file sono:
+    - validate_join: si occupa di validare il comando JOIN e di preparare la JoinQuery.
+    - execute_join: si occupa di eseguire il comando JOIN.
+
+  Il comando JOIN unisce i record di due tabelle che hanno lo stesso valore in una colonna.
+  Ad esempio:
+    JOIN Ordine Cliente ON Ordine.cliente = Cliente.id
+    JOIN Ordine Cliente ON Ordine.cliente=Cliente.id Ordine.id,Cliente.nome,Ordine.totale
+    JOIN Ordine Cliente ON Ordine.cliente = Cliente.id WHERE Ordine.totale>100 AND Cliente.nome:'Luca' LIMIT 10
+
+  Il comando JOIN accetta dai 5 token in su:
+    - Il primo token deve essere JOIN
+    - Il secondo e il terzo token sono le due tabelle (diverse tra loro)
+    - Poi ON e la condizione di uguaglianza tra una colonna di ciascuna tabella, con o senza spazi intorno all'=
+    - Se il token successivo è una lista di colonne, indica quali colonne stampare
+    - Poi, opzionalmente, WHERE e un predicato (vedi predicate.c per la grammatica)
+    - In fondo, opzionalmente, LIMIT <n>
+
+  Le colonne si indicano sempre con il nome della tabella davanti: Ordine.totale, Cliente.nome.
+  Le due colonne della condizione devono essere dello stesso tipo.
+  L'esecuzione vera e propria (ricerca per id oppure hash join partizionato) è in src/join.c.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: strtol
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, memset
+
+#include "join.h"
+#include "read.h"
+#include "../join.h"
+#include "../schema.h"
+#include "../predicate.h"
+#include "../utils.h"
+#include "../output.h"
+
+
+/**
+ * Funzione che risolve una colonna della condizione ON e la assegna alla sua tabella.
+ * @return SUCCESS se la colonna esiste e la sua tabella non ha già una colonna di join, FAILURE altrimenti
+ */
+static int resolve_join_column(JoinQuery *query, int columns_a, const char *nome) {
+  int index = get_layout_column_index(&query->layout, nome);
+  if (index < 0) {
+    printf("❌ Errore: il campo '%s' non esiste. Usa <Tabella>.<campo>\n", nome);
+    return FAILURE;
+  }
+
+  int side = index < columns_a ? 0 : 1;
+  if (query->key_columns[side] >= 0) {
+    printf("❌ Errore: la condizione ON deve confrontare una colonna di ciascuna tabella\n");
+    return FAILURE;
+  }
+
+  query->key_columns[side] = index;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che valida i token del comando JOIN e prepara la query.
+ * Devono essere almeno JOIN_INIT_TOKENS + 2 token
+ * - Controlla che il primo token sia JOIN
+ * - Controlla che le due tabelle esistano nello schema e siano diverse
+ * - Controlla la condizione ON, e che le due colonne siano dello stesso tipo
+ * - Se presenti, controlla la lista di colonne da stampare, il filtro e il LIMIT
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query La query da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_join(char *tokens[], int token_count, JoinQuery *query) {
+  if (token_count < JOIN_INIT_TOKENS + 2 || strcmp(tokens[JOIN_INIT_TOKENS], "ON") != SUCCESS) {
+    printf("❌ Errore: sintassi non valida. Usa JOIN <TabellaA> <TabellaB> ON <TabellaA>.<campo> = <TabellaB>.<campo> [<colonna>,…] [WHERE <predicato>] [LIMIT <n>]\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "JOIN") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  TableDefinition *tables[2];
+  for (int side = 0; side < 2; side++) {
+    tables[side] = get_table_from_schema(tokens[1 + side]);
+    if (tables[side] == NULL) {
+      printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1 + side]);
+      return FALSE;
+    }
+  }
+
+  if (tables[0] == tables[1]) {
+    printf("❌ Errore: non è possibile unire una tabella con se stessa\n");
+    return FALSE;
+  }
+
+  // Il record unito è il record della prima tabella seguito da quello della seconda, con le colonne qualificate
+  memset(&query->layout, 0, sizeof(RecordLayout));
+  if (build_record_layout(tables[0], tables[0]->nome_tabella, &query->layout) != SUCCESS) { return FALSE; }
+  int columns_a = query->layout.num_colonne;
+  query->record_sizes[0] = query->layout.record_size;
+
+  if (build_record_layout(tables[1], tables[1]->nome_tabella, &query->layout) != SUCCESS) { return FALSE; }
+  query->record_sizes[1] = query->layout.record_size - query->record_sizes[0];
+
+  for (int side = 0; side < 2; side++) {
+    strncpy(query->tabelle[side], tables[side]->nome_tabella, sizeof(query->tabelle[side]) - 1);
+    query->tabelle[side][sizeof(query->tabelle[side]) - 1] = '\0';
+  }
+
+  query->key_columns[0] = query->key_columns[1] = -1;
+  query->limit = -1;
+
+  // Condizione ON: "A.x = B.y" (tre token) oppure "A.x=B.y" (un token)
+  int i = JOIN_INIT_TOKENS + 1;
+  char left[101], right[101];
+  const char *after;
+
+  if (strchr(tokens[i], '=') != NULL) {
+    if (split_token(tokens[i], '=', left, sizeof(left), &after) != SUCCESS || strlen(after) >= sizeof(right)) {
+      printf("❌ Errore: condizione ON non valida: %s\n", tokens[i]);
+      return FALSE;
+    }
+    strcpy(right, after);
+    i++;
+  } else if (i + 2 < token_count && strcmp(tokens[i + 1], "=") == SUCCESS && strlen(tokens[i]) < sizeof(left) && strlen(tokens[i + 2]) < sizeof(right)) {
+    strcpy(left, tokens[i]);
+    strcpy(right, tokens[i + 2]);
+    i += 3;
+  } else {
+    printf("❌ Errore: condizione ON non valida. Usa ON <TabellaA>.<campo> = <TabellaB>.<campo>\n");
+    return FALSE;
+  }
+
+  if (resolve_join_column(query, columns_a, left) != SUCCESS || resolve_join_column(query, columns_a, right) != SUCCESS) { return FALSE; }
+
+  const LayoutColumn *key_a = &query->layout.colonne[query->key_columns[0]];
+  const LayoutColumn *key_b = &query->layout.colonne[query->key_columns[1]];
+  if (key_a->kind != key_b->kind) {
+    printf("❌ Errore: i campi '%s' (%s) e '%s' (%s) non sono dello stesso tipo\n", key_a->nome, key_a->tipo.name, key_b->nome, key_b->tipo.name);
+    return FALSE;
+  }
+
+  // Colonne da stampare: di default tutte
+  if (i < token_count && strcmp(tokens[i], "WHERE") != SUCCESS && strcmp(tokens[i], "LIMIT") != SUCCESS && is_projection_token(tokens[i])) {
+    if (parse_projection(&query->layout, tokens[i], &query->projection) != SUCCESS) { return FALSE; }
+    i++;
+  } else {
+    parse_projection(&query->layout, "*", &query->projection);
+  }
+
+  int end = token_count;                                          // Il filtro finisce dove inizia LIMIT
+  if (token_count - 2 >= i && strcmp(tokens[token_count - 2], "LIMIT") == SUCCESS) {
+    char *endptr;
+    query->limit = strtol(tokens[token_count - 1], &endptr, 10);
+    if (*endptr != '\0' || query->limit < 0) {
+      printf("❌ Errore: LIMIT deve essere un numero intero non negativo\n");
+      return FALSE;
+    }
+    end = token_count - 2;
+  }
+
+  if (i < end && strcmp(tokens[i], "WHERE") == SUCCESS) {
+    i++;
+    if (i == end) {
+      printf("❌ Errore: manca il predicato dopo WHERE\n");
+      return FALSE;
+    }
+  }
+
+  if (compile_predicate(&query->layout, tokens + i, end - i, &query->predicate) != SUCCESS) { return FALSE; }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando JOIN.
+ * Stampa i record uniti e quanti sono.
+ */
+void execute_join(const JoinQuery *query) {
+  long found = execute_join_query(query);
+  if (found >= 0) {
+    output_title("%ld record trovati\n", found);
+  }
+}
@@ -0,0 +1,14 @@
+#ifndef JOIN_COMMAND_H
+#define JOIN_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the JOIN
+int validate_join(char *tokens[], int token_count, JoinQuery *query);
+void execute_join(const JoinQuery *query);
+
+
+
+#endif
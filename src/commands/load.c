@@ -0,0 +1,114 @@
+/*
+
+
+  Load.c è il file che racchiude le funzioni relative al comando LOAD.
+  Le funzioni descritte in questo file sono:
+    - validate_load: si occupa di validare il comando LOAD.
+    - execute_load: si occupa di eseguire il comando LOAD.
+
+  Il comando LOAD aggiunge a una tabella tutte le righe di un file CSV (vedi load.c per il formato del file).
+  Ad esempio:
+    LOAD Utente FROM 'utenti.csv'
+
+  Il comando LOAD accetta esattamente 4 token:
+    - Il primo token deve essere LOAD
+    - Il secondo token deve essere il nome della tabella
+    - Il terzo token deve essere FROM
+    - Il quarto token deve essere il percorso del file, eventualmente tra apici
+
+  È molto più veloce di un CREATE per ogni riga: il file viene convertito da più thread e scritto a blocchi grandi.
+  Le aggregazioni materializzate della tabella vengono ricalcolate una volta sola, alla fine.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memset
+#include <unistd.h>                 // access, R_OK
+#include <time.h>                   // clock_gettime
+
+#include "load.h"
+#include "../load.h"
+#include "../schema.h"
+#include "../utils.h"
+#include "../materialize.h"
+#include "../transaction.h"
+
+
+/**
+ * Funzione che valida i token del comando LOAD.
+ * Devono essere esattamente LOAD_INIT_TOKENS token
+ * - Controlla che il primo token sia LOAD e il terzo FROM
+ * - Controlla che la tabella esista nello schema
+ * - Controlla che il file esista e si possa leggere
+ * - Controlla che non ci sia una transazione aperta: LOAD scrive direttamente la tabella
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query Il LOAD da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_load(char *tokens[], int token_count, LoadQuery *query) {
+  if (token_count != LOAD_INIT_TOKENS || strcmp(tokens[2], "FROM") != SUCCESS) {
+    printf("❌ Errore: sintassi non valida. Usa LOAD <NomeTabella> FROM '<file.csv>'\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "LOAD") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (in_transaction()) {
+    printf("❌ Errore: LOAD non si può usare dentro una transazione: usa COMMIT o ROLLBACK\n");
+    return FALSE;
+  }
+
+  TableDefinition *table = get_table_from_schema(tokens[1]);
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1]);
+    return FALSE;
+  }
+
+  memset(query, 0, sizeof(LoadQuery));
+  if (copy_path_token(tokens[3], query->path, sizeof(query->path)) != SUCCESS) {     // Il percorso può essere tra apici
+    printf("❌ Errore: il percorso del file non è valido\n");
+    return FALSE;
+  }
+
+  if (access(query->path, R_OK) != 0) {
+    printf("❌ Errore: il file %s non esiste o non si può leggere\n", query->path);
+    return FALSE;
+  }
+
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  if (build_record_layout(table, NULL, &query->layout) != SUCCESS) { return FALSE; }
+  query->created_at_column = get_layout_column_index(&query->layout, "created_at");
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando LOAD e mostra quanti record sono stati caricati e in quanto tempo.
+ *
+ * @param query Il LOAD da eseguire
+ */
+void execute_load(LoadQuery *query) {
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  long loaded = load_csv_file(query);
+  if (loaded < 0) {
+    printf("❌ Nessun record caricato nella tabella %s\n", query->nome_tabella);
+    return;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+  double megabytes = (double)loaded * (double)query->layout.record_size / (1024.0 * 1024.0);
+
+  printf("✅ %ld record caricati nella tabella %s in %.2f secondi (%.1f MB/s)\n", loaded, query->nome_tabella, seconds,
+         seconds > 0 ? megabytes / seconds : 0.0);
+
+  if (loaded > 0) { refresh_table_views(query->nome_tabella); }   // Una sola volta per tutto il LOAD, non per ogni record
+}
@@ -0,0 +1,14 @@
+#ifndef LOAD_COMMAND_H
+#define LOAD_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the LOAD
+int validate_load(char *tokens[], int token_count, LoadQuery *query);
+void execute_load(LoadQuery *query);
+
+
+
+#endif
@@ -0,0 +1,117 @@
+/*
+
+
+  Materialize.c è il file che racchiude le funzioni relative al comando MATERIALIZE.
+  Le funzioni descritte in questo file sono:
+    - validate_materialize: si occupa di validare il comando MATERIALIZE.
+    - execute_materialize: si occupa di eseguire il comando MATERIALIZE.
+
+  Il comando MATERIALIZE salva il risultato di un AGGREGATE come una piccola tabella, aggiornata a ogni CREATE
+  sulla tabella aggregata (vedi src/materialize.c). Si legge con READ, come una tabella:
+    MATERIALIZE OrdiniPerStato AS AGGREGATE Ordine COUNT(*) SUM(totale) AVG(totale) WHERE urgente:true GROUP BY stato
+    READ OrdiniPerStato
+
+  Il comando MATERIALIZE accetta dai 6 token in su:
+    - Il primo token deve essere MATERIALIZE
+    - Il secondo token deve essere il nome della vista, che non può essere quello di una tabella o di un'altra vista
+    - Il terzo token deve essere AS
+    - I token successivi sono un comando AGGREGATE, con le funzioni COUNT, SUM, AVG, MIN e MAX, senza SAMPLE
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, strncat
+
+#include "materialize.h"
+#include "aggregate.h"
+#include "../materialize.h"
+#include "../schema.h"
+#include "../utils.h"
+
+
+/**
+ * Funzione che valida i token del comando MATERIALIZE e prepara la definizione della vista.
+ * Devono essere almeno MATERIALIZE_INIT_TOKENS + 3 token
+ * - Controlla che il primo token sia MATERIALIZE e il terzo AS
+ * - Controlla che il nome della vista sia valido e non sia già usato
+ * - Controlla che il comando AGGREGATE sia valido e che si possa aggiornare in modo incrementale
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param view La vista da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_materialize(char *tokens[], int token_count, MaterializedView *view) {
+  if (token_count < MATERIALIZE_INIT_TOKENS + 3 || strcmp(tokens[2], "AS") != SUCCESS) {
+    printf("❌ Errore: sintassi non valida. Usa MATERIALIZE <NomeVista> AS AGGREGATE <NomeTabella> COUNT(*) … [WHERE <predicato>] [GROUP BY <campo>,…]\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "MATERIALIZE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  char *name = tokens[1];
+  if (!verify_is_only_letters(name) || strlen(name) >= sizeof(view->nome)) {
+    printf("Errore: Il nome della vista non è valido\n");
+    return FALSE;
+  }
+
+  if (get_table_from_schema(name) != NULL || find_materialized_view(name, NULL) == SUCCESS) {
+    printf("❌ Errore: il nome '%s' è già usato da una tabella o da una vista\n", name);
+    return FALSE;
+  }
+
+  char **inner = tokens + MATERIALIZE_INIT_TOKENS;
+  int inner_count = token_count - MATERIALIZE_INIT_TOKENS;
+
+  AggregateQuery query;
+  if (!validate_aggregate(inner, inner_count, &query)) { return FALSE; }
+
+  if (query.sample.enabled) {
+    printf("❌ Errore: una vista non può essere calcolata su un campione (SAMPLE)\n");
+    return FALSE;
+  }
+
+  for (int i = 0; i < query.num_specs; i++) {
+    if (query.specs[i].func == AGG_APPROX_COUNT_DISTINCT || query.specs[i].func == AGG_APPROX_PERCENTILE) {
+      printf("❌ Errore: %s non si può aggiornare in modo incrementale, usa COUNT, SUM, AVG, MIN o MAX\n", query.specs[i].label);
+      return FALSE;
+    }
+  }
+
+  memset(view, 0, sizeof(MaterializedView));
+  strncpy(view->nome, name, sizeof(view->nome) - 1);
+  strncpy(view->tabella, query.nome_tabella, sizeof(view->tabella) - 1);
+
+  size_t length = 0;
+  for (int i = 0; i < inner_count; i++) {                         // Salvo il comando AGGREGATE così com'è, con i token separati da spazi
+    size_t token_length = strlen(inner[i]);
+    if (length + token_length + 1 >= sizeof(view->definizione)) {
+      printf("❌ Errore: la definizione della vista è troppo lunga (massimo %d caratteri)\n", MAX_INPUT_SIZE - 1);
+      return FALSE;
+    }
+
+    if (i > 0) { view->definizione[length++] = ' '; }
+    memcpy(view->definizione + length, inner[i], token_length + 1);
+    length += token_length;
+  }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando MATERIALIZE: calcola la vista leggendo tutta la tabella una volta, poi la registra.
+ * Da quel momento ogni CREATE sulla tabella aggiorna la vista.
+ *
+ * @param view La vista da creare
+ */
+void execute_materialize(const MaterializedView *view) {
+  if (refresh_materialized_view(view) != SUCCESS) { return; }
+  if (add_materialized_view(view) != SUCCESS) { return; }
+
+  printf("✅ Vista %s creata sulla tabella %s\n", view->nome, view->tabella);
+  print_materialized_view(view);
+}
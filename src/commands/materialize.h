@@ -0,0 +1,14 @@
+#ifndef MATERIALIZE_COMMAND_H
+#define MATERIALIZE_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the MATERIALIZE
+int validate_materialize(char *tokens[], int token_count, MaterializedView *view);
+void execute_materialize(const MaterializedView *view);
+
+
+
+#endif
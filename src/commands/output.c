@@ -0,0 +1,67 @@
+/*
+
+
+  Output.c è il file che racchiude le funzioni relative al comando OUTPUT.
+  Le funzioni descritte in questo file sono:
+    - validate_output: si occupa di validare il comando OUTPUT.
+    - execute_output: si occupa di eseguire il comando OUTPUT.
+
+  Il comando OUTPUT mostra e sceglie il formato dei risultati di READ, FIND, AGGREGATE, JOIN e delle viste (vedi src/output.c).
+  Ad esempio:
+    OUTPUT                  ➝ stampa il formato attuale
+    OUTPUT TABLE            ➝ colonne allineate
+    OUTPUT TSV              ➝ valori separati da tab (il formato di partenza)
+    OUTPUT CSV              ➝ valori separati da virgole
+    OUTPUT JSON             ➝ un oggetto JSON per riga
+
+  Cambiare formato svuota la cache dei risultati, che contiene l'output già stampato nel formato precedente.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp
+
+#include "output.h"
+#include "../output.h"
+#include "../cache.h"
+
+
+/**
+ * Funzione che valida i token del comando OUTPUT.
+ * - OUTPUT da solo, oppure OUTPUT seguito da TSV, TABLE, CSV o JSON
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_output(char *tokens[], int token_count) {
+  if (strcmp(tokens[0], "OUTPUT") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (token_count == 1) { return TRUE; }
+  if (token_count == 2 && (strcmp(tokens[1], "TSV") == SUCCESS || strcmp(tokens[1], "TABLE") == SUCCESS ||
+                           strcmp(tokens[1], "CSV") == SUCCESS || strcmp(tokens[1], "JSON") == SUCCESS)) {
+    return TRUE;
+  }
+
+  printf("❌ Errore: sintassi non valida. Usa OUTPUT [TSV | TABLE | CSV | JSON]\n");
+  return FALSE;
+}
+
+
+/**
+ * Funzione che esegue il comando OUTPUT.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ */
+void execute_output(char *tokens[], int token_count) {
+  if (token_count == 2 && strcmp(tokens[1], get_output_mode_name()) != SUCCESS) {
+    set_output_mode(tokens[1]);
+    clear_result_cache();
+  }
+
+  printf("✅ Formato dei risultati: %s\n", get_output_mode_name());
+}
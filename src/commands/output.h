@@ -0,0 +1,14 @@
+#ifndef OUTPUT_COMMAND_H
+#define OUTPUT_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the OUTPUT
+int validate_output(char *tokens[], int token_count);
+void execute_output(char *tokens[], int token_count);
+
+
+
+#endif
@@ -0,0 +1,248 @@
+/*
+
+
+  Prepare.c è il file che racchiude le funzioni relative ai comandi PREPARE ed EXECUTE.
+  Le funzioni descritte in questo file sono:
+    - validate_prepare: si occupa di validare il comando PREPARE e di risolvere il comando preparato sullo schema.
+    - execute_prepare: si occupa di salvare il comando preparato.
+    - validate_execute: si occupa di validare il comando EXECUTE e di convertire i parametri nel record.
+    - execute_execute: si occupa di scrivere il record preparato da validate_execute.
+
+  Il comando PREPARE prepara un CREATE in cui alcuni valori sono dei parametri (?), da passare ogni volta con EXECUTE:
+    PREPARE NuovoUtente AS CREATE Utente nome:? eta:? attivo:true
+    EXECUTE NuovoUtente 'Luca' 32
+    EXECUTE NuovoUtente 'Anna' 27
+
+  Perchè?
+  Un CREATE normale, a ogni record, cerca la tabella nello schema, confronta ogni token con ogni colonna e converte i valori.
+  Con PREPARE tutto questo si fa una volta sola: per ogni ? si salva la colonna (quindi offset e funzione di conversione),
+  e i valori costanti vengono convertiti subito in un record "modello", insieme ai NULL delle colonne non indicate.
+  EXECUTE copia il modello, converte i soli parametri direttamente al loro offset, e aggiunge il record in fondo alla tabella.
+  Anche il prossimo id viene ricordato: se nessun altro ha scritto la tabella, non serve rileggere l'ultimo record.
+
+  Il comando PREPARE accetta dai 5 token in su:
+    - Il primo token deve essere PREPARE
+    - Il secondo token deve essere il nome del comando preparato (se esiste già, viene sostituito)
+    - Il terzo token deve essere AS
+    - I token successivi sono un CREATE, in cui ogni valore può essere ?
+
+  Il comando EXECUTE accetta un token per ogni parametro, dopo EXECUTE e il nome del comando preparato.
+  I comandi preparati restano in memoria fino alla chiusura del programma.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fseek, ftell
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memcpy
+
+#include "prepare.h"
+#include "../schema.h"
+#include "../utils.h"
+#include "../materialize.h"
+#include "../cache.h"
+#include "../wal.h"
+#include "../transaction.h"
+
+
+static PreparedStatement statements[MAX_PREPARED];
+static int num_statements = 0;
+
+
+/**
+ * Funzione che cerca un comando preparato per nome.
+ * @return Il comando, NULL se non esiste
+ */
+static PreparedStatement *find_prepared_statement(const char *name) {
+  for (int i = 0; i < num_statements; i++) {
+    if (strcmp(statements[i].nome, name) == SUCCESS) { return &statements[i]; }
+  }
+  return NULL;
+}
+
+
+/**
+ * Funzione che valida i token del comando PREPARE e risolve il CREATE sullo schema.
+ * Devono essere almeno PREPARE_INIT_TOKENS + 3 token
+ * - Controlla che il primo token sia PREPARE, il terzo AS e il quarto CREATE
+ * - Controlla che la tabella esista nello schema
+ * - Per ogni <campo>:<valore> controlla che il campo esista e non sia automatico (id, created_at, updated_at)
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param statement Il comando preparato da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_prepare(char *tokens[], int token_count, PreparedStatement *statement) {
+  memset(statement, 0, sizeof(PreparedStatement));
+
+  if (token_count < PREPARE_INIT_TOKENS + 3 || strcmp(tokens[2], "AS") != SUCCESS) {
+    printf("❌ Errore: sintassi non valida. Usa PREPARE <Nome> AS CREATE <NomeTabella> <campo>:? <campo>:<valore> …\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "PREPARE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[PREPARE_INIT_TOKENS], "CREATE") != SUCCESS) {
+    printf("❌ Errore: PREPARE supporta solo CREATE\n");
+    return FALSE;
+  }
+
+  if (!verify_is_only_letters(tokens[1]) || strlen(tokens[1]) >= sizeof(statement->nome)) {
+    printf("Errore: Il nome del comando preparato non è valido\n");
+    return FALSE;
+  }
+
+  TableDefinition *table = get_table_from_schema(tokens[PREPARE_INIT_TOKENS + 1]);
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[PREPARE_INIT_TOKENS + 1]);
+    return FALSE;
+  }
+
+  strncpy(statement->nome, tokens[1], sizeof(statement->nome) - 1);
+  strncpy(statement->nome_tabella, table->nome_tabella, sizeof(statement->nome_tabella) - 1);
+  if (build_record_layout(table, NULL, &statement->layout) != SUCCESS) { return FALSE; }
+  statement->created_at_column = get_layout_column_index(&statement->layout, "created_at");
+  statement->known_version = 0;                                   // Il prossimo id verrà letto dalla tabella al primo EXECUTE
+
+  statement->template_record = malloc(statement->layout.record_size);
+  statement->record = malloc(statement->layout.record_size);
+  if (!statement->template_record || !statement->record) {
+    printf("Errore: malloc fallita per il comando preparato\n");
+  } else if (bind_column_values(&statement->layout, tokens, PREPARE_INIT_TOKENS + 2, token_count,
+                                statement->template_record, statement->params, &statement->num_params) == SUCCESS) {
+    return TRUE;
+  }
+
+  free(statement->template_record);
+  free(statement->record);
+  return FALSE;
+}
+
+
+/**
+ * Funzione che salva un comando preparato, sostituendo quello con lo stesso nome se esiste già.
+ *
+ * @param statement Il comando preparato da validate_prepare (i suoi buffer passano alla lista)
+ */
+void execute_prepare(PreparedStatement *statement) {
+  PreparedStatement *slot = find_prepared_statement(statement->nome);
+
+  if (slot) {
+    free(slot->template_record);
+    free(slot->record);
+  } else if (num_statements < MAX_PREPARED) {
+    slot = &statements[num_statements++];
+  } else {
+    printf("❌ Errore: troppi comandi preparati (massimo %d)\n", MAX_PREPARED);
+    free(statement->template_record);
+    free(statement->record);
+    return;
+  }
+
+  *slot = *statement;
+  printf("✅ Comando %s preparato: %d parametri\n", slot->nome, slot->num_params);
+}
+
+
+/**
+ * Funzione che valida il comando EXECUTE e prepara il record da scrivere nel buffer del comando preparato.
+ * Non c'è nessuna ricerca nello schema: il record modello viene copiato e ogni parametro viene convertito
+ * con la funzione di conversione della sua colonna, direttamente al suo offset.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return Il comando preparato se il comando è valido, NULL altrimenti
+ */
+PreparedStatement *validate_execute(char *tokens[], int token_count) {
+  if (token_count < EXECUTE_INIT_TOKENS) {
+    printf("❌ Errore: sintassi non valida. Usa EXECUTE <Nome> <valore> <valore> …\n");
+    return NULL;
+  }
+
+  PreparedStatement *statement = find_prepared_statement(tokens[1]);
+  if (!statement) {
+    printf("❌ Errore: il comando preparato '%s' non esiste\n", tokens[1]);
+    return NULL;
+  }
+
+  if (token_count - EXECUTE_INIT_TOKENS != statement->num_params) {
+    printf("❌ Errore: %s vuole %d parametri, ne sono stati passati %d\n", statement->nome, statement->num_params, token_count - EXECUTE_INIT_TOKENS);
+    return NULL;
+  }
+
+  char *record = statement->record;
+  memcpy(record, statement->template_record, statement->layout.record_size);
+
+  for (int p = 0; p < statement->num_params; p++) {
+    const LayoutColumn *col = &statement->layout.colonne[statement->params[p]];
+    if (!convert_column_value(col, tokens[EXECUTE_INIT_TOKENS + p], record + col->offset)) {
+      printf("❌ Errore: il valore '%s' non è valido per il campo %s\n", tokens[EXECUTE_INIT_TOKENS + p], col->nome);
+      return NULL;
+    }
+  }
+
+  return statement;
+}
+
+
+/**
+ * Funzione che scrive in fondo alla tabella il record preparato da validate_execute, con il suo id e created_at.
+ * L'id viene letto dall'ultimo record solo se la tabella è stata scritta da qualcun altro dopo l'ultimo EXECUTE.
+ *
+ * @param statement Il comando preparato, con il record già valorizzato da validate_execute
+ */
+void execute_execute(PreparedStatement *statement) {
+  char *record = statement->record;
+
+  if (in_transaction()) {                                         // Il record viene tenuto fino al COMMIT (vedi transaction.c)
+    long timestamp = get_current_timestamp();
+    if (statement->created_at_column >= 0) {
+      memcpy(record + statement->layout.colonne[statement->created_at_column].offset, &timestamp, sizeof(long));
+    }
+    statement->known_version = 0;                                 // Il prossimo id lo assegna la transazione
+    if (stage_table_append(statement->nome_tabella, statement->layout.record_size, record, 1) == SUCCESS) {
+      printf("Record aggiunto alla tabella %s\n", statement->nome_tabella);
+    }
+    return;
+  }
+
+  // La versione e non la dimensione del file: una compattazione (vedi compact.c) rimpicciolisce il file senza cambiare gli id
+  bool changed = statement->known_version == 0 || get_table_version(statement->nome_tabella) != statement->known_version;
+
+  FILE *file = open_table_file(statement->nome_tabella, "a+b");
+  if (!file) { return; }
+
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+
+  if (changed) {                                                  // Qualcun altro ha scritto la tabella (o è il primo EXECUTE)
+    statement->next_id = read_next_id(file, size, statement->layout.record_size);
+  }
+
+  long timestamp = get_current_timestamp();
+  memcpy(record, &statement->next_id, sizeof(int));               // L'id è sempre il primo campo del record
+  if (statement->created_at_column >= 0) {
+    memcpy(record + statement->layout.colonne[statement->created_at_column].offset, &timestamp, sizeof(long));
+  }
+
+  fclose(file);
+
+  WalTransaction txn;                                             // Il record passa dal log (vedi wal.c), come per CREATE
+  wal_begin(&txn);
+  wal_log_table_write(&txn, statement->nome_tabella, size, record, statement->layout.record_size);
+
+  if (wal_commit(&txn) != SUCCESS) {
+    printf("❌ Errore: impossibile scrivere nella tabella %s\n", statement->nome_tabella);
+    statement->known_version = 0;
+    return;
+  }
+
+  statement->next_id++;
+  statement->known_version = get_table_version(statement->nome_tabella);    // Il commit ha appena cambiato la versione
+  printf("Record aggiunto alla tabella %s\n", statement->nome_tabella);
+
+  maintain_materialized_views(statement->nome_tabella, record, 1);
+}
@@ -0,0 +1,16 @@
+#ifndef PREPARE_COMMAND_H
+#define PREPARE_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the PREPARE and EXECUTE
+int validate_prepare(char *tokens[], int token_count, PreparedStatement *statement);
+void execute_prepare(PreparedStatement *statement);
+PreparedStatement *validate_execute(char *tokens[], int token_count);
+void execute_execute(PreparedStatement *statement);
+
+
+
+#endif
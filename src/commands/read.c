@@ -1,84 +1,453 @@
+/* 
+
+
+  Read.c è il file che racchiude le funzioni relative al comando READ, e più in generale alla lettura dei record.
+  Le funzioni descritte in questo file sono:
+    - validate_read: si occupa di validare il comando READ e di preparare la ReadQuery.
+    - execute_read: si occupa di eseguire una ReadQuery (usata sia da READ che da FIND).
+    - parse_projection: trasforma una lista di colonne "col1,col2" in una Projection.
+    - parse_read_clauses: interpreta le clausole finali della lettura (ORDER BY, AFTER, LIMIT).
+    - print_layout_header / print_record: stampano intestazioni e record, solo per le colonne richieste (nel formato di OUTPUT).
+
+  Il comando READ legge i record di una tabella.
+  Ad esempio:
+    READ Utente
+    READ Utente nome,eta
+
+    READ Utente LIMIT 50
+    READ Utente AFTER c00000032 LIMIT 50
+    READ Utente nome,eta ORDER BY eta DESC
+    READ Utente SAMPLE 1% SEED 42
+
+  Se si specificano le colonne (separate da virgola, senza spazi), vengono decodificate e stampate solo quelle.
+  La stessa sintassi vale per FIND: FIND Utente nome,eta eta>30
+
+  Paginazione:
+  Con LIMIT n la lettura si ferma dopo n record, e se la pagina è piena viene stampato un cursore.
+  Il cursore è opaco per chi lo usa: va solo ripassato con AFTER <cursore> per ottenere la pagina successiva.
+  Internamente rappresenta l'ultimo id visto: siccome gli id nel file sono crescenti, la lettura riprende
+  con una ricerca binaria (o una sola lettura, se gli id sono contigui) invece di riscansionare la tabella dall'inizio come farebbe un OFFSET.
+
+  Ordinamento:
+  Senza ORDER BY i record escono nell'ordine in cui sono stati inseriti.
+  Con ORDER BY <campo> [ASC|DESC] l'ordinamento è fatto da sort.c, anche per tabelle che non entrano in memoria.
+  ORDER BY ... LIMIT k usa un heap di k elementi, e ORDER BY id legge direttamente il file nel verso giusto.
+
+  Campionamento:
+  Con SAMPLE <n>% [SEED <s>] si leggono solo dei blocchi casuali della tabella, circa n% dei record (vedi sample.c).
+  Serve per esplorare tabelle grandi senza leggerle tutte. Non si può usare insieme ad AFTER.
+
+*/
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "read.h"
 #include "../utils.h"
+#include "../scan.h"
+#include "../predicate.h"
+#include "../sort.h"
+#include "../sample.h"
+#include "../planner.h"
+#include "../output.h"
+
+
+/**
+ * Funzione che valida i token del comando READ e prepara la query.
+ * - Controlla che il primo token sia READ
+ * - Controlla che la tabella esista nello schema
+ * - Se presente, controlla che la lista di colonne sia valida
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query La query da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_read(char *tokens[], int token_count, ReadQuery *query) {
+  if (token_count < READ_INIT_TOKENS) {
+    printf("❌ Errore: sintassi non valida. Usa READ <NomeTabella> [<colonna>,<colonna>,…] [ORDER BY <campo> [DESC]] [AFTER <cursore>] [LIMIT <n>] [SAMPLE <n>%%]\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "READ") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
 
+  if (prepare_read_query(tokens[1], query) != SUCCESS) { return FALSE; }
 
-// Funzione per stampare il contenuto di un file binario in base allo schema
-void print_table(const char *table_name) {
-  // Ottenere la definizione della tabella dallo schema
+  int next = READ_INIT_TOKENS;
+  if (next < token_count && !is_read_clause_keyword(tokens[next])) {
+    if (parse_projection(&query->layout, tokens[next], &query->projection) != SUCCESS) { return FALSE; }
+    next++;
+  }
+
+  if (parse_read_clauses(tokens, next, token_count, query) != SUCCESS) { return FALSE; }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che prepara una ReadQuery per una tabella.
+ * Costruisce il layout del record, seleziona tutte le colonne e imposta un predicato vuoto (tutti i record).
+ * 
+ * @param table_name Il nome della tabella
+ * @param query La query da valorizzare
+ * @return SUCCESS se la tabella esiste, FAILURE altrimenti
+ */
+int prepare_read_query(const char *table_name, ReadQuery *query) {
   TableDefinition *table = get_table_from_schema(table_name);
-  if (!table) {
-      printf("Tabella %s non trovata nello schema.\n", table_name);
-      return;
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", table_name);
+    return FAILURE;
   }
 
-  FILE* file = open_table_file(table_name, "rb");
+  memset(&query->layout, 0, sizeof(RecordLayout));
+  if (build_record_layout(table, NULL, &query->layout) != SUCCESS) { return FAILURE; }
 
-  if (!file) {
-    printf("Errore nell'apertura del file tables/%s\n", table_name);
-    return;
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  query->nome_tabella[sizeof(query->nome_tabella) - 1] = '\0';
+
+  query->projection.num_colonne = query->layout.num_colonne;
+  for (int i = 0; i < query->layout.num_colonne; i++) {
+    query->projection.colonne[i] = i;
   }
 
-  // Determinare la dimensione di un record
-  size_t record_size = get_record_size(table_name);
-  void *record = create_table_record_struct(table_name); // Allocazione memoria per un record
+  query->predicate.root = -1;
+  query->predicate.num_nodi = 0;
+  query->predicate.num_children = 0;
+  query->predicate.pool_used = 0;
 
-  // Stampare le intestazioni delle colonne
-  printf("Tabella: %s\n", table_name);
-  for (int i = 0; i < table->num_colonne; i++) {
-      printf("%s\t", table->colonne[i].nome_colonna);
+  query->limit = -1;
+  query->has_cursor = false;
+  query->after_id = 0;
+  query->order_column = -1;
+  query->order_desc = false;
+  query->sample.enabled = false;
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che verifica se un token è la parola chiave di una clausola finale della lettura.
+ */
+bool is_read_clause_keyword(const char *token) {
+  return strcmp(token, "AFTER") == SUCCESS || strcmp(token, "LIMIT") == SUCCESS || strcmp(token, "ORDER") == SUCCESS ||
+         strcmp(token, "SAMPLE") == SUCCESS;
+}
+
+
+/**
+ * Funzione che trova il primo token che apre una clausola finale (ORDER BY, AFTER, LIMIT, SAMPLE).
+ * Serve a FIND per capire dove finisce il predicato.
+ * @return L'indice del token, token_count se non ci sono clausole
+ */
+int find_read_clauses_start(char *tokens[], int start, int token_count) {
+  for (int i = start; i < token_count; i++) {
+    if (is_read_clause_keyword(tokens[i])) { return i; }
+  }
+  return token_count;
+}
+
+
+/**
+ * Funzione che trasforma l'ultimo id visto in un cursore opaco, ad esempio "c0000002a".
+ */
+static void encode_cursor(int id, char *cursor, size_t size) {
+  snprintf(cursor, size, "c%08x", (unsigned int)id);
+}
+
+
+/**
+ * Funzione che ricava l'ultimo id visto da un cursore.
+ * @return SUCCESS se il cursore è valido, FAILURE altrimenti
+ */
+static int decode_cursor(const char *cursor, int *id) {
+  if (cursor[0] != 'c' || strlen(cursor) != 9) { return FAILURE; }
+
+  char *endptr;
+  unsigned long value = strtoul(cursor + 1, &endptr, 16);
+  if (*endptr != '\0') { return FAILURE; }
+
+  *id = (int)value;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che interpreta le clausole finali della lettura: ORDER BY <campo> [ASC|DESC], AFTER <cursore>, LIMIT <n>
+ * e SAMPLE <n>% [SEED <s>].
+ * Tutti i token da start a token_count devono appartenere a una clausola.
+ * 
+ * @return SUCCESS se le clausole sono valide, FAILURE altrimenti
+ */
+int parse_read_clauses(char *tokens[], int start, int token_count, ReadQuery *query) {
+  for (int i = start; i < token_count; i++) {
+
+    if (strcmp(tokens[i], "LIMIT") == SUCCESS && i + 1 < token_count) {
+      char *endptr;
+      long limit = strtol(tokens[i + 1], &endptr, 10);
+      if (*endptr != '\0' || limit < 0) {
+        printf("❌ Errore: LIMIT deve essere un numero intero non negativo\n");
+        return FAILURE;
+      }
+      query->limit = limit;
+      i++;
+      continue;
+    }
+
+    if (strcmp(tokens[i], "AFTER") == SUCCESS && i + 1 < token_count) {
+      if (decode_cursor(tokens[i + 1], &query->after_id) != SUCCESS) {
+        printf("❌ Errore: il cursore '%s' non è valido\n", tokens[i + 1]);
+        return FAILURE;
+      }
+      query->has_cursor = true;
+      i++;
+      continue;
+    }
+
+    if (strcmp(tokens[i], "ORDER") == SUCCESS && i + 2 < token_count && strcmp(tokens[i + 1], "BY") == SUCCESS) {
+      query->order_column = get_layout_column_index(&query->layout, tokens[i + 2]);
+      if (query->order_column < 0) {
+        printf("❌ Errore: il campo '%s' non esiste\n", tokens[i + 2]);
+        return FAILURE;
+      }
+      i += 2;
+
+      if (i + 1 < token_count && (strcmp(tokens[i + 1], "DESC") == SUCCESS || strcmp(tokens[i + 1], "ASC") == SUCCESS)) {
+        query->order_desc = strcmp(tokens[i + 1], "DESC") == SUCCESS;
+        i++;
+      }
+      continue;
+    }
+
+    if (strcmp(tokens[i], "SAMPLE") == SUCCESS) {
+      int used = parse_sample_clause(tokens, i, token_count, &query->sample);
+      if (used < 0) { return FAILURE; }
+      i += used - 1;
+      continue;
+    }
+
+    printf("❌ Errore: clausola non valida: %s\n", tokens[i]);
+    return FAILURE;
+  }
+
+  if (query->has_cursor && query->sample.enabled) {
+    printf("❌ Errore: AFTER non può essere usato insieme a SAMPLE\n");
+    return FAILURE;
+  }
+
+  if (query->has_cursor && query->order_column >= 0) {
+    printf("❌ Errore: AFTER non può essere usato insieme a ORDER BY\n");
+    return FAILURE;
   }
-  printf("\n");
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che verifica se un token è una lista di colonne (col1,col2,…) e non una condizione.
+ * Una lista di colonne contiene solo lettere, numeri, '_', '.', ',' oppure '*'.
+ */
+bool is_projection_token(const char *token) {
+  if (strcmp(token, "AND") == SUCCESS || strcmp(token, "OR") == SUCCESS || strcmp(token, "NOT") == SUCCESS) { return false; }
+
+  for (const char *c = token; *c; c++) {
+    if (strchr(":=!<>()'\"", *c) != NULL) { return false; }
+  }
+  return *token != '\0';
+}
+
+
+/**
+ * Funzione che trasforma una lista di colonne separate da virgola in una Projection.
+ * "*" indica tutte le colonne.
+ * 
+ * @param layout Il layout del record
+ * @param token La lista di colonne, ad esempio "nome,eta"
+ * @param projection La Projection da valorizzare
+ * @return SUCCESS se tutte le colonne esistono, FAILURE altrimenti
+ */
+int parse_projection(const RecordLayout *layout, const char *token, Projection *projection) {
+  if (strcmp(token, "*") == SUCCESS) {
+    projection->num_colonne = layout->num_colonne;
+    for (int i = 0; i < layout->num_colonne; i++) { projection->colonne[i] = i; }
+    return SUCCESS;
+  }
+
+  projection->num_colonne = 0;
+
+  const char *start = token;
+  while (*start) {
+    const char *end = strchr(start, ',');
+    size_t len = end ? (size_t)(end - start) : strlen(start);
+
+    char nome[101];
+    if (len == 0 || len >= sizeof(nome)) {
+      printf("❌ Errore: lista di colonne non valida: %s\n", token);
+      return FAILURE;
+    }
+    memcpy(nome, start, len);
+    nome[len] = '\0';
+
+    int index = get_layout_column_index(layout, nome);
+    if (index < 0) {
+      printf("❌ Errore: il campo '%s' non esiste\n", nome);
+      return FAILURE;
+    }
+
+    if (projection->num_colonne >= MAX_LAYOUT_COLUMNS) {
+      printf("❌ Errore: troppe colonne richieste\n");
+      return FAILURE;
+    }
+    projection->colonne[projection->num_colonne++] = index;
+
+    if (!end) { break; }
+    start = end + 1;
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che esegue una ReadQuery: scansiona la tabella e stampa i record che soddisfano il predicato.
+ * La tabella viene letta a batch con una TableScan. Per ogni record vengono decodificate solo le colonne della projection.
+ * 
+ * @param query La query da eseguire
+ * @return Il numero di record stampati, -1 in caso di errore
+ */
+long execute_read(const ReadQuery *query) {
+  if (query->order_column >= 0) { return execute_sorted_read(query); }
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return -1; }
+  set_scan_sample(&scan, &query->sample);
+
+  const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+
+  plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);
+
+  if (query->has_cursor) {                                        // Riprendo dal primo record dopo l'ultimo id visto (se il piano non parte già dopo)
+    long position = find_position_after_id(&scan, query->after_id);
+    seek_table_scan(&scan, position > scan.next_position ? position : scan.next_position);
+  }
+
+  // Stampare le intestazioni delle colonne
+  output_title("Tabella: %s\n", query->nome_tabella);
+  print_sample_summary(&scan);
+  print_layout_header(&query->layout, &query->projection);
 
   // Leggere e stampare ogni record
-  while (fread(record, record_size, 1, file)) {
-    char *ptr = (char *)record; // Puntatore generico al record
-    for (int i = 0; i < table->num_colonne; i++) {
-      ColumnDefinition col = table->colonne[i];
+  long printed = 0;
+  int last_id = query->after_id;
+  size_t count;
+
+  while (printed != query->limit && (count = read_scan_batch(&scan)) > 0) {
+    for (size_t i = 0; i < count && printed != query->limit; i++) {
+      const char *record = scan.buffer + i * scan.record_size;
+
+      if (pred && !evaluate_predicate(pred, record)) { continue; }
+
+      print_record(&query->layout, &query->projection, record);
+      memcpy(&last_id, record, sizeof(int));                      // L'id è sempre il primo campo del record
+      printed++;
+    }
+  }
+
+  if (query->limit > 0 && printed == query->limit && !scan.sampling) {   // Pagina piena: potrebbero esserci altri record
+    char cursor[16];
+    encode_cursor(last_id, cursor, sizeof(cursor));
+    output_title("Cursore: %s (usa AFTER %s per la pagina successiva)\n", cursor, cursor);
+  }
+
+  // Pulizia
+  close_table_scan(&scan);
+  return printed;
+}
+
+
+/**
+ * Funzione che stampa le intestazioni delle colonne richieste.
+ */
+void print_layout_header(const RecordLayout *layout, const Projection *projection) {
+  for (int i = 0; i < projection->num_colonne; i++) {
+      output_column_name(layout->colonne[projection->colonne[i]].nome);
+  }
+  output_end_row();
+}
 
-      // Stampare il valore in base al tipo
-      if (strcmp(col.tipo.name, "int") == 0) {
+
+/**
+ * Funzione che stampa un record in base al suo layout, andando a capo alla fine.
+ */
+void print_record(const RecordLayout *layout, const Projection *projection, const char *record) {
+  print_record_values(layout, projection, record);
+  output_end_row();
+}
+
+
+/**
+ * Funzione che stampa i valori di un record in base al suo layout, senza andare a capo.
+ * Solo le colonne della projection vengono lette al loro offset e stampate in base alla loro tipologia interna,
+ * con le funzioni di output.c invece di un printf per campo.
+ */
+void print_record_values(const RecordLayout *layout, const Projection *projection, const char *record) {
+  bool marks_nulls = output_marks_nulls();
+
+  for (int i = 0; i < projection->num_colonne; i++) {
+    const LayoutColumn *col = &layout->colonne[projection->colonne[i]];
+    const char *ptr = record + col->offset;
+
+    // Con CSV e JSON un numero NULL diventa un campo vuoto o null (le stringhe vuote e i false restano valori)
+    bool is_number = col->kind == KIND_INT || col->kind == KIND_FLOAT || col->kind == KIND_DOUBLE || col->kind == KIND_TIMESTAMP;
+    if (marks_nulls && is_number && memcmp(ptr, get_null_value(col->tipo), col->tipo.length) == 0) {
+      output_null(col->nome);
+      continue;
+    }
+
+    // Stampare il valore in base al tipo
+    switch (col->kind) {
+      case KIND_INT: {
         int value;
         memcpy(&value, ptr, sizeof(int));
-        printf("%d\t", value);
-        ptr += sizeof(int);
-      } else if (strcmp(col.tipo.name, "char") == 0) {
-        char value[255];  // Supponiamo che la lunghezza max sia 255
-        memcpy(value, ptr, col.tipo.length);
-        value[col.tipo.length] = '\0'; // Terminatore stringa
-        printf("%s\t", value);
-        ptr += col.tipo.length;
-      } else if (strcmp(col.tipo.name, "float") == 0) {
+        output_int(col->nome, value);
+        break;
+      }
+      case KIND_CHAR: {
+        output_string(col->nome, ptr, (size_t)col->tipo.length);    // Stampo al massimo length caratteri, senza copiare la stringa
+        break;
+      }
+      case KIND_FLOAT: {
         float value;
         memcpy(&value, ptr, sizeof(float));
-        printf("%.2f\t", value);
-        ptr += sizeof(float);
-      } else if (strcmp(col.tipo.name, "double") == 0) {
+        output_float(col->nome, value, 2);
+        break;
+      }
+      case KIND_DOUBLE: {
         double value;
         memcpy(&value, ptr, sizeof(double));
-        printf("%.2f\t", value);
-        ptr += sizeof(double);
-      } else if (strcmp(col.tipo.name, "timestamp") == 0) {
+        output_float(col->nome, value, 2);
+        break;
+      }
+      case KIND_TIMESTAMP: {
         long value;
         memcpy(&value, ptr, sizeof(long));
-        printf("%ld\t", value);
-        ptr += sizeof(long);
-      } else if (strcmp(col.tipo.name, "bool") == 0) {
+        output_int(col->nome, value);
+        break;
+      }
+      case KIND_BOOL: {
         bool value;
         memcpy(&value, ptr, sizeof(bool));
-        printf("%s\t", value ? "true" : "false");
-        ptr += sizeof(bool);
-      } else {
-          printf("??\t"); // Tipo sconosciuto
+        output_bool(col->nome, value);
+        break;
       }
+      default:
+        output_null(col->nome); // Tipo sconosciuto
     }
-    printf("\n");
   }
-
-  // Pulizia
-  free(record);
-  fclose(file);
 }
@@ -7,8 +7,20 @@
 
 
 // Functions Available including the READ
-void print_table(const char *table_name);
+int validate_read(char *tokens[], int token_count, ReadQuery *query);
+long execute_read(const ReadQuery *query);
 
+int prepare_read_query(const char *table_name, ReadQuery *query);
+bool is_projection_token(const char *token);
+bool is_read_clause_keyword(const char *token);
+int find_read_clauses_start(char *tokens[], int start, int token_count);
+int parse_read_clauses(char *tokens[], int start, int token_count, ReadQuery *query);
+int parse_projection(const RecordLayout *layout, const char *token, Projection *projection);
 
+void print_layout_header(const RecordLayout *layout, const Projection *projection);
+void print_record(const RecordLayout *layout, const Projection *projection, const char *record);
+void print_record_values(const RecordLayout *layout, const Projection *projection, const char *record);
 
-#endif
\ No newline at end of file
+
+
+#endif
@@ -0,0 +1,133 @@
+/*
+
+
+  Transaction.c è il file che racchiude le funzioni relative ai comandi BEGIN, COMMIT e ROLLBACK.
+  Le funzioni descritte in questo file sono:
+    - validate_begin: si occupa di validare il comando BEGIN.
+    - execute_begin: si occupa di aprire una transazione.
+    - validate_commit: si occupa di validare il comando COMMIT.
+    - execute_commit: si occupa di confermare la transazione.
+    - validate_rollback: si occupa di validare il comando ROLLBACK.
+    - execute_rollback: si occupa di annullare la transazione.
+
+  I comandi tra BEGIN e COMMIT vengono applicati tutti insieme, o nessuno.
+  Ad esempio:
+    BEGIN
+    CREATE Ordine utente:1 totale:120
+    UPDATE Utente 1 ordini:4
+    DELETE Carrello 7
+    COMMIT                  ➝ oppure ROLLBACK, per annullare tutto
+
+  Ogni comando accetta esattamente 1 token. Una sola transazione alla volta: BEGIN dentro una transazione è un errore,
+  come COMMIT e ROLLBACK fuori. Le scritture vengono tenute in memoria fino al COMMIT (vedi src/transaction.c),
+  che le rende durevoli con un solo commit nel log. Se il programma si chiude con una transazione aperta, viene annullata.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp
+
+#include "transaction.h"
+#include "../transaction.h"
+
+
+/**
+ * Funzione che valida un comando di transazione: un solo token, il nome del comando.
+ *
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+static int validate_transaction_command(char *tokens[], int token_count, const char *command) {
+  if (strcmp(tokens[0], command) != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (token_count != TRANSACTION_INIT_TOKENS) {
+    printf("❌ Errore: sintassi non valida. Usa %s senza altri token\n", command);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+ * Funzione che valida il comando BEGIN.
+ * - Controlla che non ci sia già una transazione aperta
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_begin(char *tokens[], int token_count) {
+  if (!validate_transaction_command(tokens, token_count, "BEGIN")) { return FALSE; }
+
+  if (in_transaction()) {
+    printf("❌ Errore: c'è già una transazione aperta: usa COMMIT o ROLLBACK\n");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando BEGIN.
+ */
+void execute_begin() {
+  if (begin_transaction() == SUCCESS) { printf("✅ Transazione aperta\n"); }
+}
+
+
+/**
+ * Funzione che valida il comando COMMIT.
+ * - Controlla che ci sia una transazione aperta
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_commit(char *tokens[], int token_count) {
+  if (!validate_transaction_command(tokens, token_count, "COMMIT")) { return FALSE; }
+
+  if (!in_transaction()) {
+    printf("❌ Errore: nessuna transazione aperta: usa BEGIN\n");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando COMMIT. Se fallisce, la transazione viene annullata.
+ */
+void execute_commit() {
+  if (commit_transaction() == SUCCESS) { printf("✅ Transazione confermata\n"); }
+  else { printf("❌ Errore: COMMIT non riuscito, la transazione è chiusa\n"); }
+}
+
+
+/**
+ * Funzione che valida il comando ROLLBACK.
+ * - Controlla che ci sia una transazione aperta
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_rollback(char *tokens[], int token_count) {
+  if (!validate_transaction_command(tokens, token_count, "ROLLBACK")) { return FALSE; }
+
+  if (!in_transaction()) {
+    printf("❌ Errore: nessuna transazione aperta: usa BEGIN\n");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando ROLLBACK.
+ */
+void execute_rollback() {
+  rollback_transaction();
+  printf("✅ Transazione annullata\n");
+}
@@ -0,0 +1,18 @@
+#ifndef TRANSACTION_COMMAND_H
+#define TRANSACTION_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the BEGIN, COMMIT and ROLLBACK
+int validate_begin(char *tokens[], int token_count);
+void execute_begin();
+int validate_commit(char *tokens[], int token_count);
+void execute_commit();
+int validate_rollback(char *tokens[], int token_count);
+void execute_rollback();
+
+
+
+#endif
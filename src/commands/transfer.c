@@ -0,0 +1,175 @@
+/*
+
+
+  Transfer.c è il file che racchiude le funzioni relative ai comandi EXPORT e IMPORT.
+  Le funzioni descritte in questo file sono:
+    - validate_export: si occupa di validare il comando EXPORT.
+    - execute_export: si occupa di eseguire il comando EXPORT.
+    - validate_import: si occupa di validare il comando IMPORT.
+    - execute_import: si occupa di eseguire il comando IMPORT.
+
+  I comandi EXPORT e IMPORT spostano i record di una tabella da e verso un file COLUMNAR (vedi columnar.c),
+  ad esempio per copiarli in un altro database o leggerli da uno strumento di analisi:
+    EXPORT Utente TO 'utenti.col' FORMAT COLUMNAR
+    IMPORT Utente FROM 'utenti.col' FORMAT COLUMNAR
+
+  Entrambi i comandi accettano esattamente 6 token:
+    - Il primo token deve essere EXPORT o IMPORT
+    - Il secondo token deve essere il nome della tabella
+    - Il terzo token deve essere TO (EXPORT) o FROM (IMPORT)
+    - Il quarto token deve essere il percorso del file, eventualmente tra apici
+    - Gli ultimi due token devono essere FORMAT COLUMNAR, l'unico formato per ora
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memset
+#include <unistd.h>                 // access, R_OK
+#include <time.h>                   // clock_gettime
+
+#include "transfer.h"
+#include "../columnar.h"
+#include "../schema.h"
+#include "../utils.h"
+#include "../materialize.h"
+#include "../transaction.h"
+
+
+/**
+ * Funzione che valida i token comuni a EXPORT e IMPORT e risolve la tabella sullo schema.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param command EXPORT oppure IMPORT
+ * @param direction TO oppure FROM
+ * @param query La query da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+static int validate_transfer(char *tokens[], int token_count, const char *command, const char *direction, ColumnarQuery *query) {
+  if (token_count != TRANSFER_INIT_TOKENS || strcmp(tokens[2], direction) != SUCCESS || strcmp(tokens[4], "FORMAT") != SUCCESS) {
+    printf("❌ Errore: sintassi non valida. Usa %s <NomeTabella> %s '<file>' FORMAT COLUMNAR\n", command, direction);
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], command) != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[5], "COLUMNAR") != SUCCESS) {
+    printf("❌ Errore: il formato %s non è supportato, usa FORMAT COLUMNAR\n", tokens[5]);
+    return FALSE;
+  }
+
+  TableDefinition *table = get_table_from_schema(tokens[1]);
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1]);
+    return FALSE;
+  }
+
+  memset(query, 0, sizeof(ColumnarQuery));
+  if (copy_path_token(tokens[3], query->path, sizeof(query->path)) != SUCCESS) {
+    printf("❌ Errore: il percorso del file non è valido\n");
+    return FALSE;
+  }
+
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  return build_record_layout(table, NULL, &query->layout) == SUCCESS;
+}
+
+
+/**
+ * Funzione che restituisce i secondi passati da start.
+ */
+static double seconds_since(const struct timespec *start) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+/**
+ * Funzione che valida i token del comando EXPORT.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query L'EXPORT da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_export(char *tokens[], int token_count, ColumnarQuery *query) {
+  return validate_transfer(tokens, token_count, "EXPORT", "TO", query);
+}
+
+
+/**
+ * Funzione che esegue il comando EXPORT e mostra quanto occupa il file rispetto alla tabella.
+ *
+ * @param query L'EXPORT da eseguire
+ */
+void execute_export(ColumnarQuery *query) {
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  long exported = export_columnar_file(query);
+  if (exported < 0) { return; }
+  double seconds = seconds_since(&start);
+
+  FILE *file = fopen(query->path, "rb");
+  long file_size = 0;
+  if (file) {
+    fseek(file, 0, SEEK_END);
+    file_size = ftell(file);
+    fclose(file);
+  }
+
+  printf("✅ %ld record esportati dalla tabella %s in %s in %.2f secondi (%.1f MB, la tabella ne occupa %.1f)\n",
+         exported, query->nome_tabella, query->path, seconds, (double)file_size / (1024.0 * 1024.0),
+         (double)exported * (double)query->layout.record_size / (1024.0 * 1024.0));
+}
+
+
+/**
+ * Funzione che valida i token del comando IMPORT.
+ * Oltre ai token controlla che il file esista e si possa leggere, e che non ci sia una transazione aperta:
+ * IMPORT scrive direttamente la tabella.
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query L'IMPORT da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_import(char *tokens[], int token_count, ColumnarQuery *query) {
+  if (!validate_transfer(tokens, token_count, "IMPORT", "FROM", query)) { return FALSE; }
+
+  if (in_transaction()) {
+    printf("❌ Errore: IMPORT non si può usare dentro una transazione: usa COMMIT o ROLLBACK\n");
+    return FALSE;
+  }
+
+  if (access(query->path, R_OK) != 0) {
+    printf("❌ Errore: il file %s non esiste o non si può leggere\n", query->path);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+ * Funzione che esegue il comando IMPORT e ricalcola le aggregazioni materializzate della tabella.
+ *
+ * @param query L'IMPORT da eseguire
+ */
+void execute_import(ColumnarQuery *query) {
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  long imported = import_columnar_file(query);
+  if (imported < 0) {
+    printf("❌ Nessun record importato nella tabella %s\n", query->nome_tabella);
+    return;
+  }
+
+  printf("✅ %ld record importati nella tabella %s in %.2f secondi\n", imported, query->nome_tabella, seconds_since(&start));
+
+  if (imported > 0) { refresh_table_views(query->nome_tabella); }   // Una sola volta per tutto l'IMPORT, non per ogni record
+}
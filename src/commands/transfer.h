@@ -0,0 +1,16 @@
+#ifndef TRANSFER_COMMAND_H
+#define TRANSFER_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the EXPORT and IMPORT
+int validate_export(char *tokens[], int token_count, ColumnarQuery *query);
+void execute_export(ColumnarQuery *query);
+int validate_import(char *tokens[], int token_count, ColumnarQuery *query);
+void execute_import(ColumnarQuery *query);
+
+
+
+#endif
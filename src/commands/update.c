@@ -0,0 +1,387 @@
+/*
+
+
+  Update.c è il file che racchiude le funzioni relative al comando UPDATE.
+  Le funzioni descritte in questo file sono:
+    - validate_update: si occupa di validare il comando UPDATE e di convertire i nuovi valori.
+    - execute_update: si occupa di eseguire il comando UPDATE.
+
+  Il comando UPDATE cambia alcuni campi di record già esistenti, e valorizza updated_at con il momento della modifica.
+  Ad esempio:
+    UPDATE Utente 1 nome:'Mario' eta:40                   ➝ un record, tramite il suo id
+    UPDATE Ordine WHERE stato:'open' AND totale>100 SET stato:'urgente'
+    UPDATE Ordine SET stato:'chiuso'                       ➝ tutti i record
+
+  Il comando UPDATE accetta dai 4 token in su:
+    - Il primo token deve essere UPDATE
+    - Il secondo token deve essere il nome della tabella
+    - Il terzo token è l'id del record, seguito dai campo:valore da cambiare
+    - Oppure il terzo token è WHERE, seguito dal predicato (vedi predicate.c), SET e i campo:valore da cambiare
+    - Oppure il terzo token è SET, seguito dai campo:valore: vengono aggiornati tutti i record
+
+  Come viene scritto il record?
+  I record hanno tutti la stessa dimensione, quindi non vanno mai spostati: si riscrivono al loro posto.
+  Con l'id il record viene trovato con una ricerca binaria (vedi find_position_after_id) e si scrivono solo i byte
+  tra il primo campo cambiato e l'ultimo (updated_at compreso), senza riscrivere il resto della tabella.
+  Con WHERE la tabella viene letta una volta sola, a batch: i record che soddisfano il predicato vengono cambiati
+  direttamente nel buffer della scansione e scritti con una scrittura per ogni gruppo di record consecutivi,
+  senza spostarsi nel file record per record.
+  Le scritture passano dal log (vedi wal.c), in una sola transazione: vengono applicate alla tabella al commit,
+  tutte insieme, con un solo fdatasync. Un UPDATE con WHERE aggiorna quindi tutti i record, o nessuno.
+  Un record eliminato con DELETE non si può aggiornare: la scansione non lo vede.
+
+  Le aggregazioni materializzate della tabella perdono il vecchio record e ricevono il nuovo (vedi materialize.c):
+  con WHERE i cambiamenti di tutti i record vengono raccolti durante la scansione e scritti nelle viste dopo il commit.
+
+  Dentro una transazione (vedi transaction.c) le scritture non passano dal log ma vengono tenute fino al COMMIT.
+  I record vengono letti come li ha lasciati la transazione: con i campi già cambiati, senza quelli eliminati
+  e con quelli aggiunti, che vengono cambiati direttamente nel buffer della transazione.
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // strtol
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memcpy, memset
+
+#include "update.h"
+#include "../schema.h"
+#include "../utils.h"
+#include "../scan.h"
+#include "../predicate.h"
+#include "../planner.h"
+#include "../materialize.h"
+#include "../arena.h"
+#include "../wal.h"
+#include "../transaction.h"
+
+
+/**
+ * Funzione che converte i token campo:valore di un UPDATE nel record dei nuovi valori, ognuno alla posizione della sua colonna.
+ * Come in CREATE, id, created_at e updated_at non si possono indicare, e ogni campo si può indicare una volta sola.
+ *
+ * @return SUCCESS se tutti i token sono validi, FAILURE altrimenti
+ */
+static int bind_update_values(UpdateQuery *query, char *tokens[], int start, int token_count) {
+  if (start >= token_count) {
+    printf("❌ Errore: manca almeno un <campo>:<valore> da aggiornare\n");
+    return FAILURE;
+  }
+
+  for (int i = start; i < token_count; i++) {
+    char campo[100];
+    const char *valore;
+    if (split_token(tokens[i], ':', campo, sizeof(campo), &valore) == FAILURE) {
+      printf("Errore: token non valido per %s\n", tokens[i]);
+      return FAILURE;
+    }
+
+    int index = get_layout_column_index(&query->layout, campo);
+    if (index < 0) {
+      printf("Errore: token non valido per %s\n", tokens[i]);
+      return FAILURE;
+    }
+    if (index == 0 || strcmp(campo, "created_at") == SUCCESS || strcmp(campo, "updated_at") == SUCCESS) {   // L'id è sempre la colonna 0
+      printf("❌ Errore: il campo '%s' viene valorizzato in automatico\n", campo);
+      return FAILURE;
+    }
+    for (int c = 0; c < query->num_changes; c++) {
+      if (query->columns[c] == index) {
+        printf("❌ Errore: il campo '%s' è indicato più volte\n", campo);
+        return FAILURE;
+      }
+    }
+
+    const LayoutColumn *col = &query->layout.colonne[index];
+    if (!convert_column_value(col, valore, query->values + col->offset)) {
+      printf("❌ Errore: il valore '%s' non è valido per il campo %s\n", valore, campo);
+      return FAILURE;
+    }
+    query->columns[query->num_changes++] = index;
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che valida i token del comando UPDATE e prepara i nuovi valori.
+ * Devono essere almeno UPDATE_INIT_TOKENS + 1 token
+ * - Controlla che il primo token sia UPDATE
+ * - Controlla che la tabella esista nello schema
+ * - Controlla che il terzo token sia un id, WHERE oppure SET
+ * - Con WHERE, compila il predicato fino a SET
+ * - Controlla che ogni campo esista, non sia automatico, e che il valore sia valido per il suo tipo
+ *
+ * @param tokens Array di token
+ * @param token_count Numero di token
+ * @param query L'UPDATE da valorizzare
+ * @return 1 se il comando è valido, 0 altrimenti
+ */
+int validate_update(char *tokens[], int token_count, UpdateQuery *query) {
+  if (token_count < UPDATE_INIT_TOKENS + 1) {
+    printf("❌ Errore: sintassi non valida. Usa UPDATE <NomeTabella> <ID> <campo>:<valore> … oppure UPDATE <NomeTabella> [WHERE <predicato>] SET <campo>:<valore> …\n");
+    return FALSE;
+  }
+
+  if (strcmp(tokens[0], "UPDATE") != SUCCESS) {
+    printf("Errore: comando non riconosciuto\n");
+    return FALSE;
+  }
+
+  TableDefinition *table = get_table_from_schema(tokens[1]);
+  if (table == NULL) {
+    printf("❌ Errore: La tabella '%s' non esiste nello schema\n", tokens[1]);
+    return FALSE;
+  }
+
+  memset(query, 0, sizeof(UpdateQuery));
+  strncpy(query->nome_tabella, table->nome_tabella, sizeof(query->nome_tabella) - 1);
+  if (build_record_layout(table, NULL, &query->layout) != SUCCESS) { return FALSE; }
+  query->updated_at_column = get_layout_column_index(&query->layout, "updated_at");
+  query->predicate.root = -1;
+
+  query->values = arena_alloc(query->layout.record_size);
+  if (!query->values) { return FALSE; }
+
+  int first_value;                                                        // Primo token campo:valore
+  if (strcmp(tokens[2], "WHERE") == SUCCESS || strcmp(tokens[2], "SET") == SUCCESS) {
+    int set = UPDATE_INIT_TOKENS - 1;
+    while (set < token_count && strcmp(tokens[set], "SET") != SUCCESS) { set++; }
+
+    if (set == token_count) {
+      printf("❌ Errore: manca SET. Usa UPDATE <NomeTabella> [WHERE <predicato>] SET <campo>:<valore> …\n");
+      return FALSE;
+    }
+    if (set > UPDATE_INIT_TOKENS - 1) {                                   // Tra WHERE e SET c'è il predicato
+      if (set == UPDATE_INIT_TOKENS) {
+        printf("❌ Errore: manca il predicato dopo WHERE\n");
+        return FALSE;
+      }
+      if (compile_predicate(&query->layout, tokens + UPDATE_INIT_TOKENS, set - UPDATE_INIT_TOKENS, &query->predicate) != SUCCESS) {
+        return FALSE;
+      }
+    }
+    first_value = set + 1;
+  } else {
+    char *endptr;
+    long id = strtol(tokens[2], &endptr, 10);
+    if (*endptr != '\0' || id < 1 || id > 2147483647L) {
+      printf("❌ Errore: l'id deve essere un numero intero positivo, oppure usa WHERE <predicato> SET …\n");
+      return FALSE;
+    }
+    query->by_id = true;
+    query->id = (int)id;
+    first_value = UPDATE_INIT_TOKENS;
+  }
+
+  if (bind_update_values(query, tokens, first_value, token_count) != SUCCESS) { return FALSE; }
+
+  return TRUE;
+}
+
+
+/**
+ * Funzione che copia i nuovi valori in un record e valorizza il suo updated_at.
+ */
+static void apply_update_values(const UpdateQuery *query, char *record, long timestamp) {
+  for (int c = 0; c < query->num_changes; c++) {
+    const LayoutColumn *col = &query->layout.colonne[query->columns[c]];
+    memcpy(record + col->offset, query->values + col->offset, col->tipo.length);
+  }
+  if (query->updated_at_column >= 0) {
+    memcpy(record + query->layout.colonne[query->updated_at_column].offset, &timestamp, sizeof(long));
+  }
+}
+
+
+/**
+ * Funzione che esegue un UPDATE tramite id: legge il record, lo cambia e riscrive solo i byte cambiati.
+ * @return 1 se il record è stato aggiornato, 0 se non esiste, -1 in caso di errore
+ */
+static int update_record_by_id(const UpdateQuery *query, long timestamp) {
+  char *staged = find_staged_record(query->nome_tabella, query->id);     // Un record aggiunto dalla transazione si cambia al suo posto
+  if (staged) {
+    apply_update_values(query, staged, timestamp);
+    return 1;
+  }
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return -1; }
+
+  size_t record_size = scan.record_size;
+  char *old_record = arena_alloc(record_size);
+  char *new_record = arena_alloc(record_size);
+  long position = find_position_after_id(&scan, query->id - 1);           // Il primo record con id > id-1 è quello cercato, se esiste
+  int id = -1;
+
+  if (old_record && new_record && read_record_at(&scan, position, old_record) == SUCCESS) { memcpy(&id, old_record, sizeof(int)); }
+  close_table_scan(&scan);
+  if (id != query->id || is_record_staged_deleted(query->nome_tabella, position)) { return 0; }
+
+  overlay_staged_changes(query->nome_tabella, position * (long)record_size, old_record, record_size);
+  memcpy(new_record, old_record, record_size);
+  apply_update_values(query, new_record, timestamp);
+
+  size_t first = record_size, end = 0;                                    // Byte tra il primo e l'ultimo campo cambiato, updated_at compreso
+  for (int c = 0; c <= query->num_changes; c++) {
+    int index = c < query->num_changes ? query->columns[c] : query->updated_at_column;
+    if (index < 0) { continue; }
+
+    const LayoutColumn *col = &query->layout.colonne[index];
+    if (col->offset < first) { first = col->offset; }
+    if (col->offset + (size_t)col->tipo.length > end) { end = col->offset + (size_t)col->tipo.length; }
+  }
+
+  if (in_transaction()) { return stage_table_write(query->nome_tabella, position * (long)record_size + (long)first, new_record + first, end - first) == SUCCESS ? 1 : -1; }
+
+  WalTransaction txn;
+  wal_begin(&txn);
+  wal_log_table_write(&txn, query->nome_tabella, position * (long)record_size + (long)first, new_record + first, end - first);
+  if (wal_commit(&txn) != SUCCESS) { return -1; }
+
+  ViewChanges views;                                                      // Un UPDATE è un -1 del vecchio record e un 1 del nuovo
+  begin_view_changes(query->nome_tabella, &views);
+  add_view_change(&views, old_record, -1);
+  add_view_change(&views, new_record, 1);
+  commit_view_changes(&views);
+  return 1;
+}
+
+
+/**
+ * Funzione che aggiunge alla transazione la scrittura di count record consecutivi del batch, a partire dal record index.
+ * Senza transazione del log (txn NULL) la scrittura viene tenuta dalla transazione aperta con BEGIN.
+ */
+static void write_batch_records(WalTransaction *txn, const char *table_name, const TableScan *scan, size_t index, size_t count) {
+  long offset = get_scan_record_position(scan, index) * (long)scan->record_size;
+  if (txn) { wal_log_table_write(txn, table_name, offset, scan->buffer + index * scan->record_size, count * scan->record_size); }
+  else { stage_table_write(table_name, offset, scan->buffer + index * scan->record_size, count * scan->record_size); }
+}
+
+
+/**
+ * Funzione che copia sui record del batch le scritture della transazione aperta con BEGIN,
+ * una volta per ogni gruppo di record consecutivi nel file.
+ */
+static void overlay_batch_changes(const char *table_name, TableScan *scan, size_t count) {
+  size_t start = 0;
+  for (size_t r = 1; r <= count; r++) {
+    if (r < count && get_scan_record_position(scan, r) == get_scan_record_position(scan, r - 1) + 1) { continue; }
+
+    long offset = get_scan_record_position(scan, start) * (long)scan->record_size;
+    overlay_staged_changes(table_name, offset, scan->buffer + start * scan->record_size, (r - start) * scan->record_size);
+    start = r;
+  }
+}
+
+
+/**
+ * Funzione che esegue un UPDATE con WHERE (o su tutti i record), con una sola lettura della tabella.
+ * I record che soddisfano il predicato vengono cambiati nel buffer del batch e scritti nel log a gruppi di record consecutivi;
+ * la tabella cambia solo al commit, quando la scansione è finita.
+ *
+ * @param query L'UPDATE da eseguire
+ * @param timestamp Il valore di updated_at
+ * @param updated Il numero di record aggiornati
+ * @return SUCCESS se tutti i record sono stati aggiornati, FAILURE se non ne è stato aggiornato nessuno
+ */
+static int update_matching_records(const UpdateQuery *query, long timestamp, long *updated) {
+  *updated = 0;
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return FAILURE; }
+  plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);   // Con un intervallo di id si legge solo quello
+
+  WalTransaction txn = {0};                                               // Dentro una transazione le scritture vengono solo tenute
+  WalTransaction *log = in_transaction() ? NULL : &txn;
+  ViewChanges views = {0};                                                // Le viste si aggiornano al COMMIT della transazione
+  if (log) {
+    wal_begin(log);
+    begin_view_changes(query->nome_tabella, &views);
+  }
+
+  const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+  long matched = 0;
+  size_t count;
+
+  while (!txn.failed && (count = read_scan_batch(&scan)) > 0) {
+    size_t run_start = 0, run_length = 0;                                 // Gruppo di record cambiati, consecutivi anche nel file
+    if (!log) { overlay_batch_changes(query->nome_tabella, &scan, count); }
+
+    for (size_t r = 0; r < count; r++) {
+      char *record = scan.buffer + r * scan.record_size;
+      if (pred && !evaluate_predicate(pred, record)) { continue; }
+      if (!log && is_record_staged_deleted(query->nome_tabella, get_scan_record_position(&scan, r))) { continue; }
+
+      add_view_change(&views, record, -1);                                // Un UPDATE è un -1 del vecchio record e un 1 del nuovo
+      apply_update_values(query, record, timestamp);
+      add_view_change(&views, record, 1);
+
+      if (run_length > 0 && run_start + run_length == r &&
+          get_scan_record_position(&scan, run_start) + (long)run_length == get_scan_record_position(&scan, r)) {
+        run_length++;
+        continue;
+      }
+
+      if (run_length > 0) { write_batch_records(log, query->nome_tabella, &scan, run_start, run_length); }
+      matched += (long)run_length;
+      run_start = r;
+      run_length = 1;
+    }
+
+    if (run_length > 0) { write_batch_records(log, query->nome_tabella, &scan, run_start, run_length); }
+    matched += (long)run_length;
+  }
+
+  close_table_scan(&scan);
+  if (!log) {                                                             // I record aggiunti dalla transazione si cambiano al loro posto
+    long index = 0;
+    char *record;
+    while ((record = next_staged_record(query->nome_tabella, &index)) != NULL) {
+      if (pred && !evaluate_predicate(pred, record)) { continue; }
+      apply_update_values(query, record, timestamp);
+      matched++;
+    }
+    *updated = matched;
+    return SUCCESS;
+  }
+
+  if (matched == 0) {                                                     // Nessun record da cambiare: niente da scrivere
+    wal_abort(&txn);
+    discard_view_changes(&views);
+    return SUCCESS;
+  }
+  if (wal_commit(&txn) != SUCCESS) {
+    discard_view_changes(&views);
+    return FAILURE;
+  }
+
+  commit_view_changes(&views);                                            // La tabella è scritta: ora si possono scrivere le viste
+  *updated = matched;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che esegue il comando UPDATE già validato.
+ *
+ * @param query L'UPDATE da eseguire
+ */
+void execute_update(const UpdateQuery *query) {
+  long timestamp = get_current_timestamp();
+
+  if (query->by_id) {
+    int result = update_record_by_id(query, timestamp);
+    if (result == 0) { printf("❌ Errore: il record %d non esiste nella tabella %s\n", query->id, query->nome_tabella); }
+    else if (result < 0) { printf("❌ Errore: impossibile aggiornare il record %d della tabella %s\n", query->id, query->nome_tabella); }
+    else { printf("Record %d aggiornato nella tabella %s\n", query->id, query->nome_tabella); }
+    return;
+  }
+
+  long updated;
+  if (update_matching_records(query, timestamp, &updated) != SUCCESS) {
+    printf("❌ Errore: impossibile aggiornare la tabella %s, nessun record aggiornato\n", query->nome_tabella);
+  } else {
+    printf("✅ %ld record aggiornati nella tabella %s\n", updated, query->nome_tabella);
+  }
+}
@@ -0,0 +1,14 @@
+#ifndef UPDATE_COMMAND_H
+#define UPDATE_COMMAND_H
+
+// Config Header
+#include "../../config.h"
+
+
+// Functions Available including the UPDATE
+int validate_update(char *tokens[], int token_count, UpdateQuery *query);
+void execute_update(const UpdateQuery *query);
+
+
+
+#endif
@@ -0,0 +1,353 @@
+/*
+
+
+  Compact.c è il file che recupera, in background, lo spazio dei record eliminati con DELETE.
+  Le funzioni descritte in questo file sono:
+    - start_compaction_thread:  avvia il thread che compatta le tabelle.
+    - stop_compaction_thread:   ferma il thread, interrompendo la compattazione in corso.
+    - request_compaction:       chiede di compattare una tabella appena possibile.
+    - request_compaction_if_needed: chiede di compattare una tabella se il blocco di un record eliminato ne ha troppi.
+    - recover_compactions:      all'avvio finisce le compattazioni interrotte e chiede quelle rimaste in sospeso.
+    - pause_compaction:         sospende la compattazione, per tutta una transazione (vedi transaction.c).
+    - resume_compaction:        riprende la compattazione.
+    - lock_table_files:         blocca i file delle tabelle, per tutta la durata di un comando.
+    - unlock_table_files:       sblocca i file delle tabelle.
+
+  Quando si compatta una tabella?
+  DELETE non toglie il record dal file, lo segna nella mappa dei record eliminati (vedi tombstone.c).
+  Quando in un blocco di COMPACT_BLOCK_BYTES la frazione di record eliminati arriva a COMPACT_DEAD_FRACTION,
+  DELETE chiede di compattare la tabella. I record hanno una posizione fissa nel file: togliere quelli di un blocco
+  vuol dire spostare tutti i record che lo seguono, quindi la tabella viene riscritta tutta, con una lettura
+  e una scrittura sequenziali, in tables/<T>.compact. Alla fine il nuovo file sostituisce il vecchio con una rename.
+
+  Come fa a non bloccare i comandi?
+  Il programma esegue un comando alla volta, e main tiene il lock dei file delle tabelle per tutta la durata di ogni comando.
+  Il thread prende lo stesso lock solo per due momenti brevi:
+    ✅ all'inizio, per aprire la tabella (con la sua mappa) e leggerne la versione (vedi cache.c);
+    ✅ alla fine, per sostituire il file.
+  La copia, che è la parte lunga, avviene senza lock mentre i comandi continuano a girare.
+  Prima della rename la copia viene resa durevole, insieme alla sua mappa dei record eliminati (vedi tombstone.c), e viene
+  fatto un checkpoint del log (vedi wal.c): i record del log si riferiscono alle posizioni della tabella vecchia, e non
+  devono essere riapplicati a quella compattata. La nuova mappa viene installata dopo la rename.
+  Se nel frattempo la tabella è stata scritta la versione è cambiata e la copia non è più valida: viene buttata
+  e la compattazione riprovata. La versione non cambia con la compattazione, perchè i record restano gli stessi:
+  i risultati in cache restano validi.
+
+  L'ultimo record:
+  L'id di un nuovo record è quello dell'ultimo record del file più uno (vedi read_next_id). Se l'ultimo record è stato
+  eliminato, la compattazione lo tiene (sempre segnato come eliminato), così un id eliminato non viene mai riassegnato.
+
+  Durante una transazione (BEGIN … COMMIT) la compattazione è sospesa: la transazione tiene le posizioni dei record
+  da aggiornare ed eliminare al COMMIT, e una compattazione le cambierebbe. Una copia finita nel frattempo viene buttata
+  e riprovata dopo il COMMIT o il ROLLBACK.
+
+  Alla chiusura del programma una compattazione in corso viene interrotta: la tabella resta com'era.
+  Le richieste stanno solo in memoria, quindi all'avvio recover_compactions ricontrolla i blocchi di ogni tabella
+  e chiede di nuovo quelle che ne hanno bisogno; finisce anche una compattazione fermata tra la rename della tabella
+  e quella della sua mappa.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: fopen, fclose, fwrite, fflush, fseek, rename, remove
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strncpy, memcpy, memmove
+#include <unistd.h>                 // fsync
+#include <pthread.h>                // pthread_create, pthread_join, pthread_mutex_lock, pthread_cond_wait
+
+#include "compact.h"
+#include "schema.h"
+#include "scan.h"
+#include "tombstone.h"
+#include "cache.h"
+#include "wal.h"
+
+
+static pthread_mutex_t table_files_mutex = PTHREAD_MUTEX_INITIALIZER;    // Tenuto da main durante ogni comando
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;          // Protegge la coda e stopping
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static char queue[MAX_TABLES][50];                                       // Tabelle da compattare, nell'ordine delle richieste
+static int queue_length = 0;
+static bool stopping = false;
+static bool paused = false;                                              // Una transazione è aperta: niente compattazioni
+static bool started = false;
+static pthread_t worker;
+
+
+/**
+ * Funzioni che bloccano e sbloccano i file delle tabelle.
+ * main le chiama intorno a ogni comando: il thread di compattazione sostituisce un file solo tra un comando e l'altro.
+ */
+void lock_table_files() {
+  pthread_mutex_lock(&table_files_mutex);
+}
+
+void unlock_table_files() {
+  pthread_mutex_unlock(&table_files_mutex);
+}
+
+
+/**
+ * Funzione che verifica se il thread deve fermarsi.
+ */
+static bool is_stopping() {
+  pthread_mutex_lock(&queue_mutex);
+  bool result = stopping;
+  pthread_mutex_unlock(&queue_mutex);
+  return result;
+}
+
+
+/**
+ * Funzione che aggiunge una tabella alla coda, se non c'è già. Va chiamata con queue_mutex bloccato.
+ */
+static void enqueue_table(const char *table_name) {
+  for (int i = 0; i < queue_length; i++) {
+    if (strcmp(queue[i], table_name) == SUCCESS) { return; }
+  }
+  if (queue_length == MAX_TABLES) { return; }
+
+  strncpy(queue[queue_length], table_name, sizeof(queue[0]) - 1);
+  queue[queue_length][sizeof(queue[0]) - 1] = '\0';
+  queue_length++;
+  pthread_cond_signal(&queue_cond);
+}
+
+
+/**
+ * Funzione che riscrive una tabella senza i record eliminati e la sostituisce, se nel frattempo non è cambiata.
+ *
+ * @param table_name La tabella da compattare
+ * @return true se la tabella è stata scritta durante la copia e la compattazione va riprovata, false altrimenti
+ */
+static bool compact_table(const char *table_name) {
+  char path[256], tmp_path[256];
+  snprintf(path, sizeof(path), "%s/%s.bin", TABLES_DIR, table_name);
+  snprintf(tmp_path, sizeof(tmp_path), "%s/%s.compact", TABLES_DIR, table_name);
+
+  TableScan scan;
+  lock_table_files();                                                     // Step 1: apro la tabella e ne leggo la versione
+  bool opened = open_table_scan(table_name, &scan) == SUCCESS;
+  unsigned long version = get_table_version(table_name);
+  long total = opened ? count_table_records(&scan) : 0;
+  unlock_table_files();
+
+  if (!opened) { return false; }
+  if (scan.deleted_records == 0 || total == 0) {
+    close_table_scan(&scan);
+    return false;
+  }
+
+  FILE *out = fopen(tmp_path, "wb");                                      // Step 2: copio i record rimasti, senza lock
+  char *last = malloc(scan.record_size);
+  bool ok = out && last;
+  long written = 0, dead_position = -1;
+  int last_id = -1;
+  size_t count;
+
+  while (ok && !is_stopping() && (count = read_scan_batch(&scan)) > 0) {
+    ok = fwrite(scan.buffer, scan.record_size, count, out) == count;
+    memcpy(&last_id, scan.buffer + (count - 1) * scan.record_size, sizeof(int));
+    written += (long)count;
+  }
+  ok = ok && scan.next_position >= total;                                 // La scansione si è fermata prima della fine: errore o chiusura
+
+  if (ok) {                                                               // L'ultimo record del file è stato eliminato: lo tengo
+    int id;
+    ok = fseek(scan.file, (total - 1) * (long)scan.record_size, SEEK_SET) == 0 && fread(last, scan.record_size, 1, scan.file) == 1;
+    memcpy(&id, last, sizeof(int));
+    if (ok && (written == 0 || id != last_id)) {
+      ok = fwrite(last, scan.record_size, 1, out) == 1;
+      dead_position = written;
+    }
+  }
+
+  ok = ok && fflush(out) == 0 && fsync(fileno(out)) == 0;                 // La copia deve essere sul disco prima di sostituire la tabella
+  ok = ok && write_compacted_tombstones(table_name, out, dead_position) == SUCCESS;   // E anche la sua mappa
+  if (out && fclose(out) != 0) { ok = false; }
+  free(last);
+
+  lock_table_files();                                                     // Step 3: sostituisco il file, se la tabella non è cambiata
+  pthread_mutex_lock(&queue_mutex);
+  bool changed = paused || get_table_version(table_name) != version;      // Con una transazione aperta la copia va rifatta dopo
+  pthread_mutex_unlock(&queue_mutex);
+
+  if (!ok || changed || wal_checkpoint() != SUCCESS || rename(tmp_path, path) != 0) { remove(tmp_path); }
+
+  FILE *table = fopen(path, "rb");                                        // La mappa della copia vale solo se la rename è avvenuta
+  if (table) {
+    install_compacted_tombstones(table_name, table);
+    fclose(table);
+  }
+  unlock_table_files();
+
+  close_table_scan(&scan);
+  return ok && changed;
+}
+
+
+/**
+ * Funzione eseguita dal thread di compattazione: aspetta una richiesta, compatta la tabella e passa alla successiva.
+ */
+static void *compaction_worker(void *arg) {
+  (void)arg;
+  char table_name[50];
+
+  pthread_mutex_lock(&queue_mutex);
+  while (true) {
+    while ((queue_length == 0 || paused) && !stopping) { pthread_cond_wait(&queue_cond, &queue_mutex); }
+    if (stopping) { break; }
+
+    memcpy(table_name, queue[0], sizeof(table_name));
+    memmove(queue[0], queue[1], (size_t)(queue_length - 1) * sizeof(queue[0]));
+    queue_length--;
+    pthread_mutex_unlock(&queue_mutex);
+
+    bool retry = compact_table(table_name);
+
+    pthread_mutex_lock(&queue_mutex);
+    if (retry && !stopping) { enqueue_table(table_name); }
+  }
+  pthread_mutex_unlock(&queue_mutex);
+
+  return NULL;
+}
+
+
+/**
+ * Funzione che avvia il thread di compattazione.
+ * Se il thread non parte, DELETE funziona lo stesso: i record eliminati restano nel file, saltati dalle scansioni.
+ */
+void start_compaction_thread() {
+  started = pthread_create(&worker, NULL, compaction_worker, NULL) == 0;
+}
+
+
+/**
+ * Funzione che ferma il thread di compattazione e aspetta che finisca.
+ * Una compattazione in corso viene interrotta e le richieste ancora in coda vengono scartate.
+ */
+void stop_compaction_thread() {
+  if (!started) { return; }
+
+  pthread_mutex_lock(&queue_mutex);
+  stopping = true;
+  pthread_cond_broadcast(&queue_cond);
+  pthread_mutex_unlock(&queue_mutex);
+
+  pthread_join(worker, NULL);
+  started = false;
+}
+
+
+/**
+ * Funzione che chiede di compattare una tabella: il thread lo farà appena possibile, senza far aspettare chi la chiede.
+ *
+ * @param table_name La tabella da compattare
+ */
+void request_compaction(const char *table_name) {
+  if (!started) { return; }
+
+  pthread_mutex_lock(&queue_mutex);
+  enqueue_table(table_name);
+  pthread_mutex_unlock(&queue_mutex);
+}
+
+
+/**
+ * Funzione che chiede di compattare una tabella se, nel blocco di un record appena eliminato, i record eliminati
+ * sono almeno COMPACT_DEAD_FRACTION.
+ *
+ * @param table_name La tabella
+ * @param table Il file della tabella
+ * @param position La posizione del record eliminato
+ * @param total_records I record nel file
+ * @param record_size La dimensione di un record
+ * @return true se la compattazione è stata chiesta, false altrimenti
+ */
+bool request_compaction_if_needed(const char *table_name, FILE *table, long position, long total_records, size_t record_size) {
+  long block_records = COMPACT_BLOCK_BYTES / (long)record_size;
+  if (block_records < 1) { block_records = 1; }
+  long dead = count_block_deleted(table_name, table, position, block_records);
+
+  long block_start = position - position % block_records;                 // L'ultimo blocco può essere più corto
+  long in_block = total_records - block_start < block_records ? total_records - block_start : block_records;
+  if ((double)dead < COMPACT_DEAD_FRACTION * (double)in_block) { return false; }
+
+  request_compaction(table_name);
+  return true;
+}
+
+
+/**
+ * Funzione che dice se almeno un blocco di una tabella ha COMPACT_DEAD_FRACTION record eliminati.
+ * L'ultimo record non viene contato: se è eliminato la compattazione lo tiene (vedi compact_table),
+ * e da solo chiederebbe una compattazione a ogni avvio.
+ */
+static bool has_dead_block(const char *table_name, FILE *table, size_t record_size) {
+  unsigned char *bits;
+  long num_bits, deleted;
+  if (record_size == 0 || load_table_tombstones(table_name, table, &bits, &num_bits, &deleted) != SUCCESS || !bits) { return false; }
+
+  fseek(table, 0, SEEK_END);
+  long total = ftell(table) / (long)record_size - 1;
+  long block_records = COMPACT_BLOCK_BYTES / (long)record_size;
+  if (block_records < 1) { block_records = 1; }
+
+  bool found = false;
+  for (long start = 0; start < total && !found; start += block_records) {
+    long end = start + block_records < total ? start + block_records : total;
+    long dead = 0;
+    for (long p = start; p < end && p < num_bits; p++) {
+      if (bits[p / 8] & (1u << (p % 8))) { dead++; }
+    }
+    found = (double)dead >= COMPACT_DEAD_FRACTION * (double)(end - start);
+  }
+
+  free(bits);
+  return found;
+}
+
+
+/**
+ * Funzione che, all'avvio, finisce le compattazioni interrotte e chiede quelle rimaste in sospeso.
+ * Per ogni tabella: butta una copia rimasta a metà, installa (o butta) la mappa di una compattazione fermata
+ * dopo la rename della tabella, e chiede di compattarla se un suo blocco ha troppi record eliminati.
+ * Va chiamata dopo start_compaction_thread.
+ */
+void recover_compactions() {
+  lock_table_files();
+  for (int i = 0; i < schema.num_tabelle; i++) {
+    const char *table_name = schema.tabelle[i].nome_tabella;
+    char path[256], tmp_path[256];
+    snprintf(path, sizeof(path), "%s/%s.bin", TABLES_DIR, table_name);
+    snprintf(tmp_path, sizeof(tmp_path), "%s/%s.compact", TABLES_DIR, table_name);
+    remove(tmp_path);
+
+    FILE *table = fopen(path, "rb");
+    if (!table) { continue; }
+
+    install_compacted_tombstones(table_name, table);
+    if (has_dead_block(table_name, table, get_record_size(table_name))) { request_compaction(table_name); }
+    fclose(table);
+  }
+  unlock_table_files();
+}
+
+
+/**
+ * Funzioni che sospendono e riprendono la compattazione.
+ * Le richieste fatte nel frattempo restano in coda e vengono servite alla ripresa.
+ */
+void pause_compaction() {
+  pthread_mutex_lock(&queue_mutex);
+  paused = true;
+  pthread_mutex_unlock(&queue_mutex);
+}
+
+void resume_compaction() {
+  pthread_mutex_lock(&queue_mutex);
+  paused = false;
+  pthread_cond_broadcast(&queue_cond);
+  pthread_mutex_unlock(&queue_mutex);
+}
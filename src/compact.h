@@ -0,0 +1,23 @@
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <stdio.h>
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Compact
+void start_compaction_thread();
+void stop_compaction_thread();
+void request_compaction(const char *table_name);
+bool request_compaction_if_needed(const char *table_name, FILE *table, long position, long total_records, size_t record_size);
+void recover_compactions();
+void pause_compaction();
+void resume_compaction();
+void lock_table_files();
+void unlock_table_files();
+
+
+
+#endif
@@ -0,0 +1,482 @@
+/*
+
+
+  Groupby.c è il file che si occupa di eseguire le aggregazioni con GROUP BY.
+  Le funzioni descritte in questo file sono:
+    - execute_group_by:       esegue un AGGREGATE con GROUP BY e ne stampa i gruppi.
+    - estimate_group_count:   stima quanti gruppi ci saranno, con le statistiche di ANALYZE se ci sono.
+
+  Come funziona?
+  Si usa una tabella hash ad indirizzamento aperto (linear probing): per ogni record si costruisce la chiave
+  del gruppo, si calcola il suo hash e si cerca lo slot corrispondente. Se il gruppo non esiste, viene creato.
+
+    ✅ La tabella hash viene dimensionata in partenza con una stima del numero di gruppi, per evitare di ridimensionarla.
+    ✅ Le chiavi dei gruppi vengono scritte una dopo l'altra in un'unica area di memoria (arena), senza una malloc per gruppo.
+       Le colonne char vengono salvate solo per la loro lunghezza effettiva, non per tutti i 255 byte.
+    ✅ Gli stati delle aggregazioni dei gruppi stanno in un unico array, ogni gruppo ha la sua "fetta" a dimensione fissa.
+
+  Cosa succede se i gruppi non entrano in memoria?
+  C'è un budget di memoria (GROUP_BY_MEMORY_BUDGET). Quando viene superato, la tabella smette di creare nuovi gruppi:
+  i record dei gruppi già presenti continuano ad essere aggregati in memoria, mentre quelli dei gruppi nuovi
+  vengono scritti su disco, in GROUP_SPILL_PARTITIONS file temporanei nella cartella delle tabelle, scelti in base all'hash.
+  Tutti i record di uno stesso gruppo finiscono quindi o in memoria o nella stessa partizione.
+  Finita la scansione si stampano i gruppi in memoria, e poi si elabora ogni partizione allo stesso modo,
+  con un hash diverso, ripartizionando a sua volta se necessario.
+
+  Con SAMPLE si leggono solo i blocchi del campione, e COUNT e SUM di ogni gruppo vengono riportati all'intera tabella
+  (moltiplicati per record della tabella / record letti). L'intervallo di confidenza viene stampato solo senza GROUP BY.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fwrite, remove
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, realloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memcmp, strnlen
+#include <stdint.h>                 // uint64_t, uint32_t
+#include <unistd.h>                 // getpid
+
+#include "groupby.h"
+#include "aggregate.h"
+#include "scan.h"
+#include "predicate.h"
+#include "utils.h"
+#include "sample.h"
+#include "planner.h"
+#include "stats.h"
+#include "output.h"
+#include "commands/read.h"
+
+
+typedef struct {                                // Un gruppo: dove si trova la sua chiave nell'arena
+  uint64_t hash;                                // hash: hash della chiave, salvato per non ricalcolarlo durante i resize
+  uint32_t key_offset;                          // key_offset: posizione della chiave nell'arena
+  uint32_t key_len;                             // key_len: lunghezza della chiave
+} GroupEntry;
+
+typedef struct {                                // GroupTable: tabella hash dei gruppi per un livello di partizionamento
+  const AggregateQuery *query;
+  int level;                                    // level: 0 per la tabella, >0 per le partizioni su disco
+
+  uint32_t *slots;                              // slots: indice del gruppo + 1, 0 = slot vuoto
+  size_t capacity;                              // capacity: numero di slot (potenza di 2)
+
+  GroupEntry *groups;                           // groups: i gruppi, nell'ordine di creazione
+  size_t num_groups, groups_capacity;
+
+  char *states;                                 // states: stati delle aggregazioni, state_stride byte per gruppo
+  size_t state_stride;
+  size_t spec_offsets[MAX_AGGREGATES];          // spec_offsets: posizione dello stato di ogni funzione nella fetta del gruppo
+
+  char *keys;                                   // keys: arena con le chiavi dei gruppi, una dopo l'altra
+  size_t keys_used, keys_capacity;
+
+  size_t budget;                                // budget: memoria massima utilizzabile
+  bool spilling;                                // spilling: true se i nuovi gruppi vanno scritti su disco
+  FILE *partitions[GROUP_SPILL_PARTITIONS];     // partitions: file temporanei delle partizioni
+  long spilled;                                 // spilled: record scritti su disco
+  double sample_scale;                          // sample_scale: fattore per riportare COUNT e SUM alla tabella con SAMPLE, 0 = nessun campione
+} GroupTable;
+
+
+static int run_group_by(const AggregateQuery *query, FILE *input, int level, long estimate, double sample_scale);
+
+
+/**
+ * Funzione che costruisce la chiave di un record: i valori delle colonne di raggruppamento uno dopo l'altro.
+ * Le colonne char vengono salvate come lunghezza (1 byte) + caratteri, senza il resto del campo.
+ * @return La lunghezza della chiave
+ */
+static size_t build_group_key(const AggregateQuery *query, const char *record, char *key) {
+  size_t len = 0;
+
+  for (int i = 0; i < query->group_by.num_colonne; i++) {
+    const LayoutColumn *col = &query->layout.colonne[query->group_by.colonne[i]];
+    const char *value = record + col->offset;
+
+    if (col->kind == KIND_CHAR) {
+      size_t n = strnlen(value, col->tipo.length);
+      if (n > 255) { n = 255; }
+      key[len++] = (char)n;
+      memcpy(key + len, value, n);
+      len += n;
+    } else {
+      memcpy(key + len, value, col->tipo.length);
+      len += col->tipo.length;
+    }
+  }
+
+  return len;
+}
+
+
+/**
+ * Funzione che ricostruisce i valori delle colonne di raggruppamento in un record, a partire dalla chiave.
+ * Serve per stampare i gruppi con print_record.
+ */
+static void decode_group_key(const AggregateQuery *query, const char *key, char *record) {
+  size_t pos = 0;
+
+  for (int i = 0; i < query->group_by.num_colonne; i++) {
+    const LayoutColumn *col = &query->layout.colonne[query->group_by.colonne[i]];
+    char *value = record + col->offset;
+
+    if (col->kind == KIND_CHAR) {
+      size_t n = (unsigned char)key[pos++];
+      memset(value, 0, col->tipo.length);
+      memcpy(value, key + pos, n);
+      pos += n;
+    } else {
+      memcpy(value, key + pos, col->tipo.length);
+      pos += col->tipo.length;
+    }
+  }
+}
+
+
+/**
+ * Funzione che stima quanti gruppi ci saranno, per dimensionare la tabella hash (e per EXPLAIN).
+ * Se la tabella è stata analizzata (vedi ANALYZE) si usano i valori distinti di ogni colonna, più uno se ci sono NULL.
+ * Altrimenti una colonna bool ha al massimo 2 valori, le altre al massimo un valore per record.
+ */
+long estimate_group_count(const AggregateQuery *query, long rows) {
+  TableStats stats;
+  bool has_stats = load_table_stats(query->nome_tabella, &query->layout, &stats) == SUCCESS;
+  long estimate = 1;
+
+  for (int i = 0; i < query->group_by.num_colonne; i++) {
+    int index = query->group_by.colonne[i];
+    const LayoutColumn *col = &query->layout.colonne[index];
+    long distinct = (col->kind == KIND_BOOL) ? 2 : rows;
+
+    if (has_stats) {
+      const ColumnStats *column = &stats.colonne[index];
+      long analyzed = (long)(column->distinct + 0.5) + (column->null_count > 0 ? 1 : 0);
+      if (analyzed > 0 && analyzed < distinct) { distinct = analyzed; }
+    }
+
+    if (distinct > 0 && estimate > rows / distinct) { return rows; }       // Evito l'overflow: la stima non supera mai le righe
+    estimate *= distinct;
+  }
+
+  return estimate < rows ? estimate : rows;
+}
+
+
+/**
+ * Funzione che stima la memoria usata dalla tabella hash.
+ */
+static size_t group_table_memory(const GroupTable *table) {
+  return table->capacity * sizeof(uint32_t) + table->groups_capacity * (sizeof(GroupEntry) + table->state_stride) + table->keys_capacity;
+}
+
+
+/**
+ * Funzione che prepara la tabella hash, con capacity dimensionata sulla stima dei gruppi (ma entro il budget).
+ */
+static int init_group_table(GroupTable *table, const AggregateQuery *query, int level, long estimate) {
+  memset(table, 0, sizeof(GroupTable));
+  table->query = query;
+  table->level = level;
+  table->budget = GROUP_BY_MEMORY_BUDGET;
+
+  for (int i = 0; i < query->num_specs; i++) {
+    table->spec_offsets[i] = table->state_stride;
+    table->state_stride += aggregate_state_size(&query->layout, &query->specs[i]);
+  }
+
+  size_t per_group = 2 * sizeof(uint32_t) + sizeof(GroupEntry) + table->state_stride + 16;
+  size_t max_groups = table->budget / per_group;
+  size_t wanted = estimate > 0 ? (size_t)estimate : 1;
+  if (wanted > max_groups) { wanted = max_groups; }
+
+  table->capacity = 16;
+  while (table->capacity < wanted * 2) { table->capacity <<= 1; }        // Fattore di carico massimo: 50%
+
+  table->groups_capacity = table->capacity / 2;
+  table->keys_capacity = table->groups_capacity * 16;
+
+  table->slots = calloc(table->capacity, sizeof(uint32_t));
+  table->groups = malloc(table->groups_capacity * sizeof(GroupEntry));
+  table->states = malloc(table->groups_capacity * table->state_stride);
+  table->keys = malloc(table->keys_capacity);
+
+  if (!table->slots || !table->groups || !table->states || !table->keys) {
+    printf("Errore: malloc fallita per la tabella dei gruppi\n");
+    return FAILURE;
+  }
+
+  return SUCCESS;
+}
+
+
+static void free_group_table(GroupTable *table) {
+  free(table->slots);
+  free(table->groups);
+  free(table->states);
+  free(table->keys);
+
+  for (int p = 0; p < GROUP_SPILL_PARTITIONS; p++) {
+    if (table->partitions[p]) { fclose(table->partitions[p]); }
+  }
+}
+
+
+/**
+ * Funzione che raddoppia il numero di slot e reinserisce i gruppi usando gli hash salvati.
+ */
+static int grow_slots(GroupTable *table) {
+  size_t capacity = table->capacity * 2;
+  uint32_t *slots = calloc(capacity, sizeof(uint32_t));
+  if (!slots) { return FAILURE; }
+
+  for (size_t g = 0; g < table->num_groups; g++) {
+    size_t s = table->groups[g].hash & (capacity - 1);
+    while (slots[s] != 0) { s = (s + 1) & (capacity - 1); }
+    slots[s] = (uint32_t)(g + 1);
+  }
+
+  free(table->slots);
+  table->slots = slots;
+  table->capacity = capacity;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che fa spazio per un nuovo gruppo e una nuova chiave di key_len byte.
+ * Se per farlo si supererebbe il budget di memoria, ritorna FAILURE e il chiamante passa alla scrittura su disco.
+ */
+static int reserve_group(GroupTable *table, size_t key_len) {
+  if ((table->num_groups + 1) * 2 > table->capacity) {
+    if (group_table_memory(table) + table->capacity * sizeof(uint32_t) > table->budget) { return FAILURE; }
+    if (grow_slots(table) != SUCCESS) { return FAILURE; }
+  }
+
+  if (table->num_groups == table->groups_capacity) {
+    size_t capacity = table->groups_capacity * 2;
+    if (group_table_memory(table) + table->groups_capacity * (sizeof(GroupEntry) + table->state_stride) > table->budget) { return FAILURE; }
+
+    GroupEntry *groups = realloc(table->groups, capacity * sizeof(GroupEntry));
+    if (!groups) { return FAILURE; }
+    table->groups = groups;
+
+    char *states = realloc(table->states, capacity * table->state_stride);
+    if (!states) { return FAILURE; }
+    table->states = states;
+
+    table->groups_capacity = capacity;
+  }
+
+  if (table->keys_used + key_len > table->keys_capacity) {
+    size_t capacity = table->keys_capacity * 2 + key_len;
+    if (group_table_memory(table) + (capacity - table->keys_capacity) > table->budget) { return FAILURE; }
+
+    char *keys = realloc(table->keys, capacity);
+    if (!keys) { return FAILURE; }
+    table->keys = keys;
+    table->keys_capacity = capacity;
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che scrive un record nella sua partizione su disco.
+ * La partizione si sceglie con i bit alti dell'hash, che non sono usati per scegliere lo slot.
+ */
+static int spill_record(GroupTable *table, uint64_t hash, const char *record) {
+  int p = (int)(hash >> 60) & (GROUP_SPILL_PARTITIONS - 1);
+
+  if (!table->partitions[p]) {
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/tmp_group_%d_%d_%d.bin", TABLES_DIR, (int)getpid(), table->level, p);
+
+    table->partitions[p] = fopen(filename, "w+b");
+    if (!table->partitions[p]) {
+      printf("Errore nella creazione del file temporaneo %s\n", filename);
+      return FAILURE;
+    }
+    remove(filename);                                                   // Il file sparisce da solo alla fclose, anche in caso di errore
+  }
+
+  if (fwrite(record, table->query->layout.record_size, 1, table->partitions[p]) != 1) {
+    printf("Errore nella scrittura del file temporaneo della GROUP BY\n");
+    return FAILURE;
+  }
+
+  table->spilled++;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che aggrega un record: cerca (o crea) il suo gruppo e aggiorna gli stati.
+ */
+static int add_record(GroupTable *table, const char *record) {
+  const AggregateQuery *query = table->query;
+  char key[MAX_LAYOUT_COLUMNS * 256];
+
+  size_t key_len = build_group_key(query, record, key);
+  uint64_t hash = hash_bytes(key, key_len, table->level);
+  size_t s = hash & (table->capacity - 1);
+
+  while (table->slots[s] != 0) {                                          // Linear probing
+    GroupEntry *entry = &table->groups[table->slots[s] - 1];
+    if (entry->hash == hash && entry->key_len == key_len && memcmp(table->keys + entry->key_offset, key, key_len) == SUCCESS) { break; }
+    s = (s + 1) & (table->capacity - 1);
+  }
+
+  uint32_t group = table->slots[s];
+
+  if (group == 0) {                                                       // Gruppo nuovo
+    if (table->spilling || reserve_group(table, key_len) != SUCCESS) {
+      table->spilling = true;
+      return spill_record(table, hash, record);
+    }
+
+    s = hash & (table->capacity - 1);                                     // Gli slot potrebbero essere stati ridimensionati
+    while (table->slots[s] != 0) { s = (s + 1) & (table->capacity - 1); }
+
+    GroupEntry *entry = &table->groups[table->num_groups];
+    entry->hash = hash;
+    entry->key_offset = (uint32_t)table->keys_used;
+    entry->key_len = (uint32_t)key_len;
+    memcpy(table->keys + table->keys_used, key, key_len);
+    table->keys_used += key_len;
+
+    char *states = table->states + table->num_groups * table->state_stride;
+    for (int i = 0; i < query->num_specs; i++) {
+      init_aggregate_state(&query->specs[i], (AggregateState *)(states + table->spec_offsets[i]));
+    }
+
+    table->num_groups++;
+    group = (uint32_t)table->num_groups;
+    table->slots[s] = group;
+  }
+
+  char *states = table->states + (group - 1) * table->state_stride;
+  for (int i = 0; i < query->num_specs; i++) {
+    accumulate_batch(&query->layout, &query->specs[i], (AggregateState *)(states + table->spec_offsets[i]), record, query->layout.record_size, NULL, 1);
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che stampa i gruppi presenti in memoria.
+ */
+static void print_groups(const GroupTable *table) {
+  const AggregateQuery *query = table->query;
+  char record[query->layout.record_size];
+  memset(record, 0, sizeof(record));
+
+  for (size_t g = 0; g < table->num_groups; g++) {
+    decode_group_key(query, table->keys + table->groups[g].key_offset, record);
+
+    print_record_values(&query->layout, &query->group_by, record);
+
+    const char *states = table->states + g * table->state_stride;
+    for (int i = 0; i < query->num_specs; i++) {
+      const AggregateState *state = (const AggregateState *)(states + table->spec_offsets[i]);
+      if (table->sample_scale > 0) { print_aggregate_estimate(&query->layout, &query->specs[i], state, table->sample_scale, -1); }
+      else                         { print_aggregate_value(&query->layout, &query->specs[i], state); }
+    }
+    output_end_row();
+  }
+}
+
+
+/**
+ * Funzione che esegue un livello della GROUP BY.
+ * Con input NULL legge la tabella (applicando il filtro e il campionamento) e stampa l'intestazione,
+ * altrimenti legge i record già filtrati di una partizione.
+ * @return Il numero di gruppi stampati, -1 in caso di errore
+ */
+static int run_group_by(const AggregateQuery *query, FILE *input, int level, long estimate, double sample_scale) {
+  TableScan scan;
+  int opened = input ? open_file_scan(input, query->layout.record_size, &scan) : open_table_scan(query->nome_tabella, &scan);
+  if (opened != SUCCESS) { return -1; }
+
+  if (!input) {
+    estimate = estimate_group_count(query, count_table_records(&scan));
+    set_scan_sample(&scan, &query->sample);
+    plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);
+
+    print_sample_summary(&scan);
+    for (int i = 0; i < query->group_by.num_colonne; i++) { output_column_name(query->layout.colonne[query->group_by.colonne[i]].nome); }
+    for (int i = 0; i < query->num_specs; i++) { output_column_name(query->specs[i].label); }
+    output_end_row();
+  }
+
+  GroupTable table;
+  if (init_group_table(&table, query, level, estimate) != SUCCESS) {
+    free_group_table(&table);
+    close_table_scan(&scan);
+    return -1;
+  }
+
+  const Predicate *pred = (!input && query->predicate.root >= 0) ? &query->predicate : NULL;
+  int result = SUCCESS;
+  size_t count;
+
+  while (result == SUCCESS && (count = read_scan_batch(&scan)) > 0) {
+    for (size_t r = 0; r < count && result == SUCCESS; r++) {
+      const char *record = scan.buffer + r * scan.record_size;
+      if (pred && !evaluate_predicate(pred, record)) { continue; }
+      result = add_record(&table, record);
+    }
+  }
+
+  if (scan.sampling && scan.sampled_records > 0) { sample_scale = (double)scan.total_records / (double)scan.sampled_records; }
+  table.sample_scale = sample_scale;
+  close_table_scan(&scan);
+
+  if (result != SUCCESS) {
+    free_group_table(&table);
+    return -1;
+  }
+
+  print_groups(&table);
+  int printed = (int)table.num_groups;
+
+  // I gruppi in memoria sono stampati: libero la memoria prima di elaborare le partizioni su disco
+  free(table.slots);  table.slots = NULL;
+  free(table.groups); table.groups = NULL;
+  free(table.states); table.states = NULL;
+  free(table.keys);   table.keys = NULL;
+
+  for (int p = 0; p < GROUP_SPILL_PARTITIONS && printed >= 0; p++) {
+    FILE *partition = table.partitions[p];
+    if (!partition) { continue; }
+    table.partitions[p] = NULL;
+
+    if (level >= GROUP_MAX_SPILL_LEVEL) {
+      printf("❌ Errore: troppi gruppi, impossibile completare la GROUP BY entro il budget di memoria\n");
+      fclose(partition);
+      printed = -1;
+      continue;
+    }
+
+    rewind(partition);
+    int sub = run_group_by(query, partition, level + 1, table.spilled / GROUP_SPILL_PARTITIONS, sample_scale);   // La scansione chiude il file
+    printed = sub < 0 ? -1 : printed + sub;
+  }
+
+  free_group_table(&table);
+  return printed;
+}
+
+
+/**
+ * Funzione che esegue un AGGREGATE con GROUP BY: stampa una riga per ogni gruppo,
+ * con i valori delle colonne di raggruppamento seguiti dai risultati delle aggregazioni.
+ *
+ * @param query La query, con almeno una colonna in group_by
+ * @return Il numero di gruppi, -1 in caso di errore
+ */
+long execute_group_by(const AggregateQuery *query) {
+  output_title("Tabella: %s\n", query->nome_tabella);
+  return run_group_by(query, NULL, 0, 0, 0);
+}
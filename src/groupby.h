@@ -0,0 +1,14 @@
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Group By
+long execute_group_by(const AggregateQuery *query);
+long estimate_group_count(const AggregateQuery *query, long rows);
+
+
+
+#endif
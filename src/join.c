@@ -0,0 +1,564 @@
+/*
+
+
+  Join.c è il file che si occupa di unire i record di due tabelle (JOIN).
+  Le funzioni descritte in questo file sono:
+    - execute_join_query:     esegue una JoinQuery scegliendo la strategia più economica, e stampa i record uniti.
+
+  Strategie:
+    ✅ Ricerca per id: se la colonna di join di una tabella è il suo id, e quella tabella è la più grande,
+       si scansiona solo l'altra tabella e per ogni record si legge direttamente il record con quell'id
+       (con gli id contigui basta una lettura, altrimenti una ricerca binaria: vedi find_position_after_id).
+       Così la tabella grande non viene mai letta per intero.
+    ✅ Hash join: negli altri casi si costruisce una tabella hash sulla tabella più piccola (build)
+       e si scansiona l'altra (probe), cercando nella tabella hash i record con la stessa chiave.
+
+  Hash join partizionato (radix):
+  Una tabella hash grande come tutto il lato di build non sta in cache, e quasi ogni ricerca sarebbe un cache miss.
+  Per questo i record di build vengono divisi in 2^bits partizioni in base ai bit bassi dell'hash,
+  in modo che ogni partizione (record + tabella hash) occupi circa JOIN_CACHE_BYTES.
+  Anche i record di probe, un batch alla volta, vengono raggruppati per partizione prima di essere cercati:
+  si lavora così su una partizione alla volta, che resta in cache.
+
+  Cosa succede se il lato di build non entra in memoria?
+  Se supera JOIN_MEMORY_BUDGET, entrambe le tabelle vengono divise su disco in JOIN_SPILL_PARTITIONS file temporanei
+  in base all'hash della chiave: i record con la stessa chiave finiscono nella stessa partizione di entrambe le tabelle,
+  e ogni coppia di partizioni viene unita allo stesso modo, con un hash diverso.
+  Dopo JOIN_MAX_SPILL_LEVEL livelli una partizione ancora troppo grande ha quasi sempre tantissimi record con la stessa
+  chiave, che nessun hash può dividere: la coppia viene unita a blocchi (block nested loop), leggendo il lato di build
+  a pezzi di JOIN_MEMORY_BUDGET e rileggendo ogni volta il lato di probe. Così la memoria resta comunque limitata.
+
+  Le chiavi NULL (vedi get_null_value) non si uniscono con nulla, come in SQL. Fanno eccezione i bool, per cui il NULL coincide con false.
+  Il filtro viene valutato sul record unito, cioè il record di A seguito da quello di B, come nel layout della JoinQuery.
+  I record uniti non escono in un ordine preciso.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fwrite, remove
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, calloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memcmp, strnlen
+#include <stdint.h>                 // uint32_t, uint64_t
+#include <unistd.h>                 // getpid
+
+#include "join.h"
+#include "scan.h"
+#include "predicate.h"
+#include "utils.h"
+#include "output.h"
+#include "commands/read.h"
+
+
+typedef struct {                                // JoinContext: stato condiviso da tutti i livelli di una JOIN
+  const JoinQuery *query;
+  ColumnKind key_kind;                          // key_kind: tipologia delle colonne di join (uguale per le due tabelle)
+  size_t key_offsets[2];                        // key_offsets: posizione della chiave nel record di ogni tabella
+  size_t key_lengths[2];                        // key_lengths: lunghezza della colonna di join di ogni tabella
+  const void *null_value;                       // null_value: valore NULL della colonna di join
+  char *joined;                                 // joined: buffer del record unito (A seguito da B)
+  long printed;                                 // printed: record stampati finora
+  bool done;                                    // done: true quando si è raggiunto il LIMIT
+} JoinContext;
+
+
+static int run_hash_join(JoinContext *ctx, FILE *inputs[2], int level);
+
+
+/**
+ * Funzione che ottiene la chiave di join di un record di una delle due tabelle.
+ * Per i char conta solo la parte valorizzata, così due colonne char di lunghezza diversa si confrontano correttamente.
+ *
+ * @param side 0 per la prima tabella, 1 per la seconda
+ * @param key Puntatore che viene fatto puntare al valore della chiave
+ * @return La lunghezza della chiave, 0 se la chiave è NULL
+ */
+static size_t get_join_key(const JoinContext *ctx, int side, const char *record, const char **key) {
+  const char *value = record + ctx->key_offsets[side];
+  size_t length = ctx->key_lengths[side];
+  *key = value;
+
+  if (ctx->key_kind == KIND_CHAR) { return strnlen(value, length); }
+  if (ctx->key_kind != KIND_BOOL && memcmp(value, ctx->null_value, length) == SUCCESS) { return 0; }
+  return length;
+}
+
+
+/**
+ * Funzione che unisce un record di ogni tabella, applica il filtro e, se passa, stampa il record unito.
+ */
+static void emit_joined(JoinContext *ctx, const char *record_a, const char *record_b) {
+  const JoinQuery *query = ctx->query;
+
+  memcpy(ctx->joined, record_a, query->record_sizes[0]);
+  memcpy(ctx->joined + query->record_sizes[0], record_b, query->record_sizes[1]);
+
+  if (query->predicate.root >= 0 && !evaluate_predicate(&query->predicate, ctx->joined)) { return; }
+
+  print_record(&query->layout, &query->projection, ctx->joined);
+  ctx->printed++;
+  if (ctx->printed == query->limit) { ctx->done = true; }
+}
+
+
+/**
+ * Funzione che apre la scansione di una delle due tabelle, oppure di una sua partizione su disco.
+ */
+static int open_join_scan(const JoinContext *ctx, int side, FILE *input, TableScan *scan) {
+  if (input) { return open_file_scan(input, ctx->query->record_sizes[side], scan); }
+  return open_table_scan(ctx->query->tabelle[side], scan);
+}
+
+
+/**
+ * Funzione che divide i record di una tabella (o di una partizione) in JOIN_SPILL_PARTITIONS file temporanei,
+ * in base all'hash della chiave. I record con chiave NULL vengono scartati, tanto non si uniscono con nulla.
+ * @return SUCCESS se tutti i record sono stati scritti, FAILURE altrimenti
+ */
+static int spill_join_side(JoinContext *ctx, int side, TableScan *scan, int level, FILE *partitions[JOIN_SPILL_PARTITIONS]) {
+  size_t count;
+
+  while ((count = read_scan_batch(scan)) > 0) {
+    for (size_t r = 0; r < count; r++) {
+      const char *record = scan->buffer + r * scan->record_size;
+      const char *key;
+      size_t len = get_join_key(ctx, side, record, &key);
+      if (len == 0) { continue; }
+
+      int p = (int)((hash_bytes(key, len, level) >> 32) % JOIN_SPILL_PARTITIONS);   // Bit alti: quelli bassi servono al partizionamento in memoria
+
+      if (!partitions[p]) {
+        char filename[256];
+        snprintf(filename, sizeof(filename), "%s/tmp_join_%d_%d_%d_%d.bin", TABLES_DIR, (int)getpid(), level, side, p);
+        partitions[p] = fopen(filename, "w+b");
+        if (!partitions[p]) {
+          printf("Errore nella creazione del file temporaneo %s\n", filename);
+          return FAILURE;
+        }
+        remove(filename);                                                 // Il file sparisce da solo alla fclose
+      }
+
+      if (fwrite(record, scan->record_size, 1, partitions[p]) != 1) {
+        printf("Errore nella scrittura della partizione della JOIN\n");
+        return FAILURE;
+      }
+    }
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che esegue la JOIN partizionando entrambi i lati su disco, e poi unendo ogni coppia di partizioni.
+ * Chiude le scansioni ricevute.
+ * @return SUCCESS se la JOIN è stata completata, FAILURE altrimenti
+ */
+static int spill_hash_join(JoinContext *ctx, TableScan scans[2], int level) {
+  FILE *partitions[2][JOIN_SPILL_PARTITIONS] = {{ NULL }};
+  int result = SUCCESS;
+
+  for (int side = 0; side < 2 && result == SUCCESS; side++) {
+    result = spill_join_side(ctx, side, &scans[side], level, partitions[side]);
+  }
+  close_table_scan(&scans[0]);
+  close_table_scan(&scans[1]);
+
+  for (int p = 0; p < JOIN_SPILL_PARTITIONS; p++) {
+    if (result == SUCCESS && !ctx->done && partitions[0][p] && partitions[1][p]) {
+      FILE *inputs[2] = { partitions[0][p], partitions[1][p] };
+      rewind(inputs[0]);
+      rewind(inputs[1]);
+      result = run_hash_join(ctx, inputs, level + 1);                     // Le scansioni della partizione chiudono i file
+      continue;
+    }
+    if (partitions[0][p]) { fclose(partitions[0][p]); }                   // Una partizione vuota sull'altro lato: nessuna coppia
+    if (partitions[1][p]) { fclose(partitions[1][p]); }
+  }
+
+  return result;
+}
+
+
+/**
+ * Funzione che esegue la JOIN a blocchi (block nested loop), quando anche all'ultimo livello il lato di build
+ * non entra in JOIN_MEMORY_BUDGET. Il lato di build viene letto a pezzi che entrano nel budget, scartando le chiavi NULL;
+ * per ogni pezzo il lato di probe viene riletto dall'inizio e ogni suo record viene confrontato con tutti quelli del pezzo.
+ * I confronti sono tanti quanti le coppie, ma con chiavi quasi tutte uguali lo sono anche i record uniti.
+ * Chiude le scansioni ricevute.
+ * @return SUCCESS se la JOIN è stata completata, FAILURE altrimenti
+ */
+static int run_block_join(JoinContext *ctx, TableScan scans[2], int build_side) {
+  int probe_side = 1 - build_side;
+  TableScan *build = &scans[build_side];
+  TableScan *probe = &scans[probe_side];
+  size_t build_size = build->record_size;
+  size_t chunk_records = JOIN_MEMORY_BUDGET / build_size > 0 ? JOIN_MEMORY_BUDGET / build_size : 1;
+
+  char *chunk = malloc(chunk_records * build_size);
+  int result = SUCCESS;
+  if (!chunk) {
+    printf("Errore: malloc fallita per la JOIN\n");
+    result = FAILURE;
+  }
+
+  size_t count = 0, next = 0;                                             // Ultimo batch di build letto e primo record non ancora copiato
+  bool finished = false;
+  while (result == SUCCESS && !ctx->done && !finished) {
+    size_t n = 0;                                                         // Step 1: riempio un pezzo con i record di build
+    while (n < chunk_records) {
+      if (next == count) {
+        count = read_scan_batch(build);
+        next = 0;
+        if (count == 0) { finished = true; break; }
+      }
+
+      const char *record = build->buffer + next++ * build_size;
+      const char *key;
+      if (get_join_key(ctx, build_side, record, &key) == 0) { continue; }
+      memcpy(chunk + n++ * build_size, record, build_size);
+    }
+    if (n == 0) { break; }
+
+    if (seek_table_scan(probe, 0) != SUCCESS) {                           // Step 2: rileggo tutto il lato di probe
+      printf("Errore nella lettura della partizione della JOIN\n");
+      result = FAILURE;
+      break;
+    }
+
+    size_t probe_count;
+    while (!ctx->done && (probe_count = read_scan_batch(probe)) > 0) {
+      for (size_t r = 0; r < probe_count && !ctx->done; r++) {
+        const char *probe_record = probe->buffer + r * probe->record_size;
+        const char *probe_key;
+        size_t probe_len = get_join_key(ctx, probe_side, probe_record, &probe_key);
+        if (probe_len == 0) { continue; }
+
+        for (size_t j = 0; j < n && !ctx->done; j++) {
+          const char *build_record = chunk + j * build_size;
+          const char *build_key;
+          size_t build_len = get_join_key(ctx, build_side, build_record, &build_key);
+          if (build_len != probe_len || memcmp(build_key, probe_key, build_len) != SUCCESS) { continue; }
+
+          if (build_side == 0) { emit_joined(ctx, build_record, probe_record); }
+          else                 { emit_joined(ctx, probe_record, build_record); }
+        }
+      }
+    }
+  }
+
+  close_table_scan(&scans[0]);
+  close_table_scan(&scans[1]);
+  free(chunk);
+  return result;
+}
+
+
+/**
+ * Funzione che esegue un livello dell'hash join.
+ * Con inputs NULL legge le tabelle, altrimenti legge una coppia di partizioni su disco (e le chiude).
+ * Il lato di build è sempre quello con meno record.
+ * @return SUCCESS se la JOIN è stata completata, FAILURE altrimenti
+ */
+static int run_hash_join(JoinContext *ctx, FILE *inputs[2], int level) {
+  TableScan scans[2];
+
+  if (open_join_scan(ctx, 0, inputs ? inputs[0] : NULL, &scans[0]) != SUCCESS) {
+    if (inputs) { fclose(inputs[1]); }
+    return FAILURE;
+  }
+  if (open_join_scan(ctx, 1, inputs ? inputs[1] : NULL, &scans[1]) != SUCCESS) {
+    close_table_scan(&scans[0]);
+    return FAILURE;
+  }
+
+  long rows[2] = { count_table_records(&scans[0]), count_table_records(&scans[1]) };
+  int build_side = rows[0] <= rows[1] ? 0 : 1;
+  int probe_side = 1 - build_side;
+  TableScan *build = &scans[build_side];
+  TableScan *probe = &scans[probe_side];
+  size_t build_size = build->record_size;
+  size_t n_max = (size_t)rows[build_side];
+
+  // Memoria del lato di build: record letti + record partizionati + hash + slot della tabella hash (circa 2 per record)
+  size_t needed = n_max * (2 * build_size + 3 * sizeof(uint32_t));
+  if (needed > JOIN_MEMORY_BUDGET) {
+    if (level < JOIN_MAX_SPILL_LEVEL) { return spill_hash_join(ctx, scans, level); }
+    return run_block_join(ctx, scans, build_side);                        // Ripartizionare non divide più le chiavi
+  }
+
+  int result = FAILURE;
+  char *records = malloc(n_max * build_size + 1);
+  uint32_t *hashes = malloc(n_max * sizeof(uint32_t) + 1);
+  char *part_records = malloc(n_max * build_size + 1);
+  uint32_t *part_hashes = malloc(n_max * sizeof(uint32_t) + 1);
+  size_t *starts = NULL, *bucket_starts = NULL, *cursor = NULL;
+  uint32_t *buckets = NULL;
+  uint32_t *probe_hashes = malloc(probe->batch_records * sizeof(uint32_t));
+  uint32_t *probe_rows = malloc(probe->batch_records * sizeof(uint32_t));
+  uint32_t *probe_order = malloc(probe->batch_records * sizeof(uint32_t));
+
+  if (!records || !hashes || !part_records || !part_hashes || !probe_hashes || !probe_rows || !probe_order) {
+    printf("Errore: malloc fallita per la JOIN\n");
+    goto cleanup;
+  }
+
+  // Step 1: leggo il lato di build, scartando le chiavi NULL, e calcolo l'hash di ogni chiave
+  size_t n = 0, count;
+  while ((count = read_scan_batch(build)) > 0) {
+    for (size_t r = 0; r < count && n < n_max; r++) {
+      const char *record = build->buffer + r * build_size;
+      const char *key;
+      size_t len = get_join_key(ctx, build_side, record, &key);
+      if (len == 0) { continue; }
+
+      memcpy(records + n * build_size, record, build_size);
+      hashes[n++] = (uint32_t)hash_bytes(key, len, level);
+    }
+  }
+
+  // Step 2: scelgo quante partizioni servono perchè ognuna stia in circa JOIN_CACHE_BYTES
+  int bits = 0;
+  while (bits < JOIN_MAX_RADIX_BITS && ((n * (build_size + 3 * sizeof(uint32_t))) >> bits) > JOIN_CACHE_BYTES) { bits++; }
+  size_t num_partitions = (size_t)1 << bits;
+  uint32_t mask = (uint32_t)(num_partitions - 1);
+
+  starts = calloc(num_partitions + 1, sizeof(size_t));
+  bucket_starts = calloc(num_partitions + 1, sizeof(size_t));
+  cursor = malloc((num_partitions + 1) * sizeof(size_t));
+  if (!starts || !bucket_starts || !cursor) {
+    printf("Errore: malloc fallita per la JOIN\n");
+    goto cleanup;
+  }
+
+  // Step 3: istogramma delle partizioni, e poi sposto i record in modo che ogni partizione sia contigua
+  for (size_t i = 0; i < n; i++) { starts[(hashes[i] & mask) + 1]++; }
+  for (size_t p = 0; p < num_partitions; p++) { starts[p + 1] += starts[p]; }
+  memcpy(cursor, starts, (num_partitions + 1) * sizeof(size_t));
+
+  for (size_t i = 0; i < n; i++) {
+    size_t dst = cursor[hashes[i] & mask]++;
+    memcpy(part_records + dst * build_size, records + i * build_size, build_size);
+    part_hashes[dst] = hashes[i];
+  }
+  free(records); records = NULL;
+  free(hashes);  hashes = NULL;
+
+  // Step 4: una piccola tabella hash per ogni partizione (linear probing, almeno il doppio degli slot rispetto ai record)
+  for (size_t p = 0; p < num_partitions; p++) {
+    size_t size = starts[p + 1] - starts[p], capacity = 0;
+    if (size > 0) { for (capacity = 2; capacity < 2 * size; capacity <<= 1); }
+    bucket_starts[p + 1] = bucket_starts[p] + capacity;
+  }
+
+  buckets = calloc(bucket_starts[num_partitions] + 1, sizeof(uint32_t));
+  if (!buckets) {
+    printf("Errore: malloc fallita per la JOIN\n");
+    goto cleanup;
+  }
+
+  for (size_t p = 0; p < num_partitions; p++) {
+    uint32_t *slots = buckets + bucket_starts[p];
+    size_t capacity = bucket_starts[p + 1] - bucket_starts[p];
+
+    for (size_t j = starts[p]; j < starts[p + 1]; j++) {
+      size_t slot = (part_hashes[j] >> bits) & (capacity - 1);
+      while (slots[slot] != 0) { slot = (slot + 1) & (capacity - 1); }
+      slots[slot] = (uint32_t)(j - starts[p] + 1);                        // Indice nella partizione + 1, 0 = slot vuoto
+    }
+  }
+
+  // Step 5: scansiono il lato di probe a batch; ogni batch viene raggruppato per partizione prima di cercare le chiavi
+  while (!ctx->done && (count = read_scan_batch(probe)) > 0) {
+    size_t m = 0;
+
+    for (size_t r = 0; r < count; r++) {
+      const char *key;
+      size_t len = get_join_key(ctx, probe_side, probe->buffer + r * probe->record_size, &key);
+      if (len == 0) { continue; }
+
+      probe_hashes[m] = (uint32_t)hash_bytes(key, len, level);
+      probe_rows[m++] = (uint32_t)r;
+    }
+
+    memset(cursor, 0, (num_partitions + 1) * sizeof(size_t));
+    for (size_t i = 0; i < m; i++) { cursor[(probe_hashes[i] & mask) + 1]++; }
+    for (size_t p = 0; p < num_partitions; p++) { cursor[p + 1] += cursor[p]; }
+    for (size_t i = 0; i < m; i++) { probe_order[cursor[probe_hashes[i] & mask]++] = (uint32_t)i; }
+
+    size_t first = 0;                                                     // Dopo lo scatter, cursor[p] è la fine della partizione p
+    for (size_t p = 0; p < num_partitions && !ctx->done; first = cursor[p], p++) {
+      const uint32_t *slots = buckets + bucket_starts[p];
+      size_t capacity = bucket_starts[p + 1] - bucket_starts[p];
+      if (capacity == 0) { continue; }
+
+      for (size_t k = first; k < cursor[p] && !ctx->done; k++) {
+        uint32_t i = probe_order[k];
+        uint32_t hash = probe_hashes[i];
+        const char *probe_record = probe->buffer + probe_rows[i] * probe->record_size;
+        const char *probe_key;
+        size_t probe_len = get_join_key(ctx, probe_side, probe_record, &probe_key);
+
+        for (size_t slot = (hash >> bits) & (capacity - 1); slots[slot] != 0 && !ctx->done; slot = (slot + 1) & (capacity - 1)) {
+          size_t j = starts[p] + slots[slot] - 1;
+          if (part_hashes[j] != hash) { continue; }
+
+          const char *build_record = part_records + j * build_size;
+          const char *build_key;
+          size_t build_len = get_join_key(ctx, build_side, build_record, &build_key);
+          if (build_len != probe_len || memcmp(build_key, probe_key, build_len) != SUCCESS) { continue; }
+
+          if (build_side == 0) { emit_joined(ctx, build_record, probe_record); }
+          else                 { emit_joined(ctx, probe_record, build_record); }
+        }
+      }
+    }
+  }
+
+  result = SUCCESS;
+
+cleanup:
+  close_table_scan(&scans[0]);
+  close_table_scan(&scans[1]);
+  free(records);
+  free(hashes);
+  free(part_records);
+  free(part_hashes);
+  free(starts);
+  free(bucket_starts);
+  free(cursor);
+  free(buckets);
+  free(probe_hashes);
+  free(probe_rows);
+  free(probe_order);
+  return result;
+}
+
+
+/**
+ * Funzione che esegue la JOIN cercando i record di una tabella direttamente per id.
+ * Si scansiona solo l'altra tabella: per ogni suo record si trova la posizione dell'id cercato e si legge quel record.
+ *
+ * @param id_side La tabella la cui colonna di join è l'id
+ * @return SUCCESS se la JOIN è stata completata, FAILURE altrimenti
+ */
+static int run_id_join(JoinContext *ctx, int id_side) {
+  int other_side = 1 - id_side;
+  TableScan id_scan, other_scan;
+
+  if (open_table_scan(ctx->query->tabelle[id_side], &id_scan) != SUCCESS) { return FAILURE; }
+  if (open_table_scan(ctx->query->tabelle[other_side], &other_scan) != SUCCESS) {
+    close_table_scan(&id_scan);
+    return FAILURE;
+  }
+
+  char *id_record = malloc(id_scan.record_size);
+  if (!id_record) {
+    printf("Errore: malloc fallita per la JOIN\n");
+    close_table_scan(&id_scan);
+    close_table_scan(&other_scan);
+    return FAILURE;
+  }
+
+  long total = count_table_records(&id_scan);
+  size_t count;
+
+  while (!ctx->done && (count = read_scan_batch(&other_scan)) > 0) {
+    for (size_t r = 0; r < count && !ctx->done; r++) {
+      const char *record = other_scan.buffer + r * other_scan.record_size;
+      const char *key;
+      if (get_join_key(ctx, other_side, record, &key) == 0) { continue; }
+
+      int id, found_id;
+      memcpy(&id, key, sizeof(int));
+      if (id <= 0) { continue; }
+
+      long position = find_position_after_id(&id_scan, id - 1);           // Il primo record con id > id-1 è quello cercato, se esiste
+      if (position >= total || read_record_at(&id_scan, position, id_record) != SUCCESS) { continue; }
+
+      memcpy(&found_id, id_record + ctx->key_offsets[id_side], sizeof(int));
+      if (found_id != id) { continue; }
+
+      if (id_side == 0) { emit_joined(ctx, id_record, record); }
+      else              { emit_joined(ctx, record, id_record); }
+    }
+  }
+
+  free(id_record);
+  close_table_scan(&id_scan);
+  close_table_scan(&other_scan);
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che ottiene il numero di record di una tabella, -1 in caso di errore.
+ */
+static long count_rows(const char *table_name) {
+  TableScan scan;
+  if (open_table_scan(table_name, &scan) != SUCCESS) { return -1; }
+
+  long rows = count_table_records(&scan);
+  close_table_scan(&scan);
+  return rows;
+}
+
+
+/**
+ * Funzione che verifica se la colonna di join di una tabella è il suo id.
+ */
+static bool is_id_key(const JoinQuery *query, int side) {
+  char id_name[101];
+  snprintf(id_name, sizeof(id_name), "%s.id", query->tabelle[side]);
+  return strcmp(query->layout.colonne[query->key_columns[side]].nome, id_name) == SUCCESS;
+}
+
+
+/**
+ * Funzione che esegue una JoinQuery e stampa i record uniti.
+ * Se la colonna di join della tabella più grande è il suo id, i record vengono cercati per id; altrimenti si usa l'hash join.
+ *
+ * @param query La query da eseguire
+ * @return Il numero di record stampati, -1 in caso di errore
+ */
+long execute_join_query(const JoinQuery *query) {
+  long rows[2] = { count_rows(query->tabelle[0]), count_rows(query->tabelle[1]) };
+  if (rows[0] < 0 || rows[1] < 0) { return -1; }
+
+  JoinContext ctx;
+  memset(&ctx, 0, sizeof(JoinContext));
+  ctx.query = query;
+
+  for (int side = 0; side < 2; side++) {
+    const LayoutColumn *col = &query->layout.colonne[query->key_columns[side]];
+    ctx.key_offsets[side] = col->offset - (side == 0 ? 0 : query->record_sizes[0]);   // Offset nel record della sua tabella
+    ctx.key_lengths[side] = col->tipo.length;
+    ctx.key_kind = col->kind;
+    ctx.null_value = get_null_value(col->tipo);
+  }
+
+  ctx.joined = malloc(query->layout.record_size);
+  if (!ctx.joined) {
+    printf("Errore: malloc fallita per la JOIN\n");
+    return -1;
+  }
+
+  output_title("Tabelle: %s, %s\n", query->tabelle[0], query->tabelle[1]);
+  print_layout_header(&query->layout, &query->projection);
+
+  int id_side = -1;
+  for (int side = 0; side < 2; side++) {
+    if (is_id_key(query, side) && (id_side < 0 || rows[side] > rows[id_side])) { id_side = side; }
+  }
+
+  int result;
+  if (query->limit == 0) {
+    result = SUCCESS;
+  } else if (id_side >= 0 && rows[id_side] >= rows[1 - id_side]) {
+    result = run_id_join(&ctx, id_side);
+  } else {
+    result = run_hash_join(&ctx, NULL, 0);
+  }
+
+  free(ctx.joined);
+  return result == SUCCESS ? ctx.printed : -1;
+}
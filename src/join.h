@@ -0,0 +1,13 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Join
+long execute_join_query(const JoinQuery *query);
+
+
+
+#endif
@@ -0,0 +1,81 @@
+/*
+
+
+  Lexer.c è il file che si occupa di dividere un comando in token.
+  Le funzioni descritte in questo file sono:
+    - tokenize_command: divide il comando in token, in un solo passaggio e senza copiare nulla.
+
+  Come funziona?
+  I token sono separati da spazi (o tab), ma uno spazio tra apici fa parte del token: nome:'Mario Rossi' è un token solo.
+  Dentro gli apici (singoli o doppi) il carattere \ fa entrare nella stringa il carattere successivo, ad esempio nome:'L\'Aquila'.
+  Il lexer non toglie apici e \: decide solo dove finisce ogni token, così chi legge il valore (la conversione di un char,
+  il lexer dei predicati) lo vede esattamente come l'ha scritto l'utente.
+
+  Ogni token è un puntatore dentro la stringa di input: alla fine di ogni token lo spazio viene sostituito da '\0',
+  quindi non c'è nessuna copia. L'array dei token viene preso dall'arena del comando e può contenere tutti i token
+  che servono, senza un numero massimo.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strlen
+
+#include "lexer.h"
+#include "arena.h"
+
+
+/**
+ * Funzione che dice se un carattere separa due token.
+ */
+static bool is_separator(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+
+/**
+ * Funzione che divide un comando in token.
+ * La stringa di input viene modificata: ogni token finisce con '\0' e i puntatori restituiti puntano dentro l'input.
+ *
+ * @param input Il comando
+ * @param token_count Il numero di token trovati
+ * @return L'array dei token (nell'arena del comando), NULL se una stringa tra apici non è terminata
+ */
+char **tokenize_command(char *input, int *token_count) {
+  *token_count = 0;
+
+  size_t length = strlen(input);
+  char **tokens = arena_alloc((length / 2 + 1) * sizeof(char *));  // Ogni token occupa almeno un carattere più il separatore
+  if (!tokens) { return NULL; }
+
+  char *read = input;
+  int count = 0;
+
+  while (*read) {
+    while (is_separator(*read)) { read++; }
+    if (*read == '\0') { break; }
+
+    tokens[count++] = read;
+    char quote = '\0';                                            // L'apice della stringa in cui siamo, '\0' fuori da una stringa
+
+    while (*read && (quote || !is_separator(*read))) {
+      if (quote) {
+        if (*read == '\\' && read[1] != '\0') { read++; }         // Il carattere dopo \ fa parte della stringa, anche se è un apice
+        else if (*read == quote) { quote = '\0'; }
+      } else if (*read == '\'' || *read == '"') {
+        quote = *read;
+      }
+      read++;
+    }
+
+    if (quote) {
+      printf("❌ Errore: stringa non terminata: %s\n", tokens[count - 1]);
+      return NULL;
+    }
+
+    if (*read) { *read++ = '\0'; }                                // Chiudo il token al posto del separatore
+  }
+
+  *token_count = count;
+  return tokens;
+}
@@ -0,0 +1,13 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Lexer
+char **tokenize_command(char *input, int *token_count);
+
+
+
+#endif
@@ -0,0 +1,399 @@
+/*
+
+
+  Load.c è il file che si occupa di caricare un file CSV in una tabella (comando LOAD).
+  Le funzioni descritte in questo file sono:
+    - load_csv_file: converte tutte le righe di un CSV in record e le aggiunge in fondo alla tabella.
+
+  Com'è fatto il CSV?
+  La prima riga è l'intestazione, con i nomi delle colonne della tabella nell'ordine del file (non per forza tutte).
+  Le colonne che mancano restano NULL, e id, created_at e updated_at vengono valorizzati come per un CREATE.
+  Se l'intestazione contiene id, created_at o updated_at (ad esempio un CSV scritto da READ con OUTPUT CSV),
+  quei campi vengono saltati.
+  I campi sono separati da virgole; un campo tra doppi apici può contenere virgole, e "" dentro gli apici è un apice.
+  Un campo vuoto è NULL. Le righe vuote vengono saltate, e ogni riga deve stare su una riga sola.
+
+  Come funziona?
+  Il file viene mappato in memoria (mmap), così non c'è nessuna copia tra il kernel e il programma.
+  Il CSV viene letto a blocchi di LOAD_BATCH_BYTES, sempre tagliati alla fine di una riga, e ogni blocco viene diviso
+  tra più thread, anche loro su confini di riga.
+  1. Ogni thread conta le righe della sua parte: così si sa subito quanti record ci sono e gli id vengono assegnati
+     a intervalli contigui (il thread 0 parte dal prossimo id della tabella, il thread 1 dal primo id dopo quelli del thread 0…).
+  2. Ogni thread converte le sue righe direttamente in un buffer di record, con le funzioni di conversione delle colonne,
+     partendo da un record modello che contiene già i NULL e created_at.
+  3. I buffer vengono scritti nella tabella uno dopo l'altro, con un solo fwrite grande per thread.
+  Se una riga non è valida, la tabella viene riportata alla dimensione che aveva prima del LOAD: o si carica tutto, o niente.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fwrite, fflush
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memchr, memcpy, strcmp
+#include <pthread.h>                // pthread_create, pthread_join
+#include <fcntl.h>                  // open
+#include <unistd.h>                 // close, sysconf, ftruncate, fsync
+#include <sys/mman.h>               // mmap, munmap, madvise
+#include <sys/stat.h>               // fstat
+
+#include "load.h"
+#include "schema.h"
+#include "utils.h"
+
+
+typedef struct {                                // LoadChunk: la parte di un blocco del CSV convertita da un thread
+  const LoadQuery *query;                       // query: il LOAD
+  const int *fields;                            // fields: indice nel layout della colonna di ogni campo del CSV, -1 se va saltato
+  int num_fields;                               // num_fields: campi di ogni riga
+  const char *template_record;                  // template_record: record con i NULL e created_at, da cui parte ogni riga
+  const char *start;                            // start / end: la parte del CSV, sempre su confini di riga
+  const char *end;
+  long first_line;                              // first_line: numero di riga (nel file) della prima riga della parte
+  long num_records;                             // num_records: righe non vuote della parte
+  int first_id;                                 // first_id: id del primo record della parte
+  char *records;                                // records: i record convertiti
+  long error_line;                              // error_line: riga del primo errore, 0 se non ci sono errori
+  char error[256];                              // error: descrizione dell'errore
+} LoadChunk;
+
+
+/**
+ * Funzione che trova la prossima riga non vuota tra pos e end.
+ * Il \r di fine riga (file scritti su Windows) non fa parte della riga.
+ *
+ * @param pos La posizione da cui cercare, viene spostata dopo la riga
+ * @param line_start / line_end La riga trovata
+ * @param lines Contatore delle righe del file, incrementato anche per le righe vuote
+ * @return true se c'è una riga, false se si è arrivati a end
+ */
+static bool next_csv_line(const char **pos, const char *end, const char **line_start, const char **line_end, long *lines) {
+  while (*pos < end) {
+    const char *start = *pos;
+    const char *newline = memchr(start, '\n', (size_t)(end - start));
+    const char *stop = newline ? newline : end;
+
+    *pos = newline ? newline + 1 : end;
+    (*lines)++;
+
+    if (stop > start && stop[-1] == '\r') { stop--; }
+    if (stop == start) { continue; }                               // Riga vuota: la salto
+
+    *line_start = start;
+    *line_end = stop;
+    return true;
+  }
+  return false;
+}
+
+
+/**
+ * Funzione che legge un campo del CSV e lo copia in field, togliendo gli apici.
+ *
+ * @param pos La posizione del campo, viene spostata dopo la virgola (o a end)
+ * @param end La fine della riga
+ * @param field Il buffer del campo, di LOAD_FIELD_SIZE byte
+ * @param quoted Diventa true se il campo era tra apici (un campo "" tra apici è una stringa vuota, non NULL)
+ * @param more Diventa true se dopo il campo c'è una virgola, quindi un altro campo
+ * @return SUCCESS se il campo è valido, FAILURE altrimenti
+ */
+static int read_csv_field(const char **pos, const char *end, char *field, bool *quoted, bool *more) {
+  const char *p = *pos;
+  size_t length = 0;
+  *quoted = p < end && *p == '"';
+
+  if (*quoted) {
+    p++;
+    while (true) {
+      if (p >= end) { return FAILURE; }                           // Apice non chiuso
+      if (*p == '"') {
+        if (p + 1 < end && p[1] == '"') { p++; }                  // "" dentro gli apici è un apice
+        else { p++; break; }
+      }
+      if (length >= LOAD_FIELD_SIZE - 1) { return FAILURE; }
+      field[length++] = *p++;
+    }
+    if (p < end && *p != ',') { return FAILURE; }                 // Dopo l'apice di chiusura ci deve essere una virgola
+  } else {
+    const char *comma = memchr(p, ',', (size_t)(end - p));
+    const char *stop = comma ? comma : end;
+    length = (size_t)(stop - p);
+    if (length >= LOAD_FIELD_SIZE) { return FAILURE; }
+    memcpy(field, p, length);
+    p = stop;
+  }
+
+  field[length] = '\0';
+  *more = p < end;                                                // Se non sono alla fine della riga, sono su una virgola
+  *pos = *more ? p + 1 : end;                                     // Salto la virgola
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione eseguita da ogni thread: converte le righe della sua parte nel suo buffer di record.
+ */
+static void *convert_csv_chunk(void *arg) {
+  LoadChunk *chunk = arg;
+  const RecordLayout *layout = &chunk->query->layout;
+  size_t record_size = layout->record_size;
+
+  char field[LOAD_FIELD_SIZE];
+  const char *pos = chunk->start;
+  const char *line_start, *line_end;
+  long line = chunk->first_line - 1;
+  long r = 0;
+
+  while (next_csv_line(&pos, chunk->end, &line_start, &line_end, &line)) {
+    char *record = chunk->records + r * record_size;
+    memcpy(record, chunk->template_record, record_size);
+
+    int id = chunk->first_id + (int)r;
+    memcpy(record, &id, sizeof(int));                             // L'id è sempre il primo campo del record
+
+    const char *p = line_start;
+    bool more = true;
+    for (int f = 0; f < chunk->num_fields; f++) {
+      bool quoted;
+      if (!more) {
+        snprintf(chunk->error, sizeof(chunk->error), "mancano dei campi dal campo %d", f + 1);
+        chunk->error_line = line;
+        return NULL;
+      }
+      if (read_csv_field(&p, line_end, field, &quoted, &more) != SUCCESS) {
+        snprintf(chunk->error, sizeof(chunk->error), "il campo %d non è valido", f + 1);
+        chunk->error_line = line;
+        return NULL;
+      }
+      if (field[0] == '\0' && !quoted) { continue; }              // Campo vuoto: resta NULL
+      if (chunk->fields[f] < 0) { continue; }                     // Colonna automatica: la valorizza il LOAD
+
+      const LayoutColumn *col = &layout->colonne[chunk->fields[f]];
+      if (!convert_column_value(col, field, record + col->offset)) {
+        snprintf(chunk->error, sizeof(chunk->error), "il valore '%.60s' non è valido per il campo %s", field, col->nome);
+        chunk->error_line = line;
+        return NULL;
+      }
+    }
+
+    if (more) {
+      snprintf(chunk->error, sizeof(chunk->error), "la riga ha più di %d campi", chunk->num_fields);
+      chunk->error_line = line;
+      return NULL;
+    }
+    r++;
+  }
+
+  return NULL;
+}
+
+
+/**
+ * Funzione che legge l'intestazione del CSV e trova la colonna di ogni campo (-1 per id, created_at e updated_at, che vengono saltati).
+ * @return Il numero di campi, -1 se l'intestazione non è valida
+ */
+static int parse_csv_header(const LoadQuery *query, const char *start, const char *end, int fields[MAX_FIELDS]) {
+  bool assigned[MAX_LAYOUT_COLUMNS] = { false };
+  char field[LOAD_FIELD_SIZE];
+  const char *p = start;
+  int count = 0;
+  bool more = true;
+
+  while (more) {
+    bool quoted;
+    if (read_csv_field(&p, end, field, &quoted, &more) != SUCCESS) {
+      printf("❌ Errore: l'intestazione del CSV non è valida\n");
+      return -1;
+    }
+
+    int index = get_layout_column_index(&query->layout, field);
+    if (index < 0) {
+      printf("❌ Errore: la colonna '%s' del CSV non esiste nella tabella %s\n", field, query->nome_tabella);
+      return -1;
+    }
+    if (assigned[index] || count >= MAX_FIELDS) {
+      printf("❌ Errore: la colonna '%s' è indicata più volte nell'intestazione\n", field);
+      return -1;
+    }
+
+    assigned[index] = true;
+    bool automatic = index == 0 || index == query->created_at_column || strcmp(field, "updated_at") == SUCCESS;   // L'id è sempre la colonna 0
+    fields[count++] = automatic ? -1 : index;
+  }
+
+  if (count == 0) { printf("❌ Errore: l'intestazione del CSV è vuota\n"); }
+  return count > 0 ? count : -1;
+}
+
+
+/**
+ * Funzione che sposta end alla fine della riga in cui cade (o lo lascia a limit).
+ */
+static const char *align_to_line(const char *end, const char *limit) {
+  if (end >= limit) { return limit; }
+  const char *newline = memchr(end, '\n', (size_t)(limit - end));
+  return newline ? newline + 1 : limit;
+}
+
+
+/**
+ * Funzione che converte e scrive un blocco del CSV, dividendolo tra i thread.
+ * @return Il numero di record scritti, -1 in caso di errore
+ */
+static long load_csv_batch(const LoadQuery *query, const int *fields, int num_fields, const char *template_record,
+                           const char *start, const char *end, long first_line, int *next_id, FILE *table) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = (int)((end - start) / LOAD_MIN_THREAD_BYTES) + 1;
+  if (threads > cpus) { threads = (int)cpus; }
+  if (threads > LOAD_MAX_THREADS) { threads = LOAD_MAX_THREADS; }
+  if (threads < 1) { threads = 1; }
+
+  LoadChunk chunks[LOAD_MAX_THREADS];
+  memset(chunks, 0, sizeof(chunks));
+  size_t step = (size_t)(end - start) / (size_t)threads;
+  const char *pos = start;
+  long line = first_line;
+
+  for (int t = 0; t < threads; t++) {                             // Divido il blocco su confini di riga e conto le righe di ogni parte
+    LoadChunk *chunk = &chunks[t];
+    chunk->query = query;
+    chunk->fields = fields;
+    chunk->num_fields = num_fields;
+    chunk->template_record = template_record;
+    chunk->start = pos;
+    chunk->end = t == threads - 1 ? end : align_to_line(pos + step, end);
+    chunk->first_line = line;
+    chunk->first_id = *next_id;
+
+    const char *scan = chunk->start, *line_start, *line_end;
+    while (next_csv_line(&scan, chunk->end, &line_start, &line_end, &line)) { chunk->num_records++; }
+
+    chunk->records = malloc((size_t)chunk->num_records * query->layout.record_size + 1);
+    if (!chunk->records) {
+      printf("Errore: malloc fallita per il caricamento\n");
+      for (int i = 0; i <= t; i++) { free(chunks[i].records); }
+      return -1;
+    }
+
+    *next_id += (int)chunk->num_records;                          // Gli id di ogni parte sono un intervallo contiguo
+    pos = chunk->end;
+  }
+
+  pthread_t ids[LOAD_MAX_THREADS];
+  int started = 0;
+  for (int t = 1; t < threads; t++) {                             // La parte 0 la converte questo thread
+    if (pthread_create(&ids[t], NULL, convert_csv_chunk, &chunks[t]) != 0) { break; }
+    started = t;
+  }
+  convert_csv_chunk(&chunks[0]);
+  for (int t = started + 1; t < threads; t++) { convert_csv_chunk(&chunks[t]); }   // Thread non partiti: li converto qui
+  for (int t = 1; t <= started; t++) { pthread_join(ids[t], NULL); }
+
+  long written = 0;
+  for (int t = 0; t < threads; t++) {
+    LoadChunk *chunk = &chunks[t];
+    if (written >= 0 && chunk->error_line > 0) {
+      printf("❌ Errore alla riga %ld del CSV: %s\n", chunk->error_line, chunk->error);
+      written = -1;
+    }
+    if (written >= 0 && chunk->num_records > 0 && fwrite(chunk->records, query->layout.record_size, (size_t)chunk->num_records, table) != (size_t)chunk->num_records) {
+      printf("❌ Errore: impossibile scrivere nella tabella %s\n", query->nome_tabella);
+      written = -1;
+    }
+    if (written >= 0) { written += chunk->num_records; }
+    free(chunk->records);
+  }
+
+  return written;
+}
+
+
+/**
+ * Funzione che carica un file CSV in fondo a una tabella.
+ * Se qualcosa va storto la tabella torna com'era prima.
+ *
+ * @param query Il LOAD da eseguire
+ * @return Il numero di record caricati, -1 in caso di errore
+ */
+long load_csv_file(const LoadQuery *query) {
+  int fd = open(query->path, O_RDONLY);
+  if (fd < 0) {
+    printf("❌ Errore: impossibile aprire il file %s\n", query->path);
+    return -1;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    printf("❌ Errore: il file %s è vuoto\n", query->path);
+    close(fd);
+    return -1;
+  }
+
+  const char *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);                                                      // La mappatura resta valida anche dopo aver chiuso il file
+  if (data == MAP_FAILED) {
+    printf("❌ Errore: impossibile leggere il file %s\n", query->path);
+    return -1;
+  }
+  madvise((void *)data, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+  const char *end = data + info.st_size;
+  const char *pos = data;
+  const char *header_start, *header_end;
+  long line = 0;
+  int fields[MAX_FIELDS];
+  int num_fields = -1;
+
+  if (next_csv_line(&pos, end, &header_start, &header_end, &line)) {
+    num_fields = parse_csv_header(query, header_start, header_end, fields);
+  } else {
+    printf("❌ Errore: il file %s non contiene l'intestazione\n", query->path);
+  }
+
+  char *template_record = get_table_record_buffer(query->nome_tabella);
+  FILE *table = num_fields > 0 && template_record ? open_table_file(query->nome_tabella, "a+b") : NULL;
+  if (!table) {
+    munmap((void *)data, (size_t)info.st_size);
+    return -1;
+  }
+
+  for (int c = 0; c < query->layout.num_colonne; c++) {           // Record modello: tutti NULL, created_at uguale per tutto il LOAD
+    const LayoutColumn *col = &query->layout.colonne[c];
+    memcpy(template_record + col->offset, get_null_value(col->tipo), col->tipo.length);
+  }
+  long timestamp = get_current_timestamp();
+  if (query->created_at_column >= 0) {
+    memcpy(template_record + query->layout.colonne[query->created_at_column].offset, &timestamp, sizeof(long));
+  }
+
+  fseek(table, 0, SEEK_END);
+  long original_size = ftell(table);
+  int next_id = read_next_id(table, original_size, query->layout.record_size);
+  fseek(table, 0, SEEK_END);
+
+  long total = 0;
+  while (pos < end && total >= 0) {
+    const char *batch_end = align_to_line(pos + (end - pos > LOAD_BATCH_BYTES ? LOAD_BATCH_BYTES : end - pos), end);
+    long first_line = line + 1;
+
+    for (const char *p = pos; p < batch_end && (p = memchr(p, '\n', (size_t)(batch_end - p))) != NULL; p++) { line++; }
+    if (batch_end == end && end[-1] != '\n') { line++; }          // Ultima riga senza \n finale
+
+    long written = load_csv_batch(query, fields, num_fields, template_record, pos, batch_end, first_line, &next_id, table);
+    total = written < 0 ? -1 : total + written;
+    pos = batch_end;
+  }
+
+  if (total >= 0 && (fflush(table) != 0 || fsync(fileno(table)) != 0)) {   // LOAD non passa dal log (vedi wal.c): un solo fsync alla fine
+    printf("❌ Errore: impossibile rendere durevole la tabella %s\n", query->nome_tabella);
+    total = -1;
+  }
+
+  if (total < 0) {                                                // Qualcosa è andato storto: riporto la tabella a prima del LOAD
+    fflush(table);
+    if (ftruncate(fileno(table), original_size) != 0) { printf("❌ Errore: impossibile ripristinare la tabella %s\n", query->nome_tabella); }
+  }
+
+  fclose(table);
+  munmap((void *)data, (size_t)info.st_size);
+  return total;
+}
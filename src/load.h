@@ -0,0 +1,13 @@
+#ifndef LOAD_H
+#define LOAD_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Load
+long load_csv_file(const LoadQuery *query);
+
+
+
+#endif
@@ -0,0 +1,669 @@
+/*
+
+
+  Materialize.c è il file che si occupa delle aggregazioni materializzate (comando MATERIALIZE).
+  Le funzioni descritte in questo file sono:
+    - find_materialized_view:       cerca un'aggregazione materializzata per nome.
+    - add_materialized_view:        aggiunge un'aggregazione materializzata all'elenco in VIEWS_FILE.
+    - load_view_query:              rivalida la definizione di un'aggregazione materializzata e ne prepara la query.
+    - refresh_materialized_view:    ricalcola da capo un'aggregazione materializzata leggendo tutta la tabella.
+    - begin_view_changes:           prepara l'aggiornamento delle viste di una tabella, caricandole in memoria una volta sola.
+    - add_view_change:              aggiunge alle viste un record aggiunto o tolto dalla tabella.
+    - commit_view_changes:          scrive le viste aggiornate, dopo che la tabella è stata scritta.
+    - discard_view_changes:         butta l'aggiornamento preparato.
+    - maintain_materialized_views:  aggiorna le aggregazioni materializzate di una tabella quando un suo record cambia.
+    - maintain_materialized_views_batch: come maintain_materialized_views, per tanti record scritti insieme.
+    - refresh_table_views:          ricalcola da capo tutte le aggregazioni materializzate di una tabella.
+    - print_materialized_view:      stampa i gruppi di un'aggregazione materializzata.
+
+  Cos'è un'aggregazione materializzata?
+  È il risultato di un AGGREGATE … GROUP BY …, salvato in un file come una piccola tabella (tables/<V>.view)
+  e aggiornato a ogni modifica della tabella aggregata, invece di essere ricalcolato a ogni lettura.
+  Leggerla costa quanto i suoi gruppi, non quanto i record della tabella.
+
+  Come viene salvata?
+  L'elenco delle aggregazioni materializzate (nome, tabella, comando AGGREGATE) sta in VIEWS_FILE, accanto allo schema.
+  Il comando viene salvato come testo e rivalidato ogni volta che serve, perchè la query compilata contiene dei puntatori
+  (le funzioni di conversione) che non possono essere scritti su file.
+  Il file tables/<V>.view contiene un ViewHeader seguito dai gruppi, tutti della stessa dimensione:
+    [ chiave del gruppo | record del gruppo (long long) | stato di ogni aggregazione ]
+  La chiave è la concatenazione dei valori delle colonne di GROUP BY, a dimensione fissa (le colonne char sono
+  completate con zeri), così un gruppo si aggiorna sovrascrivendolo al suo posto nel file.
+
+  Come viene aggiornata?
+  Un comando che cambia la tabella apre un ViewChanges (begin_view_changes): per ogni vista della tabella il comando
+  AGGREGATE viene validato una volta sola e i gruppi del file vengono caricati in memoria, con una tabella hash sulla chiave.
+  Poi, per ogni record aggiunto (sign = 1) o tolto (sign = -1) dalla tabella (un UPDATE è un -1 e un 1):
+    ✅ se il record non soddisfa il filtro WHERE della vista, non cambia nulla;
+    ✅ altrimenti si cerca il suo gruppo nella tabella hash e si aggiunge (merge_aggregate_state) o si toglie
+       (subtract_aggregate_state) lo stato calcolato sul solo record.
+  Alla fine (commit_view_changes) vengono scritti solo i gruppi cambiati, al loro posto, e quelli nuovi in fondo;
+  se un gruppo è rimasto senza record il file viene riscritto tutto senza di lui.
+  COUNT, SUM e AVG si aggiornano sempre così. MIN e MAX non si possono aggiornare quando si toglie proprio l'estremo:
+  in quel caso (e solo in quello) la vista viene ricalcolata da capo. Per questo le funzioni approssimate, che non si possono
+  mai sottrarre, e SAMPLE non sono ammessi in una vista.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fread, fwrite, fseek, rename
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, realloc, calloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memcmp, strnlen, strtok_r
+#include <stdint.h>                 // uint32_t
+#include <unistd.h>                 // access, ftruncate
+
+#include "materialize.h"
+#include "aggregate.h"
+#include "predicate.h"
+#include "scan.h"
+#include "planner.h"
+#include "utils.h"
+#include "schema.h"
+#include "arena.h"
+#include "lexer.h"
+#include "cache.h"
+#include "output.h"
+#include "commands/aggregate.h"
+#include "commands/read.h"
+
+
+/**
+ * Funzione che costruisce il percorso del file di una vista: tables/<V>.view
+ */
+static void get_view_path(const char *name, const char *suffix, char *path, size_t size) {
+  snprintf(path, size, "%s/%s.view%s", TABLES_DIR, name, suffix);
+}
+
+
+/**
+ * Funzione che legge l'elenco delle aggregazioni materializzate da VIEWS_FILE.
+ * @return Il numero di viste lette (0 se il file non esiste ancora)
+ */
+static int load_views(MaterializedView views[MAX_VIEWS]) {
+  FILE *file = fopen(VIEWS_FILE, "rb");
+  if (!file) { return 0; }
+
+  int count = (int)fread(views, sizeof(MaterializedView), MAX_VIEWS, file);
+  fclose(file);
+  return count;
+}
+
+
+/**
+ * Funzione che cerca un'aggregazione materializzata per nome.
+ * @return SUCCESS se la vista esiste (e viene copiata in view, se non è NULL), FAILURE altrimenti
+ */
+int find_materialized_view(const char *name, MaterializedView *view) {
+  MaterializedView views[MAX_VIEWS];
+  int count = load_views(views);
+
+  for (int i = 0; i < count; i++) {
+    if (strcmp(views[i].nome, name) != SUCCESS) { continue; }
+    if (view) { *view = views[i]; }
+    return SUCCESS;
+  }
+  return FAILURE;
+}
+
+
+/**
+ * Funzione che aggiunge un'aggregazione materializzata in fondo a VIEWS_FILE.
+ * @return SUCCESS se la vista è stata salvata, FAILURE altrimenti
+ */
+int add_materialized_view(const MaterializedView *view) {
+  MaterializedView views[MAX_VIEWS];
+  if (load_views(views) >= MAX_VIEWS) {
+    printf("❌ Errore: troppe aggregazioni materializzate (massimo %d)\n", MAX_VIEWS);
+    return FAILURE;
+  }
+
+  FILE *file = fopen(VIEWS_FILE, "ab");
+  if (!file) {
+    printf("❌ Errore: impossibile scrivere il file %s\n", VIEWS_FILE);
+    return FAILURE;
+  }
+
+  size_t written = fwrite(view, sizeof(MaterializedView), 1, file);
+  fclose(file);
+  bump_schema_version();                                          // READ <NomeVista> ora legge la vista, non più una tabella
+  return written == 1 ? SUCCESS : FAILURE;
+}
+
+
+/**
+ * Funzione che rivalida il comando AGGREGATE di una vista e ne prepara la query.
+ * Il comando viene diviso in token con lo stesso lexer del parser, su una copia (il lexer modifica la stringa).
+ */
+int load_view_query(const MaterializedView *view, AggregateQuery *query) {
+  char definition[MAX_INPUT_SIZE];
+  strncpy(definition, view->definizione, sizeof(definition) - 1);
+  definition[sizeof(definition) - 1] = '\0';
+
+  int token_count = 0;
+  char **tokens = tokenize_command(definition, &token_count);
+
+  if (!tokens || token_count == 0 || !validate_aggregate(tokens, token_count, query)) {
+    printf("❌ Errore: la definizione della vista '%s' non è più valida\n", view->nome);
+    return FAILURE;
+  }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che calcola come sono disposti i gruppi di una vista.
+ */
+static void get_view_format(const AggregateQuery *query, ViewFormat *format) {
+  size_t key_size = 0;
+  for (int i = 0; i < query->group_by.num_colonne; i++) { key_size += query->layout.colonne[query->group_by.colonne[i]].tipo.length; }
+
+  format->key_size = (key_size + 7) & ~(size_t)7;
+  format->entry_size = format->key_size + sizeof(long long);
+  for (int i = 0; i < query->num_specs; i++) {
+    format->spec_offsets[i] = format->entry_size;
+    format->entry_size += aggregate_state_size(&query->layout, &query->specs[i]);
+  }
+}
+
+
+/**
+ * Funzione che costruisce la chiave di un gruppo: i valori delle colonne di GROUP BY uno dopo l'altro.
+ * Le colonne char vengono copiate fino al terminatore e completate con zeri, così due valori uguali hanno la stessa chiave.
+ */
+static void build_view_key(const AggregateQuery *query, const ViewFormat *format, const char *record, char *key) {
+  memset(key, 0, format->key_size);
+  size_t pos = 0;
+
+  for (int i = 0; i < query->group_by.num_colonne; i++) {
+    const LayoutColumn *col = &query->layout.colonne[query->group_by.colonne[i]];
+    size_t length = col->kind == KIND_CHAR ? strnlen(record + col->offset, col->tipo.length) : (size_t)col->tipo.length;
+    memcpy(key + pos, record + col->offset, length);
+    pos += col->tipo.length;
+  }
+}
+
+
+/**
+ * Funzione che prepara un gruppo vuoto con la sua chiave.
+ */
+static void init_view_entry(const AggregateQuery *query, const ViewFormat *format, const char *key, char *entry) {
+  memcpy(entry, key, format->key_size);
+  memset(entry + format->key_size, 0, sizeof(long long));
+  for (int i = 0; i < query->num_specs; i++) {
+    init_aggregate_state(&query->specs[i], (AggregateState *)(entry + format->spec_offsets[i]));
+  }
+}
+
+
+/**
+ * Funzione che aggiunge un record a un gruppo.
+ */
+static void accumulate_view_entry(const AggregateQuery *query, const ViewFormat *format, char *entry, const char *record) {
+  long long *rows = (long long *)(entry + format->key_size);
+  (*rows)++;
+  for (int i = 0; i < query->num_specs; i++) {
+    accumulate_batch(&query->layout, &query->specs[i], (AggregateState *)(entry + format->spec_offsets[i]), record, query->layout.record_size, NULL, 1);
+  }
+}
+
+
+/**
+ * Funzione che scrive tutti i gruppi di una vista nel suo file.
+ * Si scrive prima un file temporaneo e poi lo si rinomina, così una scrittura interrotta non lascia una vista a metà.
+ */
+static int write_view_file(const char *name, const char *entries, long num_groups, size_t entry_size) {
+  char path[256], tmp_path[256];
+  get_view_path(name, "", path, sizeof(path));
+  get_view_path(name, ".tmp", tmp_path, sizeof(tmp_path));
+
+  FILE *file = fopen(tmp_path, "wb");
+  if (!file) {
+    printf("❌ Errore: impossibile scrivere il file %s\n", tmp_path);
+    return FAILURE;
+  }
+
+  ViewHeader header = { VIEW_VERSION, num_groups, entry_size };
+  bool ok = fwrite(&header, sizeof(ViewHeader), 1, file) == 1 &&
+            (num_groups == 0 || fwrite(entries, entry_size, (size_t)num_groups, file) == (size_t)num_groups);
+  ok = fclose(file) == 0 && ok;
+
+  if (!ok || rename(tmp_path, path) != 0) {
+    printf("❌ Errore: impossibile scrivere il file %s\n", path);
+    remove(tmp_path);
+    return FAILURE;
+  }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che libera i gruppi di una vista.
+ */
+static void free_view_groups(ViewGroups *groups) {
+  free(groups->entries);
+  free(groups->dirty);
+  free(groups->slots);
+  free(groups->key);
+  free(groups->delta);
+  free(groups);
+}
+
+
+/**
+ * Funzione che prepara i gruppi di una vista: valida il suo comando AGGREGATE una volta sola,
+ * per tutti i record di un comando, e alloca lo spazio per la chiave e lo stato di un record.
+ *
+ * @return I gruppi (vuoti), da liberare con free_view_groups; NULL se la definizione non è valida
+ */
+static ViewGroups *new_view_groups(const MaterializedView *view) {
+  ViewGroups *groups = calloc(1, sizeof(ViewGroups));
+  if (!groups) {
+    printf("Errore: malloc fallita per la vista\n");
+    return NULL;
+  }
+
+  groups->view = *view;
+  if (load_view_query(view, &groups->query) != SUCCESS) {
+    free(groups);
+    return NULL;
+  }
+  get_view_format(&groups->query, &groups->format);
+
+  groups->key = malloc(groups->format.key_size + 1);
+  groups->delta = malloc(groups->format.entry_size);
+  if (!groups->key || !groups->delta) {
+    printf("Errore: malloc fallita per la vista\n");
+    free_view_groups(groups);
+    return NULL;
+  }
+  return groups;
+}
+
+
+/**
+ * Funzione che cerca il gruppo di una chiave con la tabella hash ad indirizzamento aperto, come in groupby.c.
+ * Se il gruppo non c'è e create è true, viene aggiunto in fondo, vuoto.
+ *
+ * @return Il gruppo, NULL se non c'è (o se la memoria è finita)
+ */
+static char *find_view_group(ViewGroups *groups, const char *key, bool create) {
+  const ViewFormat *format = &groups->format;
+
+  if (2 * (groups->num_groups + 1) > groups->num_slots) {         // Tabella hash piena per metà: la raddoppio e reinserisco i gruppi
+    size_t new_slots = groups->num_slots ? groups->num_slots * 2 : 1024;
+    uint32_t *grown = calloc(new_slots, sizeof(uint32_t));
+    if (!grown) { printf("Errore: malloc fallita per la vista\n"); return NULL; }
+
+    for (size_t g = 0; g < groups->num_groups; g++) {
+      size_t s = hash_bytes(groups->entries + g * format->entry_size, format->key_size, 0) & (new_slots - 1);
+      while (grown[s]) { s = (s + 1) & (new_slots - 1); }
+      grown[s] = (uint32_t)(g + 1);
+    }
+    free(groups->slots);
+    groups->slots = grown;
+    groups->num_slots = new_slots;
+  }
+
+  size_t s = hash_bytes(key, format->key_size, 0) & (groups->num_slots - 1);
+  while (groups->slots[s] && memcmp(groups->entries + (groups->slots[s] - 1) * format->entry_size, key, format->key_size) != 0) {
+    s = (s + 1) & (groups->num_slots - 1);
+  }
+  if (groups->slots[s]) { return groups->entries + (groups->slots[s] - 1) * format->entry_size; }
+  if (!create) { return NULL; }
+
+  if (groups->num_groups == groups->capacity) {                   // Gruppo nuovo
+    size_t new_capacity = groups->capacity ? groups->capacity * 2 : 64;
+    char *grown = realloc(groups->entries, new_capacity * format->entry_size);
+    bool *grown_dirty = grown ? realloc(groups->dirty, new_capacity * sizeof(bool)) : NULL;
+    if (grown) { groups->entries = grown; }
+    if (!grown_dirty) { printf("Errore: malloc fallita per la vista\n"); return NULL; }
+    groups->dirty = grown_dirty;
+    groups->capacity = new_capacity;
+  }
+
+  char *entry = groups->entries + groups->num_groups * format->entry_size;
+  init_view_entry(&groups->query, format, key, entry);
+  groups->dirty[groups->num_groups] = true;
+  groups->slots[s] = (uint32_t)(++groups->num_groups);
+  return entry;
+}
+
+
+/**
+ * Funzione che carica in memoria i gruppi salvati nel file di una vista, indicizzandoli per chiave.
+ * @return SUCCESS se il file è valido, FAILURE altrimenti
+ */
+static int load_view_groups(ViewGroups *groups) {
+  const ViewFormat *format = &groups->format;
+  char path[256];
+  get_view_path(groups->view.nome, "", path, sizeof(path));
+
+  FILE *file = fopen(path, "rb");
+  if (!file) { return FAILURE; }
+
+  ViewHeader header;
+  int result = FAILURE;
+  if (fread(&header, sizeof(ViewHeader), 1, file) != 1 || header.version != VIEW_VERSION || header.entry_size != format->entry_size) { goto cleanup; }
+
+  for (long g = 0; g < header.num_groups; g++) {
+    if (fread(groups->delta, format->entry_size, 1, file) != 1) { goto cleanup; }
+
+    char *entry = find_view_group(groups, groups->delta, true);
+    if (!entry) { goto cleanup; }
+    memcpy(entry, groups->delta, format->entry_size);
+  }
+
+  memset(groups->dirty, 0, groups->num_groups * sizeof(bool));
+  groups->file_groups = groups->num_groups;
+  result = SUCCESS;
+
+cleanup:
+  fclose(file);
+  return result;
+}
+
+
+/**
+ * Funzione che aggiunge (sign = 1) o toglie (sign = -1) un record dai gruppi di una vista, in memoria.
+ * Se la vista non si può aggiornare così (il record toglie il minimo o il massimo, o il suo gruppo non c'è),
+ * viene segnata da ricalcolare e i record successivi vengono ignorati.
+ */
+static void apply_view_change(ViewGroups *groups, const char *record, int sign) {
+  const AggregateQuery *query = &groups->query;
+  const ViewFormat *format = &groups->format;
+  if (groups->stale) { return; }
+  if (query->predicate.root >= 0 && !evaluate_predicate(&query->predicate, record)) { return; }
+
+  build_view_key(query, format, record, groups->key);
+  char *entry = find_view_group(groups, groups->key, sign > 0);
+  if (!entry) {                                                   // Record tolto da un gruppo che non c'è: la vista non è allineata
+    groups->stale = true;
+    return;
+  }
+  groups->dirty[(size_t)(entry - groups->entries) / format->entry_size] = true;
+
+  init_view_entry(query, format, groups->key, groups->delta);     // Lo stato del solo record, da aggiungere o togliere
+  accumulate_view_entry(query, format, groups->delta, record);
+
+  long long rows;
+  memcpy(&rows, entry + format->key_size, sizeof(long long));
+  rows += sign;
+  memcpy(entry + format->key_size, &rows, sizeof(long long));
+
+  for (int i = 0; i < query->num_specs; i++) {
+    AggregateState *state = (AggregateState *)(entry + format->spec_offsets[i]);
+    const AggregateState *change = (const AggregateState *)(groups->delta + format->spec_offsets[i]);
+
+    if (sign > 0) { merge_aggregate_state(&query->layout, &query->specs[i], state, change); }
+    else if (subtract_aggregate_state(&query->layout, &query->specs[i], state, change) != SUCCESS) { groups->stale = true; return; }
+  }
+
+  if (rows <= 0) { init_view_entry(query, format, groups->key, entry); }   // Gruppo vuoto: resta nell'indice, ma non viene salvato
+}
+
+
+/**
+ * Funzione che salva i gruppi di una vista nel suo file.
+ * Di solito si sovrascrivono solo i gruppi cambiati, al loro posto, e si aggiungono in fondo quelli nuovi.
+ * Se un gruppo è rimasto senza record, il file viene riscritto tutto senza i gruppi vuoti (vedi write_view_file).
+ *
+ * @return SUCCESS se la vista è stata salvata, FAILURE altrimenti
+ */
+static int save_view_groups(ViewGroups *groups) {
+  const ViewFormat *format = &groups->format;
+  size_t kept = 0;
+
+  for (size_t g = 0; g < groups->num_groups; g++) {               // Tolgo i gruppi vuoti, tenendo l'ordine degli altri
+    char *entry = groups->entries + g * format->entry_size;
+    long long rows;
+    memcpy(&rows, entry + format->key_size, sizeof(long long));
+    if (rows <= 0) { continue; }
+
+    if (kept != g) { memmove(groups->entries + kept * format->entry_size, entry, format->entry_size); }
+    groups->dirty[kept] = groups->dirty[g] || kept != g;
+    kept++;
+  }
+
+  if (kept < groups->num_groups || groups->file_groups == 0) {
+    groups->num_groups = kept;
+    return write_view_file(groups->view.nome, groups->entries, (long)kept, format->entry_size);
+  }
+
+  char path[256];
+  get_view_path(groups->view.nome, "", path, sizeof(path));
+  FILE *file = fopen(path, "r+b");
+  if (!file) { return FAILURE; }
+
+  ViewHeader header = { VIEW_VERSION, (long)groups->num_groups, format->entry_size };
+  bool ok = fwrite(&header, sizeof(ViewHeader), 1, file) == 1;
+  for (size_t g = 0; ok && g < groups->num_groups; g++) {
+    if (!groups->dirty[g]) { continue; }
+    ok = fseek(file, (long)sizeof(ViewHeader) + (long)(g * format->entry_size), SEEK_SET) == 0 &&
+         fwrite(groups->entries + g * format->entry_size, format->entry_size, 1, file) == 1;
+  }
+  ok = fclose(file) == 0 && ok;
+  return ok ? SUCCESS : FAILURE;
+}
+
+
+/**
+ * Funzione che ricalcola da capo una vista, leggendo tutta la tabella una volta sola.
+ * I gruppi vengono raccolti in memoria e scritti nell'ordine in cui sono stati trovati.
+ *
+ * @return SUCCESS se la vista è stata ricalcolata, FAILURE altrimenti
+ */
+int refresh_materialized_view(const MaterializedView *view) {
+  ViewGroups *groups = new_view_groups(view);
+  if (!groups) { return FAILURE; }
+
+  const AggregateQuery *query = &groups->query;
+  char table_path[256];
+  snprintf(table_path, sizeof(table_path), "%s/%s.bin", TABLES_DIR, query->nome_tabella);
+  if (access(table_path, F_OK) != 0) {                            // Tabella ancora vuota
+    int result = write_view_file(view->nome, NULL, 0, groups->format.entry_size);
+    free_view_groups(groups);
+    return result;
+  }
+
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) {
+    free_view_groups(groups);
+    return FAILURE;
+  }
+  plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);
+
+  const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+  int result = FAILURE;
+  size_t count;
+
+  while ((count = read_scan_batch(&scan)) > 0) {
+    for (size_t r = 0; r < count; r++) {
+      const char *record = scan.buffer + r * scan.record_size;
+      if (pred && !evaluate_predicate(pred, record)) { continue; }
+
+      build_view_key(query, &groups->format, record, groups->key);
+      char *entry = find_view_group(groups, groups->key, true);
+      if (!entry) { goto cleanup; }
+      accumulate_view_entry(query, &groups->format, entry, record);
+    }
+  }
+
+  result = write_view_file(view->nome, groups->entries, (long)groups->num_groups, groups->format.entry_size);
+
+cleanup:
+  free_view_groups(groups);
+  close_table_scan(&scan);
+  return result;
+}
+
+
+/**
+ * Funzione che prepara l'aggiornamento delle viste di una tabella per un comando che ne cambia dei record.
+ * Ogni vista viene validata e caricata in memoria una volta sola; i record cambiati si passano con add_view_change
+ * e le viste si scrivono con commit_view_changes, dopo che la tabella è stata scritta (o si buttano con discard_view_changes).
+ *
+ * @param table_name La tabella modificata
+ * @param changes Le modifiche da preparare
+ */
+void begin_view_changes(const char *table_name, ViewChanges *changes) {
+  MaterializedView views[MAX_VIEWS];
+  int count = load_views(views);
+  changes->num_views = 0;
+
+  for (int i = 0; i < count; i++) {
+    if (strcmp(views[i].tabella, table_name) != SUCCESS) { continue; }
+
+    ViewGroups *groups = new_view_groups(&views[i]);
+    if (!groups) { continue; }
+    if (load_view_groups(groups) != SUCCESS) { groups->stale = true; }   // File mancante o di un altro formato: si ricalcola
+    changes->views[changes->num_views++] = groups;
+  }
+}
+
+
+/**
+ * Funzione che aggiunge alle viste della tabella un record aggiunto (sign = 1) o tolto (sign = -1).
+ * Un UPDATE è un -1 del vecchio record e un 1 del nuovo.
+ */
+void add_view_change(ViewChanges *changes, const char *record, int sign) {
+  for (int i = 0; i < changes->num_views; i++) { apply_view_change(changes->views[i], record, sign); }
+}
+
+
+/**
+ * Funzione che scrive le viste aggiornate da add_view_change.
+ * Una vista che non si può aggiornare in modo incrementale viene ricalcolata da capo, quindi va chiamata
+ * quando la tabella contiene già le modifiche.
+ */
+void commit_view_changes(ViewChanges *changes) {
+  for (int i = 0; i < changes->num_views; i++) {
+    ViewGroups *groups = changes->views[i];
+    if (groups->stale || save_view_groups(groups) != SUCCESS) { refresh_materialized_view(&groups->view); }
+    free_view_groups(groups);
+  }
+  changes->num_views = 0;
+}
+
+
+/**
+ * Funzione che butta le modifiche preparate, ad esempio se la scrittura della tabella non è riuscita.
+ */
+void discard_view_changes(ViewChanges *changes) {
+  for (int i = 0; i < changes->num_views; i++) { free_view_groups(changes->views[i]); }
+  changes->num_views = 0;
+}
+
+
+/**
+ * Funzione che aggiorna tutte le viste di una tabella dopo che un suo record è cambiato.
+ *
+ * @param table_name La tabella modificata
+ * @param record Il record aggiunto o tolto, con il layout completo della tabella
+ * @param sign 1 se il record è stato aggiunto, -1 se è stato tolto
+ */
+void maintain_materialized_views(const char *table_name, const char *record, int sign) {
+  maintain_materialized_views_batch(table_name, record, 1, 0, sign);
+}
+
+
+/**
+ * Funzione che aggiorna tutte le viste di una tabella dopo che tanti record sono stati scritti insieme.
+ * Le viste vengono lette e scritte una volta sola per tutti i record.
+ *
+ * @param table_name La tabella modificata
+ * @param records I record aggiunti o tolti, uno dopo l'altro
+ * @param num_records Il numero di record
+ * @param record_size La dimensione di un record
+ * @param sign 1 se i record sono stati aggiunti, -1 se sono stati tolti
+ */
+void maintain_materialized_views_batch(const char *table_name, const char *records, int num_records, size_t record_size, int sign) {
+  ViewChanges changes;
+  begin_view_changes(table_name, &changes);
+  if (changes.num_views == 0) { return; }
+
+  for (int r = 0; r < num_records; r++) { add_view_change(&changes, records + (size_t)r * record_size, sign); }
+  commit_view_changes(&changes);
+}
+
+
+/**
+ * Funzione che ricalcola da capo tutte le viste di una tabella.
+ * Serve quando cambiano tanti record insieme (ad esempio con LOAD): una lettura della tabella per vista
+ * costa meno che aggiornare le viste record per record.
+ *
+ * @param table_name La tabella modificata
+ */
+void refresh_table_views(const char *table_name) {
+  MaterializedView views[MAX_VIEWS];
+  int count = load_views(views);
+
+  for (int i = 0; i < count; i++) {
+    if (strcmp(views[i].tabella, table_name) == SUCCESS) { refresh_materialized_view(&views[i]); }
+  }
+}
+
+
+/**
+ * Funzione che stampa i gruppi di una vista, leggendo solo il suo file.
+ * Senza GROUP BY, una vista senza record stampa comunque la sua riga (COUNT a 0, le altre NULL), come AGGREGATE.
+ *
+ * @return Il numero di gruppi stampati, -1 in caso di errore
+ */
+long print_materialized_view(const MaterializedView *view) {
+  AggregateQuery query;
+  if (load_view_query(view, &query) != SUCCESS) { return -1; }
+
+  ViewFormat format;
+  get_view_format(&query, &format);
+
+  char path[256];
+  get_view_path(view->nome, "", path, sizeof(path));
+
+  ViewHeader header;
+  FILE *file = fopen(path, "rb");
+  if (!file || fread(&header, sizeof(ViewHeader), 1, file) != 1 || header.version != VIEW_VERSION || header.entry_size != format.entry_size) {
+    printf("❌ Errore: il file %s non è valido\n", path);
+    if (file) { fclose(file); }
+    return -1;
+  }
+
+  char *entry = arena_alloc(format.entry_size);
+  char *record = get_table_record_buffer(query.nome_tabella);
+  if (!entry || !record) {
+    fclose(file);
+    return -1;
+  }
+
+  output_title("Tabella: %s\n", view->nome);
+  for (int i = 0; i < query.group_by.num_colonne; i++) { output_column_name(query.layout.colonne[query.group_by.colonne[i]].nome); }
+  for (int i = 0; i < query.num_specs; i++) { output_column_name(query.specs[i].label); }
+  output_end_row();
+
+  if (header.num_groups == 0 && query.group_by.num_colonne == 0) {   // Nessun record: una riga con gli stati vuoti
+    init_view_entry(&query, &format, "", entry);
+    header.num_groups = 1;
+  } else if (header.num_groups > 0 && fread(entry, format.entry_size, 1, file) != 1) {
+    header.num_groups = 0;
+  }
+
+  long printed = 0;
+  while (printed < header.num_groups) {
+    size_t pos = 0;
+    for (int i = 0; i < query.group_by.num_colonne; i++) {        // Rimetto i valori della chiave al loro posto nel record
+      const LayoutColumn *col = &query.layout.colonne[query.group_by.colonne[i]];
+      memcpy(record + col->offset, entry + pos, col->tipo.length);
+      pos += col->tipo.length;
+    }
+
+    print_record_values(&query.layout, &query.group_by, record);
+    for (int i = 0; i < query.num_specs; i++) {
+      print_aggregate_value(&query.layout, &query.specs[i], (const AggregateState *)(entry + format.spec_offsets[i]));
+    }
+    output_end_row();
+
+    if (++printed < header.num_groups && fread(entry, format.entry_size, 1, file) != 1) { break; }
+  }
+
+  fclose(file);
+  return printed;
+}
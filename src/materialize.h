@@ -0,0 +1,59 @@
+#ifndef MATERIALIZE_H
+#define MATERIALIZE_H
+
+#include <stdint.h>
+
+// Config Header
+#include "../config.h"
+
+
+typedef struct {                                // ViewHeader: intestazione del file tables/<V>.view
+  int version;                                  // version: VIEW_VERSION, per riconoscere un file di un formato diverso
+  long num_groups;                              // num_groups: gruppi salvati dopo l'intestazione
+  size_t entry_size;                            // entry_size: byte di ogni gruppo (chiave, record del gruppo, stati)
+} ViewHeader;
+
+typedef struct {                                // ViewFormat: come sono disposti i gruppi di una vista nel file
+  size_t key_size;                              // key_size: byte della chiave, arrotondati a 8 per allineare gli stati
+  size_t spec_offsets[MAX_AGGREGATES];          // spec_offsets: posizione dello stato di ogni funzione, dopo il contatore dei record
+  size_t entry_size;                            // entry_size: byte di un gruppo
+} ViewFormat;
+
+typedef struct {                                // ViewGroups: i gruppi di una vista in memoria, indicizzati per chiave
+  MaterializedView view;                        // view: la vista
+  AggregateQuery query;                         // query: il comando AGGREGATE della vista, validato una volta per comando
+  ViewFormat format;                            // format: come sono disposti i gruppi
+  char *entries;                                // entries: i gruppi uno dopo l'altro, come nel file
+  bool *dirty;                                  // dirty: per ogni gruppo, true se va scritto nel file
+  size_t num_groups, capacity;                  // num_groups / capacity: gruppi in entries e gruppi allocati
+  size_t file_groups;                           // file_groups: gruppi letti dal file, i successivi sono nuovi
+  uint32_t *slots;                              // slots: tabella hash ad indirizzamento aperto, con l'indice del gruppo + 1 (0 = vuoto)
+  size_t num_slots;                             // num_slots: dimensione di slots, una potenza di 2
+  char *key;                                    // key: la chiave di un record
+  char *delta;                                  // delta: lo stato di un solo record, da aggiungere o togliere
+  bool stale;                                   // stale: la vista non si può aggiornare in modo incrementale e va ricalcolata
+} ViewGroups;
+
+typedef struct {                                // ViewChanges: le viste di una tabella da aggiornare per un comando
+  ViewGroups *views[MAX_VIEWS];                 // views: i gruppi di ogni vista della tabella
+  int num_views;                                // num_views: quante viste
+} ViewChanges;
+
+
+// Functions Available including the Materialize
+int find_materialized_view(const char *name, MaterializedView *view);
+int add_materialized_view(const MaterializedView *view);
+int load_view_query(const MaterializedView *view, AggregateQuery *query);
+int refresh_materialized_view(const MaterializedView *view);
+void begin_view_changes(const char *table_name, ViewChanges *changes);
+void add_view_change(ViewChanges *changes, const char *record, int sign);
+void commit_view_changes(ViewChanges *changes);
+void discard_view_changes(ViewChanges *changes);
+void maintain_materialized_views(const char *table_name, const char *record, int sign);
+void maintain_materialized_views_batch(const char *table_name, const char *records, int num_records, size_t record_size, int sign);
+void refresh_table_views(const char *table_name);
+long print_materialized_view(const MaterializedView *view);
+
+
+
+#endif
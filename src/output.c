@@ -0,0 +1,413 @@
+/*
+
+
+  Output.c è il file che si occupa di stampare i risultati dei comandi (READ, FIND, AGGREGATE, JOIN e le viste).
+  Le funzioni descritte in questo file sono:
+    - init_output:          dà allo stdout un buffer grande, all'avvio del programma.
+    - set_output_mode:      sceglie il formato dei risultati (comando OUTPUT).
+    - get_output_mode_name: ottiene il nome del formato attuale.
+    - output_marks_nulls:   dice se il formato attuale distingue i NULL dai valori (CSV e JSON).
+    - output_title:         stampa il titolo di un risultato (ad esempio "Tabella: Utente"), solo nei formati per le persone.
+    - output_column_name:   stampa il nome di una colonna nell'intestazione.
+    - output_int, output_float, output_string, output_bool, output_null: stampano un valore della riga.
+    - output_end_row:       chiude la riga (o l'intestazione).
+
+  Perchè?
+  Stampare un record con printf vuol dire, per ogni campo, interpretare la stringa di formato, prendere il lock dello stdout
+  e formattare il numero con il codice generico della libreria: con milioni di record costa più della lettura della tabella.
+  Qui lo stdout ha un buffer di OUTPUT_BUFFER_BYTES, i numeri vengono formattati a mano e ogni riga viene composta
+  in un buffer locale e copiata con una sola fwrite_unlocked, quindi la libreria fa una sola write ogni OUTPUT_BUFFER_BYTES.
+  Siccome tutto passa comunque dallo stdout, l'ordine con i printf degli altri messaggi resta quello giusto,
+  e la cache dei risultati continua a catturare l'output come prima. Il programma svuota il buffer prima di leggere un comando.
+
+  Formati (OUTPUT TSV | TABLE | CSV | JSON):
+    ✅ TSV:   ogni valore seguito da un tab, come è sempre stato.
+    ✅ TABLE: colonne allineate e separate da due spazi, con i numeri a destra; un valore più largo della colonna la allarga.
+    ✅ CSV:   valori separati da virgole, con i doppi apici solo dove servono: si può ricaricare con LOAD.
+    ✅ JSON:  un oggetto per riga, {"colonna":valore,…}, senza intestazione e senza titolo.
+  I titoli ("Tabella: …") e i riepiloghi ("N record trovati", il cursore) vengono stampati solo con TSV e TABLE,
+  così un CSV o un JSON contiene solo i dati.
+
+
+*/
+
+#define _GNU_SOURCE                 // fwrite_unlocked
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: setvbuf, fwrite_unlocked, putc_unlocked, vprintf
+#include <stdarg.h>                 // va_list
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strlen, strnlen
+#include <math.h>                   // isfinite, fabs, nearbyint, signbit
+
+#include "output.h"
+
+
+#define FIXED_BUFFER_BYTES 320      // "%.6f" di -DBL_MAX: 309 cifre, il segno, il punto, 6 decimali e il terminatore
+
+
+static const char *mode_names[] = { "TSV", "TABLE", "CSV", "JSON" };   // Nell'ordine di OutputMode
+
+static OutputMode mode = OUTPUT_TSV;
+static char stdout_buffer[OUTPUT_BUFFER_BYTES];
+static int field = 0;                           // Campi già stampati nella riga attuale
+static bool header_row = false;                 // true se la riga attuale è l'intestazione
+static int widths[MAX_LAYOUT_COLUMNS + MAX_AGGREGATES];   // TABLE: larghezza di ogni colonna, decisa dall'intestazione
+static int num_widths = 0;
+
+
+static char row[8192];                          // La riga attuale: passa allo stdout tutta insieme, con una sola fwrite_unlocked
+static size_t row_length = 0;
+
+
+/**
+ * Funzione che passa allo stdout la riga accumulata finora.
+ */
+static void flush_row() {
+  fwrite_unlocked(row, 1, row_length, stdout);
+  row_length = 0;
+}
+
+
+static void put(const char *text, size_t length) {
+  if (row_length + length > sizeof(row)) {
+    flush_row();
+    if (length > sizeof(row)) { fwrite_unlocked(text, 1, length, stdout); return; }
+  }
+  memcpy(row + row_length, text, length);
+  row_length += length;
+}
+
+
+static void put_char(char c) {
+  if (row_length == sizeof(row)) { flush_row(); }
+  row[row_length++] = c;
+}
+
+
+/**
+ * Funzione che stampa n spazi.
+ */
+static void put_spaces(int n) {
+  static const char spaces[] = "                                ";
+  while (n > 0) {
+    int chunk = n < (int)sizeof(spaces) - 1 ? n : (int)sizeof(spaces) - 1;
+    put(spaces, (size_t)chunk);
+    n -= chunk;
+  }
+}
+
+
+/**
+ * Funzione che conta i caratteri di un testo UTF-8 (non i byte), per allineare le colonne con TABLE.
+ */
+static int display_width(const char *text, size_t length) {
+  int width = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (((unsigned char)text[i] & 0xC0) != 0x80) { width++; }
+  }
+  return width;
+}
+
+
+/**
+ * Funzione che formatta un intero in base 10, senza printf.
+ * @return I caratteri scritti in buffer (almeno 21 byte)
+ */
+static size_t format_int(long long value, char *buffer) {
+  char digits[20];
+  size_t n = 0;
+  unsigned long long rest = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+  do {
+    digits[n++] = (char)('0' + rest % 10);
+    rest /= 10;
+  } while (rest > 0);
+
+  size_t length = 0;
+  if (value < 0) { buffer[length++] = '-'; }
+  while (n > 0) { buffer[length++] = digits[--n]; }
+  return length;
+}
+
+
+/**
+ * Funzione che formatta un numero con decimals cifre decimali, come "%.*f" ma senza printf.
+ * Il numero viene arrotondato all'intero di unità (ad esempio centesimi) più vicino, a pari in caso di metà esatta come printf.
+ * I numeri troppo grandi perchè il calcolo sia esatto, NaN e infinito passano da snprintf.
+ *
+ * @return I caratteri scritti in buffer (FIXED_BUFFER_BYTES byte), mai più di quelli che ci stanno
+ */
+static size_t format_fixed(double value, int decimals, char *buffer) {
+  static const double powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+  if (!isfinite(value) || fabs(value) >= 1e12 || decimals < 0 || decimals > 6) {
+    int length = snprintf(buffer, FIXED_BUFFER_BYTES, "%.*f", decimals, value);
+    if (length < 0) { return 0; }
+    return (size_t)length < FIXED_BUFFER_BYTES ? (size_t)length : FIXED_BUFFER_BYTES - 1;   // snprintf dice quanti ne servirebbero
+  }
+
+  unsigned long long units = (unsigned long long)nearbyint(fabs(value) * powers[decimals]);
+  unsigned long long scale = (unsigned long long)powers[decimals];
+  unsigned long long whole = units / scale;
+  unsigned long long fraction = units % scale;
+
+  size_t length = 0;
+  if (signbit(value)) { buffer[length++] = '-'; }
+  length += format_int((long long)whole, buffer + length);
+
+  if (decimals > 0) {
+    buffer[length++] = '.';
+    for (int d = decimals - 1; d >= 0; d--) {
+      buffer[length + (size_t)d] = (char)('0' + fraction % 10);
+      fraction /= 10;
+    }
+    length += (size_t)decimals;
+  }
+  return length;
+}
+
+
+/**
+ * Funzione che stampa una stringa tra doppi apici per il JSON, con le sequenze di escape.
+ */
+static void put_json_string(const char *text, size_t length) {
+  static const char hex[] = "0123456789abcdef";
+  put_char('"');
+
+  size_t start = 0;
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = (unsigned char)text[i];
+    if (c >= 0x20 && c != '"' && c != '\\') { continue; }
+
+    put(text + start, i - start);                               // I caratteri normali vengono copiati a blocchi
+    start = i + 1;
+    if (c == '"' || c == '\\') { put_char('\\'); put_char((char)c); }
+    else if (c == '\n')        { put("\\n", 2); }
+    else if (c == '\t')        { put("\\t", 2); }
+    else if (c == '\r')        { put("\\r", 2); }
+    else {
+      char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+      put(escape, sizeof(escape));
+    }
+  }
+
+  put(text + start, length - start);
+  put_char('"');
+}
+
+
+/**
+ * Funzione che stampa un valore per il CSV: tra doppi apici (con "" per un doppio apice) solo se contiene
+ * una virgola, un apice, un a capo o degli spazi all'inizio o alla fine.
+ */
+static void put_csv_string(const char *text, size_t length) {
+  bool quote = length > 0 && (text[0] == ' ' || text[length - 1] == ' ');
+  for (size_t i = 0; !quote && i < length; i++) {
+    quote = text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r';
+  }
+
+  if (!quote) {
+    put(text, length);
+    return;
+  }
+
+  put_char('"');
+  size_t start = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (text[i] != '"') { continue; }
+    put(text + start, i + 1 - start);                             // Copio fino all'apice compreso, poi lo ripeto
+    put_char('"');
+    start = i + 1;
+  }
+  put(text + start, length - start);
+  put_char('"');
+}
+
+
+/**
+ * Funzione che stampa un valore della riga, già in testo, nel formato attuale.
+ *
+ * @param name Il nome della colonna (serve al JSON)
+ * @param text Il valore
+ * @param length I byte del valore
+ * @param is_text true per le stringhe (tra apici nel JSON e allineate a sinistra in TABLE), false per numeri, bool e null
+ */
+static void put_field(const char *name, const char *text, size_t length, bool is_text) {
+  switch (mode) {
+    case OUTPUT_TSV:
+      put(text, length);
+      put_char('\t');
+      break;
+
+    case OUTPUT_TABLE: {
+      if (field > 0) { put("  ", 2); }
+      int width = field < num_widths ? widths[field] : OUTPUT_COLUMN_WIDTH;
+      int padding = width - display_width(text, length);
+      if (!is_text) { put_spaces(padding); }
+      put(text, length);
+      if (is_text) { put_spaces(padding); }
+      break;
+    }
+
+    case OUTPUT_CSV:
+      if (field > 0) { put_char(','); }
+      if (is_text) { put_csv_string(text, length); } else { put(text, length); }
+      break;
+
+    case OUTPUT_JSON:
+      put_char(field == 0 ? '{' : ',');
+      put_json_string(name, strlen(name));
+      put_char(':');
+      if (is_text) { put_json_string(text, length); } else { put(text, length); }
+      break;
+  }
+  field++;
+}
+
+
+/**
+ * Funzione che dà allo stdout un buffer di OUTPUT_BUFFER_BYTES. Va chiamata prima di stampare qualsiasi cosa.
+ */
+void init_output() {
+  setvbuf(stdout, stdout_buffer, _IOFBF, sizeof(stdout_buffer));
+}
+
+
+/**
+ * Funzione che sceglie il formato dei risultati.
+ *
+ * @param name TSV, TABLE, CSV oppure JSON
+ * @return SUCCESS se il formato esiste, FAILURE altrimenti
+ */
+int set_output_mode(const char *name) {
+  for (size_t m = 0; m < sizeof(mode_names) / sizeof(mode_names[0]); m++) {
+    if (strcmp(name, mode_names[m]) == SUCCESS) {
+      mode = (OutputMode)m;
+      return SUCCESS;
+    }
+  }
+  return FAILURE;
+}
+
+
+/**
+ * Funzione che ottiene il nome del formato attuale.
+ */
+const char *get_output_mode_name() {
+  return mode_names[mode];
+}
+
+
+/**
+ * Funzione che dice se i NULL vanno stampati come tali: un campo vuoto nel CSV, null nel JSON.
+ * Con TSV e TABLE un numero NULL resta il suo valore (ad esempio -1), come è sempre stato.
+ */
+bool output_marks_nulls() {
+  return mode == OUTPUT_CSV || mode == OUTPUT_JSON;
+}
+
+
+/**
+ * Funzione che stampa il titolo di un risultato, come printf, solo con TSV e TABLE.
+ * Anche le righe di riepilogo ("N record trovati", il cursore della pagina successiva) passano da qui.
+ * Inizia un nuovo risultato: le larghezze delle colonne di TABLE verranno decise dalla sua intestazione.
+ */
+void output_title(const char *format, ...) {
+  flush_row();
+  num_widths = 0;
+  if (mode != OUTPUT_TSV && mode != OUTPUT_TABLE) { return; }
+
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+
+
+/**
+ * Funzione che stampa il nome di una colonna nell'intestazione (che il JSON non ha).
+ */
+void output_column_name(const char *name) {
+  header_row = true;
+  size_t length = strlen(name);
+
+  switch (mode) {
+    case OUTPUT_TSV:
+      put(name, length);
+      put_char('\t');
+      break;
+
+    case OUTPUT_TABLE: {
+      int width = display_width(name, length);
+      if (width < OUTPUT_COLUMN_WIDTH) { width = OUTPUT_COLUMN_WIDTH; }
+      if (field < (int)(sizeof(widths) / sizeof(widths[0]))) { widths[field] = width; num_widths = field + 1; }
+      if (field > 0) { put("  ", 2); }
+      put(name, length);
+      put_spaces(width - display_width(name, length));
+      break;
+    }
+
+    case OUTPUT_CSV:
+      if (field > 0) { put_char(','); }
+      put_csv_string(name, length);
+      break;
+
+    case OUTPUT_JSON:
+      break;
+  }
+  field++;
+}
+
+
+void output_int(const char *name, long long value) {
+  char buffer[32];
+  put_field(name, buffer, format_int(value, buffer), false);
+}
+
+
+void output_float(const char *name, double value, int decimals) {
+  char buffer[FIXED_BUFFER_BYTES];
+  if (mode == OUTPUT_JSON && !isfinite(value)) { put_field(name, "null", 4, false); return; }
+  put_field(name, buffer, format_fixed(value, decimals, buffer), false);
+}
+
+
+void output_string(const char *name, const char *value, size_t max_length) {
+  put_field(name, value, strnlen(value, max_length), true);       // Al massimo max_length caratteri, senza copiare la stringa
+}
+
+
+void output_bool(const char *name, bool value) {
+  put_field(name, value ? "true" : "false", value ? 4 : 5, false);
+}
+
+
+void output_null(const char *name) {
+  if (mode == OUTPUT_JSON)     { put_field(name, "null", 4, false); }
+  else if (mode == OUTPUT_CSV) { put_field(name, "", 0, false); }
+  else                         { put_field(name, "NULL", 4, false); }
+}
+
+
+/**
+ * Funzione che chiude la riga attuale. Con TABLE l'intestazione viene sottolineata, con JSON l'intestazione non c'è.
+ */
+void output_end_row() {
+  if (header_row && mode == OUTPUT_JSON) {
+    // Il JSON non ha intestazione: i nomi delle colonne sono in ogni oggetto
+  } else if (mode == OUTPUT_JSON) {
+    put(field == 0 ? "{}\n" : "}\n", field == 0 ? 3 : 2);
+  } else {
+    put_char('\n');
+    if (header_row && mode == OUTPUT_TABLE) {
+      for (int i = 0; i < num_widths; i++) {
+        if (i > 0) { put("  ", 2); }
+        for (int w = 0; w < widths[i]; w++) { put_char('-'); }
+      }
+      put_char('\n');
+    }
+  }
+
+  flush_row();
+  field = 0;
+  header_row = false;
+}
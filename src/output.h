@@ -0,0 +1,25 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Output
+void init_output();
+int set_output_mode(const char *name);
+const char *get_output_mode_name();
+bool output_marks_nulls();
+
+void output_title(const char *format, ...);
+void output_column_name(const char *name);
+void output_int(const char *name, long long value);
+void output_float(const char *name, double value, int decimals);
+void output_string(const char *name, const char *value, size_t max_length);
+void output_bool(const char *name, bool value);
+void output_null(const char *name);
+void output_end_row();
+
+
+
+#endif
@@ -28,18 +28,58 @@
 
   4️⃣ CREATE <NomeTabella> <campo>:<valore> <campo>:<valore> …
   ➝ Crea un nuovo oggetto nella tabella specificata. La Tabella deve essere prima definita nello schema. Non è necessario specificare tutti i campi, solo quelli che si vuole valorizzare.
+  ➝ Con più righe tra parentesi, CREATE <NomeTabella> (<campo>:<valore> …) (<campo>:<valore> …), crea tutti i record con una sola scrittura.
 
-  5️⃣ READ <NomeTabella>
-  ➝ Legge tutti i record di una tabella specificata. Mostra i dati in modo formattato.
+  5️⃣ READ <NomeTabella> [<colonna>,<colonna>,…] [ORDER BY <campo> [DESC]] [AFTER <cursore>] [LIMIT <n>] [SAMPLE <n>% [SEED <s>]]
+  ➝ Legge tutti i record di una tabella specificata. Mostra i dati in modo formattato, eventualmente solo per le colonne richieste.
+  ➝ Con LIMIT si ottiene una pagina di record e un cursore, da passare ad AFTER per leggere la pagina successiva.
+  ➝ Con ORDER BY i record vengono ordinati per una colonna, anche se la tabella non entra in memoria.
+  ➝ Con SAMPLE si legge solo una percentuale della tabella, a blocchi scelti a caso.
 
   6️⃣ UPDATE <NomeTabella> <ID> <campo>:<valore> <campo>:<valore> …
   ➝ Aggiorna un record esistente di una tabella specificata. Non è necessario specificare tutti i campi, solo quelli che si vuole aggiornare.
+  ➝ Con UPDATE <NomeTabella> [WHERE <predicato>] SET <campo>:<valore> … aggiorna tutti i record che soddisfano il predicato, con una sola lettura della tabella.
 
-  7️⃣ FIND <NomeTabella> <campo>:<valore>
-  ➝ Cerca un record in una tabella in base a un criterio.
+  7️⃣ FIND <NomeTabella> [<colonna>,…] <campo>:<valore> [AND|OR|NOT ...]
+  ➝ Cerca i record di una tabella che soddisfano un predicato. Es. FIND Ordine stato:'open' AND (totale>100 OR urgente:true)
 
   8️⃣ DELETE <NomeTabella> <ID>
-  ➝ Elimina un oggetto specifico tramite ID.
+  ➝ Elimina un oggetto specifico tramite ID. Il record viene solo segnato come eliminato, lo spazio viene recuperato in background.
+
+  9️⃣ AGGREGATE <NomeTabella> COUNT(*) SUM(<campo>) MIN(<campo>) MAX(<campo>) AVG(<campo>) … [WHERE <predicato>] [GROUP BY <campo>,…] [SAMPLE <n>% [SEED <s>]]
+  ➝ Calcola delle funzioni di aggregazione sui record di una tabella, eventualmente filtrati e raggruppati.
+  ➝ Con SAMPLE il risultato è stimato su una parte della tabella, con il suo intervallo di confidenza.
+  ➝ APPROX_COUNT_DISTINCT(<campo>) e APPROX_PERCENTILE(<campo>,<p>) stimano i valori distinti e i percentili con uno sketch di dimensione fissa.
+
+  🔟 JOIN <TabellaA> <TabellaB> ON <TabellaA>.<campo> = <TabellaB>.<campo> [<colonna>,…] [WHERE <predicato>] [LIMIT <n>]
+  ➝ Unisce i record di due tabelle che hanno lo stesso valore nelle colonne indicate. Le colonne vanno qualificate con il nome della tabella.
+
+  1️⃣1️⃣ ANALYZE <NomeTabella>
+  ➝ Raccoglie le statistiche di una tabella (NULL, valori distinti, istogramma), usate per scegliere come leggerla.
+
+  1️⃣2️⃣ EXPLAIN READ|FIND|AGGREGATE …
+  ➝ Mostra come verrebbe eseguita una query: il piano scelto, il suo costo e i record stimati ed effettivi.
+
+  1️⃣3️⃣ MATERIALIZE <NomeVista> AS AGGREGATE <NomeTabella> COUNT(*) SUM(<campo>) … [WHERE <predicato>] [GROUP BY <campo>,…]
+  ➝ Salva il risultato di un AGGREGATE come una vista, aggiornata a ogni CREATE sulla tabella. Si legge con READ <NomeVista>.
+
+  1️⃣4️⃣ CACHE [CLEAR | LIMIT <byte>]
+  ➝ Mostra la cache dei risultati di READ, FIND, AGGREGATE e JOIN (hit, miss, memoria usata), la svuota o ne cambia il limite.
+
+  1️⃣5️⃣ PREPARE <Nome> AS CREATE <NomeTabella> <campo>:? <campo>:<valore> …   /   EXECUTE <Nome> <valore> <valore> …
+  ➝ Prepara un CREATE risolvendo una volta sola tabella e colonne; EXECUTE lo esegue passando solo i valori dei parametri (?).
+
+  1️⃣6️⃣ LOAD <NomeTabella> FROM '<file.csv>'
+  ➝ Aggiunge alla tabella tutte le righe di un file CSV, con l'intestazione con i nomi delle colonne. Molto più veloce di un CREATE per riga.
+
+  1️⃣7️⃣ EXPORT <NomeTabella> TO '<file>' FORMAT COLUMNAR   /   IMPORT <NomeTabella> FROM '<file>' FORMAT COLUMNAR
+  ➝ Scrive i record della tabella in un file binario a colonne, che si descrive da solo, e li aggiunge a una tabella senza passare dal testo.
+
+  1️⃣8️⃣ OUTPUT [TSV | TABLE | CSV | JSON]
+  ➝ Sceglie il formato dei risultati: valori separati da tab, colonne allineate, CSV oppure un oggetto JSON per riga.
+
+  1️⃣9️⃣ BEGIN … COMMIT | ROLLBACK
+  ➝ Apre una transazione: le scritture dei comandi successivi vengono applicate tutte insieme al COMMIT, o annullate con ROLLBACK.
 
 */
 
@@ -49,16 +89,33 @@
 #include <string.h>
 
 #include "parser.h"
+#include "lexer.h"
 
 #include "schema.h"
 #include "commands/define.h"
 #include "commands/create.h"
 #include "commands/read.h"
+#include "commands/find.h"
+#include "commands/aggregate.h"
+#include "commands/join.h"
+#include "commands/analyze.h"
+#include "commands/explain.h"
+#include "commands/materialize.h"
+#include "materialize.h"
+#include "commands/cache.h"
+#include "cache.h"
+#include "commands/prepare.h"
+#include "commands/load.h"
+#include "commands/transfer.h"
+#include "commands/output.h"
+#include "commands/delete.h"
+#include "commands/update.h"
+#include "commands/transaction.h"
 
 /**
  * Questa funzione processa il comando inserito dall'utente.
- * Partendo da una stringa di input, si ottiene una lista di token, suddividendo la stringa per gli spazi
- * Infatti, ogni sintassi dei comandi del nostro sistema, si basa sulla suddivisione per spazi.
+ * Partendo da una stringa di input, si ottiene una lista di token, suddividendo la stringa per gli spazi (vedi lexer.c)
+ * Infatti, ogni sintassi dei comandi del nostro sistema, si basa sulla suddivisione per spazi; uno spazio tra apici non divide.
  * Una volta ottenuta la lista di token, il PRIMO deve essere sempre il comando
  * Se non c'è un comando valido nella stringa, si ritorna subito l'errore
  * Se il comando è valido, viene validato e in caso, eseguito
@@ -66,25 +123,12 @@
  * Definire la lista di comandi che l'utente può inserire tramite un elenco chiuso mi permette di avere il controllo su tutto quello che succede. 
  */
 void process_command(char *input) {
-  char *tokens[MAX_TOKENS];                            // Array per memorizzare i token del comando
   int token_count = 0;
 
   // Tokenizzo la stringa (divide l'input in parole separate dagli spazi)
-  // Per tokenizzare la stringa, utilizzo la funzione strtok_r invece di strtok.
-  // La funzione strtok_r è una versione thread-safe di strtok, che utilizza un puntatore a char (saveptr) per mantenere lo stato.
-  char *token;
-  char *saveptr;  // Variabile per mantenere lo stato
-
-  // La funzione strtok_r() divide una stringa in token (parole) utilizzando un delimitatore specificato e si salva il puntatore alla posizione successiva in saveptr.
-  token = strtok_r(input, " ", &saveptr);              // Punta ora alla prima parola del comando
-
-  while(token != NULL & token_count < MAX_TOKENS) {    // Continua finchè non arriva alla fine della stringa o raggiunge il numero massimo di token
-    tokens[token_count] = token;                       // Salva il token nell'array
-    token_count++;                                     // Incrementa il contatore dei token
-
-    // Attenzione qui: il primo parametro di strtok_r è NULL per indicare che voglio continuare a tokenizzare la stessa stringa.
-    token = strtok_r(NULL, " ", &saveptr);             // Passa al token successivo.
-  }
+  // I token puntano dentro input, non viene copiato nulla; l'array vive nell'arena del comando.
+  char **tokens = tokenize_command(input, &token_count);
+  if (!tokens) { return; }
 
   // Controlliamo che ci sia almeno un comando
   if (token_count < 1) {
@@ -99,6 +143,10 @@ void process_command(char *input) {
     return;
   }
 
+  CachedCommand cached;                                 // Se il risultato è già in cache viene stampato, altrimenti viene catturato
+  CacheLookup lookup = lookup_result_cache(tokens, token_count, &cached);
+  if (lookup == CACHE_HIT) { return; }
+
   switch (command) {                                    // Eseguo il comando corrispondente
     case CMD_INFO:
       // validate_info(tokens, token_count);
@@ -109,26 +157,106 @@ void process_command(char *input) {
     case CMD_DEFINE:
       if (validate_define(tokens, token_count)) { execute_define(tokens, token_count); }
       break;
-    case CMD_CREATE:
-      if (validate_create(tokens, token_count)) { execute_create(tokens, token_count); }
+    case CMD_CREATE: {
+      CreateQuery query;
+      if (validate_create(tokens, token_count, &query)) { execute_create(&query); }
+      break;
+    }
+    case CMD_READ: {
+      MaterializedView view;
+      if (token_count == READ_INIT_TOKENS && find_materialized_view(tokens[1], &view) == SUCCESS) {   // READ di una vista: si leggono solo i suoi gruppi
+        print_materialized_view(&view);
+        break;
+      }
+
+      ReadQuery query;
+      if (validate_read(tokens, token_count, &query)) { execute_read(&query); }
+      break;
+    }
+    case CMD_UPDATE: {
+      UpdateQuery query;
+      if (validate_update(tokens, token_count, &query)) { execute_update(&query); }
+      break;
+    }
+    case CMD_FIND: {
+      ReadQuery query;
+      if (validate_find(tokens, token_count, &query)) { execute_find(&query); }
+      break;
+    }
+    case CMD_DELETE: {
+      DeleteQuery query;
+      if (validate_delete(tokens, token_count, &query)) { execute_delete(&query); }
+      break;
+    }
+    case CMD_AGGREGATE: {
+      AggregateQuery query;
+      if (validate_aggregate(tokens, token_count, &query)) { execute_aggregate(&query); }
+      break;
+    }
+    case CMD_JOIN: {
+      JoinQuery query;
+      if (validate_join(tokens, token_count, &query)) { execute_join(&query); }
+      break;
+    }
+    case CMD_ANALYZE:
+      if (validate_analyze(tokens, token_count)) { execute_analyze(tokens, token_count); }
+      break;
+    case CMD_EXPLAIN: {
+      ExplainQuery query;
+      if (validate_explain(tokens, token_count, &query)) { execute_explain(&query); }
       break;
-    case CMD_READ:
-      print_table(tokens[1]);
-      // validate_read(tokens, token_count);
+    }
+    case CMD_MATERIALIZE: {
+      MaterializedView view;
+      if (validate_materialize(tokens, token_count, &view)) { execute_materialize(&view); }
       break;
-    case CMD_UPDATE:
-      // validate_update(tokens, token_count);
+    }
+    case CMD_CACHE:
+      if (validate_cache(tokens, token_count)) { execute_cache(tokens, token_count); }
       break;
-    case CMD_FIND:
-      // validate_find(tokens, token_count);
+    case CMD_OUTPUT:
+      if (validate_output(tokens, token_count)) { execute_output(tokens, token_count); }
       break;
-    case CMD_DELETE:
-      // validate_delete(tokens, token_count);
+    case CMD_PREPARE: {
+      PreparedStatement statement;
+      if (validate_prepare(tokens, token_count, &statement)) { execute_prepare(&statement); }
+      break;
+    }
+    case CMD_EXECUTE: {
+      PreparedStatement *statement = validate_execute(tokens, token_count);
+      if (statement) { execute_execute(statement); }
+      break;
+    }
+    case CMD_LOAD: {
+      LoadQuery query;
+      if (validate_load(tokens, token_count, &query)) { execute_load(&query); }
+      break;
+    }
+    case CMD_EXPORT: {
+      ColumnarQuery query;
+      if (validate_export(tokens, token_count, &query)) { execute_export(&query); }
+      break;
+    }
+    case CMD_IMPORT: {
+      ColumnarQuery query;
+      if (validate_import(tokens, token_count, &query)) { execute_import(&query); }
+      break;
+    }
+    case CMD_BEGIN:
+      if (validate_begin(tokens, token_count)) { execute_begin(); }
+      break;
+    case CMD_COMMIT:
+      if (validate_commit(tokens, token_count)) { execute_commit(); }
+      break;
+    case CMD_ROLLBACK:
+      if (validate_rollback(tokens, token_count)) { execute_rollback(); }
       break;
     default:
       printf("❌ Errore interno.\n");
   }
 
+  if (lookup == CACHE_MISS) { store_result_cache(&cached); }
+
 }
 
 
@@ -137,16 +265,64 @@ void process_command(char *input) {
  * Questa funzione determina se una stringa corrisponde a un comando del sistema.
  * Se si, ritorna il comando corrispondente.
  * In questo modo, mi assicuro che vengano utilizzati solo i comandi che io ho definito.
+ * La prima lettera sceglie al massimo tre comandi possibili, quindi bastano al massimo tre strcmp invece di provarli tutti.
  */
 CommandType get_command_type(char *command) {
-  if (strcmp(command, "INFO")   == SUCCESS) return CMD_INFO;
-  if (strcmp(command, "SCHEMA") == SUCCESS) return CMD_SCHEMA;
-  if (strcmp(command, "DEFINE") == SUCCESS) return CMD_DEFINE;
-  if (strcmp(command, "CREATE") == SUCCESS) return CMD_CREATE;
-  if (strcmp(command, "READ")   == SUCCESS) return CMD_READ;
-  if (strcmp(command, "UPDATE") == SUCCESS) return CMD_UPDATE;
-  if (strcmp(command, "FIND")   == SUCCESS) return CMD_FIND;
-  if (strcmp(command, "DELETE") == SUCCESS) return CMD_DELETE;
+  switch (command[0]) {
+    case 'A':
+      if (strcmp(command, "AGGREGATE") == SUCCESS) return CMD_AGGREGATE;
+      if (strcmp(command, "ANALYZE") == SUCCESS) return CMD_ANALYZE;
+      break;
+    case 'B':
+      if (strcmp(command, "BEGIN")  == SUCCESS) return CMD_BEGIN;
+      break;
+    case 'C':
+      if (strcmp(command, "CREATE") == SUCCESS) return CMD_CREATE;
+      if (strcmp(command, "CACHE")  == SUCCESS) return CMD_CACHE;
+      if (strcmp(command, "COMMIT") == SUCCESS) return CMD_COMMIT;
+      break;
+    case 'D':
+      if (strcmp(command, "DEFINE") == SUCCESS) return CMD_DEFINE;
+      if (strcmp(command, "DELETE") == SUCCESS) return CMD_DELETE;
+      break;
+    case 'E':
+      if (strcmp(command, "EXECUTE") == SUCCESS) return CMD_EXECUTE;
+      if (strcmp(command, "EXPLAIN") == SUCCESS) return CMD_EXPLAIN;
+      if (strcmp(command, "EXPORT")  == SUCCESS) return CMD_EXPORT;
+      break;
+    case 'F':
+      if (strcmp(command, "FIND")   == SUCCESS) return CMD_FIND;
+      break;
+    case 'I':
+      if (strcmp(command, "INFO")   == SUCCESS) return CMD_INFO;
+      if (strcmp(command, "IMPORT") == SUCCESS) return CMD_IMPORT;
+      break;
+    case 'J':
+      if (strcmp(command, "JOIN")   == SUCCESS) return CMD_JOIN;
+      break;
+    case 'L':
+      if (strcmp(command, "LOAD")   == SUCCESS) return CMD_LOAD;
+      break;
+    case 'M':
+      if (strcmp(command, "MATERIALIZE") == SUCCESS) return CMD_MATERIALIZE;
+      break;
+    case 'O':
+      if (strcmp(command, "OUTPUT") == SUCCESS) return CMD_OUTPUT;
+      break;
+    case 'P':
+      if (strcmp(command, "PREPARE") == SUCCESS) return CMD_PREPARE;
+      break;
+    case 'R':
+      if (strcmp(command, "READ")   == SUCCESS) return CMD_READ;
+      if (strcmp(command, "ROLLBACK") == SUCCESS) return CMD_ROLLBACK;
+      break;
+    case 'S':
+      if (strcmp(command, "SCHEMA") == SUCCESS) return CMD_SCHEMA;
+      break;
+    case 'U':
+      if (strcmp(command, "UPDATE") == SUCCESS) return CMD_UPDATE;
+      break;
+  }
 
   return CMD_UNKNOWN;
-}
\ No newline at end of file
+}
@@ -0,0 +1,277 @@
+/*
+
+
+  Planner.c è il file che sceglie come leggere una tabella per una query (il "piano di accesso").
+  Le funzioni descritte in questo file sono:
+    - choose_access_plan:   stima i record che soddisfano il predicato e sceglie il modo più economico di leggere la tabella.
+    - apply_access_plan:    prepara una scansione secondo il piano scelto.
+    - plan_table_scan:      sceglie e applica il piano in un colpo solo (usato da READ, FIND e AGGREGATE).
+    - print_access_plan:    stampa il piano scelto (usato da EXPLAIN).
+
+  Modi di leggere una tabella:
+    - ACCESS_FULL_SCAN: si leggono tutti i record, in sequenza.
+    - ACCESS_ID_LOOKUP: il predicato fissa un solo id (id:42): lo si trova con una ricerca binaria, come fa AFTER.
+    - ACCESS_ID_RANGE:  il predicato limita gli id (id>=100 AND id<200): si trova il primo con una ricerca binaria
+                        e la scansione si ferma dopo l'ultimo. Gli id sono sempre crescenti nel file, come un indice.
+  L'intervallo di id viene ricavato solo dalle condizioni sull'id in AND con il resto del predicato:
+  in un OR o sotto un NOT non limita i record da leggere.
+  Il predicato viene comunque valutato su ogni record letto, quindi il piano cambia solo quanti record si leggono.
+
+  Modello dei costi:
+  Il costo di leggere r record è quello delle pagine da COST_PAGE_BYTES lette in sequenza (COST_SEQ_PAGE l'una)
+  più un piccolo costo per valutare il predicato su ogni record (COST_RECORD).
+  Una ricerca binaria costa log2(record) letture casuali (COST_RANDOM_PAGE l'una).
+  Si sceglie il modo con il costo minore: un intervallo che copre quasi tutta la tabella resta una scansione completa.
+
+  Stime dei record:
+  Se la tabella ha le statistiche di ANALYZE (vedi stats.c), ogni confronto viene stimato con l'istogramma
+  e con il numero di valori distinti della sua colonna, tenendo conto dei NULL.
+  Altrimenti si usano delle stime di default: gli id contigui da 1 al numero di record,
+  DEFAULT_DISTINCT valori distinti per colonna e un terzo dei record per un confronto < o >.
+  Le condizioni in AND si moltiplicano, quelle in OR si combinano come eventi indipendenti.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy
+#include <math.h>                   // log2
+#include <limits.h>                 // INT_MAX
+
+#include "planner.h"
+
+
+/**
+ * Funzione che trova la colonna del layout confrontata da un nodo del predicato.
+ * @return L'indice della colonna, -1 se non c'è
+ */
+static int get_node_column(const RecordLayout *layout, const PredicateNode *node) {
+  for (int i = 0; i < layout->num_colonne; i++) {
+    if (layout->colonne[i].offset == node->offset && layout->colonne[i].kind == node->kind) { return i; }
+  }
+  return -1;
+}
+
+
+/**
+ * Funzione che stima la frazione di record con valore minore di value in una colonna (NULL compresi nel totale).
+ * Senza istogramma: per l'id si suppongono gli id contigui da 1 a rows, per le altre colonne un terzo.
+ */
+static double estimate_fraction_below(const AccessPlan *plan, int column, double value) {
+  if (plan->has_stats) {
+    double fraction = estimate_column_fraction_below(&plan->stats.colonne[column], value);
+    if (fraction >= 0) { return fraction; }
+  }
+
+  if (column == 0) {                                                      // id
+    double fraction = plan->rows > 0 ? (value - 1) / (double)plan->rows : 0;
+    return fraction < 0 ? 0 : (fraction > 1 ? 1 : fraction);
+  }
+  return 1.0 / 3.0;
+}
+
+
+/**
+ * Funzione che stima la frazione di record che soddisfano un confronto.
+ */
+static double estimate_comparison(const AccessPlan *plan, const RecordLayout *layout, const Predicate *pred, const PredicateNode *node) {
+  int column = get_node_column(layout, node);
+  if (column < 0) { return 1.0 / 3.0; }
+
+  const LayoutColumn *col = &layout->colonne[column];
+  double not_null = 1, distinct;
+
+  if (plan->has_stats) {
+    const ColumnStats *stats = &plan->stats.colonne[column];
+    if (plan->stats.rows > 0) { not_null = 1 - (double)stats->null_count / (double)plan->stats.rows; }
+    distinct = stats->distinct;
+  } else if (column == 0) {
+    distinct = (double)plan->rows;                                        // Gli id sono tutti diversi
+  } else {
+    distinct = col->kind == KIND_BOOL ? 2 : DEFAULT_DISTINCT;
+  }
+  if (distinct < 1) { distinct = 1; }
+
+  double equal = not_null / distinct;
+  double value;
+  bool numeric = read_numeric_value(col, pred->pool + node->constant, &value);
+
+  if (plan->has_stats && numeric && plan->stats.colonne[column].num_bounds > 0 &&
+      (value < plan->stats.colonne[column].min || value > plan->stats.colonne[column].max)) {
+    equal = 0;                                                            // Fuori dall'intervallo dei valori: nessun record uguale
+  }
+
+  if (node->cmp == CMP_EQ) { return equal; }
+  if (node->cmp == CMP_NE) { return not_null - equal; }
+  if (!numeric) { return not_null / 3.0; }                                // char: nessun istogramma
+
+  double below = estimate_fraction_below(plan, column, value) * not_null;
+  double result;
+  switch (node->cmp) {
+    case CMP_LT: result = below; break;
+    case CMP_LE: result = below + equal; break;
+    case CMP_GT: result = not_null - below - equal; break;
+    default:     result = not_null - below; break;                        // CMP_GE
+  }
+  return result < 0 ? 0 : (result > 1 ? 1 : result);
+}
+
+
+/**
+ * Funzione che stima la frazione di record che soddisfano un nodo del predicato.
+ */
+static double estimate_node(const AccessPlan *plan, const RecordLayout *layout, const Predicate *pred, int index) {
+  const PredicateNode *node = &pred->nodi[index];
+  const int *children = pred->children + node->first_child;
+  double result;
+
+  switch (node->op) {
+    case PRED_AND:
+      result = 1;
+      for (int i = 0; i < node->num_children; i++) { result *= estimate_node(plan, layout, pred, children[i]); }
+      return result;
+
+    case PRED_OR:
+      result = 1;                                                         // Probabilità che nessuna condizione sia vera
+      for (int i = 0; i < node->num_children; i++) { result *= 1 - estimate_node(plan, layout, pred, children[i]); }
+      return 1 - result;
+
+    case PRED_NOT:
+      return 1 - estimate_node(plan, layout, pred, children[0]);
+
+    default:
+      return estimate_comparison(plan, layout, pred, node);
+  }
+}
+
+
+/**
+ * Funzione che restringe l'intervallo di id del piano con un confronto sull'id.
+ */
+static void narrow_id_range(AccessPlan *plan, const Predicate *pred, const PredicateNode *node) {
+  if (node->op != PRED_CMP || node->offset != 0 || node->kind != KIND_INT) { return; }   // L'id è sempre il primo campo
+
+  int id;
+  memcpy(&id, pred->pool + node->constant, sizeof(int));
+
+  switch (node->cmp) {
+    case CMP_EQ: if (id > plan->low_id) { plan->low_id = id; }  if (id < plan->high_id) { plan->high_id = id; } break;
+    case CMP_LT: if (id - 1L < plan->high_id) { plan->high_id = id - 1L; } break;
+    case CMP_LE: if (id < plan->high_id) { plan->high_id = id; } break;
+    case CMP_GT: if (id + 1L > plan->low_id) { plan->low_id = id + 1L; } break;
+    case CMP_GE: if (id > plan->low_id) { plan->low_id = id; } break;
+    default: break;
+  }
+}
+
+
+/**
+ * Funzione che stima il costo di leggere in sequenza un certo numero di record.
+ */
+static double estimate_scan_cost(double records, size_t record_size) {
+  double pages = records * (double)record_size / COST_PAGE_BYTES;
+  if (records > 0 && pages < 1) { pages = 1; }
+  return pages * COST_SEQ_PAGE + records * COST_RECORD;
+}
+
+
+/**
+ * Funzione che sceglie come leggere una tabella per una query.
+ * Carica le statistiche (se ci sono), stima i record che soddisfano il predicato,
+ * ricava dal predicato l'intervallo di id e confronta il costo della scansione completa con quello della ricerca per id.
+ *
+ * @param table_name La tabella da leggere
+ * @param layout Il layout dei record della tabella
+ * @param pred Il predicato della query (vuoto = tutti i record)
+ * @param scan Una scansione aperta sulla tabella, serve per contare i record
+ * @param plan Il piano da valorizzare
+ */
+void choose_access_plan(const char *table_name, const RecordLayout *layout, const Predicate *pred, TableScan *scan, AccessPlan *plan) {
+  plan->method = ACCESS_FULL_SCAN;
+  plan->rows = count_table_records(scan);
+  plan->low_id = 0;                                                       // Gli id partono da 1
+  plan->high_id = INT_MAX;
+  plan->has_stats = load_table_stats(table_name, layout, &plan->stats) == SUCCESS;
+
+  double rows = (double)plan->rows;
+  plan->full_scan_cost = estimate_scan_cost(rows, layout->record_size);
+  plan->cost = plan->full_scan_cost;
+  plan->estimated_scanned = rows;
+  plan->estimated_matches = pred->root >= 0 ? rows * estimate_node(plan, layout, pred, pred->root) : rows;
+
+  if (pred->root < 0) { return; }
+
+  const PredicateNode *root = &pred->nodi[pred->root];
+  if (root->op == PRED_AND) {
+    for (int i = 0; i < root->num_children; i++) { narrow_id_range(plan, pred, &pred->nodi[pred->children[root->first_child + i]]); }
+  } else {
+    narrow_id_range(plan, pred, root);
+  }
+
+  if (plan->low_id == 0 && plan->high_id == INT_MAX) { return; }          // Nessun limite sugli id
+
+  double in_range = 0;
+  if (plan->low_id <= plan->high_id) {
+    in_range = rows * (estimate_fraction_below(plan, 0, (double)plan->high_id + 1) - estimate_fraction_below(plan, 0, (double)plan->low_id));
+    if (in_range < 1 && plan->low_id == plan->high_id) { in_range = 1; }
+  }
+
+  double search_cost = log2(rows + 1) * COST_RANDOM_PAGE;
+  double range_cost = search_cost + estimate_scan_cost(in_range, layout->record_size);
+
+  if (range_cost < plan->full_scan_cost) {
+    plan->method = plan->low_id == plan->high_id ? ACCESS_ID_LOOKUP : ACCESS_ID_RANGE;
+    plan->cost = range_cost;
+    plan->estimated_scanned = in_range;
+    if (plan->estimated_matches > in_range) { plan->estimated_matches = in_range; }
+  }
+}
+
+
+/**
+ * Funzione che prepara una scansione appena aperta secondo il piano: con un intervallo di id,
+ * la scansione parte dal primo id dell'intervallo e si ferma dopo l'ultimo.
+ */
+void apply_access_plan(TableScan *scan, const AccessPlan *plan) {
+  if (plan->method == ACCESS_FULL_SCAN) { return; }
+
+  int low = plan->low_id > INT_MAX ? INT_MAX : (int)plan->low_id;
+  int high = plan->high_id < low ? low - 1 : (int)plan->high_id;          // Intervallo vuoto: la scansione non restituisce nulla
+  set_scan_id_range(scan, low, high);
+}
+
+
+/**
+ * Funzione che sceglie e applica il piano di accesso a una scansione appena aperta.
+ * Con SAMPLE la scansione è già limitata ai blocchi del campione, e il piano non viene applicato.
+ */
+void plan_table_scan(TableScan *scan, const char *table_name, const RecordLayout *layout, const Predicate *pred) {
+  if (scan->sampling || pred->root < 0) { return; }
+
+  AccessPlan plan;
+  choose_access_plan(table_name, layout, pred, scan, &plan);
+  apply_access_plan(scan, &plan);
+}
+
+
+/**
+ * Funzione che stampa il piano scelto, con il suo costo e le stime dei record.
+ */
+void print_access_plan(const AccessPlan *plan) {
+  switch (plan->method) {
+    case ACCESS_ID_LOOKUP: printf("📋 Piano: ricerca per id (id = %ld)\n", plan->low_id); break;
+    case ACCESS_ID_RANGE:
+      if (plan->high_id == INT_MAX) { printf("📋 Piano: intervallo di id (id ≥ %ld)\n", plan->low_id); }
+      else if (plan->low_id == 0)   { printf("📋 Piano: intervallo di id (id ≤ %ld)\n", plan->high_id); }
+      else                          { printf("📋 Piano: intervallo di id (%ld ≤ id ≤ %ld)\n", plan->low_id, plan->high_id); }
+      break;
+    default: printf("📋 Piano: scansione completa\n"); break;
+  }
+
+  printf("   Costo stimato: %.1f (scansione completa: %.1f)\n", plan->cost, plan->full_scan_cost);
+  if (plan->has_stats) {
+    printf("   Statistiche: ANALYZE su %ld record (ora la tabella ne ha %ld)\n", plan->stats.rows, plan->rows);
+  } else {
+    printf("   Statistiche: assenti, stime di default (usa ANALYZE per stime migliori)\n");
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+// Config Header
+#include "../config.h"
+#include "scan.h"
+#include "stats.h"
+
+
+typedef enum {                                  // Modi di leggere una tabella
+  ACCESS_FULL_SCAN,                             // Scansione di tutta la tabella
+  ACCESS_ID_LOOKUP,                             // Ricerca binaria di un solo id
+  ACCESS_ID_RANGE                               // Ricerca binaria del primo id, poi scansione fino all'ultimo id dell'intervallo
+} AccessMethod;
+
+typedef struct {                                // AccessPlan: come leggere una tabella per una query, scelto in base ai costi
+  AccessMethod method;                          // method: il modo scelto
+  long low_id, high_id;                         // low_id / high_id: intervallo di id ricavato dal predicato (estremi compresi)
+  long rows;                                    // rows: record della tabella
+  double estimated_scanned;                     // estimated_scanned: record che si stima di leggere con il modo scelto
+  double estimated_matches;                     // estimated_matches: record che si stima soddisfino il predicato
+  double cost;                                  // cost: costo stimato del modo scelto
+  double full_scan_cost;                        // full_scan_cost: costo stimato della scansione completa, per confronto
+  bool has_stats;                               // has_stats: true se le stime usano le statistiche di ANALYZE
+  TableStats stats;                             // stats: le statistiche caricate (valide solo se has_stats)
+} AccessPlan;
+
+
+// Functions Available including the Planner
+void choose_access_plan(const char *table_name, const RecordLayout *layout, const Predicate *pred, TableScan *scan, AccessPlan *plan);
+void apply_access_plan(TableScan *scan, const AccessPlan *plan);
+void plan_table_scan(TableScan *scan, const char *table_name, const RecordLayout *layout, const Predicate *pred);
+void print_access_plan(const AccessPlan *plan);
+
+
+
+#endif
@@ -0,0 +1,497 @@
+/*
+
+
+  Predicate.c è il file che si occupa di compilare e valutare i predicati dei comandi (ad esempio FIND).
+  Un predicato è un'espressione come:
+
+    stato:'open' AND (totale>100 OR urgente:true)
+
+  Le funzioni descritte in questo file sono:
+    - compile_predicate:      trasforma i token di un'espressione in un albero compatto di nodi (Predicate).
+    - evaluate_predicate:     valuta un predicato compilato su un record.
+
+  Grammatica supportata:
+    espressione  := and ( OR and )*
+    and          := unario ( [AND] unario )*          (due condizioni vicine senza operatore sono in AND)
+    unario       := NOT unario | ( espressione ) | confronto
+    confronto    := <campo> <operatore> <valore>
+    operatore    := :  =  !=  <  <=  >  >=            (":" è sinonimo di "=")
+
+  Perchè compilare il predicato?
+  Il predicato viene analizzato una volta sola per comando, non una volta per record.
+  Durante la compilazione:
+    ✅ ogni colonna viene risolta nel suo offset all'interno del record (tramite il RecordLayout);
+    ✅ ogni costante viene già convertita nel tipo della colonna con la sua ConvertFunc;
+    ✅ i figli di AND e OR vengono ordinati dal più economico al più costoso, così la valutazione
+       si ferma il prima possibile (short-circuit) spendendo il meno possibile.
+  In questo modo, valutare un filtro complesso su un record costa poco più di un singolo confronto.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strlen, memcpy, strncmp
+#include <ctype.h>                  // Funzioni per la manipolazione dei caratteri: isspace
+
+#include "predicate.h"
+#include "schema.h"
+#include "arena.h"
+#include "utils.h"
+
+
+typedef enum {                                  // Tipologie di lessemi di un'espressione
+  LEX_WORD,
+  LEX_STRING,
+  LEX_LPAREN,
+  LEX_RPAREN,
+  LEX_CMP,
+  LEX_AND,
+  LEX_OR,
+  LEX_NOT,
+  LEX_END,
+  LEX_ERROR
+} LexType;
+
+typedef struct {                                // Lessema corrente dell'espressione
+  LexType type;
+  CompareOp cmp;                                // Operatore, solo per LEX_CMP
+  char text[256];                               // Testo del lessema (senza apici per le stringhe)
+} Lexeme;
+
+typedef struct {                                // Stato del parser durante la compilazione
+  const RecordLayout *layout;
+  Predicate *pred;
+  const char *text;
+  size_t pos;
+  Lexeme current;
+  int depth;                                    // Parentesi e NOT aperti: ognuno è una ricorsione del parser
+  bool error;
+} PredicateParser;
+
+
+static int parse_or(PredicateParser *parser);
+
+
+/**
+ * Funzione che legge il prossimo lessema dell'espressione.
+ * Le stringhe possono essere racchiuse tra apici singoli o doppi, e il carattere \ permette di inserire un apice nella stringa.
+ */
+static void next_lexeme(PredicateParser *parser) {
+  const char *s = parser->text;
+  Lexeme *lex = &parser->current;
+
+  while (isspace((unsigned char)s[parser->pos])) { parser->pos++; }
+
+  lex->text[0] = '\0';
+  char c = s[parser->pos];
+
+  if (c == '\0') { lex->type = LEX_END; return; }
+  if (c == '(')  { lex->type = LEX_LPAREN; parser->pos++; return; }
+  if (c == ')')  { lex->type = LEX_RPAREN; parser->pos++; return; }
+
+  if (c == ':' || c == '=' || c == '!' || c == '<' || c == '>') {
+    char n = s[parser->pos + 1];
+    lex->type = LEX_CMP;
+    parser->pos++;
+
+    if (c == ':' || c == '=') { lex->cmp = CMP_EQ; return; }
+    if (c == '!' && n == '=') { lex->cmp = CMP_NE; parser->pos++; return; }
+    if (c == '<' && n == '=') { lex->cmp = CMP_LE; parser->pos++; return; }
+    if (c == '>' && n == '=') { lex->cmp = CMP_GE; parser->pos++; return; }
+    if (c == '<' && n == '>') { lex->cmp = CMP_NE; parser->pos++; return; }
+    if (c == '<')             { lex->cmp = CMP_LT; return; }
+    if (c == '>')             { lex->cmp = CMP_GT; return; }
+
+    lex->type = LEX_ERROR;                                                  // Un '!' da solo non è un operatore
+    return;
+  }
+
+  size_t len = 0;
+
+  if (c == '\'' || c == '"') {                                              // Stringa tra apici
+    char quote = c;
+    parser->pos++;
+
+    while (s[parser->pos] != '\0' && s[parser->pos] != quote) {
+      if (s[parser->pos] == '\\' && s[parser->pos + 1] != '\0') { parser->pos++; }
+      if (len < sizeof(lex->text) - 1) { lex->text[len++] = s[parser->pos]; }
+      parser->pos++;
+    }
+
+    if (s[parser->pos] != quote) {
+      printf("❌ Errore: stringa non terminata nel predicato\n");
+      lex->type = LEX_ERROR;
+      return;
+    }
+
+    parser->pos++;
+    lex->text[len] = '\0';
+    lex->type = LEX_STRING;
+    return;
+  }
+
+  while (s[parser->pos] != '\0' && !isspace((unsigned char)s[parser->pos]) && strchr("():=!<>'\"", s[parser->pos]) == NULL) {
+    if (len < sizeof(lex->text) - 1) { lex->text[len++] = s[parser->pos]; }
+    parser->pos++;
+  }
+  lex->text[len] = '\0';
+
+  if      (strcmp(lex->text, "AND") == SUCCESS) { lex->type = LEX_AND; }
+  else if (strcmp(lex->text, "OR")  == SUCCESS) { lex->type = LEX_OR; }
+  else if (strcmp(lex->text, "NOT") == SUCCESS) { lex->type = LEX_NOT; }
+  else                                          { lex->type = LEX_WORD; }
+}
+
+
+/**
+ * Funzione che alloca un nuovo nodo nel predicato.
+ * @return L'indice del nodo, -1 se i nodi sono finiti
+ */
+static int new_node(PredicateParser *parser, PredicateOp op) {
+  Predicate *pred = parser->pred;
+
+  if (pred->num_nodi >= MAX_PREDICATE_NODES) {
+    printf("❌ Errore: il predicato è troppo complesso (massimo %d condizioni)\n", MAX_PREDICATE_NODES);
+    parser->error = true;
+    return -1;
+  }
+
+  PredicateNode *node = &pred->nodi[pred->num_nodi];
+  memset(node, 0, sizeof(PredicateNode));
+  node->op = op;
+  node->first_child = -1;
+
+  return pred->num_nodi++;
+}
+
+
+/**
+ * Funzione che crea un nodo AND oppure OR a partire dai suoi figli.
+ * I figli vengono copiati in modo contiguo nell'array children e ordinati per costo crescente:
+ * durante la valutazione si provano prima le condizioni più economiche.
+ */
+static int new_group_node(PredicateParser *parser, PredicateOp op, int *children, int count) {
+  if (count == 1) { return children[0]; }                                  // Un gruppo con un solo figlio è il figlio stesso
+
+  Predicate *pred = parser->pred;
+  int index = new_node(parser, op);
+  if (index < 0) { return -1; }
+
+  PredicateNode *node = &pred->nodi[index];
+  node->first_child = pred->num_children;
+  node->num_children = count;
+
+  for (int i = 0; i < count; i++) {
+    int child = children[i];
+    int j = pred->num_children + i;
+
+    // Insertion sort sul costo: l'espressione ha pochi figli, non serve nulla di più
+    while (j > node->first_child && pred->nodi[pred->children[j - 1]].cost > pred->nodi[child].cost) {
+      pred->children[j] = pred->children[j - 1];
+      j--;
+    }
+    pred->children[j] = child;
+    node->cost += pred->nodi[child].cost;
+  }
+
+  pred->num_children += count;
+  return index;
+}
+
+
+/**
+ * Funzione che compila un confronto <campo> <operatore> <valore>.
+ * La colonna viene risolta nel suo offset e la costante viene convertita con la ConvertFunc della colonna.
+ */
+static int parse_comparison(PredicateParser *parser) {
+  if (parser->current.type != LEX_WORD) {
+    printf("❌ Errore: nel predicato è atteso il nome di un campo\n");
+    parser->error = true;
+    return -1;
+  }
+
+  int col_index = get_layout_column_index(parser->layout, parser->current.text);
+  if (col_index < 0) {
+    printf("❌ Errore: il campo '%s' non esiste\n", parser->current.text);
+    parser->error = true;
+    return -1;
+  }
+  const LayoutColumn *col = &parser->layout->colonne[col_index];
+
+  next_lexeme(parser);
+  if (parser->current.type != LEX_CMP) {
+    printf("❌ Errore: operatore mancante dopo il campo '%s'\n", col->nome);
+    parser->error = true;
+    return -1;
+  }
+  CompareOp cmp = parser->current.cmp;
+
+  next_lexeme(parser);
+  if (parser->current.type != LEX_WORD && parser->current.type != LEX_STRING) {
+    printf("❌ Errore: valore mancante per il campo '%s'\n", col->nome);
+    parser->error = true;
+    return -1;
+  }
+
+  Predicate *pred = parser->pred;
+  if (pred->pool_used + col->tipo.length > PREDICATE_POOL_SIZE) {
+    printf("❌ Errore: troppe costanti nel predicato\n");
+    parser->error = true;
+    return -1;
+  }
+
+  char *constant = pred->pool + pred->pool_used;
+  memset(constant, 0, col->tipo.length);
+  if (!col->tipo.convert || !convert_column_value(col, parser->current.text, constant)) {   // Le costanti del pool non sono allineate
+    printf("❌ Errore: il valore '%s' non è valido per il campo '%s' (%s)\n", parser->current.text, col->nome, col->tipo.name);
+    parser->error = true;
+    return -1;
+  }
+
+  int index = new_node(parser, PRED_CMP);
+  if (index < 0) { return -1; }
+
+  PredicateNode *node = &pred->nodi[index];
+  node->cmp = cmp;
+  node->kind = col->kind;
+  node->offset = col->offset;
+  node->length = col->tipo.length;
+  node->constant = (int)pred->pool_used;
+  node->cost = (col->kind == KIND_CHAR) ? 4 : 1;                            // Confrontare stringhe costa più che confrontare numeri
+
+  pred->pool_used += col->tipo.length;
+
+  next_lexeme(parser);
+  return index;
+}
+
+
+static int parse_unary(PredicateParser *parser) {
+  if (parser->current.type == LEX_NOT || parser->current.type == LEX_LPAREN) {   // La ricorsione non deve finire lo stack
+    if (parser->depth >= MAX_PREDICATE_DEPTH) {
+      printf("❌ Errore: il predicato è troppo complesso (massimo %d parentesi o NOT annidati)\n", MAX_PREDICATE_DEPTH);
+      parser->error = true;
+      return -1;
+    }
+  }
+
+  if (parser->current.type == LEX_NOT) {
+    next_lexeme(parser);
+
+    parser->depth++;
+    int child = parse_unary(parser);
+    parser->depth--;
+    if (child < 0) { return -1; }
+
+    int index = new_node(parser, PRED_NOT);
+    if (index < 0) { return -1; }
+
+    Predicate *pred = parser->pred;
+    pred->nodi[index].first_child = pred->num_children;
+    pred->nodi[index].num_children = 1;
+    pred->nodi[index].cost = pred->nodi[child].cost;
+    pred->children[pred->num_children++] = child;
+    return index;
+  }
+
+  if (parser->current.type == LEX_LPAREN) {
+    next_lexeme(parser);
+
+    parser->depth++;
+    int index = parse_or(parser);
+    parser->depth--;
+    if (index < 0) { return -1; }
+
+    if (parser->current.type != LEX_RPAREN) {
+      printf("❌ Errore: parentesi non chiusa nel predicato\n");
+      parser->error = true;
+      return -1;
+    }
+
+    next_lexeme(parser);
+    return index;
+  }
+
+  return parse_comparison(parser);
+}
+
+
+static int parse_and(PredicateParser *parser) {
+  int children[MAX_PREDICATE_NODES];
+  int count = 0;
+
+  while (true) {
+    int child = parse_unary(parser);
+    if (child < 0) { return -1; }
+    children[count++] = child;
+
+    if (parser->current.type == LEX_AND) {
+      next_lexeme(parser);
+      continue;
+    }
+
+    // Due condizioni vicine senza operatore sono in AND: FIND Utente nome:'Luca' eta:32
+    LexType t = parser->current.type;
+    if (t == LEX_WORD || t == LEX_LPAREN || t == LEX_NOT) { continue; }
+
+    break;
+  }
+
+  return new_group_node(parser, PRED_AND, children, count);
+}
+
+
+static int parse_or(PredicateParser *parser) {
+  int children[MAX_PREDICATE_NODES];
+  int count = 0;
+
+  while (true) {
+    int child = parse_and(parser);
+    if (child < 0) { return -1; }
+    children[count++] = child;
+
+    if (parser->current.type != LEX_OR) { break; }
+    next_lexeme(parser);
+  }
+
+  return new_group_node(parser, PRED_OR, children, count);
+}
+
+
+/**
+ * Funzione che compila un predicato a partire dai token del comando.
+ * I token vengono riuniti in un'unica espressione, così le parentesi e gli operatori possono essere attaccati ai campi: (totale>100
+ * Se non ci sono token, il predicato è vuoto ed è sempre vero.
+ *
+ * @param layout Il layout del record su cui verrà valutato il predicato
+ * @param tokens I token dell'espressione
+ * @param token_count Il numero di token
+ * @param pred Il predicato da valorizzare
+ * @return SUCCESS se la compilazione è andata a buon fine, FAILURE altrimenti
+ */
+int compile_predicate(const RecordLayout *layout, char *tokens[], int token_count, Predicate *pred) {
+  pred->num_nodi = 0;
+  pred->num_children = 0;
+  pred->pool_used = 0;
+  pred->root = -1;
+
+  if (token_count <= 0) { return SUCCESS; }
+
+  size_t total = 1;
+  for (int i = 0; i < token_count; i++) { total += strlen(tokens[i]) + 1; }
+
+  char *text = arena_alloc(total);                                // Serve solo durante la compilazione
+  if (!text) { return FAILURE; }
+
+  text[0] = '\0';
+  for (int i = 0; i < token_count; i++) {
+    if (i > 0) { strcat(text, " "); }
+    strcat(text, tokens[i]);
+  }
+
+  PredicateParser parser = { .layout = layout, .pred = pred, .text = text, .pos = 0, .depth = 0, .error = false };
+  next_lexeme(&parser);
+
+  int root = parse_or(&parser);
+
+  if (root >= 0 && parser.current.type != LEX_END) {
+    printf("❌ Errore: il predicato contiene elementi non validi dopo la fine dell'espressione\n");
+    root = -1;
+  }
+
+  if (root < 0) { return FAILURE; }
+
+  pred->root = root;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che confronta il valore di un campo del record con la costante del nodo.
+ * @return un numero negativo, zero o positivo come strcmp
+ */
+static int compare_field(const PredicateNode *node, const char *field, const char *constant) {
+  switch (node->kind) {
+    case KIND_INT: {
+      int a, b;
+      memcpy(&a, field, sizeof(int));
+      memcpy(&b, constant, sizeof(int));
+      return (a > b) - (a < b);
+    }
+    case KIND_FLOAT: {
+      float a, b;
+      memcpy(&a, field, sizeof(float));
+      memcpy(&b, constant, sizeof(float));
+      return (a > b) - (a < b);
+    }
+    case KIND_DOUBLE: {
+      double a, b;
+      memcpy(&a, field, sizeof(double));
+      memcpy(&b, constant, sizeof(double));
+      return (a > b) - (a < b);
+    }
+    case KIND_TIMESTAMP: {
+      long a, b;
+      memcpy(&a, field, sizeof(long));
+      memcpy(&b, constant, sizeof(long));
+      return (a > b) - (a < b);
+    }
+    case KIND_BOOL:
+      return (int)(unsigned char)field[0] - (int)(unsigned char)constant[0];
+    case KIND_CHAR:
+      return strncmp(field, constant, node->length);
+    default:
+      return memcmp(field, constant, node->length);
+  }
+}
+
+
+static bool evaluate_node(const Predicate *pred, int index, const char *record) {
+  const PredicateNode *node = &pred->nodi[index];
+  const int *children = pred->children + node->first_child;
+
+  switch (node->op) {
+    case PRED_AND:
+      for (int i = 0; i < node->num_children; i++) {
+        if (!evaluate_node(pred, children[i], record)) { return false; }   // Basta una condizione falsa
+      }
+      return true;
+
+    case PRED_OR:
+      for (int i = 0; i < node->num_children; i++) {
+        if (evaluate_node(pred, children[i], record)) { return true; }     // Basta una condizione vera
+      }
+      return false;
+
+    case PRED_NOT:
+      return !evaluate_node(pred, children[0], record);
+
+    case PRED_CMP: {
+      int c = compare_field(node, record + node->offset, pred->pool + node->constant);
+      switch (node->cmp) {
+        case CMP_EQ: return c == 0;
+        case CMP_NE: return c != 0;
+        case CMP_LT: return c < 0;
+        case CMP_LE: return c <= 0;
+        case CMP_GT: return c > 0;
+        case CMP_GE: return c >= 0;
+      }
+      return false;
+    }
+  }
+
+  return false;
+}
+
+
+/**
+ * Funzione che valuta un predicato compilato su un record.
+ * @param pred Il predicato compilato
+ * @param record Il buffer del record, con la disposizione descritta dal layout usato in compilazione
+ * @return true se il record soddisfa il predicato
+ */
+bool evaluate_predicate(const Predicate *pred, const char *record) {
+  if (pred->root < 0) { return true; }                                      // Predicato vuoto: ogni record va bene
+  return evaluate_node(pred, pred->root, record);
+}
@@ -0,0 +1,14 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Predicate
+int compile_predicate(const RecordLayout *layout, char *tokens[], int token_count, Predicate *pred);
+bool evaluate_predicate(const Predicate *pred, const char *record);
+
+
+
+#endif
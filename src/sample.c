@@ -0,0 +1,175 @@
+/*
+
+
+  Sample.c è il file che si occupa del campionamento a blocchi (SAMPLE) e delle stime calcolate su un campione.
+  Le funzioni descritte in questo file sono:
+    - parse_sample_clause:    interpreta la clausola SAMPLE <n>% [SEED <s>].
+    - next_sample_random:     genera un numero casuale in [0, 1) a partire da un seme (splitmix64).
+    - print_sample_summary:   stampa quanti blocchi sono stati letti e con quale seme.
+    - add_sample_block:       aggiunge i valori di un blocco letto alle somme che servono per le stime.
+    - print_sample_estimate:  stampa il risultato stimato di un'aggregazione, con il suo intervallo di confidenza al 95%.
+
+  Perchè a blocchi e non a record?
+  Leggere un record ogni cento costa quasi come leggere tutta la tabella, perchè il disco legge comunque pagine intere.
+  Leggendo invece dei blocchi interi (SAMPLE_BLOCK_BYTES, vedi scan.c) si legge davvero solo la percentuale richiesta.
+
+  Stime:
+  I blocchi sono scelti in modo casuale semplice, senza ripetizione: m blocchi su N.
+  Tutte le stime sono stimatori a rapporto, che sfruttano un totale noto della tabella:
+    - COUNT e SUM: (somma dei totali dei blocchi letti / record letti) · record della tabella.
+      Il numero di record della tabella si conosce dalla dimensione del file, meno i record eliminati (vedi tombstone.c),
+      così l'ultimo blocco (più corto) non falsa la stima, e un COUNT(*) senza filtro risulta esatto.
+      Anche i record letti sono solo quelli rimasti: un blocco con tanti record eliminati pesa meno degli altri.
+    - AVG: somma dei valori / numero di valori non NULL nei blocchi letti.
+  Per un rapporto R = Σy / Σx la varianza è circa
+      (1 - m/N) · s² / (m · x̄²)      con s² la varianza degli scarti y - R·x dei blocchi e x̄ la media di x.
+  L'intervallo di confidenza al 95% è ±1.96 deviazioni standard. Se tutti i blocchi sono stati letti vale 0,
+  se ne è stato letto uno solo (su più di uno) non si può stimare e non viene stampato.
+
+  Il seme:
+  Con SEED <s> si sceglie il seme del generatore, e la stessa query restituisce sempre lo stesso campione.
+  Senza SEED il seme viene scelto a caso, e viene stampato insieme al campione per poterlo ripetere.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: strtod, strtoull
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: strcmp, strlen
+#include <time.h>                   // time
+#include <unistd.h>                 // getpid
+#include <math.h>                   // sqrt
+
+#include "sample.h"
+#include "aggregate.h"
+#include "output.h"
+
+
+/**
+ * Funzione che interpreta la clausola SAMPLE <n>% [SEED <s>], a partire dal token SAMPLE.
+ * Il simbolo % è facoltativo: SAMPLE 5% e SAMPLE 5 sono equivalenti.
+ *
+ * @param tokens Array di token
+ * @param start La posizione del token SAMPLE
+ * @param token_count Numero di token
+ * @param sample Il campionamento da valorizzare
+ * @return Il numero di token usati dalla clausola, -1 se la clausola non è valida
+ */
+int parse_sample_clause(char *tokens[], int start, int token_count, SampleSpec *sample) {
+  if (start + 1 >= token_count || strcmp(tokens[start], "SAMPLE") != SUCCESS) {
+    printf("❌ Errore: sintassi non valida. Usa SAMPLE <n>%% [SEED <s>]\n");
+    return -1;
+  }
+
+  char *endptr;
+  double percent = strtod(tokens[start + 1], &endptr);
+  if (endptr == tokens[start + 1] || (*endptr != '\0' && strcmp(endptr, "%") != SUCCESS) || percent <= 0 || percent > 100) {
+    printf("❌ Errore: la percentuale di SAMPLE deve essere un numero maggiore di 0 e al massimo 100\n");
+    return -1;
+  }
+
+  sample->enabled = true;
+  sample->percent = percent;
+  sample->seed = ((unsigned long long)time(NULL) << 16) ^ (unsigned long long)getpid();   // Seme casuale, viene stampato
+
+  if (start + 2 < token_count && strcmp(tokens[start + 2], "SEED") == SUCCESS) {
+    if (start + 3 >= token_count) {
+      printf("❌ Errore: manca il valore di SEED\n");
+      return -1;
+    }
+
+    sample->seed = strtoull(tokens[start + 3], &endptr, 10);
+    if (*endptr != '\0' || tokens[start + 3][0] == '-') {
+      printf("❌ Errore: SEED deve essere un numero intero non negativo\n");
+      return -1;
+    }
+    return 4;
+  }
+
+  return 2;
+}
+
+
+/**
+ * Funzione che genera un numero casuale in [0, 1) e fa avanzare lo stato del generatore (splitmix64).
+ * È veloce, ha un buon mescolamento dei bit anche partendo da semi piccoli come 1, 2, 3, e con lo stesso stato
+ * produce sempre la stessa sequenza su qualunque macchina, a differenza di rand().
+ */
+double next_sample_random(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return (double)(z >> 11) * (1.0 / 9007199254740992.0);                  // 53 bit casuali, come la mantissa di un double
+}
+
+
+/**
+ * Funzione che stampa quanti blocchi vengono letti e con quale seme, se la scansione è campionata.
+ * Come il titolo del risultato, non viene stampato con OUTPUT CSV e JSON.
+ */
+void print_sample_summary(const TableScan *scan) {
+  if (!scan->sampling) { return; }
+
+  output_title("🎲 Campione: %ld blocchi su %ld (%ld record per blocco, %ld record in tutto), SEED %llu\n",
+         scan->wanted_blocks, scan->total_blocks, scan->block_records, scan->total_records, scan->sample_seed);
+}
+
+
+/**
+ * Funzione che aggiunge un blocco letto alle somme che servono per le stime.
+ *
+ * @param y Il totale del blocco (conteggio per COUNT, somma per SUM e AVG)
+ * @param n I valori non NULL del blocco (serve per AVG)
+ * @param rows I record del blocco (servono per COUNT e SUM)
+ */
+void add_sample_block(SampleMoments *moments, double y, double n, double rows) {
+  moments->blocks++;
+  moments->sum_y += y;
+  moments->sum_yy += y * y;
+  moments->sum_n += n;
+  moments->sum_nn += n * n;
+  moments->sum_yn += y * n;
+  moments->sum_r += rows;
+  moments->sum_rr += rows * rows;
+  moments->sum_yr += y * rows;
+}
+
+
+/**
+ * Funzione che calcola la varianza dello stimatore a rapporto R = Σy / Σx.
+ * @return La varianza, -1 se non si può stimare
+ */
+static double ratio_variance(double sum_y, double sum_yy, double sum_x, double sum_xx, double sum_xy, long blocks, long total_blocks) {
+  if (blocks >= total_blocks) { return 0; }                               // Letti tutti i blocchi: il valore è esatto
+  if (blocks < 2 || sum_x <= 0) { return -1; }
+
+  double m = (double)blocks;
+  double ratio = sum_y / sum_x;
+  double mean_x = sum_x / m;
+  double s2 = (sum_yy - 2 * ratio * sum_xy + ratio * ratio * sum_xx) / (m - 1);   // Varianza degli scarti y - R·x
+  double variance = (1.0 - m / (double)total_blocks) * s2 / (m * mean_x * mean_x);
+
+  return variance > 0 ? variance : 0;
+}
+
+
+/**
+ * Funzione che stampa il risultato di un'aggregazione calcolata su una scansione campionata,
+ * riportato all'intera tabella e con il suo intervallo di confidenza al 95%.
+ */
+void print_sample_estimate(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state, const SampleMoments *moments, const TableScan *scan) {
+  double rows = (double)scan->total_records;
+  double scale = scan->sampled_records > 0 ? rows / (double)scan->sampled_records : 0;
+  double half_width = -1;
+
+  if (spec->func == AGG_AVG) {
+    double variance = ratio_variance(moments->sum_y, moments->sum_yy, moments->sum_n, moments->sum_nn, moments->sum_yn, moments->blocks, scan->total_blocks);
+    if (variance >= 0) { half_width = 1.96 * sqrt(variance); }
+  } else if (spec->func == AGG_COUNT || spec->func == AGG_SUM) {
+    double variance = ratio_variance(moments->sum_y, moments->sum_yy, moments->sum_r, moments->sum_rr, moments->sum_yr, moments->blocks, scan->total_blocks);
+    if (variance >= 0) { half_width = 1.96 * rows * sqrt(variance); }
+  }
+
+  print_aggregate_estimate(layout, spec, state, scale, half_width);
+}
@@ -0,0 +1,28 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdint.h>
+
+// Config Header
+#include "../config.h"
+#include "scan.h"
+
+
+typedef struct {                                // SampleMoments: somme sui blocchi letti, per stimare un'aggregazione e la sua varianza
+  long blocks;                                  // blocks: blocchi letti
+  double sum_y, sum_yy;                         // sum_y / sum_yy: somma dei totali dei blocchi (y) e dei loro quadrati
+  double sum_n, sum_nn, sum_yn;                 // sum_n / sum_nn / sum_yn: valori non NULL per blocco (n), per AVG
+  double sum_r, sum_rr, sum_yr;                 // sum_r / sum_rr / sum_yr: record per blocco (r), per COUNT e SUM
+} SampleMoments;
+
+
+// Functions Available including the Sample
+int parse_sample_clause(char *tokens[], int start, int token_count, SampleSpec *sample);
+double next_sample_random(uint64_t *state);
+void print_sample_summary(const TableScan *scan);
+void add_sample_block(SampleMoments *moments, double y, double n, double rows);
+void print_sample_estimate(const RecordLayout *layout, const AggregateSpec *spec, const AggregateState *state, const SampleMoments *moments, const TableScan *scan);
+
+
+
+#endif
@@ -0,0 +1,452 @@
+/* 
+
+
+  Scan.c è il file che si occupa di leggere i record di una tabella in modo sequenziale.
+  Invece di leggere un record alla volta con una fread per riga, legge tanti record insieme (un "batch")
+  in un buffer riutilizzato per tutta la scansione.
+
+  Le funzioni descritte in questo file sono:
+    - open_table_scan:      prepara la scansione di una tabella.
+    - open_file_scan:       prepara la scansione di un file temporaneo che contiene record (ad esempio un file di spill).
+    - read_scan_batch:      legge il prossimo batch di record e ritorna quanti record contiene.
+    - read_scan_batch_backward: legge il batch precedente, per scansionare la tabella dalla fine verso l'inizio.
+    - close_table_scan:     libera le risorse della scansione.
+    - seek_table_scan:      sposta la scansione su un record preciso.
+    - count_table_records:  ottiene il numero di record della tabella dalla dimensione del file.
+    - count_live_records:   come count_table_records, senza contare i record eliminati.
+    - get_scan_record_position: ottiene la posizione nel file di un record del batch.
+    - find_position_after_id: trova il primo record con id maggiore di un id dato, senza leggere tutta la tabella.
+    - read_record_at:       legge un singolo record in una posizione precisa (ad esempio dopo un ordinamento o una ricerca per id).
+    - set_scan_sample:      limita la scansione a un campione casuale di blocchi (SAMPLE).
+    - set_scan_id_range:    limita la scansione ai record con id in un intervallo (vedi planner.c).
+
+  Chi usa la scansione lavora direttamente sui record presenti in scan->buffer:
+  il record i-esimo del batch si trova a scan->buffer + i * scan->record_size.
+
+  Campionamento:
+  Con set_scan_sample la tabella viene divisa in blocchi di circa SAMPLE_BLOCK_BYTES (sempre un numero intero di record)
+  e ogni read_scan_batch restituisce il prossimo blocco scelto, saltando gli altri senza leggerli.
+  I blocchi vengono scelti con il metodo di selezione sequenziale (Knuth, algoritmo S): si leggono esattamente
+  wanted_blocks blocchi, tutti con la stessa probabilità, e sempre in avanti nel file.
+  Il generatore casuale parte dal seme della query, quindi con lo stesso seme si ottiene sempre lo stesso campione.
+
+  Intervallo di id:
+  Con set_scan_id_range la scansione parte dal primo record con id >= low_id (ricerca binaria) e, siccome gli id
+  sono crescenti nel file, si ferma al primo record con id > high_id: l'ultimo batch viene troncato lì.
+
+  Record eliminati:
+  Un record eliminato con DELETE resta nel file, segnato nella mappa tables/<T>.del (vedi tombstone.c).
+  open_table_scan carica la mappa una volta sola, e ogni batch viene compattato togliendo i record eliminati:
+  chi usa la scansione non li vede mai. Se un batch ha perso dei record, il record i-esimo non si trova più
+  in posizione batch_position + i: chi ha bisogno della posizione nel file usa get_scan_record_position.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: fopen, fclose, fread
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memset
+
+#include "scan.h"
+#include "schema.h"
+#include "utils.h"
+#include "sample.h"
+#include "tombstone.h"
+
+
+/**
+ * Funzione che prepara la scansione di una tabella.
+ * Apre il file della tabella e alloca il buffer in cui verranno letti i batch di record.
+ * 
+ * @param table_name Il nome della tabella da scansionare
+ * @param scan La struttura TableScan da valorizzare
+ * @return SUCCESS se la scansione è pronta, FAILURE altrimenti
+ */
+int open_table_scan(const char *table_name, TableScan *scan) {
+  memset(scan, 0, sizeof(TableScan));
+
+  scan->record_size = get_record_size(table_name);
+  if (scan->record_size == 0) {
+    printf("Errore nella determinazione della dimensione del record\n");
+    return FAILURE;
+  }
+
+  FILE *file = open_table_file(table_name, "rb");
+  if (!file) {
+    printf("Errore nell'apertura del file tables/%s\n", table_name);
+    return FAILURE;
+  }
+
+  if (open_file_scan(file, scan->record_size, scan) != SUCCESS) { return FAILURE; }
+
+  if (load_table_tombstones(table_name, scan->file, &scan->deleted, &scan->deleted_bits, &scan->deleted_records) != SUCCESS) {
+    printf("Errore: malloc fallita per la mappa dei record eliminati\n");
+    close_table_scan(scan);
+    return FAILURE;
+  }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che prepara la scansione di un file già aperto che contiene record di dimensione record_size.
+ * La scansione parte dalla posizione corrente del file, e chiudendo la scansione si chiude anche il file.
+ * 
+ * @param file Il file da scansionare
+ * @param record_size La dimensione di un record
+ * @param scan La struttura TableScan da valorizzare
+ * @return SUCCESS se la scansione è pronta, FAILURE altrimenti
+ */
+int open_file_scan(FILE *file, size_t record_size, TableScan *scan) {
+  memset(scan, 0, sizeof(TableScan));
+  scan->file = file;
+  scan->record_size = record_size;
+
+  scan->batch_records = SCAN_BATCH_BYTES / scan->record_size;                 // Quanti record interi entrano in un batch
+  if (scan->batch_records == 0) { scan->batch_records = 1; }
+
+  scan->buffer = malloc(scan->batch_records * scan->record_size);
+  if (!scan->buffer) {
+    printf("Errore: malloc fallita per il buffer di scansione\n");
+    fclose(scan->file);
+    scan->file = NULL;
+    return FAILURE;
+  }
+
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che verifica se il record in una posizione è stato eliminato.
+ */
+static bool is_record_deleted(const TableScan *scan, long position) {
+  return position < scan->deleted_bits && (scan->deleted[position / 8] & (1u << (position % 8)));
+}
+
+
+/**
+ * Funzione che verifica se tra count record a partire da first ce n'è almeno uno eliminato.
+ * Controlla un byte della mappa (8 record) alla volta, così un batch senza record eliminati costa poco.
+ */
+static bool has_deleted_records(const TableScan *scan, long first, long count) {
+  long last = first + count < scan->deleted_bits ? first + count : scan->deleted_bits;
+
+  for (long p = first; p < last; ) {
+    if (p % 8 == 0 && p + 8 <= last) {
+      if (scan->deleted[p / 8]) { return true; }
+      p += 8;
+    } else {
+      if (is_record_deleted(scan, p)) { return true; }
+      p++;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Funzione che toglie dal batch appena letto i record eliminati, spostando i successivi al loro posto.
+ * Per ogni record rimasto si ricorda la posizione nel batch, per get_scan_record_position.
+ * @return Il numero di record rimasti nel batch
+ */
+static size_t skip_deleted_records(TableScan *scan, size_t count) {
+  scan->batch_filtered = false;
+  if (!scan->deleted || !has_deleted_records(scan, scan->batch_position, (long)count)) { return count; }
+
+  if (!scan->positions) {
+    scan->positions = malloc(scan->batch_records * sizeof(uint32_t));
+    if (!scan->positions) {
+      printf("Errore: malloc fallita per il buffer di scansione\n");
+      return 0;
+    }
+  }
+
+  size_t kept = 0;
+  for (size_t r = 0; r < count; r++) {
+    if (is_record_deleted(scan, scan->batch_position + (long)r)) { continue; }
+
+    if (kept != r) { memcpy(scan->buffer + kept * scan->record_size, scan->buffer + r * scan->record_size, scan->record_size); }
+    scan->positions[kept++] = (uint32_t)r;
+  }
+
+  scan->batch_filtered = true;
+  return kept;
+}
+
+
+/**
+ * Funzione che tronca un batch al primo record con id > max_id, con una ricerca binaria nel buffer.
+ * @return Il numero di record del batch con id <= max_id
+ */
+static size_t truncate_batch_at_bound(TableScan *scan, size_t count) {
+  int id;
+  memcpy(&id, scan->buffer + (count - 1) * scan->record_size, sizeof(int));   // L'id è sempre il primo campo del record
+  if (id <= scan->max_id) { return count; }
+
+  size_t low = 0, high = count - 1;                                       // Il record in posizione high ha id > max_id
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    memcpy(&id, scan->buffer + mid * scan->record_size, sizeof(int));
+    if (id > scan->max_id) { high = mid; } else { low = mid + 1; }
+  }
+
+  scan->bound_reached = true;
+  return low;
+}
+
+
+/**
+ * Funzione che legge il prossimo batch di record.
+ * Un eventuale record incompleto alla fine del file viene ignorato.
+ * 
+ * @param scan La scansione in corso
+ * @return Il numero di record letti nel buffer, 0 quando la tabella è finita
+ */
+size_t read_scan_batch(TableScan *scan) {
+  if (!scan->file) { return 0; }
+
+  if (scan->sampling) {
+    while (scan->next_block < scan->total_blocks && scan->taken_blocks < scan->wanted_blocks) {
+      long block = scan->next_block++;
+      double left = (double)(scan->total_blocks - block);                   // Blocchi ancora da considerare, compreso questo
+      double needed = (double)(scan->wanted_blocks - scan->taken_blocks);
+
+      if (next_sample_random(&scan->sample_state) * left >= needed) { continue; }   // Scelto con probabilità needed / left
+
+      scan->taken_blocks++;
+      if (seek_table_scan(scan, block * scan->block_records) != SUCCESS) { return 0; }
+
+      size_t count = fread(scan->buffer, scan->record_size, (size_t)scan->block_records, scan->file);
+      scan->batch_position = scan->next_position;
+      scan->next_position += count;
+
+      size_t kept = skip_deleted_records(scan, count);
+      scan->sampled_records += (long)kept;                                // Solo i record rimasti, come total_records
+      if (kept > 0) { return kept; }                                      // Un blocco di soli record eliminati: passo al prossimo
+    }
+    return 0;
+  }
+
+  while (!scan->bound_reached) {
+    size_t count = fread(scan->buffer, scan->record_size, scan->batch_records, scan->file);
+
+    scan->batch_position = scan->next_position;
+    scan->next_position += count;
+
+    if (scan->bounded && count > 0) { count = truncate_batch_at_bound(scan, count); }
+
+    size_t kept = skip_deleted_records(scan, count);
+    if (kept > 0 || count == 0) { return kept; }                          // Un batch di soli record eliminati non è la fine della tabella
+  }
+  return 0;
+}
+
+
+/**
+ * Funzione che legge il batch di record che precede next_position, per scansionare la tabella al contrario.
+ * Per partire dalla fine della tabella: seek_table_scan(scan, count_table_records(scan)).
+ * I record nel buffer restano nell'ordine del file: chi legge al contrario deve scorrere il batch dall'ultimo record.
+ * 
+ * @param scan La scansione in corso
+ * @return Il numero di record letti nel buffer, 0 quando si è arrivati all'inizio della tabella
+ */
+size_t read_scan_batch_backward(TableScan *scan) {
+  if (!scan->file || scan->next_position <= 0) { return 0; }
+
+  long start = scan->next_position - (long)scan->batch_records;
+  if (start < 0) { start = 0; }
+
+  if (fseek(scan->file, start * (long)scan->record_size, SEEK_SET) != 0) { return 0; }
+  size_t count = fread(scan->buffer, scan->record_size, scan->next_position - start, scan->file);
+
+  scan->batch_position = start;
+  scan->next_position = start;
+
+  return skip_deleted_records(scan, count);
+}
+
+
+/**
+ * Funzione che chiude la scansione e libera il buffer.
+ */
+void close_table_scan(TableScan *scan) {
+  if (scan->file) { fclose(scan->file); }
+  free(scan->buffer);
+  free(scan->deleted);
+  free(scan->positions);
+
+  scan->file = NULL;
+  scan->buffer = NULL;
+  scan->deleted = NULL;
+  scan->positions = NULL;
+}
+
+
+
+/**
+ * Funzione che sposta la scansione su un record preciso.
+ * Il prossimo batch letto inizierà dal record in posizione position (0 = primo record).
+ * 
+ * @return SUCCESS se lo spostamento è riuscito, FAILURE altrimenti
+ */
+int seek_table_scan(TableScan *scan, long position) {
+  if (!scan->file || position < 0) { return FAILURE; }
+
+  if (fseek(scan->file, position * (long)scan->record_size, SEEK_SET) != 0) { return FAILURE; }
+
+  scan->next_position = position;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che ottiene il numero di record della tabella.
+ * Siccome i record hanno tutti la stessa dimensione, basta dividere la dimensione del file per quella del record.
+ * La posizione della scansione non cambia.
+ */
+long count_table_records(TableScan *scan) {
+  if (!scan->file) { return 0; }
+
+  long current = ftell(scan->file);
+  fseek(scan->file, 0, SEEK_END);
+  long file_size = ftell(scan->file);
+  fseek(scan->file, current, SEEK_SET);
+
+  return file_size / (long)scan->record_size;
+}
+
+
+/**
+ * Funzione che ottiene il numero di record della tabella ancora presenti, cioè senza quelli eliminati con DELETE.
+ * Come count_table_records non legge nessun record: il numero di record eliminati è nell'intestazione della mappa.
+ */
+long count_live_records(TableScan *scan) {
+  long live = count_table_records(scan) - scan->deleted_records;
+  return live > 0 ? live : 0;
+}
+
+
+/**
+ * Funzione che ottiene la posizione nel file del record index-esimo dell'ultimo batch letto,
+ * anche se dal batch sono stati tolti dei record eliminati.
+ */
+long get_scan_record_position(const TableScan *scan, size_t index) {
+  return scan->batch_position + (long)(scan->batch_filtered ? scan->positions[index] : index);
+}
+
+
+/**
+ * Funzione che legge l'id del record in una certa posizione.
+ * L'id è sempre il primo campo del record.
+ */
+static int read_id_at(TableScan *scan, long position) {
+  int id = -1;
+  fseek(scan->file, position * (long)scan->record_size, SEEK_SET);
+  if (fread(&id, sizeof(int), 1, scan->file) != 1) { return -1; }
+  return id;
+}
+
+
+/**
+ * Funzione che trova la posizione del primo record con id maggiore di id.
+ * La tabella è un file in cui i record vengono sempre aggiunti in fondo con id crescente:
+ * gli id sono quindi ordinati, e posso usare una ricerca binaria invece di leggere tutto il file.
+ * 
+ * Nel caso comune (nessun buco negli id) il record cercato si trova proprio in posizione id, e basta una lettura.
+ * 
+ * @param scan Una scansione aperta sulla tabella
+ * @param id L'ultimo id già visto
+ * @return La posizione del primo record con id > id (il numero di record se non ce ne sono)
+ */
+long find_position_after_id(TableScan *scan, int id) {
+  long total = count_table_records(scan);
+  long low = 0, high = total;
+
+  if (id < 0) { return 0; }
+
+  // Controllo veloce: con gli id contigui il record id+1 è in posizione id
+  if ((long)id < total && read_id_at(scan, id) > id && (id == 0 || read_id_at(scan, id - 1) <= id)) {
+    return id;
+  }
+
+  while (low < high) {                                                        // Ricerca binaria sul primo id > id
+    long mid = low + (high - low) / 2;
+    if (read_id_at(scan, mid) > id) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+
+  return low;
+}
+
+
+/**
+ * Funzione che legge un singolo record in una posizione precisa, senza toccare il batch corrente.
+ * Un record eliminato non si può leggere.
+ * 
+ * @param scan Una scansione aperta sulla tabella
+ * @param position La posizione del record (0 = primo record)
+ * @param record Il buffer in cui leggere il record, grande scan->record_size
+ * @return SUCCESS se il record è stato letto, FAILURE altrimenti
+ */
+int read_record_at(TableScan *scan, long position, char *record) {
+  if (!scan->file || position < 0 || (scan->deleted && is_record_deleted(scan, position))) { return FAILURE; }
+  if (fseek(scan->file, position * (long)scan->record_size, SEEK_SET) != 0) { return FAILURE; }
+  if (fread(record, scan->record_size, 1, scan->file) != 1) { return FAILURE; }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che limita la scansione a un campione casuale di blocchi della tabella.
+ * Va chiamata subito dopo l'apertura: da qui in avanti read_scan_batch restituisce un blocco scelto alla volta.
+ * Viene letto almeno un blocco, così anche su una tabella piccola il campione non è mai vuoto.
+ * 
+ * @param scan Una scansione appena aperta
+ * @param sample Il campionamento richiesto, se non è attivo la scansione resta completa
+ */
+void set_scan_sample(TableScan *scan, const SampleSpec *sample) {
+  if (!sample->enabled || !scan->file) { return; }
+
+  long total = count_table_records(scan);
+
+  scan->block_records = SAMPLE_BLOCK_BYTES / (long)scan->record_size;
+  if (scan->block_records < 1) { scan->block_records = 1; }
+  if (scan->block_records > (long)scan->batch_records) { scan->block_records = (long)scan->batch_records; }
+
+  scan->total_blocks = (total + scan->block_records - 1) / scan->block_records;
+  double wanted = (double)scan->total_blocks * sample->percent / 100.0;
+  scan->wanted_blocks = (long)wanted;
+  if ((double)scan->wanted_blocks < wanted || scan->wanted_blocks < 1) { scan->wanted_blocks++; }   // Arrotondo per eccesso
+  if (scan->wanted_blocks > scan->total_blocks) { scan->wanted_blocks = scan->total_blocks; }
+
+  scan->sampling = true;
+  scan->sample_seed = sample->seed;
+  scan->sample_state = sample->seed;
+  scan->taken_blocks = 0;
+  scan->next_block = 0;
+  scan->total_records = count_live_records(scan);                         // Le stime si riportano ai record rimasti
+  scan->sampled_records = 0;
+}
+
+
+/**
+ * Funzione che limita la scansione ai record con low_id <= id <= high_id.
+ * Va chiamata subito dopo l'apertura: sposta la scansione sul primo id dell'intervallo,
+ * e read_scan_batch smette di restituire record dopo l'ultimo.
+ *
+ * @param scan Una scansione appena aperta su una tabella
+ * @param low_id Il primo id da leggere
+ * @param high_id L'ultimo id da leggere
+ */
+void set_scan_id_range(TableScan *scan, int low_id, int high_id) {
+  if (!scan->file) { return; }
+
+  seek_table_scan(scan, find_position_after_id(scan, low_id - 1));
+  scan->bounded = true;
+  scan->max_id = high_id;
+  scan->bound_reached = high_id < low_id;
+}
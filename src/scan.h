@@ -0,0 +1,59 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Config Header
+#include "../config.h"
+
+
+typedef struct {                                // TableScan: stato di una scansione sequenziale di una tabella
+  FILE *file;                                   // file: il file tables/<T>.bin aperto in lettura
+  size_t record_size;                           // record_size: dimensione di un record
+  char *buffer;                                 // buffer: contiene i record dell'ultimo batch letto
+  size_t batch_records;                         // batch_records: quanti record entrano nel buffer
+  long next_position;                           // next_position: posizione (in record) del prossimo record da leggere
+  long batch_position;                          // batch_position: posizione (in record) del primo record del batch
+
+  bool sampling;                                // sampling: true se si leggono solo dei blocchi casuali (SAMPLE)
+  unsigned long long sample_seed;               // sample_seed: seme usato, per poter ripetere lo stesso campione
+  uint64_t sample_state;                        // sample_state: stato del generatore casuale
+  long block_records;                           // block_records: record in un blocco campionato
+  long total_blocks;                            // total_blocks: blocchi della tabella
+  long wanted_blocks;                           // wanted_blocks: blocchi da leggere
+  long taken_blocks;                            // taken_blocks: blocchi letti finora
+  long next_block;                              // next_block: prossimo blocco da considerare
+  long total_records;                           // total_records: record della tabella, senza quelli eliminati
+  long sampled_records;                         // sampled_records: record letti nei blocchi del campione, senza quelli eliminati
+
+  bool bounded;                                 // bounded: true se la scansione si ferma dopo un certo id (vedi set_scan_id_range)
+  int max_id;                                   // max_id: ultimo id da restituire
+  bool bound_reached;                           // bound_reached: true quando è stato letto un id oltre max_id
+
+  unsigned char *deleted;                       // deleted: mappa dei record eliminati con DELETE (vedi tombstone.c), NULL se non ce ne sono
+  long deleted_bits;                            // deleted_bits: quanti record descrive la mappa
+  long deleted_records;                         // deleted_records: quanti record sono stati eliminati
+  uint32_t *positions;                          // positions: se il batch ha perso dei record eliminati, la posizione di ogni record rimasto nel batch
+  bool batch_filtered;                          // batch_filtered: true se l'ultimo batch ha perso dei record eliminati
+} TableScan;
+
+
+// Functions Available including the Scan
+int open_table_scan(const char *table_name, TableScan *scan);
+int open_file_scan(FILE *file, size_t record_size, TableScan *scan);
+size_t read_scan_batch(TableScan *scan);
+size_t read_scan_batch_backward(TableScan *scan);
+void close_table_scan(TableScan *scan);
+int seek_table_scan(TableScan *scan, long position);
+long count_table_records(TableScan *scan);
+long count_live_records(TableScan *scan);
+long get_scan_record_position(const TableScan *scan, size_t index);
+long find_position_after_id(TableScan *scan, int id);
+int read_record_at(TableScan *scan, long position, char *record);
+void set_scan_sample(TableScan *scan, const SampleSpec *sample);
+void set_scan_id_range(TableScan *scan, int low_id, int high_id);
+
+
+
+#endif
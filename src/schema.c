@@ -5,6 +5,9 @@
 #include <ctype.h>                  // Funzioni per la manipolazione dei caratteri: isalpha, isdigit
 
 #include "schema.h"
+#include "utils.h"
+#include "wal.h"
+#include "transaction.h"
 
 
 Schema schema = { .tabelle = { 0 }, .num_tabelle = 0, .mutex = PTHREAD_MUTEX_INITIALIZER };   // Inizializzo la variabile globale schema
@@ -13,9 +16,13 @@ Schema schema = { .tabelle = { 0 }, .num_tabelle = 0, .mutex = PTHREAD_MUTEX_INI
   Questo metodo si occupa di caricare il file che contiene lo schema di tutte le tabelle definite dall'utente.
   Se il file non esiste, viene creato uno schema vuoto.
   Se il file esiste, carica lo schema dal file.
+  Prima di leggerlo riapplica le modifiche rimaste nel log da un'esecuzione interrotta (vedi wal.c): schema e tabelle
+  tornano come dopo l'ultimo comando confermato.
   @return 1 se il caricamento è avvenuto con successo, 0 altrimenti
 */
 int load_schema() {
+  if (wal_recover() != SUCCESS) { return FAILURE; }
+
   printf("carico lo schema...\n");
 
   FILE *file = fopen(SCHEMA_FILE, "rb");
@@ -34,6 +41,7 @@ int load_schema() {
       fclose(file);
       return FAILURE;
     }
+    fclose(file);
   }
 
   return SUCCESS;
@@ -79,6 +87,11 @@ int add_table_to_schema(TableDefinition* new_table) {
 
   pthread_mutex_unlock(&schema.mutex);
 
+  if (in_transaction()) {                                         // Dentro una transazione lo schema viene scritto al COMMIT
+    stage_schema_change();
+    return SUCCESS;
+  }
+
   int result = write_schema_to_file();                            // Scrivo lo schema nel file
 
   if(result != SUCCESS) {
@@ -162,18 +175,20 @@ int remove_table_from_schema(const char* table_name) {
 
 /** 
   Questo metodo si occupa di scrivere lo schema nel file.
+  Lo schema passa dal log (vedi wal.c): il file viene riscritto solo quando il nuovo schema è durevole,
+  e un crash a metà della scrittura viene riparato al prossimo avvio.
   @return 1 se la scrittura è avvenuta con successo, 0 altrimenti
 */
 int write_schema_to_file() {
-  FILE *file = fopen(SCHEMA_FILE, "wb");
-  if (file == NULL) {
-    printf("Errore nell'aprire il file schema per la scrittura\n");
+  WalTransaction txn;
+  wal_begin(&txn);
+  wal_log_schema(&txn, &schema);
+
+  if (wal_commit(&txn) != SUCCESS) {
+    printf("Errore nello scrivere il file schema\n");
     return FAILURE;
   }
-
-  fwrite(&schema, sizeof(Schema), 1, file);
-  fclose(file);
-  return SUCCESS;
+  return SUCCESS;                                                 // Il commit ha già cambiato la versione dello schema
 }
 
 /** 
@@ -195,22 +210,37 @@ void print_schema() {
 }
 
 
-void* create_table_record_struct(const char* table_name) {
+/**
+ * Questa funzione restituisce il buffer per un record di una tabella, azzerato.
+ * Ogni tabella ha il suo buffer, allocato la prima volta che serve e riutilizzato da tutti i comandi successivi:
+ * non va liberato, e resta valido finché non si chiede di nuovo il buffer della stessa tabella.
+ * Se la tabella viene ridefinita con un record più grande, il buffer viene ingrandito.
+ *
+ * @param table_name Il nome della tabella
+ * @return Il buffer, NULL se la tabella non esiste o la memoria non basta
+ */
+char* get_table_record_buffer(const char* table_name) {
+  static char* buffers[MAX_TABLES];
+  static size_t sizes[MAX_TABLES];
+
   TableDefinition* table = get_table_from_schema(table_name);
   if (!table) { return NULL; }
 
-  size_t record_size = get_record_size(table_name);  // Calcolo la dimensione totale
-  void* record = malloc(record_size);               // Allocazione unica
-  if (!record) { return NULL; }
-
-  memset(record, 0, record_size);  // Inizializza la memoria a 0 (per evitare dati sporchi)
-
-  return record;
-}
+  int index = (int)(table - schema.tabelle);
+  size_t record_size = get_record_size(table_name);
 
+  if (sizes[index] < record_size) {
+    char* grown = realloc(buffers[index], record_size);
+    if (!grown) {
+      printf("Errore: malloc fallita per il record della tabella %s\n", table_name);
+      return NULL;
+    }
+    buffers[index] = grown;
+    sizes[index] = record_size;
+  }
 
-void free_table_record_struct(void* record) {
-  free(record);
+  memset(buffers[index], 0, record_size);  // Inizializza la memoria a 0 (per evitare dati sporchi)
+  return buffers[index];
 }
 
 
@@ -232,3 +262,62 @@ size_t get_record_size(const char* table_name) {
 
   return record_size;
 }
+
+
+
+/** 
+ * Questa funzione costruisce il layout di un record a partire dalla definizione della tabella.
+ * Per ogni colonna calcola una volta sola l'offset all'interno del record e la sua tipologia interna (ColumnKind).
+ * Chi deve leggere tanti record (FIND, READ, ...) usa il layout invece di ricalcolare gli offset per ogni riga.
+ * 
+ * Se viene passato un prefix (ad esempio "Utente"), i nomi delle colonne vengono qualificati: "Utente.nome".
+ * Se il layout contiene già delle colonne, quelle nuove vengono aggiunte in coda (utile per affiancare due tabelle).
+ * 
+ * @param table La tabella di cui costruire il layout
+ * @param prefix Il prefisso da aggiungere al nome delle colonne, NULL per non qualificarle
+ * @param layout Il layout da valorizzare
+ * @return SUCCESS se il layout è stato costruito, FAILURE altrimenti
+ */
+int build_record_layout(TableDefinition* table, const char* prefix, RecordLayout* layout) {
+  if (!table || !layout) { return FAILURE; }
+
+  if (layout->num_colonne + table->num_colonne > MAX_LAYOUT_COLUMNS) {
+    printf("❌ Errore: troppe colonne nel layout del record\n");
+    return FAILURE;
+  }
+
+  for (int i = 0; i < table->num_colonne; i++) {
+    LayoutColumn *col = &layout->colonne[layout->num_colonne];
+
+    if (prefix) {
+      snprintf(col->nome, sizeof(col->nome), "%s.%s", prefix, table->colonne[i].nome_colonna);
+    } else {
+      snprintf(col->nome, sizeof(col->nome), "%s", table->colonne[i].nome_colonna);
+    }
+
+    col->tipo = table->colonne[i].tipo;
+    col->kind = get_column_kind(col->tipo);
+    col->offset = layout->record_size;                              // La colonna inizia dove finisce quella precedente
+
+    layout->record_size += col->tipo.length;
+    layout->num_colonne++;
+  }
+
+  return SUCCESS;
+}
+
+
+/** 
+ * Questa funzione cerca una colonna nel layout di un record.
+ * @param layout Il layout in cui cercare
+ * @param column_name Il nome della colonna
+ * @return L'indice della colonna nel layout, -1 se non esiste
+ */
+int get_layout_column_index(const RecordLayout* layout, const char* column_name) {
+  for (int i = 0; i < layout->num_colonne; i++) {
+    if (strcmp(layout->colonne[i].nome, column_name) == SUCCESS) {
+      return i;
+    }
+  }
+  return -1;  // Colonna non trovata
+}
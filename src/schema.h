@@ -15,8 +15,10 @@ int remove_table_from_schema(const char* table_name);
 void print_schema();
 int write_schema_to_file();
 
-void* create_table_record_struct(const char* table_name);
-void free_table_record_struct(void* record);
+char* get_table_record_buffer(const char* table_name);
 size_t get_record_size(const char* table_name);
 
+int build_record_layout(TableDefinition* table, const char* prefix, RecordLayout* layout);
+int get_layout_column_index(const RecordLayout* layout, const char* column_name);
+
 #endif
\ No newline at end of file
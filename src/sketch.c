@@ -0,0 +1,235 @@
+/*
+
+
+  Sketch.c è il file che racchiude gli sketch, cioè riassunti di dimensione fissa di un insieme di valori,
+  usati da APPROX_COUNT_DISTINCT e APPROX_PERCENTILE.
+  Le funzioni descritte in questo file sono:
+    - init_hll / init_tdigest:            inizializzano uno sketch vuoto.
+    - add_hll_hash / add_tdigest:         aggiungono un valore (per HyperLogLog, il suo hash).
+    - merge_hll / merge_tdigest:          uniscono due sketch calcolati su parti diverse dei dati.
+    - estimate_hll:                       stima quanti valori distinti sono stati aggiunti.
+    - estimate_tdigest_quantile:          stima il valore sotto cui cade una frazione q dei valori.
+
+  Perchè degli sketch?
+  Un COUNT DISTINCT esatto deve ricordarsi tutti i valori visti, un percentile esatto deve ordinarli tutti.
+  Uno sketch occupa sempre gli stessi byte, qualunque sia il numero di record, e due sketch si possono unire:
+  ogni gruppo di GROUP BY, o ogni parte di una scansione, ha il suo sketch, e alla fine si uniscono.
+
+  HyperLogLog:
+  L'hash di ogni valore sceglie un registro (i primi HLL_PRECISION bit) e, con i bit restanti, un "rango":
+  il numero di zeri iniziali + 1. Vedere un rango r è probabile solo dopo circa 2^r valori distinti,
+  quindi il massimo rango di ogni registro dice quanti valori distinti ci sono passati.
+  La media armonica dei registri dà la stima, con un errore standard di circa 1.04 / sqrt(2^HLL_PRECISION).
+  Con pochi valori si usa invece il conteggio dei registri ancora vuoti (linear counting), più preciso.
+  Unire due sketch vuol dire prendere, registro per registro, il massimo.
+
+  t-digest:
+  I valori vengono riassunti in centroidi (media, peso). I centroidi vicini alle code della distribuzione
+  restano piccoli, quelli al centro possono essere grandi: così i percentili estremi (p99) restano precisi.
+  La dimensione massima di un centroide è decisa dalla funzione di scala k(q) = δ/(2π) · asin(2q - 1),
+  con δ = TDIGEST_COMPRESSION: ogni centroide può coprire al massimo un'unità di k.
+  I nuovi valori vengono aggiunti in fondo all'array come centroidi di peso 1; quando l'array è pieno,
+  i centroidi vengono ordinati e fusi. Unire due t-digest vuol dire aggiungere i centroidi dell'uno all'altro.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: qsort
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memset
+#include <math.h>                   // asin, sin, log
+
+#include "sketch.h"
+
+
+/**
+ * Funzione che rimescola i bit di un hash (finalizzatore di MurmurHash3).
+ * HyperLogLog guarda gli zeri iniziali dell'hash: serve che anche i bit alti siano ben distribuiti.
+ */
+static uint64_t mix_hash(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDULL;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+
+void init_hll(HyperLogLog *hll) {
+  memset(hll->registers, 0, sizeof(hll->registers));
+}
+
+
+/**
+ * Funzione che aggiunge l'hash di un valore allo sketch.
+ */
+void add_hll_hash(HyperLogLog *hll, uint64_t hash) {
+  hash = mix_hash(hash);
+
+  uint64_t index = hash >> (64 - HLL_PRECISION);                          // I primi bit scelgono il registro
+  uint64_t rest = (hash << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1));  // Un bit a 1 in fondo: il rango non supera 64 - HLL_PRECISION + 1
+  unsigned char rank = (unsigned char)(__builtin_clzll(rest) + 1);
+
+  if (rank > hll->registers[index]) { hll->registers[index] = rank; }
+}
+
+
+void merge_hll(HyperLogLog *into, const HyperLogLog *from) {
+  for (size_t i = 0; i < sizeof(into->registers); i++) {
+    if (from->registers[i] > into->registers[i]) { into->registers[i] = from->registers[i]; }
+  }
+}
+
+
+/**
+ * Funzione che stima quanti valori distinti sono stati aggiunti allo sketch.
+ */
+double estimate_hll(const HyperLogLog *hll) {
+  double m = (double)(1 << HLL_PRECISION);
+  double sum = 0;
+  long zeros = 0;
+
+  for (size_t i = 0; i < sizeof(hll->registers); i++) {
+    sum += 1.0 / (double)(1ULL << hll->registers[i]);
+    if (hll->registers[i] == 0) { zeros++; }
+  }
+
+  double alpha = 0.7213 / (1.0 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+
+  if (estimate <= 2.5 * m && zeros > 0) {                                 // Pochi valori: linear counting sui registri vuoti
+    estimate = m * log(m / (double)zeros);
+  }
+
+  return estimate;
+}
+
+
+void init_tdigest(TDigest *digest) {
+  digest->total = 0;
+  digest->min = 0;
+  digest->max = 0;
+  digest->num_centroids = 0;
+}
+
+
+/**
+ * Funzioni di scala del t-digest: da quantile a k e viceversa.
+ */
+static double tdigest_k(double q) {
+  return TDIGEST_COMPRESSION / (2 * M_PI) * asin(2 * q - 1);
+}
+
+static double tdigest_q(double k) {
+  if (k >= TDIGEST_COMPRESSION / 4.0) { return 1; }
+  return (sin(k * 2 * M_PI / TDIGEST_COMPRESSION) + 1) / 2;
+}
+
+
+static int compare_centroids(const void *a, const void *b) {
+  double x = ((const Centroid *)a)->mean;
+  double y = ((const Centroid *)b)->mean;
+  return (x > y) - (x < y);
+}
+
+
+/**
+ * Funzione che ordina i centroidi e fonde quelli vicini, finchè ognuno copre al massimo un'unità di k.
+ */
+static void compress_tdigest(TDigest *digest) {
+  if (digest->num_centroids <= 1) { return; }
+
+  Centroid *c = digest->centroids;
+  qsort(c, digest->num_centroids, sizeof(Centroid), compare_centroids);
+
+  int last = 0;
+  double before = 0;                                                      // Peso dei centroidi già chiusi
+  double limit = digest->total * tdigest_q(tdigest_k(0) + 1);
+
+  for (int i = 1; i < digest->num_centroids; i++) {
+    if (before + c[last].weight + c[i].weight <= limit) {
+      c[last].weight += c[i].weight;
+      c[last].mean += (c[i].mean - c[last].mean) * c[i].weight / c[last].weight;
+    } else {
+      before += c[last].weight;
+      limit = digest->total * tdigest_q(tdigest_k(before / digest->total) + 1);
+      c[++last] = c[i];
+    }
+  }
+
+  digest->num_centroids = last + 1;
+}
+
+
+/**
+ * Funzione che aggiunge un centroide in fondo all'array, comprimendo prima se è pieno.
+ */
+static void push_centroid(TDigest *digest, double mean, double weight) {
+  if (digest->num_centroids == TDIGEST_CAPACITY) { compress_tdigest(digest); }
+
+  digest->centroids[digest->num_centroids].mean = mean;
+  digest->centroids[digest->num_centroids].weight = weight;
+  digest->num_centroids++;
+}
+
+
+void add_tdigest(TDigest *digest, double value) {
+  if (digest->total == 0 || value < digest->min) { digest->min = value; }
+  if (digest->total == 0 || value > digest->max) { digest->max = value; }
+
+  push_centroid(digest, value, 1);
+  digest->total += 1;
+}
+
+
+void merge_tdigest(TDigest *into, const TDigest *from) {
+  if (from->total == 0) { return; }
+
+  if (into->total == 0 || from->min < into->min) { into->min = from->min; }
+  if (into->total == 0 || from->max > into->max) { into->max = from->max; }
+
+  for (int i = 0; i < from->num_centroids; i++) {
+    push_centroid(into, from->centroids[i].mean, from->centroids[i].weight);
+    into->total += from->centroids[i].weight;
+  }
+}
+
+
+/**
+ * Funzione che stima il quantile q (tra 0 e 1) dei valori aggiunti.
+ * Ogni centroide è pensato centrato nella sua posizione cumulata: tra due centri si interpola linearmente,
+ * e prima del primo (dopo l'ultimo) si interpola verso il minimo (massimo) esatto.
+ * Lo sketch non viene modificato: si lavora su una copia compressa.
+ *
+ * @return La stima, oppure 0 se lo sketch è vuoto
+ */
+double estimate_tdigest_quantile(const TDigest *digest, double q) {
+  if (digest->total == 0) { return 0; }
+
+  TDigest sorted = *digest;
+  compress_tdigest(&sorted);
+
+  const Centroid *c = sorted.centroids;
+  int n = sorted.num_centroids;
+  double target = q * sorted.total;
+
+  if (n == 1 || target <= c[0].weight / 2) {
+    if (c[0].weight <= 1) { return n == 1 ? c[0].mean : sorted.min; }
+    double t = target / (c[0].weight / 2);
+    return sorted.min + (c[0].mean - sorted.min) * (t < 1 ? t : 1);
+  }
+
+  double center = c[0].weight / 2;                                        // Posizione cumulata del centro del centroide corrente
+  for (int i = 0; i + 1 < n; i++) {
+    double next = center + (c[i].weight + c[i + 1].weight) / 2;
+    if (target <= next) {
+      return c[i].mean + (c[i + 1].mean - c[i].mean) * (target - center) / (next - center);
+    }
+    center = next;
+  }
+
+  double t = (target - center) / (c[n - 1].weight / 2);
+  double value = c[n - 1].mean + (sorted.max - c[n - 1].mean) * t;
+  return value < sorted.max ? value : sorted.max;
+}
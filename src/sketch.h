@@ -0,0 +1,40 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <stdint.h>
+
+// Config Header
+#include "../config.h"
+
+
+typedef struct {                                // HyperLogLog: sketch per stimare quanti valori distinti ci sono
+  unsigned char registers[1 << HLL_PRECISION];  // registers: per ogni registro, il massimo "rango" visto (zeri iniziali dell'hash + 1)
+} HyperLogLog;
+
+typedef struct {                                // Centroid: un gruppo di valori vicini, riassunto dalla media e dal peso
+  double mean;                                  // mean: media dei valori del gruppo
+  double weight;                                // weight: quanti valori contiene
+} Centroid;
+
+typedef struct {                                // TDigest: sketch per stimare i percentili di una distribuzione
+  double total;                                 // total: peso totale (numero di valori aggiunti)
+  double min, max;                              // min / max: estremi esatti, servono per interpolare le code
+  int num_centroids;                            // num_centroids: centroidi in uso (i primi possono essere già compressi, gli altri appena aggiunti)
+  Centroid centroids[TDIGEST_CAPACITY];         // centroids: array a dimensione fissa, così lo sketch sta dentro lo stato di un'aggregazione
+} TDigest;
+
+
+// Functions Available including the Sketch
+void init_hll(HyperLogLog *hll);
+void add_hll_hash(HyperLogLog *hll, uint64_t hash);
+void merge_hll(HyperLogLog *into, const HyperLogLog *from);
+double estimate_hll(const HyperLogLog *hll);
+
+void init_tdigest(TDigest *digest);
+void add_tdigest(TDigest *digest, double value);
+void merge_tdigest(TDigest *into, const TDigest *from);
+double estimate_tdigest_quantile(const TDigest *digest, double q);
+
+
+
+#endif
@@ -0,0 +1,552 @@
+/*
+
+
+  Sort.c è il file che si occupa di ordinare i record di una tabella (ORDER BY), anche quando non entrano in memoria.
+  Le funzioni descritte in questo file sono:
+    - get_sort_key_size:      ottiene la dimensione della chiave normalizzata di una colonna.
+    - build_sort_key:         costruisce la chiave normalizzata di un record.
+    - execute_sorted_read:    esegue una ReadQuery con ORDER BY e stampa i record ordinati, scegliendo la strategia migliore.
+    - choose_sort_method:     sceglie la strategia di ordinamento di una ReadQuery (usata anche da EXPLAIN).
+
+  Chiavi normalizzate:
+  Invece di confrontare i valori in base al tipo (int, float, char, …) ogni volta, ogni valore viene trasformato una volta sola
+  in una sequenza di byte che, confrontata con una semplice memcmp, dà lo stesso ordine del valore originale:
+    - int e timestamp: si inverte il bit del segno e si scrivono i byte dal più significativo (big-endian);
+    - float e double: se il numero è positivo si inverte il bit del segno, se è negativo si invertono tutti i bit;
+    - bool: un byte, 0 o 1;
+    - char: i caratteri fino al terminatore, seguiti da zeri.
+  Per DESC si invertono tutti i byte della chiave.
+  In coda alla chiave si aggiunge la posizione del record (big-endian): così a parità di valore resta l'ordine di inserimento
+  (invertito anch'esso per DESC, così un ordinamento DESC è esattamente il contrario di quello ASC).
+
+  Strategie:
+  choose_sort_method sceglie come ordinare in base alla query:
+    ✅ ORDER BY id: l'id cresce con l'ordine di inserimento, perchè la tabella viene solo aggiunta in fondo.
+       Non serve ordinare nulla: per ASC si legge il file dall'inizio, per DESC dalla fine, e con LIMIT ci si ferma dopo k record.
+       created_at invece viene ordinato come le altre colonne: viene dall'orologio del sistema, che può tornare indietro.
+    ✅ ORDER BY ... LIMIT k (top-k): durante la scansione si tiene un heap con le k coppie migliori viste finora.
+       Ogni record costa al massimo log2(k) confronti, e la memoria usata è proporzionale a k, non alla tabella.
+    ✅ Tutti gli altri casi: ordinamento esterno, descritto qui sotto.
+  Con SAMPLE si ordinano solo i blocchi del campione, anche per id.
+
+  Ordinamento esterno:
+  Si ordinano coppie (chiave, posizione del record), non i record interi.
+    1️⃣ Si scansiona la tabella riempiendo un buffer di coppie grande al massimo SORT_MEMORY_BUDGET.
+    2️⃣ Quando il buffer è pieno, lo si ordina e lo si scrive su un file temporaneo (un "run" ordinato).
+    3️⃣ Finita la scansione, i run vengono fusi insieme (k-way merge) con un loser tree:
+       per ogni coppia in uscita servono solo log2(k) confronti.
+    4️⃣ Per ogni coppia in uscita si legge il record alla sua posizione e lo si stampa.
+  Se tutte le coppie entrano in memoria, non si scrive nulla su disco.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fread, fwrite, fseek
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free, qsort
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memcmp, strnlen
+#include <stdint.h>                 // uint32_t, uint64_t
+#include <unistd.h>                 // getpid
+
+#include "sort.h"
+#include "scan.h"
+#include "predicate.h"
+#include "utils.h"
+#include "sample.h"
+#include "planner.h"
+#include "schema.h"
+#include "arena.h"
+#include "output.h"
+#include "commands/read.h"
+
+
+typedef struct {                                // RunReader: lettore bufferizzato di un run ordinato su disco
+  FILE *file;
+  char *buffer;
+  size_t entries;                               // entries: coppie presenti nel buffer
+  size_t next;                                  // next: prossima coppia da restituire
+  bool exhausted;                               // exhausted: true quando il run è finito
+} RunReader;
+
+
+static size_t qsort_entry_size;                 // Dimensione delle coppie per il comparatore di qsort (che non accetta parametri extra)
+
+
+static long execute_external_sort(const ReadQuery *query);
+
+
+/**
+ * Funzione che scrive un numero in big-endian, dal byte più significativo.
+ */
+static void write_big_endian(unsigned char *out, uint64_t value, size_t bytes) {
+  for (size_t i = 0; i < bytes; i++) {
+    out[i] = (unsigned char)(value >> (8 * (bytes - 1 - i)));
+  }
+}
+
+
+/**
+ * Funzione che ottiene la dimensione della chiave normalizzata di una colonna.
+ */
+size_t get_sort_key_size(const LayoutColumn *col) {
+  return col->tipo.length;                                                // Ogni tipo occupa nella chiave quanto occupa nel record
+}
+
+
+/**
+ * Funzione che costruisce la chiave normalizzata del valore di una colonna.
+ * Due chiavi confrontate con memcmp danno lo stesso ordine dei valori originali (invertito se desc).
+ *
+ * @param col La colonna di ordinamento
+ * @param desc true per ordine decrescente
+ * @param record Il record da cui leggere il valore
+ * @param key Il buffer in cui scrivere la chiave, grande get_sort_key_size(col)
+ */
+void build_sort_key(const LayoutColumn *col, bool desc, const char *record, unsigned char *key) {
+  const char *value = record + col->offset;
+  size_t size = get_sort_key_size(col);
+
+  switch (col->kind) {
+    case KIND_INT: {
+      int v;
+      memcpy(&v, value, sizeof(int));
+      write_big_endian(key, (uint32_t)v ^ 0x80000000u, sizeof(int));
+      break;
+    }
+    case KIND_TIMESTAMP: {
+      long v;
+      memcpy(&v, value, sizeof(long));
+      write_big_endian(key, (uint64_t)v ^ (1ULL << (8 * sizeof(long) - 1)), sizeof(long));
+      break;
+    }
+    case KIND_FLOAT: {
+      uint32_t bits;
+      memcpy(&bits, value, sizeof(float));
+      bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+      write_big_endian(key, bits, sizeof(float));
+      break;
+    }
+    case KIND_DOUBLE: {
+      uint64_t bits;
+      memcpy(&bits, value, sizeof(double));
+      bits = (bits & (1ULL << 63)) ? ~bits : (bits | (1ULL << 63));
+      write_big_endian(key, bits, sizeof(double));
+      break;
+    }
+    case KIND_BOOL:
+      key[0] = value[0] ? 1 : 0;
+      break;
+    case KIND_CHAR: {
+      size_t n = strnlen(value, size);
+      memcpy(key, value, n);
+      memset(key + n, 0, size - n);
+      break;
+    }
+    default:
+      memcpy(key, value, size);
+  }
+
+  if (desc) {
+    for (size_t i = 0; i < size; i++) { key[i] = (unsigned char)~key[i]; }
+  }
+}
+
+
+/**
+ * Funzione che scrive la posizione del record in coda alla chiave.
+ * Per DESC la posizione viene invertita, così a parità di valore esce prima il record inserito dopo.
+ */
+static void write_entry_position(unsigned char *out, uint64_t position, bool desc) {
+  write_big_endian(out, desc ? ~position : position, sizeof(uint64_t));
+}
+
+
+static int compare_entries(const void *a, const void *b) {
+  return memcmp(a, b, qsort_entry_size);
+}
+
+
+/**
+ * Funzione che ordina un buffer di coppie e lo scrive in un nuovo run su disco.
+ * @return Il file del run, riavvolto all'inizio, NULL in caso di errore
+ */
+static FILE *write_sorted_run(char *entries, size_t count, size_t entry_size, int run_number) {
+  char filename[256];
+  snprintf(filename, sizeof(filename), "%s/tmp_sort_%d_%d.bin", TABLES_DIR, (int)getpid(), run_number);
+
+  FILE *file = fopen(filename, "w+b");
+  if (!file) {
+    printf("Errore nella creazione del file temporaneo %s\n", filename);
+    return NULL;
+  }
+  remove(filename);                                                       // Il file sparisce da solo alla fclose
+
+  qsort_entry_size = entry_size;
+  qsort(entries, count, entry_size, compare_entries);
+
+  if (fwrite(entries, entry_size, count, file) != count) {
+    printf("Errore nella scrittura del run ordinato\n");
+    fclose(file);
+    return NULL;
+  }
+
+  rewind(file);
+  return file;
+}
+
+
+/**
+ * Funzione che passa alla coppia successiva di un run, ricaricando il buffer quando serve.
+ */
+static void advance_run(RunReader *run, size_t entry_size, size_t buffer_entries) {
+  run->next++;
+  if (run->next < run->entries) { return; }
+
+  run->entries = fread(run->buffer, entry_size, buffer_entries, run->file);
+  run->next = 0;
+  run->exhausted = (run->entries == 0);
+}
+
+
+/**
+ * Funzione del loser tree: ritorna true se il run a deve uscire dopo il run b.
+ * Il run k (virtuale) è il più piccolo di tutti e serve solo a costruire l'albero; un run finito è il più grande.
+ */
+static bool run_after(const RunReader *runs, int k, int a, int b, size_t entry_size) {
+  if (a == k) { return false; }
+  if (b == k) { return true; }
+  if (runs[a].exhausted) { return !runs[b].exhausted; }
+  if (runs[b].exhausted) { return false; }
+
+  return memcmp(runs[a].buffer + runs[a].next * entry_size, runs[b].buffer + runs[b].next * entry_size, entry_size) > 0;
+}
+
+
+/**
+ * Funzione che fa risalire il run s nel loser tree: in ogni nodo resta il perdente, il vincitore prosegue verso la radice.
+ * tree[0] contiene il vincitore assoluto, cioè il run con la coppia più piccola.
+ */
+static void adjust_loser_tree(int *tree, const RunReader *runs, int k, int s, size_t entry_size) {
+  for (int t = (s + k) / 2; t > 0; t /= 2) {
+    if (run_after(runs, k, s, tree[t], entry_size)) {
+      int winner = tree[t];
+      tree[t] = s;
+      s = winner;
+    }
+  }
+  tree[0] = s;
+}
+
+
+/**
+ * Funzione che stampa il record alla posizione indicata nella coppia.
+ * @return SUCCESS se il record è stato letto, FAILURE altrimenti
+ */
+static int print_entry(const ReadQuery *query, TableScan *scan, const unsigned char *entry, size_t key_size, char *record) {
+  uint64_t position = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) { position = (position << 8) | entry[key_size + i]; }
+  if (query->order_desc) { position = ~position; }
+
+  if (read_record_at(scan, (long)position, record) != SUCCESS) { return FAILURE; }
+
+  print_record(&query->layout, &query->projection, record);
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che verifica se una colonna cresce con l'ordine di inserimento dei record.
+ * Succede solo per id, assegnato in modo crescente e mai modificato.
+ */
+static bool is_insertion_ordered(const LayoutColumn *col) {
+  return strcmp(col->nome, "id") == SUCCESS;
+}
+
+
+/**
+ * Funzione che esegue una ReadQuery ordinata per id, senza ordinare nulla.
+ * Per ASC legge il file dall'inizio, per DESC dalla fine; con LIMIT si ferma appena ha stampato k record.
+ * @return Il numero di record stampati, -1 in caso di errore
+ */
+static long execute_insertion_ordered_read(const ReadQuery *query) {
+  TableScan scan;
+  if (open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return -1; }
+  if (!query->order_desc) { plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate); }
+
+  const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+
+  output_title("Tabella: %s\n", query->nome_tabella);
+  print_layout_header(&query->layout, &query->projection);
+
+  if (query->order_desc) { seek_table_scan(&scan, count_table_records(&scan)); }
+
+  long printed = 0;
+  size_t count;
+
+  while (printed != query->limit && (count = query->order_desc ? read_scan_batch_backward(&scan) : read_scan_batch(&scan)) > 0) {
+    for (size_t i = 0; i < count && printed != query->limit; i++) {
+      size_t r = query->order_desc ? count - 1 - i : i;                    // Al contrario, il batch si scorre dall'ultimo record
+      const char *record = scan.buffer + r * scan.record_size;
+
+      if (pred && !evaluate_predicate(pred, record)) { continue; }
+
+      print_record(&query->layout, &query->projection, record);
+      printed++;
+    }
+  }
+
+  close_table_scan(&scan);
+  return printed;
+}
+
+
+/**
+ * Funzione che sposta verso il basso la coppia in posizione i di un max-heap, finchè è più grande dei suoi figli.
+ */
+static void heap_sift_down(char *heap, size_t size, size_t i, size_t entry_size, char *tmp) {
+  while (true) {
+    size_t largest = i, left = 2 * i + 1, right = 2 * i + 2;
+
+    if (left < size && memcmp(heap + left * entry_size, heap + largest * entry_size, entry_size) > 0) { largest = left; }
+    if (right < size && memcmp(heap + right * entry_size, heap + largest * entry_size, entry_size) > 0) { largest = right; }
+    if (largest == i) { return; }
+
+    memcpy(tmp, heap + i * entry_size, entry_size);
+    memcpy(heap + i * entry_size, heap + largest * entry_size, entry_size);
+    memcpy(heap + largest * entry_size, tmp, entry_size);
+    i = largest;
+  }
+}
+
+
+/**
+ * Funzione che sposta verso l'alto la coppia in posizione i di un max-heap, finchè è più grande del padre.
+ */
+static void heap_sift_up(char *heap, size_t i, size_t entry_size, char *tmp) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (memcmp(heap + i * entry_size, heap + parent * entry_size, entry_size) <= 0) { return; }
+
+    memcpy(tmp, heap + i * entry_size, entry_size);
+    memcpy(heap + i * entry_size, heap + parent * entry_size, entry_size);
+    memcpy(heap + parent * entry_size, tmp, entry_size);
+    i = parent;
+  }
+}
+
+
+/**
+ * Funzione che esegue ORDER BY ... LIMIT k con un heap limitato a k coppie.
+ * La radice del max-heap è la peggiore delle k coppie migliori viste finora:
+ * un nuovo record entra nell'heap solo se è migliore della radice, e in quel caso la sostituisce.
+ * @return Il numero di record stampati, -1 in caso di errore
+ */
+static long execute_top_k_read(const ReadQuery *query) {
+  const LayoutColumn *col = &query->layout.colonne[query->order_column];
+  size_t key_size = get_sort_key_size(col);
+  size_t entry_size = key_size + sizeof(uint64_t);
+  size_t k = (size_t)query->limit;
+
+  char *heap = arena_alloc((k + 2) * entry_size);                         // Le ultime due coppie servono come appoggio
+  char *record = get_table_record_buffer(query->nome_tabella);
+
+  TableScan scan;
+  if (!heap || !record || open_table_scan(query->nome_tabella, &scan) != SUCCESS) { return -1; }
+  set_scan_sample(&scan, &query->sample);
+  plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);
+
+  unsigned char *candidate = (unsigned char *)heap + k * entry_size;
+  char *tmp = heap + (k + 1) * entry_size;
+  const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+  size_t size = 0;
+  size_t count;
+
+  while (k > 0 && (count = read_scan_batch(&scan)) > 0) {
+    for (size_t r = 0; r < count; r++) {
+      const char *rec = scan.buffer + r * scan.record_size;
+      if (pred && !evaluate_predicate(pred, rec)) { continue; }
+
+      build_sort_key(col, query->order_desc, rec, candidate);
+      write_entry_position(candidate + key_size, (uint64_t)get_scan_record_position(&scan, r), query->order_desc);
+
+      if (size < k) {                                                     // L'heap non è ancora pieno: aggiungo
+        memcpy(heap + size * entry_size, candidate, entry_size);
+        heap_sift_up(heap, size, entry_size, tmp);
+        size++;
+      } else if (memcmp(candidate, heap, entry_size) < 0) {              // Migliore della peggiore: la sostituisco
+        memcpy(heap, candidate, entry_size);
+        heap_sift_down(heap, size, 0, entry_size, tmp);
+      }
+    }
+  }
+
+  qsort_entry_size = entry_size;
+  qsort(heap, size, entry_size, compare_entries);
+
+  output_title("Tabella: %s\n", query->nome_tabella);
+  print_sample_summary(&scan);
+  print_layout_header(&query->layout, &query->projection);
+
+  long printed = 0;
+  for (size_t i = 0; i < size; i++) {
+    if (print_entry(query, &scan, (unsigned char *)heap + i * entry_size, key_size, record) != SUCCESS) { break; }
+    printed++;
+  }
+
+  close_table_scan(&scan);
+  return printed;
+}
+
+
+/**
+ * Funzione che esegue una ReadQuery con ORDER BY, scegliendo la strategia più economica.
+ *
+ * @param query La query, con order_column >= 0
+ * @return Il numero di record stampati, -1 in caso di errore
+ */
+long execute_sorted_read(const ReadQuery *query) {
+  switch (choose_sort_method(query)) {
+    case SORT_INSERTION_ORDER: return execute_insertion_ordered_read(query);
+    case SORT_TOP_K:           return execute_top_k_read(query);
+    default:                   return execute_external_sort(query);
+  }
+}
+
+
+/**
+ * Funzione che sceglie come eseguire una ReadQuery con ORDER BY (usata anche da EXPLAIN).
+ * - Per id l'ordine di inserimento è già quello giusto.
+ * - Con un LIMIT k piccolo abbastanza da tenere k chiavi in memoria basta un heap di k record.
+ * - Altrimenti serve l'ordinamento esterno.
+ */
+SortMethod choose_sort_method(const ReadQuery *query) {
+  const LayoutColumn *order = &query->layout.colonne[query->order_column];
+  size_t order_entry_size = get_sort_key_size(order) + sizeof(uint64_t);
+
+  if (is_insertion_ordered(order) && !query->sample.enabled) { return SORT_INSERTION_ORDER; }
+
+  if (query->limit >= 0 && (size_t)query->limit <= SORT_MEMORY_BUDGET / order_entry_size) { return SORT_TOP_K; }
+
+  return SORT_EXTERNAL;
+}
+
+
+/**
+ * Funzione che esegue una ReadQuery con ORDER BY tramite l'ordinamento esterno.
+ *
+ * @param query La query, con order_column >= 0
+ * @return Il numero di record stampati, -1 in caso di errore
+ */
+static long execute_external_sort(const ReadQuery *query) {
+  const LayoutColumn *col = &query->layout.colonne[query->order_column];
+  size_t key_size = get_sort_key_size(col);
+  size_t entry_size = key_size + sizeof(uint64_t);
+
+  size_t capacity = SORT_MEMORY_BUDGET / entry_size;
+  char *entries = malloc(capacity * entry_size);
+  char *record = get_table_record_buffer(query->nome_tabella);
+  FILE *runs_files[SORT_MAX_RUNS];
+  int num_runs = 0;
+  long printed = -1;
+
+  TableScan scan;
+  if (!entries || !record || open_table_scan(query->nome_tabella, &scan) != SUCCESS) {
+    if (!entries) { printf("Errore: malloc fallita per l'ordinamento\n"); }
+    free(entries);
+    return -1;
+  }
+  set_scan_sample(&scan, &query->sample);
+  plan_table_scan(&scan, query->nome_tabella, &query->layout, &query->predicate);
+
+  const Predicate *pred = query->predicate.root >= 0 ? &query->predicate : NULL;
+  size_t used = 0;
+  size_t count;
+
+  // 1️⃣ e 2️⃣: costruisco le coppie (chiave, posizione) e scrivo un run ordinato ogni volta che il buffer si riempie
+  while ((count = read_scan_batch(&scan)) > 0) {
+    for (size_t r = 0; r < count; r++) {
+      const char *rec = scan.buffer + r * scan.record_size;
+      if (pred && !evaluate_predicate(pred, rec)) { continue; }
+
+      if (used == capacity) {
+        if (num_runs == SORT_MAX_RUNS) {
+          printf("❌ Errore: la tabella è troppo grande per essere ordinata con il budget di memoria attuale\n");
+          goto cleanup;
+        }
+        runs_files[num_runs] = write_sorted_run(entries, used, entry_size, num_runs);
+        if (!runs_files[num_runs]) { goto cleanup; }
+        num_runs++;
+        used = 0;
+      }
+
+      unsigned char *entry = (unsigned char *)entries + used * entry_size;
+      build_sort_key(col, query->order_desc, rec, entry);
+      write_entry_position(entry + key_size, (uint64_t)get_scan_record_position(&scan, r), query->order_desc);
+      used++;
+    }
+  }
+
+  output_title("Tabella: %s\n", query->nome_tabella);
+  print_sample_summary(&scan);
+  print_layout_header(&query->layout, &query->projection);
+  printed = 0;
+
+  if (num_runs == 0) {                                                    // Tutto in memoria: basta un ordinamento
+    qsort_entry_size = entry_size;
+    qsort(entries, used, entry_size, compare_entries);
+
+    for (size_t i = 0; i < used && printed != query->limit; i++) {
+      if (print_entry(query, &scan, (unsigned char *)entries + i * entry_size, key_size, record) != SUCCESS) { break; }
+      printed++;
+    }
+    goto cleanup;
+  }
+
+  if (used > 0) {                                                         // L'ultimo buffer diventa anch'esso un run
+    if (num_runs == SORT_MAX_RUNS) {
+      printf("❌ Errore: la tabella è troppo grande per essere ordinata con il budget di memoria attuale\n");
+      printed = -1;
+      goto cleanup;
+    }
+    runs_files[num_runs] = write_sorted_run(entries, used, entry_size, num_runs);
+    if (!runs_files[num_runs]) { printed = -1; goto cleanup; }
+    num_runs++;
+  }
+
+  // 3️⃣: k-way merge con loser tree. Il buffer delle coppie viene diviso tra i run.
+  {
+    int k = num_runs;
+    size_t buffer_entries = capacity / k;
+    RunReader runs[SORT_MAX_RUNS];
+    int tree[SORT_MAX_RUNS];
+
+    for (int i = 0; i < k; i++) {
+      runs[i].file = runs_files[i];
+      runs[i].buffer = entries + i * buffer_entries * entry_size;
+      runs[i].entries = 0;
+      runs[i].next = 0;
+      runs[i].exhausted = false;
+      advance_run(&runs[i], entry_size, buffer_entries);
+      runs[i].next = 0;
+    }
+
+    for (int i = 0; i < k; i++) { tree[i] = k; }                          // Tutti i nodi partono dal run virtuale "più piccolo"
+    for (int i = k - 1; i >= 0; i--) { adjust_loser_tree(tree, runs, k, i, entry_size); }
+
+    while (printed != query->limit) {
+      int winner = tree[0];
+      if (runs[winner].exhausted) { break; }                              // Il vincitore è finito: sono finiti tutti
+
+      if (print_entry(query, &scan, (unsigned char *)runs[winner].buffer + runs[winner].next * entry_size, key_size, record) != SUCCESS) { break; }
+      printed++;
+
+      advance_run(&runs[winner], entry_size, buffer_entries);
+      adjust_loser_tree(tree, runs, k, winner, entry_size);
+    }
+  }
+
+cleanup:
+  for (int i = 0; i < num_runs; i++) { fclose(runs_files[i]); }
+  close_table_scan(&scan);
+  free(entries);
+  return printed;
+}
@@ -0,0 +1,23 @@
+#ifndef SORT_H
+#define SORT_H
+
+// Config Header
+#include "../config.h"
+
+
+typedef enum {                                  // Modi di eseguire una ReadQuery con ORDER BY
+  SORT_INSERTION_ORDER,                         // id o created_at: si legge il file nel suo ordine (o al contrario per DESC)
+  SORT_TOP_K,                                   // ORDER BY … LIMIT k: heap dei k record migliori
+  SORT_EXTERNAL                                 // Ordinamento esterno: run ordinate su disco e fusione
+} SortMethod;
+
+
+// Functions Available including the Sort
+size_t get_sort_key_size(const LayoutColumn *col);
+void build_sort_key(const LayoutColumn *col, bool desc, const char *record, unsigned char *key);
+long execute_sorted_read(const ReadQuery *query);
+SortMethod choose_sort_method(const ReadQuery *query);
+
+
+
+#endif
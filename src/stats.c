@@ -0,0 +1,241 @@
+/*
+
+
+  Stats.c è il file che si occupa delle statistiche delle tabelle, raccolte con il comando ANALYZE.
+  Le funzioni descritte in questo file sono:
+    - analyze_table:                    legge tutta la tabella e calcola le statistiche di ogni colonna.
+    - save_table_stats:                 salva le statistiche in tables/<T>.stats.
+    - load_table_stats:                 carica le statistiche di una tabella, se ci sono e sono ancora valide.
+    - print_table_stats:                stampa le statistiche in forma di tabella.
+    - estimate_column_fraction_below:   stima la frazione di valori di una colonna minori di un valore dato.
+    - read_numeric_value:               legge il valore di una colonna numerica come double.
+
+  Quali statistiche?
+  Per ogni colonna del layout (compresi id, created_at e updated_at):
+    ✅ quanti valori NULL ci sono (vedi get_null_value);
+    ✅ quanti valori distinti ci sono, stimati con un HyperLogLog (vedi sketch.c);
+    ✅ per le colonne numeriche, minimo, massimo e un istogramma equi-depth con STATS_HISTOGRAM_BUCKETS intervalli.
+
+  Istogramma equi-depth:
+  Invece di dividere [min, max] in intervalli della stessa larghezza, si scelgono i confini in modo che ogni intervallo
+  contenga la stessa frazione di valori: i confini sono i quantili 0, 1/B, 2/B, … 1.
+  Così anche una distribuzione molto sbilanciata viene descritta bene dove ci sono più valori.
+  I quantili vengono stimati con un t-digest durante l'unica scansione della tabella, senza ordinare nulla.
+
+  Le statistiche servono al planner (vedi planner.c) per stimare quanti record soddisfano un predicato,
+  e a GROUP BY per stimare quanti gruppi ci saranno.
+  Vengono salvate così come sono in memoria, come lo schema: il campo version permette di ignorare un file di un formato diverso.
+  Non vengono aggiornate da CREATE: il numero di record della tabella viene sempre letto dal file,
+  e le frazioni calcolate da ANALYZE restano una buona stima finchè i dati non cambiano molto.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, fopen, fread, fwrite
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memset, memcpy, strnlen
+#include <time.h>                   // time
+
+#include "stats.h"
+#include "scan.h"
+#include "sketch.h"
+#include "utils.h"
+#include "arena.h"
+
+
+/**
+ * Funzione che costruisce il percorso del file delle statistiche di una tabella: tables/<T>.stats
+ */
+static void get_stats_path(const char *table_name, char *path, size_t size) {
+  snprintf(path, size, "%s/%s.stats", TABLES_DIR, table_name);
+}
+
+
+/**
+ * Funzione che legge il valore di una colonna numerica come double (per i bool, 0 o 1).
+ * Serve anche al planner, per confrontare le costanti di un predicato con l'istogramma.
+ * @return false se il valore è NULL o la colonna non è numerica, true altrimenti
+ */
+bool read_numeric_value(const LayoutColumn *col, const char *field, double *value) {
+  switch (col->kind) {
+    case KIND_INT:       { int v;    memcpy(&v, field, sizeof(v)); *value = v; return v != -1; }
+    case KIND_FLOAT:     { float v;  memcpy(&v, field, sizeof(v)); *value = v; return v != -1.0f; }
+    case KIND_DOUBLE:    { double v; memcpy(&v, field, sizeof(v)); *value = v; return v != -1.0; }
+    case KIND_TIMESTAMP: { long v;   memcpy(&v, field, sizeof(v)); *value = (double)v; return v != 0; }
+    case KIND_BOOL:      { *value = field[0] ? 1 : 0; return true; }    // Per i bool il NULL coincide con false
+    default:             return false;
+  }
+}
+
+
+/**
+ * Funzione che legge tutta la tabella e calcola le statistiche di ogni colonna.
+ * Ogni colonna ha il suo HyperLogLog e, se numerica (bool escluso), il suo t-digest.
+ *
+ * @param table_name La tabella da analizzare
+ * @param layout Il layout dei record della tabella
+ * @param stats Le statistiche da valorizzare
+ * @return SUCCESS se le statistiche sono state calcolate, FAILURE altrimenti
+ */
+int analyze_table(const char *table_name, const RecordLayout *layout, TableStats *stats) {
+  TableScan scan;
+  if (open_table_scan(table_name, &scan) != SUCCESS) { return FAILURE; }
+
+  int columns = layout->num_colonne;
+  HyperLogLog *hlls = arena_alloc(columns * sizeof(HyperLogLog));
+  TDigest *digests = arena_alloc(columns * sizeof(TDigest));
+  if (!hlls || !digests) {
+    close_table_scan(&scan);
+    return FAILURE;
+  }
+
+  memset(stats, 0, sizeof(TableStats));
+  stats->version = STATS_VERSION;
+  stats->record_size = layout->record_size;
+  stats->analyzed_at = (long)time(NULL);
+  stats->num_colonne = columns;
+
+  for (int c = 0; c < columns; c++) {
+    init_hll(&hlls[c]);
+    init_tdigest(&digests[c]);
+  }
+
+  size_t count;
+  while ((count = read_scan_batch(&scan)) > 0) {
+    stats->rows += (long)count;
+
+    for (int c = 0; c < columns; c++) {
+      const LayoutColumn *col = &layout->colonne[c];
+      ColumnStats *column = &stats->colonne[c];
+
+      for (size_t r = 0; r < count; r++) {
+        const char *field = scan.buffer + r * scan.record_size + col->offset;
+        double value;
+
+        if (col->kind == KIND_CHAR) {
+          size_t length = strnlen(field, col->tipo.length);
+          if (length == 0) { column->null_count++; continue; }            // Stringa vuota = NULL
+          add_hll_hash(&hlls[c], hash_bytes(field, length, 0));
+          continue;
+        }
+
+        if (!read_numeric_value(col, field, &value)) { column->null_count++; continue; }
+        add_hll_hash(&hlls[c], hash_bytes(field, col->tipo.length, 0));
+        if (col->kind != KIND_BOOL) { add_tdigest(&digests[c], value); }
+      }
+    }
+  }
+
+  for (int c = 0; c < columns; c++) {
+    ColumnStats *column = &stats->colonne[c];
+    long values = stats->rows - column->null_count;
+
+    column->distinct = values > 0 ? estimate_hll(&hlls[c]) : 0;
+    if (column->distinct > values) { column->distinct = (double)values; }   // La stima non può superare i valori letti
+
+    if (digests[c].total == 0) { continue; }
+    column->min = digests[c].min;
+    column->max = digests[c].max;
+    column->num_bounds = STATS_HISTOGRAM_BUCKETS + 1;
+    for (int b = 0; b <= STATS_HISTOGRAM_BUCKETS; b++) {
+      column->bounds[b] = estimate_tdigest_quantile(&digests[c], (double)b / STATS_HISTOGRAM_BUCKETS);
+    }
+    column->bounds[0] = column->min;                                      // Gli estremi sono esatti
+    column->bounds[STATS_HISTOGRAM_BUCKETS] = column->max;
+  }
+
+  close_table_scan(&scan);
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che salva le statistiche di una tabella in tables/<T>.stats, sovrascrivendo quelle precedenti.
+ * @return SUCCESS se il file è stato scritto, FAILURE altrimenti
+ */
+int save_table_stats(const char *table_name, const TableStats *stats) {
+  char path[256];
+  get_stats_path(table_name, path, sizeof(path));
+
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    printf("❌ Errore: impossibile scrivere il file %s\n", path);
+    return FAILURE;
+  }
+
+  size_t written = fwrite(stats, sizeof(TableStats), 1, file);
+  fclose(file);
+
+  if (written != 1) {
+    printf("❌ Errore: impossibile scrivere il file %s\n", path);
+    remove(path);
+    return FAILURE;
+  }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che carica le statistiche di una tabella.
+ * Le statistiche vengono ignorate se il file non esiste o se non corrisponde più al layout della tabella.
+ *
+ * @return SUCCESS se le statistiche sono state caricate, FAILURE altrimenti (senza stampare nulla: le statistiche sono facoltative)
+ */
+int load_table_stats(const char *table_name, const RecordLayout *layout, TableStats *stats) {
+  char path[256];
+  get_stats_path(table_name, path, sizeof(path));
+
+  FILE *file = fopen(path, "rb");
+  if (!file) { return FAILURE; }
+
+  size_t read = fread(stats, sizeof(TableStats), 1, file);
+  fclose(file);
+
+  if (read != 1 || stats->version != STATS_VERSION || stats->record_size != layout->record_size || stats->num_colonne != layout->num_colonne) {
+    return FAILURE;
+  }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che stampa le statistiche di una tabella, una riga per colonna.
+ */
+void print_table_stats(const RecordLayout *layout, const TableStats *stats) {
+  printf("%ld record analizzati\n", stats->rows);
+  printf("Colonna\tNULL\tDistinti\tMin\tMax\n");
+
+  for (int c = 0; c < stats->num_colonne; c++) {
+    const ColumnStats *column = &stats->colonne[c];
+    double null_fraction = stats->rows > 0 ? (double)column->null_count / (double)stats->rows : 0;
+
+    printf("%s\t%.1f%%\t%.0f\t", layout->colonne[c].nome, null_fraction * 100, column->distinct);
+    if (column->num_bounds > 0) { printf("%.2f\t%.2f\n", column->min, column->max); }
+    else                        { printf("-\t-\n"); }
+  }
+}
+
+
+/**
+ * Funzione che stima la frazione dei valori non NULL di una colonna minori di value, usando l'istogramma.
+ * Dentro un intervallo dell'istogramma i valori sono considerati distribuiti uniformemente.
+ *
+ * @return Una frazione tra 0 e 1, oppure -1 se la colonna non ha un istogramma
+ */
+double estimate_column_fraction_below(const ColumnStats *column, double value) {
+  if (column->num_bounds < 2) { return -1; }
+
+  int buckets = column->num_bounds - 1;
+  if (value <= column->bounds[0]) { return 0; }
+  if (value > column->bounds[buckets]) { return 1; }
+
+  for (int b = 0; b < buckets; b++) {
+    double low = column->bounds[b], high = column->bounds[b + 1];
+    if (value > high) { continue; }
+
+    double inside = high > low ? (value - low) / (high - low) : 0;        // Intervallo degenere: un solo valore ripetuto
+    return ((double)b + inside) / (double)buckets;
+  }
+
+  return 1;
+}
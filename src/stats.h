@@ -0,0 +1,36 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Config Header
+#include "../config.h"
+
+
+typedef struct {                                // ColumnStats: statistiche di una colonna, raccolte da ANALYZE
+  long null_count;                              // null_count: record con valore NULL (vedi get_null_value)
+  double distinct;                              // distinct: stima dei valori distinti non NULL (HyperLogLog)
+  double min, max;                              // min / max: estremi dei valori non NULL (solo colonne numeriche)
+  int num_bounds;                               // num_bounds: confini dell'istogramma, 0 se la colonna non ne ha uno
+  double bounds[STATS_HISTOGRAM_BUCKETS + 1];   // bounds: istogramma equi-depth, ogni intervallo contiene la stessa frazione di valori
+} ColumnStats;
+
+typedef struct {                                // TableStats: statistiche di una tabella, salvate in tables/<T>.stats
+  int version;                                  // version: STATS_VERSION, per riconoscere un file di un formato diverso
+  size_t record_size;                           // record_size: dimensione del record al momento di ANALYZE
+  long rows;                                    // rows: record della tabella al momento di ANALYZE
+  long analyzed_at;                             // analyzed_at: quando è stato eseguito ANALYZE (secondi dal 1970)
+  int num_colonne;                              // num_colonne: colonne del layout (id, campi, created_at, updated_at)
+  ColumnStats colonne[MAX_LAYOUT_COLUMNS];      // colonne: statistiche di ogni colonna, nell'ordine del layout
+} TableStats;
+
+
+// Functions Available including the Stats
+int analyze_table(const char *table_name, const RecordLayout *layout, TableStats *stats);
+int save_table_stats(const char *table_name, const TableStats *stats);
+int load_table_stats(const char *table_name, const RecordLayout *layout, TableStats *stats);
+void print_table_stats(const RecordLayout *layout, const TableStats *stats);
+double estimate_column_fraction_below(const ColumnStats *column, double value);
+bool read_numeric_value(const LayoutColumn *col, const char *field, double *value);
+
+
+
+#endif
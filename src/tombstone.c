@@ -0,0 +1,274 @@
+/*
+
+
+  Tombstone.c è il file che si occupa dei record eliminati con DELETE.
+  Le funzioni descritte in questo file sono:
+    - load_table_tombstones:    carica la mappa dei record eliminati di una tabella, per saltarli durante la scansione.
+    - mark_record_deleted:      segna un record come eliminato, scrivendo un solo byte della mappa.
+    - count_block_deleted:      conta i record eliminati nel blocco di un record, per decidere se compattare la tabella.
+    - write_compacted_tombstones:   scrive la mappa di una tabella compattata, prima di sostituire la tabella (vedi compact.c).
+    - install_compacted_tombstones: installa quella mappa, dopo che la tabella è stata sostituita.
+
+  Come si elimina un record?
+  Il file di una tabella è una sequenza di record della stessa dimensione, con gli id crescenti: togliere un record
+  vorrebbe dire riscrivere tutti quelli che lo seguono. Invece il record resta dov'è e viene segnato come eliminato
+  in una mappa di bit (una "tombstone"), salvata in tables/<T>.del: il bit i-esimo vale 1 se il record in posizione i
+  è stato eliminato. Eliminare un record costa la scrittura di un byte, qualsiasi sia la dimensione della tabella.
+  Le scansioni (vedi scan.c) caricano la mappa una volta sola e saltano i record eliminati.
+
+  Il file tables/<T>.del contiene un TombstoneHeader seguito dai bit, otto record per byte.
+  Un record oltre la fine della mappa non è stato eliminato: i record aggiunti in fondo non toccano la mappa.
+  L'intestazione contiene l'inode del file della tabella: se la tabella viene sostituita (ad esempio da una compattazione
+  interrotta a metà) la mappa non le corrisponde più e viene ignorata, invece di eliminare i record sbagliati.
+  Per questo la mappa della tabella compattata viene scritta, con l'inode della copia, prima della rename della tabella.
+
+  Lo spazio dei record eliminati viene recuperato in background, riscrivendo la tabella senza di loro (vedi compact.c).
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: fopen, fclose, fread, fwrite, rename, remove
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: calloc, free
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memset
+#include <stdint.h>                 // uint32_t, uint64_t, int64_t
+#include <unistd.h>                 // pread, pwrite, ftruncate, fsync
+#include <sys/stat.h>               // fstat, stat
+
+#include "tombstone.h"
+
+
+typedef struct {                                // TombstoneHeader: intestazione del file tables/<T>.del
+  uint32_t version;                             // version: TOMBSTONE_VERSION, per riconoscere un file di un formato diverso
+  uint32_t reserved;                            // reserved: sempre 0
+  uint64_t inode;                               // inode: inode del file della tabella a cui si riferisce la mappa
+  int64_t deleted;                              // deleted: quanti record sono stati eliminati (bit a 1)
+} TombstoneHeader;
+
+
+/**
+ * Funzione che costruisce il percorso della mappa dei record eliminati di una tabella: tables/<T>.del
+ */
+static void get_tombstone_path(const char *table_name, char *path, size_t size) {
+  snprintf(path, size, "%s/%s.del", TABLES_DIR, table_name);
+}
+
+
+/**
+ * Funzione che ottiene l'inode del file di una tabella già aperto.
+ */
+static uint64_t get_table_inode(FILE *table) {
+  struct stat st;
+  if (fstat(fileno(table), &st) != 0) { return 0; }
+  return (uint64_t)st.st_ino;
+}
+
+
+/**
+ * Funzione che carica la mappa dei record eliminati di una tabella.
+ * Se la tabella non ha record eliminati (o la mappa non le corrisponde) bits resta NULL e non si alloca nulla.
+ *
+ * @param table_name La tabella
+ * @param table Il file della tabella, aperto: la mappa deve riferirsi proprio a questo file
+ * @param bits La mappa, da liberare con free (NULL se non ci sono record eliminati)
+ * @param num_bits Quanti record descrive la mappa
+ * @param deleted Quanti record sono stati eliminati
+ * @return SUCCESS se la mappa è stata caricata (anche vuota), FAILURE se non c'è memoria per caricarla
+ */
+int load_table_tombstones(const char *table_name, FILE *table, unsigned char **bits, long *num_bits, long *deleted) {
+  *bits = NULL;
+  *num_bits = 0;
+  *deleted = 0;
+
+  char path[256];
+  get_tombstone_path(table_name, path, sizeof(path));
+
+  FILE *file = fopen(path, "rb");
+  if (!file) { return SUCCESS; }
+
+  TombstoneHeader header;
+  if (fread(&header, sizeof(TombstoneHeader), 1, file) != 1 || header.version != TOMBSTONE_VERSION ||
+      header.inode != get_table_inode(table) || header.deleted <= 0) {
+    fclose(file);
+    return SUCCESS;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long bytes = ftell(file) - (long)sizeof(TombstoneHeader);
+  fseek(file, (long)sizeof(TombstoneHeader), SEEK_SET);
+
+  *bits = bytes > 0 ? malloc((size_t)bytes) : NULL;
+  if (!*bits) {
+    fclose(file);
+    return bytes > 0 ? FAILURE : SUCCESS;
+  }
+
+  bytes = (long)fread(*bits, 1, (size_t)bytes, file);
+  fclose(file);
+
+  *num_bits = bytes * 8;
+  *deleted = (long)header.deleted;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che segna un record come eliminato.
+ * Viene letto e riscritto solo il byte del record e l'intestazione; se la mappa non esiste (o non corrisponde
+ * alla tabella) viene creata vuota.
+ * DELETE non la chiama direttamente: l'eliminazione passa dal log (vedi wal.c), che la chiama dopo il commit e,
+ * dopo un crash, di nuovo all'avvio. Per questo un record già eliminato non è un errore e non viene contato due volte.
+ *
+ * @param table_name La tabella
+ * @param table Il file della tabella, aperto
+ * @param position La posizione del record nel file (0 = primo record)
+ * @return SUCCESS se il record è segnato come eliminato, FAILURE altrimenti
+ */
+int mark_record_deleted(const char *table_name, FILE *table, long position) {
+  char path[256];
+  get_tombstone_path(table_name, path, sizeof(path));
+
+  FILE *file = fopen(path, "r+b");
+  if (!file) { file = fopen(path, "w+b"); }
+  if (!file) { return FAILURE; }
+
+  int fd = fileno(file);
+  uint64_t inode = get_table_inode(table);
+  TombstoneHeader header;
+
+  if (pread(fd, &header, sizeof(TombstoneHeader), 0) != (ssize_t)sizeof(TombstoneHeader) ||
+      header.version != TOMBSTONE_VERSION || header.inode != inode) {           // Mappa nuova (o di un'altra tabella): riparto da zero
+    memset(&header, 0, sizeof(TombstoneHeader));
+    header.version = TOMBSTONE_VERSION;
+    header.inode = inode;
+    if (ftruncate(fd, (off_t)sizeof(TombstoneHeader)) != 0) { fclose(file); return FAILURE; }
+  }
+
+  off_t offset = (off_t)sizeof(TombstoneHeader) + position / 8;
+  unsigned char mask = (unsigned char)(1u << (position % 8));
+  unsigned char byte = 0;
+  if (pread(fd, &byte, 1, offset) < 0) { fclose(file); return FAILURE; }       // Oltre la fine del file il byte vale 0
+  if (byte & mask) { fclose(file); return SUCCESS; }                            // Già eliminato (ad esempio riapplicando il log)
+
+  byte |= mask;
+  header.deleted++;
+  int result = pwrite(fd, &byte, 1, offset) == 1 && pwrite(fd, &header, sizeof(TombstoneHeader), 0) == (ssize_t)sizeof(TombstoneHeader) ? SUCCESS : FAILURE;
+  fclose(file);
+  return result;
+}
+
+
+/**
+ * Funzione che conta i record eliminati nel blocco di block_records record che contiene position.
+ * DELETE la usa dopo aver eliminato un record, per decidere se la tabella va compattata.
+ *
+ * @param table_name La tabella
+ * @param table Il file della tabella, aperto
+ * @param position La posizione di un record del blocco
+ * @param block_records Quanti record ci sono in un blocco
+ * @return I record eliminati nel blocco, 0 se la mappa non c'è o non corrisponde alla tabella
+ */
+long count_block_deleted(const char *table_name, FILE *table, long position, long block_records) {
+  char path[256];
+  get_tombstone_path(table_name, path, sizeof(path));
+
+  FILE *file = fopen(path, "rb");
+  if (!file) { return 0; }
+
+  int fd = fileno(file);
+  TombstoneHeader header;
+  if (pread(fd, &header, sizeof(TombstoneHeader), 0) != (ssize_t)sizeof(TombstoneHeader) ||
+      header.version != TOMBSTONE_VERSION || header.inode != get_table_inode(table)) {
+    fclose(file);
+    return 0;
+  }
+
+  long first = position - position % block_records;                             // Conto i bit a 1 del blocco
+  long first_byte = first / 8;
+  size_t span = (size_t)((first + block_records - 1) / 8 - first_byte + 1);
+  unsigned char *chunk = calloc(span, 1);                                       // Oltre la fine del file i byte restano a 0
+  long dead = 0;
+
+  if (chunk && pread(fd, chunk, span, (off_t)sizeof(TombstoneHeader) + first_byte) >= 0) {
+    for (long p = first; p < first + block_records; p++) {
+      if (chunk[p / 8 - first_byte] & (1u << (p % 8))) { dead++; }
+    }
+  }
+
+  free(chunk);
+  fclose(file);
+  return dead;
+}
+
+
+/**
+ * Funzione che costruisce il percorso della mappa di una tabella compattata, in attesa di sostituire quella vecchia.
+ */
+static void get_compacted_tombstone_path(const char *table_name, char *path, size_t size) {
+  snprintf(path, size, "%s/%s.del.compact", TABLES_DIR, table_name);
+}
+
+
+/**
+ * Funzione che scrive la mappa dei record eliminati di una tabella compattata, prima che la tabella venga sostituita.
+ * La tabella compattata non contiene più record eliminati, tranne al massimo l'ultimo (vedi compact.c).
+ * La mappa si riferisce già all'inode della copia e viene scritta in tables/<T>.del.compact: la installa
+ * install_compacted_tombstones dopo la rename della tabella. Così, comunque si fermi il programma, la tabella
+ * non resta mai senza la sua mappa: con la tabella vecchia vale la mappa vecchia, con quella nuova la nuova.
+ *
+ * @param table_name La tabella
+ * @param compacted Il file della tabella compattata, aperto e già durevole
+ * @param dead_position La posizione dell'unico record eliminato rimasto, -1 se non ce ne sono
+ * @return SUCCESS se la mappa è stata scritta ed è durevole, FAILURE altrimenti
+ */
+int write_compacted_tombstones(const char *table_name, FILE *compacted, long dead_position) {
+  char path[256];
+  get_compacted_tombstone_path(table_name, path, sizeof(path));
+
+  TombstoneHeader header = { TOMBSTONE_VERSION, 0, get_table_inode(compacted), dead_position < 0 ? 0 : 1 };
+  size_t bytes = dead_position < 0 ? 0 : (size_t)dead_position / 8 + 1;
+  unsigned char *bits = bytes > 0 ? calloc(bytes, 1) : NULL;
+  FILE *file = bytes == 0 || bits ? fopen(path, "wb") : NULL;
+  if (!file) {
+    free(bits);
+    return FAILURE;
+  }
+
+  if (bits) { bits[dead_position / 8] = (unsigned char)(1u << (dead_position % 8)); }
+  bool ok = fwrite(&header, sizeof(TombstoneHeader), 1, file) == 1 && (bytes == 0 || fwrite(bits, 1, bytes, file) == bytes);
+  ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+  ok = fclose(file) == 0 && ok;
+  free(bits);
+
+  if (!ok) { remove(path); }
+  return ok ? SUCCESS : FAILURE;
+}
+
+
+/**
+ * Funzione che installa la mappa scritta da write_compacted_tombstones, se si riferisce al file attuale della tabella.
+ * Altrimenti la compattazione non è arrivata alla rename (o è stata buttata) e la mappa viene cancellata.
+ * compact.c la chiama dopo la rename, e all'avvio per finire una compattazione interrotta tra le due rename.
+ *
+ * @param table_name La tabella
+ * @param table Il file della tabella, aperto
+ * @return SUCCESS se non c'era niente da installare o la mappa è stata installata, FAILURE altrimenti
+ */
+int install_compacted_tombstones(const char *table_name, FILE *table) {
+  char path[256], compacted_path[256];
+  get_tombstone_path(table_name, path, sizeof(path));
+  get_compacted_tombstone_path(table_name, compacted_path, sizeof(compacted_path));
+
+  FILE *file = fopen(compacted_path, "rb");
+  if (!file) { return SUCCESS; }
+
+  TombstoneHeader header;
+  bool matches = fread(&header, sizeof(TombstoneHeader), 1, file) == 1 && header.version == TOMBSTONE_VERSION &&
+                 header.inode == get_table_inode(table);
+  fclose(file);
+
+  if (!matches) {
+    remove(compacted_path);
+    return SUCCESS;
+  }
+  return rename(compacted_path, path) == 0 ? SUCCESS : FAILURE;
+}
@@ -0,0 +1,19 @@
+#ifndef TOMBSTONE_H
+#define TOMBSTONE_H
+
+#include <stdio.h>
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Tombstone
+int load_table_tombstones(const char *table_name, FILE *table, unsigned char **bits, long *num_bits, long *deleted);
+int mark_record_deleted(const char *table_name, FILE *table, long position);
+long count_block_deleted(const char *table_name, FILE *table, long position, long block_records);
+int write_compacted_tombstones(const char *table_name, FILE *compacted, long dead_position);
+int install_compacted_tombstones(const char *table_name, FILE *table);
+
+
+
+#endif
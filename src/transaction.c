@@ -0,0 +1,582 @@
+/*
+
+
+  Transaction.c è il file che tiene le scritture di una transazione (BEGIN … COMMIT) fino al COMMIT.
+  Le funzioni descritte in questo file sono:
+    - in_transaction:           dice se c'è una transazione aperta.
+    - begin_transaction:        apre una transazione.
+    - commit_transaction:       scrive tutte le modifiche della transazione, con un solo commit durevole nel log.
+    - rollback_transaction:     annulla la transazione, buttando le modifiche tenute in memoria.
+    - stage_table_append:       rimanda al COMMIT dei record da aggiungere in fondo a una tabella (CREATE, EXECUTE).
+    - stage_table_write:        rimanda al COMMIT la scrittura di alcuni byte di una tabella (UPDATE).
+    - stage_record_deleted:     rimanda al COMMIT l'eliminazione di un record già nella tabella (DELETE).
+    - is_record_staged_deleted: dice se un record già nella tabella è stato eliminato dalla transazione.
+    - overlay_staged_changes:   copia sopra dei byte letti da una tabella le modifiche della transazione (UPDATE).
+    - find_staged_record:       cerca per id un record aggiunto dalla transazione, per cambiarlo (UPDATE).
+    - delete_staged_record:     elimina un record aggiunto dalla transazione (DELETE).
+    - next_staged_record:       scorre i record aggiunti dalla transazione (UPDATE … WHERE).
+    - stage_schema_change:      segna che la transazione ha definito una tabella (DEFINE): lo schema si scrive al COMMIT.
+
+  Come funziona?
+  Dopo BEGIN i comandi che scrivono non toccano né i file né il log: le loro modifiche restano in memoria, divise per tabella.
+    ✅ i record aggiunti stanno uno dopo l'altro in un unico buffer, già con il loro id: al COMMIT diventano una sola scrittura
+       in fondo alla tabella;
+    ✅ le modifiche ai record già nella tabella sono una sequenza di StagedChange (dove e quanti byte) seguiti dai byte;
+    ✅ le eliminazioni sono le posizioni dei record.
+  Il COMMIT trasforma tutto in una sola transazione del log (vedi wal.c): un solo record di commit e un solo fdatasync
+  per tutti i comandi, su tutte le tabelle. O vengono applicate tutte le modifiche, o nessuna.
+  Il ROLLBACK libera i buffer: non c'è niente da annullare nei file, perchè non sono mai stati toccati.
+  Le tabelle definite con DEFINE nella transazione vengono tolte dallo schema in memoria (sono sempre le ultime).
+
+  Cosa vedono le letture?
+  READ, FIND, AGGREGATE e JOIN leggono i file, quindi vedono i dati confermati: le modifiche della transazione diventano
+  visibili dopo il COMMIT. UPDATE e DELETE vedono invece anche le modifiche della transazione: i record aggiunti,
+  quelli eliminati e i campi già cambiati (vedi overlay_staged_changes), così due UPDATE dello stesso record si sommano.
+
+  Durante la transazione la compattazione è sospesa (vedi compact.c): le posizioni dei record segnate per UPDATE e DELETE
+  devono restare valide fino al COMMIT. Le aggregazioni materializzate delle tabelle modificate vengono aggiornate al COMMIT
+con le differenze della transazione: +1 per i record aggiunti, -1/+1 (vecchio e nuovo) per quelli cambiati, -1 per quelli eliminati.
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, snprintf, fseek, ftell
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, realloc, free, qsort
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memset, strncpy, strcmp
+#include <sys/stat.h>               // stat
+
+#include "transaction.h"
+#include "schema.h"
+#include "utils.h"
+#include "wal.h"
+#include "compact.h"
+#include "materialize.h"
+
+
+typedef struct {                                // StagedChange: una scrittura rimandata dentro una tabella, seguita dai suoi byte
+  long offset;                                  // offset: il byte della tabella da cui scrivere
+  size_t length;                                // length: quanti byte
+} StagedChange;
+
+typedef struct {                                // StagedTable: le modifiche di una tabella, tenute fino al COMMIT
+  char nome_tabella[50];                        // nome_tabella: la tabella
+  size_t record_size;                           // record_size: dimensione di un record
+  int first_id;                                 // first_id: id del primo record aggiunto dalla transazione
+  int next_id;                                  // next_id: id del prossimo record da aggiungere, 0 se non ne sono ancora stati aggiunti
+  char *appends;                                // appends: i record aggiunti, consecutivi come verranno scritti in fondo alla tabella
+  char *appends_deleted;                        // appends_deleted: per ogni record aggiunto, 1 se la transazione lo ha poi eliminato
+  long num_appends, appends_capacity, appends_deleted_capacity;
+  char *changes;                                // changes: sequenza di StagedChange, ognuno seguito dai suoi byte (allineati a 8)
+  long changes_length, changes_capacity;
+  long *deleted;                                // deleted: posizioni dei record già nella tabella eliminati dalla transazione, in ordine
+  long num_deleted, deleted_capacity;
+} StagedTable;
+
+
+static bool active = false;                     // C'è una transazione aperta
+static bool failed = false;                     // Una modifica non è stata tenuta (memoria finita): il COMMIT non si può fare
+static StagedTable tables[MAX_TABLES];
+static int num_tables = 0;
+static int schema_tables = 0;                   // Tabelle dello schema al BEGIN: quelle dopo sono state definite dalla transazione
+static bool schema_changed = false;
+
+
+/**
+ * Funzione che ingrandisce un buffer della transazione (raddoppiandolo) finché non contiene needed elementi.
+ * Se non c'è memoria, la transazione fallisce.
+ *
+ * @return SUCCESS se il buffer è abbastanza grande, FAILURE altrimenti
+ */
+static int grow_staged_buffer(void **buffer, long *capacity, long needed, size_t element_size) {
+  if (needed <= *capacity) { return SUCCESS; }
+
+  long grown_capacity = *capacity ? *capacity : 64;
+  while (grown_capacity < needed) { grown_capacity *= 2; }
+
+  void *grown = realloc(*buffer, (size_t)grown_capacity * element_size);
+  if (!grown) {
+    printf("❌ Errore: memoria insufficiente per la transazione, usa ROLLBACK\n");
+    failed = true;
+    return FAILURE;
+  }
+
+  *buffer = grown;
+  *capacity = grown_capacity;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che cerca le modifiche di una tabella.
+ *
+ * @param table_name La tabella
+ * @param create true per aggiungere la tabella se non ha ancora modifiche
+ * @return Le modifiche della tabella, NULL se non ne ha (o la tabella non esiste)
+ */
+static StagedTable *get_staged_table(const char *table_name, bool create) {
+  for (int i = 0; i < num_tables; i++) {
+    if (strcmp(tables[i].nome_tabella, table_name) == SUCCESS) { return &tables[i]; }
+  }
+
+  size_t record_size = get_record_size(table_name);
+  if (!create || num_tables == MAX_TABLES || record_size == 0) { return NULL; }
+
+  StagedTable *table = &tables[num_tables++];
+  memset(table, 0, sizeof(StagedTable));
+  strncpy(table->nome_tabella, table_name, sizeof(table->nome_tabella) - 1);
+  table->record_size = record_size;
+  return table;
+}
+
+
+/**
+ * Funzione che butta tutte le modifiche tenute dalla transazione e la chiude.
+ */
+static void discard_transaction() {
+  for (int i = 0; i < num_tables; i++) {
+    free(tables[i].appends);
+    free(tables[i].appends_deleted);
+    free(tables[i].changes);
+    free(tables[i].deleted);
+  }
+
+  num_tables = 0;
+  schema_changed = false;
+  failed = false;
+  active = false;
+  resume_compaction();
+}
+
+
+/**
+ * Funzione che toglie dallo schema in memoria le tabelle definite dalla transazione.
+ */
+static void discard_schema_changes() {
+  if (!schema_changed) { return; }
+
+  pthread_mutex_lock(&schema.mutex);
+  for (int i = schema_tables; i < schema.num_tabelle; i++) { memset(&schema.tabelle[i], 0, sizeof(TableDefinition)); }
+  schema.num_tabelle = schema_tables;
+  pthread_mutex_unlock(&schema.mutex);
+}
+
+
+/**
+ * Funzione che dice se c'è una transazione aperta.
+ */
+bool in_transaction() {
+  return active;
+}
+
+
+/**
+ * Funzione che apre una transazione. Da qui al COMMIT le scritture vengono tenute in memoria.
+ * @return SUCCESS se la transazione è stata aperta, FAILURE se ce n'era già una
+ */
+int begin_transaction() {
+  if (active) { return FAILURE; }
+
+  pause_compaction();                                             // Le posizioni dei record devono restare quelle di adesso
+  active = true;
+  failed = false;
+  num_tables = 0;
+  schema_tables = schema.num_tabelle;
+  schema_changed = false;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che ottiene la dimensione attuale del file di una tabella, 0 se il file non esiste ancora.
+ */
+static long get_table_file_size(const char *table_name) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s.bin", TABLES_DIR, table_name);
+
+  struct stat st;
+  return stat(path, &st) == 0 ? (long)st.st_size : 0;
+}
+
+
+/**
+ * Funzione che scrive nel log le modifiche di una tabella:
+ * i record aggiunti con una sola scrittura in fondo al file, poi le modifiche ai record, poi le eliminazioni.
+ *
+ * @param txn La transazione del log
+ * @param table Le modifiche della tabella
+ * @param base La posizione (in record) da cui vengono aggiunti i nuovi record
+ */
+static void log_staged_table(WalTransaction *txn, const StagedTable *table, long base) {
+  if (table->num_appends > 0) {
+    wal_log_table_write(txn, table->nome_tabella, base * (long)table->record_size, table->appends, (size_t)table->num_appends * table->record_size);
+  }
+
+  for (long pos = 0; pos < table->changes_length; ) {
+    StagedChange change;
+    memcpy(&change, table->changes + pos, sizeof(StagedChange));
+    wal_log_table_write(txn, table->nome_tabella, change.offset, table->changes + pos + sizeof(StagedChange), change.length);
+    pos += (long)(sizeof(StagedChange) + ((change.length + 7) & ~(size_t)7));
+  }
+
+  for (long i = 0; i < table->num_deleted; i++) { wal_log_record_deleted(txn, table->nome_tabella, table->deleted[i]); }
+  for (long i = 0; i < table->num_appends; i++) {
+    if (table->appends_deleted[i]) { wal_log_record_deleted(txn, table->nome_tabella, base + i); }
+  }
+}
+
+
+/**
+ * Funzione che controlla, dopo il COMMIT, se i blocchi con dei record eliminati dalla transazione vanno compattati.
+ */
+static void check_staged_compaction(const StagedTable *table, long base) {
+  long total = base + table->num_appends;
+  FILE *file = open_table_file(table->nome_tabella, "rb");
+  if (!file) { return; }
+
+  for (long i = 0; i < table->num_deleted + table->num_appends; i++) {
+    if (i >= table->num_deleted && !table->appends_deleted[i - table->num_deleted]) { continue; }
+
+    long position = i < table->num_deleted ? table->deleted[i] : base + i - table->num_deleted;
+    if (request_compaction_if_needed(table->nome_tabella, file, position, total, table->record_size)) { break; }   // Basta chiederla una volta
+  }
+  fclose(file);
+}
+
+
+/**
+ * Funzione che confronta due posizioni, per qsort.
+ */
+static int compare_positions(const void *a, const void *b) {
+  long x = *(const long *)a, y = *(const long *)b;
+  return (x > y) - (x < y);
+}
+
+
+/**
+ * Funzione che raccoglie le differenze della transazione per le viste materializzate di una tabella (vedi materialize.c).
+ * Va chiamata prima di applicare le modifiche, perchè i record cambiati ed eliminati vengono letti dal file come erano.
+ * Se un record non si può leggere, le viste vengono ricalcolate dopo il COMMIT.
+ *
+ * @param table Le modifiche della tabella
+ * @param views Le differenze delle viste, da confermare dopo il COMMIT
+ */
+static void stage_view_changes(const StagedTable *table, ViewChanges *views) {
+  begin_view_changes(table->nome_tabella, views);
+  if (views->num_views == 0) { return; }
+
+  for (long i = 0; i < table->num_appends; i++) {                 // I record aggiunti, senza quelli poi eliminati
+    if (!table->appends_deleted[i]) { add_view_change(views, table->appends + (size_t)i * table->record_size, 1); }
+  }
+
+  long num_positions = 0;                                         // Le posizioni dei record cambiati, una volta sola
+  long *positions = NULL;
+  for (long pos = 0; pos < table->changes_length; ) {
+    StagedChange change;
+    memcpy(&change, table->changes + pos, sizeof(StagedChange));
+    num_positions += (long)((change.offset + (long)change.length - 1) / (long)table->record_size - change.offset / (long)table->record_size + 1);
+    pos += (long)(sizeof(StagedChange) + ((change.length + 7) & ~(size_t)7));
+  }
+  if (num_positions > 0) { positions = malloc((size_t)num_positions * sizeof(long)); }
+
+  long count = 0;
+  for (long pos = 0; positions && pos < table->changes_length; ) {
+    StagedChange change;
+    memcpy(&change, table->changes + pos, sizeof(StagedChange));
+    long last = (change.offset + (long)change.length - 1) / (long)table->record_size;
+    for (long position = change.offset / (long)table->record_size; position <= last; position++) { positions[count++] = position; }
+    pos += (long)(sizeof(StagedChange) + ((change.length + 7) & ~(size_t)7));
+  }
+  if (count > 1) { qsort(positions, (size_t)count, sizeof(long), compare_positions); }
+
+  FILE *file = open_table_file(table->nome_tabella, "rb");
+  char *old_record = malloc(table->record_size);
+  char *new_record = malloc(table->record_size);
+  bool ok = file && old_record && new_record && (num_positions == 0 || positions);
+
+  for (long i = 0; ok && i < count; i++) {                        // I record cambiati: tolgo il vecchio e aggiungo il nuovo
+    if (i > 0 && positions[i] == positions[i - 1]) { continue; }
+    if (is_record_staged_deleted(table->nome_tabella, positions[i])) { continue; }
+
+    long offset = positions[i] * (long)table->record_size;
+    ok = fseek(file, offset, SEEK_SET) == 0 && fread(old_record, table->record_size, 1, file) == 1;
+    if (!ok) { break; }
+
+    memcpy(new_record, old_record, table->record_size);
+    overlay_staged_changes(table->nome_tabella, offset, new_record, table->record_size);
+    add_view_change(views, old_record, -1);
+    add_view_change(views, new_record, 1);
+  }
+
+  for (long i = 0; ok && i < table->num_deleted; i++) {           // I record eliminati
+    ok = fseek(file, table->deleted[i] * (long)table->record_size, SEEK_SET) == 0 && fread(old_record, table->record_size, 1, file) == 1;
+    if (ok) { add_view_change(views, old_record, -1); }
+  }
+
+  if (!ok) {
+    for (int v = 0; v < views->num_views; v++) { views->views[v]->stale = true; }
+  }
+
+  if (file) { fclose(file); }
+  free(positions);
+  free(old_record);
+  free(new_record);
+}
+
+
+/**
+ * Funzione che conferma la transazione.
+ * Step 1: scrivo nel log lo schema, se è cambiato, e le modifiche di ogni tabella, in una sola transazione del log
+ * Step 2: con un solo commit (e un solo fdatasync) le rendo durevoli e le applico ai file
+ * Step 3: aggiorno le aggregazioni materializzate delle tabelle modificate e, se serve, chiedo di compattarle
+ *
+ * @return SUCCESS se tutte le modifiche sono state applicate, FAILURE se non ne è stata applicata nessuna
+ */
+int commit_transaction() {
+  if (!active) { return FAILURE; }
+  if (failed) {
+    printf("❌ Errore: una modifica della transazione non è stata tenuta, nessuna modifica applicata\n");
+    rollback_transaction();
+    return FAILURE;
+  }
+
+  WalTransaction txn;                                             // Step 1: una sola transazione del log
+  wal_begin(&txn);
+  if (schema_changed) { wal_log_schema(&txn, &schema); }
+
+  long bases[MAX_TABLES];
+  ViewChanges views[MAX_TABLES];
+  for (int i = 0; i < num_tables; i++) {
+    bases[i] = get_table_file_size(tables[i].nome_tabella) / (long)tables[i].record_size;
+    log_staged_table(&txn, &tables[i], bases[i]);
+    stage_view_changes(&tables[i], &views[i]);
+  }
+
+  if (wal_commit(&txn) != SUCCESS) {                              // Step 2: un solo commit durevole
+    for (int i = 0; i < num_tables; i++) { discard_view_changes(&views[i]); }
+    rollback_transaction();
+    return FAILURE;
+  }
+
+  for (int i = 0; i < num_tables; i++) {                          // Step 3: viste e compattazione
+    commit_view_changes(&views[i]);
+    check_staged_compaction(&tables[i], bases[i]);
+  }
+
+  discard_transaction();
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che annulla la transazione: le modifiche tenute in memoria vengono buttate, i file non sono mai stati toccati.
+ */
+void rollback_transaction() {
+  if (!active) { return; }
+
+  discard_schema_changes();
+  discard_transaction();
+}
+
+
+/**
+ * Funzione che rimanda al COMMIT dei record da aggiungere in fondo a una tabella.
+ * Gli id vengono assegnati qui, dopo l'ultimo della tabella e di quelli già aggiunti dalla transazione,
+ * e scritti nel primo campo dei record.
+ *
+ * @param table_name La tabella
+ * @param record_size La dimensione di un record
+ * @param records I record, consecutivi: l'id viene valorizzato qui
+ * @param count Quanti record
+ * @return SUCCESS se i record sono stati tenuti, FAILURE altrimenti
+ */
+int stage_table_append(const char *table_name, size_t record_size, char *records, int count) {
+  StagedTable *table = get_staged_table(table_name, true);
+  if (!table || table->record_size != record_size) { failed = true; return FAILURE; }
+
+  if (table->next_id == 0) {                                      // Il primo record aggiunto: leggo l'ultimo id della tabella
+    FILE *file = open_table_file(table_name, "rb");
+    table->next_id = 1;
+    if (file) {
+      fseek(file, 0, SEEK_END);
+      table->next_id = read_next_id(file, ftell(file), record_size);
+      fclose(file);
+    }
+    table->first_id = table->next_id;
+  }
+
+  long needed = table->num_appends + count;
+  if (grow_staged_buffer((void **)&table->appends, &table->appends_capacity, needed, record_size) != SUCCESS ||
+      grow_staged_buffer((void **)&table->appends_deleted, &table->appends_deleted_capacity, needed, 1) != SUCCESS) {
+    return FAILURE;
+  }
+
+  for (int r = 0; r < count; r++) {
+    int id = table->next_id++;
+    memcpy(records + (size_t)r * record_size, &id, sizeof(int));  // L'id è sempre il primo campo del record
+  }
+
+  memcpy(table->appends + (size_t)table->num_appends * record_size, records, (size_t)count * record_size);
+  memset(table->appends_deleted + table->num_appends, 0, (size_t)count);
+  table->num_appends = needed;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che rimanda al COMMIT la scrittura di alcuni byte di un record già nella tabella.
+ *
+ * @param table_name La tabella
+ * @param offset Il byte della tabella da cui scrivere
+ * @param data I byte da scrivere
+ * @param length Quanti byte
+ * @return SUCCESS se la scrittura è stata tenuta, FAILURE altrimenti
+ */
+int stage_table_write(const char *table_name, long offset, const void *data, size_t length) {
+  StagedTable *table = get_staged_table(table_name, true);
+  if (!table) { failed = true; return FAILURE; }
+
+  long size = (long)(sizeof(StagedChange) + ((length + 7) & ~(size_t)7));
+  if (grow_staged_buffer((void **)&table->changes, &table->changes_capacity, table->changes_length + size, 1) != SUCCESS) { return FAILURE; }
+
+  StagedChange change = { offset, length };
+  memcpy(table->changes + table->changes_length, &change, sizeof(StagedChange));
+  memcpy(table->changes + table->changes_length + sizeof(StagedChange), data, length);
+  table->changes_length += size;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che cerca, con una ricerca binaria, dove sta (o andrebbe) una posizione tra quelle eliminate di una tabella.
+ */
+static long find_staged_deleted(const StagedTable *table, long position) {
+  long low = 0, high = table->num_deleted;
+  while (low < high) {
+    long mid = low + (high - low) / 2;
+    if (table->deleted[mid] < position) { low = mid + 1; }
+    else { high = mid; }
+  }
+  return low;
+}
+
+
+/**
+ * Funzione che rimanda al COMMIT l'eliminazione di un record già nella tabella.
+ * Le posizioni restano in ordine, così is_record_staged_deleted è una ricerca binaria.
+ *
+ * @param table_name La tabella
+ * @param position La posizione del record nel file
+ * @return SUCCESS se l'eliminazione è stata tenuta, FAILURE altrimenti
+ */
+int stage_record_deleted(const char *table_name, long position) {
+  StagedTable *table = get_staged_table(table_name, true);
+  if (!table) { failed = true; return FAILURE; }
+
+  long index = find_staged_deleted(table, position);
+  if (index < table->num_deleted && table->deleted[index] == position) { return SUCCESS; }
+  if (grow_staged_buffer((void **)&table->deleted, &table->deleted_capacity, table->num_deleted + 1, sizeof(long)) != SUCCESS) { return FAILURE; }
+
+  memmove(table->deleted + index + 1, table->deleted + index, (size_t)(table->num_deleted - index) * sizeof(long));
+  table->deleted[index] = position;
+  table->num_deleted++;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che dice se un record già nella tabella è stato eliminato dalla transazione.
+ */
+bool is_record_staged_deleted(const char *table_name, long position) {
+  StagedTable *table = active ? get_staged_table(table_name, false) : NULL;
+  if (!table) { return false; }
+
+  long index = find_staged_deleted(table, position);
+  return index < table->num_deleted && table->deleted[index] == position;
+}
+
+
+/**
+ * Funzione che copia sopra dei byte letti da una tabella le scritture della transazione che li toccano, nell'ordine in cui
+ * sono state fatte. Così un UPDATE parte dal record come lo ha lasciato l'UPDATE precedente della stessa transazione.
+ *
+ * @param table_name La tabella
+ * @param offset Il byte della tabella da cui sono stati letti
+ * @param data I byte letti, da aggiornare
+ * @param length Quanti byte
+ */
+void overlay_staged_changes(const char *table_name, long offset, char *data, size_t length) {
+  StagedTable *table = active ? get_staged_table(table_name, false) : NULL;
+  if (!table) { return; }
+
+  long end = offset + (long)length;
+  for (long pos = 0; pos < table->changes_length; ) {
+    StagedChange change;
+    memcpy(&change, table->changes + pos, sizeof(StagedChange));
+    long change_end = change.offset + (long)change.length;
+
+    if (change.offset < end && change_end > offset) {             // Copio solo la parte in comune
+      long from = change.offset > offset ? change.offset : offset;
+      long to = change_end < end ? change_end : end;
+      memcpy(data + (from - offset), table->changes + pos + sizeof(StagedChange) + (from - change.offset), (size_t)(to - from));
+    }
+    pos += (long)(sizeof(StagedChange) + ((change.length + 7) & ~(size_t)7));
+  }
+}
+
+
+/**
+ * Funzione che cerca per id un record aggiunto dalla transazione (e non eliminato).
+ * Il puntatore resta valido fino alla prossima stage_table_append della tabella.
+ *
+ * @return Il record, da cambiare al suo posto, NULL se la transazione non lo ha aggiunto
+ */
+char *find_staged_record(const char *table_name, int id) {
+  StagedTable *table = active ? get_staged_table(table_name, false) : NULL;
+  if (!table || table->num_appends == 0) { return NULL; }
+
+  long index = (long)id - table->first_id;                        // Gli id aggiunti sono consecutivi
+  if (index < 0 || index >= table->num_appends || table->appends_deleted[index]) { return NULL; }
+  return table->appends + (size_t)index * table->record_size;
+}
+
+
+/**
+ * Funzione che elimina un record aggiunto dalla transazione. Il record resta nel buffer, segnato come eliminato:
+ * al COMMIT viene scritto ed eliminato, così il suo id non viene riassegnato.
+ *
+ * @return SUCCESS se il record è stato eliminato, FAILURE se la transazione non lo ha aggiunto
+ */
+int delete_staged_record(const char *table_name, int id) {
+  if (!find_staged_record(table_name, id)) { return FAILURE; }
+
+  StagedTable *table = get_staged_table(table_name, false);
+  table->appends_deleted[id - table->first_id] = 1;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che scorre i record aggiunti dalla transazione a una tabella, saltando quelli eliminati.
+ *
+ * @param table_name La tabella
+ * @param index Da dove ripartire: 0 la prima volta, poi viene avanzato
+ * @return Il prossimo record, NULL quando sono finiti
+ */
+char *next_staged_record(const char *table_name, long *index) {
+  StagedTable *table = active ? get_staged_table(table_name, false) : NULL;
+  if (!table) { return NULL; }
+
+  while (*index < table->num_appends) {
+    long current = (*index)++;
+    if (!table->appends_deleted[current]) { return table->appends + (size_t)current * table->record_size; }
+  }
+  return NULL;
+}
+
+
+/**
+ * Funzione che segna che la transazione ha definito una tabella: lo schema viene scritto nel log al COMMIT.
+ */
+void stage_schema_change() {
+  schema_changed = true;
+}
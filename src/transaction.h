@@ -0,0 +1,25 @@
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+// Config Header
+#include "../config.h"
+
+
+// Functions Available including the Transaction
+bool in_transaction();
+int begin_transaction();
+int commit_transaction();
+void rollback_transaction();
+int stage_table_append(const char *table_name, size_t record_size, char *records, int count);
+int stage_table_write(const char *table_name, long offset, const void *data, size_t length);
+int stage_record_deleted(const char *table_name, long position);
+bool is_record_staged_deleted(const char *table_name, long position);
+void overlay_staged_changes(const char *table_name, long offset, char *data, size_t length);
+char *find_staged_record(const char *table_name, int id);
+int delete_staged_record(const char *table_name, int id);
+char *next_staged_record(const char *table_name, long *index);
+void stage_schema_change();
+
+
+
+#endif
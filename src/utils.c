@@ -7,9 +7,14 @@
   Le funzioni descritte in questo file sono:
     - parse_column_definition:                analizza un token e se è valido, restituisce una ColumnDefinition.
     - parse_column_type:                      analizza una tipologia di campo e se è valida restituisce una ColumnType.
-    - get_next_id_for_table:                  ottiene il prossimo ID Univoco disponibile per una tabella. 
+    - get_column_kind:                        ottiene la tipologia interna (ColumnKind) di una ColumnType.
+    - bind_column_values:                     abbina i token <campo>:<valore> alle colonne e li converte nel record.
+    - convert_column_value:                   converte un valore nel suo campo di un record, anche se non è allineato.
+    - read_next_id:                           ottiene il prossimo ID Univoco disponibile per una tabella. 
     - long get_current_timestamp:             ottiene il Timestamp di questo preciso momento.
     - get_null_value                          ottiene il valore NULL per una tipologia di dato
+    - hash_bytes:                             calcola l'hash di una chiave (usato da GROUP BY e JOIN).
+    - copy_path_token:                        copia il percorso di un file da un token, senza gli apici.
     - verify_is_only_letters:                 verifica che una variabile contenga solo caratteri alfabetici.
 
   In questo file è anche definito l'array di column_types, ovvero la lista di tutti i tipi di campi disponibili a sistema.
@@ -31,6 +36,7 @@
 
 #include "utils.h"
 #include "schema.h"
+#include "cache.h"
 
 
 /** TIPI DI CAMPI UTILIZZABILI A SISTEMA */
@@ -64,8 +70,9 @@ ColumnDefinition parse_column_definition(const char *token) {
   ColumnDefinition column;
   memset(&column, 0, sizeof(ColumnDefinition));                 // Inizializza la struttura a 0. è importante per evitare valori non inizializzati
 
-  char nome_colonna[100], tipo_colonna[100];
-  if (split_token(token, ':', nome_colonna, tipo_colonna) == FAILURE) {
+  char nome_colonna[50];
+  const char *tipo_colonna;
+  if (split_token(token, ':', nome_colonna, sizeof(nome_colonna), &tipo_colonna) == FAILURE) {
     printf("Errore: il campo %s non è definito correttamente.\n", token);
     return column;
   }
@@ -104,100 +111,120 @@ ColumnType parse_column_type(const char *tipo_colonna) {
 }
 
 /** 
- * Funzione per ottenere la coppia Colonna:Valore in formato ColumnValueDefinition, da un token.
- * Questo è l'unico modo per assicurarsi che il token <campo>:<valore> sia effettivamente un token valido per la tabella.
- * Questo parsing comprende anche il controllo sulla validità del campo, se il campo appartiene alla tabella e se il valore è valido.
- * Se il valore del token è valido, lo converte già nel tipo corrispondente del campo.
+ * Funzione per ottenere la tipologia interna di una colonna.
+ * Confrontare i nomi dei tipi con strcmp va bene quando lo si fa una volta per comando,
+ * ma non per ogni record letto: per questo chi scansiona una tabella si ricava il ColumnKind una volta sola.
  * 
- * @param table: la tabella di riferimento, il token
- * @return Il puntatore alla struttura ColumnValueDefinition se valido, NULL altrimenti
-*/
-ColumnValueDefinition parse_column_value_definition(TableDefinition *table, const char *token) {
-  ColumnValueDefinition couple;
-  memset(&couple, 0, sizeof(ColumnValueDefinition));            // Inizializza la struttura a 0. è importante per evitare valori non inizializzati
+ * @param tipo Il tipo di colonna
+ * @return Il ColumnKind corrispondente, KIND_UNKNOWN se il tipo non è valido
+ */
+ColumnKind get_column_kind(ColumnType tipo) {
+  if (strcmp(tipo.name, "int")       == SUCCESS) return KIND_INT;
+  if (strcmp(tipo.name, "char")      == SUCCESS) return KIND_CHAR;
+  if (strcmp(tipo.name, "float")     == SUCCESS) return KIND_FLOAT;
+  if (strcmp(tipo.name, "double")    == SUCCESS) return KIND_DOUBLE;
+  if (strcmp(tipo.name, "bool")      == SUCCESS) return KIND_BOOL;
+  if (strcmp(tipo.name, "timestamp") == SUCCESS) return KIND_TIMESTAMP;
+  return KIND_UNKNOWN;
+}
 
-  char nome_colonna[100], valore[100];
-  if (split_token(token, ':', nome_colonna, valore) == FAILURE) {
-    printf("Errore: il campo %s non è definito correttamente.\n", token);
-    return couple;
-  }
+/**
+ * Funzione che converte un valore nel suo campo di un record.
+ * I campi di un record sono uno dopo l'altro, senza spazi: dopo una colonna char da 255 byte un int o un double
+ * non è allineato, e le funzioni di conversione lo scriverebbero con un accesso non allineato.
+ * I numeri vengono quindi convertiti in una variabile allineata e copiati; le stringhe vanno direttamente nel campo.
+ *
+ * @param col La colonna
+ * @param input Il valore come testo
+ * @param field Il campo del record (record + col->offset)
+ * @return true se il valore è valido per il tipo della colonna, false altrimenti
+ */
+bool convert_column_value(const LayoutColumn *col, const char *input, char *field) {
+  if (col->kind == KIND_CHAR) { return col->tipo.convert(input, field); }
 
-  // Cerco la colonna nella tabella
-  ColumnDefinition *col_def = NULL;
-  for (int i = 0; i < table->num_colonne; i++) {
-    if (strcmp(table->colonne[i].nome_colonna, nome_colonna) == 0) {
-      col_def = &table->colonne[i];
-      break;
-    }
-  }
-  if (!col_def) { return couple; }                              // Se la colonna non esiste, ritorna un oggetto "non valido"
-
-  ColumnType tipo = col_def->tipo;                              // Ottengo il tipo di colonna
-  couple.valore = malloc(tipo.length);                          // Alloco spazio per il valore e lo converto
-  if (!couple.valore) { 
-    printf("Errore: malloc fallita per la colonna %s\n", nome_colonna);
-    return couple; 
-  }                        // Se la memoria non può essere allocata, ritorna un oggetto "non valido"
-
-  if (!tipo.convert(valore, couple.valore)) {                   // Converto il valore
-    printf("Errore: funzione di conversione NULL per il tipo %s\n", tipo.name);
-    free(couple.valore);
-    couple.valore = NULL;
-    return couple;
-  }
+  union { int i; float f; double d; long l; bool b; } value;
+  if (!col->tipo.convert(input, &value)) { return false; }
 
-  couple.campo = *col_def;
-  return couple;
+  memcpy(field, &value, (size_t)col->tipo.length);
+  return true;
 }
 
 
-
-/**
- * Funzione per ottenere il prossimo ID disponibile per una tabella.
- * Come prima cosa, cerca il file binario corrispondente al nome della tabella.
- * Se il file non esiste o è vuoto, ritorno 1, non essendoci record salvati a database.
- * Se il file non è vuoto, mi leggo l'ultimo record del file.
- * Avendo lo schema della tabella in questione, posso facilmente leggere un record intero.
- * Aggiungo 1 all'id dell'ultimo record.
+/** 
+ * Funzione che abbina i token <campo>:<valore> alle colonne di un record e converte ogni valore direttamente al suo offset.
+ * Questo è l'unico modo per assicurarsi che i token <campo>:<valore> siano effettivamente validi per la tabella:
+ * il campo deve esistere, non deve essere automatico (id, created_at, updated_at), non deve essere ripetuto
+ * e il valore deve essere convertibile nel tipo della colonna.
+ * Il record parte con il NULL di ogni colonna, così le colonne non indicate restano nulle.
+ * Tutto avviene in un solo passaggio sui token e senza allocare memoria.
  * 
- * @param table_name: il nome della tabella
- * @return id (int). In caso di errore ritorna -1
- */
-int get_next_id_for_table(const char *table_name) {
-  char filename[100];
-  snprintf(filename, sizeof(filename), "tables/%s.bin", table_name);                // Creo il nome del file relativo alla tabella
+ * Se params non è NULL, il valore ? non viene convertito: l'indice della colonna viene aggiunto a params (usato da PREPARE).
+ * 
+ * @param layout: il layout del record, i token, il primo token da abbinare, il record da valorizzare
+ * @return SUCCESS se tutti i token sono validi, FAILURE altrimenti
+*/
+int bind_column_values(const RecordLayout *layout, char *tokens[], int start, int token_count, char *record, int *params, int *num_params) {
+  bool assigned[MAX_LAYOUT_COLUMNS] = { false };
 
-  FILE *file = fopen(filename, "rb");
-  if (!file) { return 1; }                                                          // Se il file non esiste, ritorno 1
+  for (int c = 0; c < layout->num_colonne; c++) {
+    const LayoutColumn *col = &layout->colonne[c];
+    memcpy(record + col->offset, get_null_value(col->tipo), col->tipo.length);
+  }
 
-  fseek(file, 0, SEEK_END);                                                         // Se esiste, posiziono il cursore alla fine del file
+  for (int i = start; i < token_count; i++) {
+    char campo[100];
+    const char *valore;
+    if (split_token(tokens[i], ':', campo, sizeof(campo), &valore) == FAILURE) {
+      printf("Errore: token non valido per %s\n", tokens[i]);
+      return FAILURE;
+    }
 
-  long file_size = ftell(file);                                                     // Verifica che il file non sia vuoto
-  if (file_size == 0) {
-    fclose(file);
-    return 1;                                                                       // Se il file è vuoto, il primo ID sarà 1
+    int index = get_layout_column_index(layout, campo);
+    if (index < 0) {
+      printf("Errore: token non valido per %s\n", tokens[i]);
+      return FAILURE;
+    }
+    if (index == 0 || strcmp(campo, "created_at") == SUCCESS || strcmp(campo, "updated_at") == SUCCESS) {   // L'id è sempre la colonna 0
+      printf("❌ Errore: il campo '%s' viene valorizzato in automatico\n", campo);
+      return FAILURE;
+    }
+    if (assigned[index]) {
+      printf("❌ Errore: il campo '%s' è indicato più volte\n", campo);
+      return FAILURE;
+    }
+    assigned[index] = true;
+
+    const LayoutColumn *col = &layout->colonne[index];
+    if (params && strcmp(valore, "?") == SUCCESS) {
+      params[(*num_params)++] = index;
+    } else if (!convert_column_value(col, valore, record + col->offset)) {
+      printf("❌ Errore: il valore '%s' non è valido per il campo %s\n", valore, campo);
+      return FAILURE;
+    }
   }
 
-  size_t record_size = get_record_size(table_name);                                 // Se il file non è vuoto, ottengo la dimensione del record relativo alla tabella
-  if (record_size == 0) {
-    printf("Errore nella determinazione della dimensione del record\n");
-    return -1;
-  }
+  return SUCCESS;
+}
 
-  void* record = create_table_record_struct(table_name);                            // Se il file non è vuoto, creo una struct per la tabella per poter leggere un record
-  if (!record) {
-    printf("Errore nella creazione del record per la tabella %s\n", table_name);
-    return -1;
-  }
 
-  size_t last_record_offset = file_size - record_size;                              // Calcolo l'offset dell'ultimo record, così posso andare all'inizio del record
-  fseek(file, last_record_offset, SEEK_SET);                                        // Vado all'inizio dell'ultimo record
-  fread(record, record_size, 1, file);                                              // Leggo l'ultimo record
 
-  int last_id = *((int*)record);                                                    // Estraggo l'ID dal record (è sempre il primo campo)
+/**
+ * Funzione per ottenere il prossimo ID disponibile per una tabella, dal suo file già aperto.
+ * Se il file è vuoto, ritorno 1, non essendoci record salvati a database.
+ * Se il file non è vuoto, leggo solo l'id dell'ultimo record (è sempre il primo campo) e aggiungo 1.
+ * Non serve leggere tutto il record, quindi non serve nemmeno allocarlo.
+ * 
+ * @param file: il file della tabella, aperto in lettura
+ * @param file_size: la dimensione del file
+ * @param record_size: la dimensione di un record della tabella
+ * @return id (int)
+ */
+int read_next_id(FILE *file, long file_size, size_t record_size) {
+  if (file_size < (long)record_size) { return 1; }                                  // Se il file è vuoto, il primo ID sarà 1
 
-  fclose(file);
-  free_table_record_struct(record);                                                 // Libero la memoria
+  int last_id;
+  fseek(file, file_size - (long)record_size, SEEK_SET);                             // Vado all'inizio dell'ultimo record
+  if (fread(&last_id, sizeof(int), 1, file) != 1) { return 1; }
 
   return last_id + 1;                                                               // Ritorno l'ID
 }
@@ -232,30 +259,56 @@ const void *get_null_value(ColumnType tipo) {
 
 /**
  * Funzione per separare un token in due parti sulla base di un separatore.
+ * La parte prima (un nome) viene copiata in un buffer di size byte, la parte dopo non viene copiata:
+ * dopo punta direttamente dentro il token, così un valore può essere lungo quanto serve.
+ *
  * @param token La stringa da analizzare
  * @param separatore Il carattere separatore
  * @param prima La parte prima del separatore
- * @param dopo La parte dopo il separatore
- * @return 0 se la separazione è andata a buon fine, -1 altrimenti
+ * @param size La dimensione del buffer prima
+ * @param dopo La parte dopo il separatore, dentro il token
+ * @return 0 se la separazione è andata a buon fine, -1 altrimenti (separatore mancante o parte prima troppo lunga)
  */
-int split_token(const char *token, char separatore, char *prima, char *dopo) {
-  char *pos = strchr(token, separatore); // Trova la posizione del separatore
-  if (!pos) {
-      return FAILURE;  // Errore: separatore non trovato
+int split_token(const char *token, char separatore, char *prima, size_t size, const char **dopo) {
+  const char *pos = strchr(token, separatore); // Trova la posizione del separatore
+  if (!pos || (size_t)(pos - token) >= size) {
+      return FAILURE;  // Errore: separatore non trovato, oppure il nome non entra nel buffer
   }
 
   // Copia la parte prima del separatore
-  strncpy(prima, token, pos - token);
+  memcpy(prima, token, pos - token);
   prima[pos - token] = '\0';  // Aggiungi il terminatore
 
-  // Copia la parte dopo il separatore
-  strcpy(dopo, pos + 1);  // Tutto dopo il separatore
+  *dopo = pos + 1;  // Tutto dopo il separatore
 
   return SUCCESS;  // Separazione riuscita
 }
 
 
 
+/**
+ * Funzione che copia il percorso di un file da un token (LOAD, EXPORT, IMPORT), togliendo gli apici se ci sono.
+ *
+ * @param token Il token, ad esempio 'utenti.csv'
+ * @param path Il buffer in cui copiare il percorso
+ * @param size La dimensione del buffer
+ * @return SUCCESS se il percorso è valido, FAILURE se è vuoto o troppo lungo
+ */
+int copy_path_token(const char *token, char *path, size_t size) {
+  size_t length = strlen(token);
+  if (length >= 2 && (token[0] == '\'' || token[0] == '"') && token[length - 1] == token[0]) {
+    token++;
+    length -= 2;
+  }
+  if (length == 0 || length >= size) { return FAILURE; }
+
+  memcpy(path, token, length);
+  path[length] = '\0';
+  return SUCCESS;
+}
+
+
+
 /**
  * Funzione per verificare se una stringa contiene solo caratteri alfabetici.
  * 
@@ -280,6 +333,22 @@ int verify_is_only_letters(const char *s) {
 long get_current_timestamp() { return time(NULL); }
 
 
+/**
+ * Funzione che calcola l'hash di una chiave (FNV-1a a 64 bit).
+ * Il seed cambia con level: chi partiziona i record su disco usa un livello diverso per ogni ripartizione,
+ * così i record di una partizione si ridistribuiscono.
+ */
+uint64_t hash_bytes(const char *key, size_t len, int level) {
+  uint64_t hash = 14695981039346656037ULL ^ ((uint64_t)level * 0x9E3779B97F4A7C15ULL);
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (unsigned char)key[i];
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 29;                                                     // Mescolo i bit alti con quelli bassi
+  return hash;
+}
+
+
 /**
  * Funzioni che convertono una stringa nelle varie tipologie di dato di sistema
  * Questi metodi sono utili quando devo validare un token <campo>:<valore> per controllare che il valore passato sia effettivamente di quel tipo.
@@ -322,11 +391,24 @@ bool convert_char_to_timestamp(const char *input, void *output) {
 }
 
 bool convert_char_to_string(const char *input, void *output) {
-  printf("ciao\n");
   if (input == NULL || output == NULL) {
       return false;  // Se l'input o l'output sono NULL, fallisce
   }
 
+  // Se il valore è racchiuso tra apici ('Luca' oppure "Luca"), salvo solo il contenuto.
+  // In questo modo CREATE Utente nome:'Luca' e FIND Utente nome:'Luca' lavorano sullo stesso valore.
+  // Dentro gli apici, \ fa entrare il carattere successivo: 'L\'Aquila' diventa L'Aquila, come nei predicati.
+  size_t len = strlen(input);
+  if (len >= 2 && (input[0] == '\'' || input[0] == '"') && input[len - 1] == input[0]) {
+    char *text = output;
+    size_t written = 0;
+    memset(output, 0, 255);
+    for (size_t i = 1; i < len - 1 && written < 254; i++) {
+      if (input[i] == '\\' && i + 1 < len - 1) { i++; }
+      text[written++] = input[i];
+    }
+    return true;
+  }
 
   // Assicurati che non ci siano buffer overflow o manipolazioni non valide
   strncpy((char*)output, input, 255);
@@ -370,6 +452,9 @@ FILE* open_table_file(const char* table_name, const char* mode) {
   char filepath[256];
   snprintf(filepath, sizeof(filepath), "%s/%s.bin", TABLES_DIR, table_name);
 
+  // Ogni apertura in scrittura cambia la versione della tabella, e invalida i risultati in cache che la leggono
+  if (mode[0] != 'r' || strchr(mode, '+')) { bump_table_version(table_name); }
+
   // Tenta di aprire il file con la modalità richiesta
   FILE* file = fopen(filepath, mode);
   if (!file && strcmp(mode, "a+b") == 0) {
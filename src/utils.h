@@ -1,6 +1,8 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdint.h>
+
 // Config Header
 #include "../config.h"
 
@@ -15,15 +17,19 @@ bool convert_char_to_string(const char *input, void *output);
 
 ColumnDefinition parse_column_definition(const char *token);
 ColumnType parse_column_type(const char *tipo_colonna);
-ColumnValueDefinition parse_column_value_definition(TableDefinition *table, const char *token);
+ColumnKind get_column_kind(ColumnType tipo);
+bool convert_column_value(const LayoutColumn *col, const char *input, char *field);
+int bind_column_values(const RecordLayout *layout, char *tokens[], int start, int token_count, char *record, int *params, int *num_params);
 
-int get_next_id_for_table(const char *table_name);
+int read_next_id(FILE *file, long file_size, size_t record_size);
 const void *get_null_value(ColumnType tipo);
 
-int split_token(const char *token, char separatore, char *prima, char *dopo);
+int split_token(const char *token, char separatore, char *prima, size_t size, const char **dopo);
+int copy_path_token(const char *token, char *path, size_t size);
 
 int verify_is_only_letters(const char *s);
 long get_current_timestamp();
+uint64_t hash_bytes(const char *key, size_t len, int level);
 
 void fix_conversion_functions();
 FILE* open_table_file(const char* table_name, const char* mode);
@@ -0,0 +1,651 @@
+/*
+
+
+  Wal.c è il file che rende durevoli le modifiche ai dati, scrivendole prima in un log (write-ahead log).
+  Le funzioni descritte in questo file sono:
+    - wal_recover:              all'avvio riapplica le transazioni confermate nel log, poi lo svuota (vedi load_schema).
+    - wal_begin:                inizia una transazione.
+    - wal_log_table_write:      aggiunge alla transazione la scrittura di alcuni byte in una tabella.
+    - wal_log_record_deleted:   aggiunge alla transazione l'eliminazione di un record (vedi tombstone.c).
+    - wal_log_schema:           aggiunge alla transazione il nuovo schema.
+    - wal_commit:               conferma la transazione, la rende durevole e applica le sue modifiche ai file.
+    - wal_abort:                annulla la transazione: le sue modifiche non toccano i file.
+    - wal_checkpoint:           rende durevoli i file scritti finora e svuota il log.
+    - wal_close:                chiude il log alla fine del programma, con un ultimo checkpoint.
+
+  Perchè un log?
+  CREATE, UPDATE, DELETE e DEFINE scrivevano direttamente nei file, senza mai un fsync: un crash a metà di una fwrite
+  lasciava un record spezzato, e una modifica già confermata all'utente poteva sparire.
+  Adesso un comando che scrive descrive le sue modifiche nel log wal.log (quali byte scrivere, e dove) e le conferma
+  con un record di commit. Solo quando il log è sul disco (fdatasync) le modifiche vengono applicate ai file,
+  rileggendole dal log. Un file contiene quindi solo modifiche già durevoli nel log:
+    ✅ se il programma si ferma dopo il commit, all'avvio wal_recover riapplica la transazione. Le scritture sono a
+       posizioni precise, quindi riapplicarle è innocuo, e un record spezzato viene riscritto intero;
+    ✅ se si ferma prima, la transazione non ha il commit e viene ignorata: non aveva ancora toccato nessun file.
+  Il commit applica le modifiche con la stessa funzione usata dal recupero, così i due percorsi non possono divergere.
+
+  Un fdatasync per comando, non per record:
+  Tutti i record di un comando finiscono nel log e il commit fa un solo fdatasync: un CREATE di mille righe o un
+  UPDATE … WHERE su tutta la tabella aspettano il disco una volta sola.
+  Se più thread scrivono insieme i commit vengono raggruppati (group commit): il primo che arriva al commit (il leader)
+  aspetta al massimo WAL_GROUP_COMMIT_US che le altre transazioni aperte arrivino anche loro al commit, poi un solo
+  fdatasync le rende durevoli tutte. Chi arriva mentre è in corso aspetta quello, o il successivo.
+  Se non ci sono altre transazioni aperte, come per i comandi del prompt che arrivano uno alla volta, il leader non aspetta.
+
+  Checkpoint:
+  Il log cresce a ogni commit. Quando supera WAL_CHECKPOINT_BYTES, e alla chiusura del programma, i file scritti
+  dall'ultimo checkpoint vengono resi durevoli con fsync e il log viene svuotato. Anche la compattazione (vedi compact.c)
+  fa un checkpoint prima di sostituire una tabella: le posizioni dei record cambiano, e il log non deve più riferirsi a quella vecchia.
+
+  Ogni record del log inizia con un WalRecordHeader, che contiene un checksum: un record scritto a metà (la fine del log
+  durante un crash) non viene riconosciuto, e il recupero si ferma lì.
+
+  LOAD e IMPORT non passano dal log: scriverebbero due volte milioni di record. Aggiungono in fondo alla tabella
+  e alla fine fanno un solo fsync (vedi load.c e columnar.c).
+
+
+*/
+
+#include <stdio.h>                  // Funzioni per la gestione di input/output: printf, snprintf, fopen, fwrite, fclose
+#include <stdlib.h>                 // Funzioni per la gestione della memoria: malloc, realloc, free, qsort, bsearch
+#include <string.h>                 // Funzioni per la manipolazione delle stringhe: memcpy, memmove, memset, strncpy, strcmp
+#include <errno.h>                  // errno, ENOENT, EINTR, ETIMEDOUT
+#include <fcntl.h>                  // open, O_RDWR, O_CREAT, O_RDONLY
+#include <unistd.h>                 // pread, pwrite, fsync, fdatasync, ftruncate, lseek, close
+#include <time.h>                   // clock_gettime, per l'attesa del group commit
+#include <pthread.h>                // pthread_mutex_lock, pthread_cond_wait, pthread_cond_timedwait
+
+#include "wal.h"
+#include "utils.h"
+#include "cache.h"
+#include "tombstone.h"
+
+
+typedef enum {                                  // Tipi di record del log
+  WAL_TABLE_WRITE = 1,                          // Scrivere dei byte in una tabella, a partire da un offset
+  WAL_RECORD_DELETED = 2,                       // Segnare un record come eliminato nella mappa della tabella
+  WAL_SCHEMA = 3,                               // Riscrivere schema.bin
+  WAL_COMMIT = 4                                // La transazione è confermata
+} WalRecordType;
+
+typedef struct {                                // WalRecordHeader: intestazione di ogni record del log
+  uint32_t type;                                // type: un WalRecordType
+  uint32_t length;                              // length: byte del record dopo l'intestazione
+  uint64_t transaction;                         // transaction: la transazione a cui appartiene il record
+  uint64_t checksum;                            // checksum: dell'intestazione (con checksum a 0) e del record
+} WalRecordHeader;
+
+typedef struct {                                // WalTableChange: inizio di un record WAL_TABLE_WRITE o WAL_RECORD_DELETED
+  char nome_tabella[56];                        // nome_tabella: la tabella modificata (56 byte: la struct resta di 64)
+  int64_t offset;                               // offset: il byte da cui scrivere, o la posizione del record eliminato
+} WalTableChange;
+
+typedef struct {                                // WalReader: lettura sequenziale dei record del log
+  char *data;                                   // data: byte del log letti e non ancora usati
+  size_t capacity;                              // capacity: dimensione di data
+  size_t length;                                // length: byte validi in data
+  size_t pos;                                   // pos: primo byte di data non ancora usato
+  uint64_t offset;                              // offset: posizione nel log del primo byte di data
+  uint64_t end;                                 // end: fine della parte di log da leggere
+} WalReader;
+
+typedef struct {                                // WalTarget: la tabella aperta per applicare i record, riusata finché non cambia
+  char nome_tabella[56];
+  FILE *file;
+} WalTarget;
+
+
+static pthread_mutex_t wal_mutex = PTHREAD_MUTEX_INITIALIZER;      // Protegge tutto lo stato qui sotto
+static pthread_cond_t commit_reached = PTHREAD_COND_INITIALIZER;   // Una transazione ha scritto il suo commit (o è stata annullata)
+static pthread_cond_t sync_done = PTHREAD_COND_INITIALIZER;        // Un fdatasync del log è finito
+static int wal_fd = -1;
+static char *buffer;                            // Record del log non ancora scritti nel file
+static size_t buffered;
+static uint64_t written_end;                    // Byte del log già scritti nel file
+static uint64_t synced_end;                     // Byte del log già durevoli
+static bool syncing;                            // Un leader sta facendo fdatasync
+static bool log_failed;                         // Una scrittura del log è fallita: i commit falliscono fino al prossimo checkpoint
+static bool redo_pending;                       // Una transazione confermata non è stata applicata: il log va tenuto fino al riavvio
+static int open_transactions;                   // Transazioni iniziate che non hanno ancora scritto il commit
+static int active_transactions;                 // Transazioni non ancora applicate o annullate: finché ce ne sono, il log non si svuota
+static uint64_t next_transaction = 1;
+static char dirty_tables[MAX_TABLES][56];       // Tabelle scritte dall'ultimo checkpoint, da rendere durevoli con fsync
+static int num_dirty_tables;
+static bool schema_dirty;
+
+
+/**
+ * Funzione che aggiorna il checksum (FNV-1a, otto byte alla volta) con dei byte.
+ * Il risultato dipende da come i byte sono divisi: tutti i pezzi tranne l'ultimo devono essere lunghi un multiplo di 8,
+ * così scrivere intestazione, WalTableChange e dati separatamente dà lo stesso checksum di rileggerli tutti insieme.
+ */
+static uint64_t checksum_bytes(uint64_t hash, const void *data, size_t length) {
+  const unsigned char *bytes = data;
+  size_t i = 0;
+
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(uint64_t));
+    hash = (hash ^ word) * 1099511628211ULL;
+  }
+  for (; i < length; i++) { hash = (hash ^ bytes[i]) * 1099511628211ULL; }
+
+  return hash;
+}
+
+
+/**
+ * Funzione che calcola il checksum di un record del log.
+ */
+static uint64_t checksum_record(WalRecordHeader header, const void *head, size_t head_length, const void *data, size_t length) {
+  header.checksum = 0;
+  uint64_t hash = checksum_bytes(14695981039346656037ULL, &header, sizeof(WalRecordHeader));
+  hash = checksum_bytes(hash, head, head_length);
+  return checksum_bytes(hash, data, length);
+}
+
+
+/**
+ * Funzione che segna una tabella come scritta dall'ultimo checkpoint.
+ */
+static void mark_table_dirty(const char *table_name) {
+  pthread_mutex_lock(&wal_mutex);
+  bool found = false;
+  for (int i = 0; i < num_dirty_tables && !found; i++) { found = strcmp(dirty_tables[i], table_name) == SUCCESS; }
+
+  if (!found && num_dirty_tables < MAX_TABLES) {
+    strncpy(dirty_tables[num_dirty_tables], table_name, sizeof(dirty_tables[0]) - 1);
+    dirty_tables[num_dirty_tables][sizeof(dirty_tables[0]) - 1] = '\0';
+    num_dirty_tables++;
+  }
+  pthread_mutex_unlock(&wal_mutex);
+}
+
+
+/**
+ * Funzione che scrive nel file del log i record nel buffer. Va chiamata con wal_mutex bloccato.
+ * Se la scrittura fallisce il buffer resta com'è: i byte già scritti verranno riscritti alla stessa posizione.
+ */
+static int flush_log_buffer() {
+  size_t done = 0;
+  while (done < buffered) {
+    ssize_t n = pwrite(wal_fd, buffer + done, buffered - done, (off_t)(written_end + done));
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return FAILURE; }
+    done += (size_t)n;
+  }
+
+  written_end += buffered;
+  buffered = 0;
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che aggiunge dei byte in fondo al log, passando dal buffer. Va chiamata con wal_mutex bloccato.
+ */
+static int append_log_bytes(const void *data, size_t length) {
+  const char *bytes = data;
+  while (length > 0) {
+    if (buffered == WAL_BUFFER_BYTES && flush_log_buffer() != SUCCESS) { return FAILURE; }
+
+    size_t n = WAL_BUFFER_BYTES - buffered < length ? WAL_BUFFER_BYTES - buffered : length;
+    memcpy(buffer + buffered, bytes, n);
+    buffered += n;
+    bytes += n;
+    length -= n;
+  }
+  return SUCCESS;
+}
+
+
+/**
+ * Funzione che aggiunge un record al log: intestazione, head (ad esempio un WalTableChange) e dati.
+ * Se non riesce la transazione fallisce, e con lei tutte quelle che la seguono fino al prossimo checkpoint:
+ * nel log potrebbe essere rimasto un record a metà, e dopo di lui il recupero non legge più nulla.
+ */
+static void append_log_record(WalTransaction *txn, uint32_t type, const void *head, size_t head_length, const void *data, size_t length) {
+  WalRecordHeader header = { type, (uint32_t)(head_length + length), txn->id, 0 };
+  header.checksum = checksum_record(header, head, head_length, data, length);   // Fuori dal lock: è la parte lunga
+
+  pthread_mutex_lock(&wal_mutex);
+  bool ok = !txn->failed && !log_failed &&
+            append_log_bytes(&header, sizeof(WalRecordHeader)) == SUCCESS &&
+            append_log_bytes(head, head_length) == SUCCESS &&
+            append_log_bytes(data, length) == SUCCESS;
+  if (!ok && !txn->failed) { log_failed = true; }
+  pthread_mutex_unlock(&wal_mutex);
+
+  if (!ok) { txn->failed = true; }
+}
+
+
+/**
+ * Funzione che si assicura che nel buffer del lettore ci siano almeno bytes byte, leggendo il log se serve.
+ */
+static bool fill_wal_reader(WalReader *reader, size_t bytes) {
+  if (reader->length - reader->pos >= bytes) { return true; }
+
+  memmove(reader->data, reader->data + reader->pos, reader->length - reader->pos);
+  reader->offset += reader->pos;
+  reader->length -= reader->pos;
+  reader->pos = 0;
+
+  if (bytes > reader->capacity) {
+    char *grown = realloc(reader->data, bytes);
+    if (!grown) { return false; }
+    reader->data = grown;
+    reader->capacity = bytes;
+  }
+
+  while (reader->length < bytes) {
+    uint64_t from = reader->offset + reader->length;
+    if (from >= reader->end) { return false; }
+
+    size_t want = reader->capacity - reader->length;
+    if (want > reader->end - from) { want = (size_t)(reader->end - from); }
+    ssize_t n = pread(wal_fd, reader->data + reader->length, want, (off_t)from);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    reader->length += (size_t)n;
+  }
+  return true;
+}
+
+
+/**
+ * Funzione che legge il prossimo record del log e ne controlla il checksum.
+ *
+ * @param reader Il lettore
+ * @param header L'intestazione del record
+ * @param payload Il record dopo l'intestazione, valido fino alla prossima lettura
+ * @return true se il record è valido, false alla fine del log o a un record incompleto o rovinato
+ */
+static bool read_wal_record(WalReader *reader, WalRecordHeader *header, const char **payload) {
+  if (!fill_wal_reader(reader, sizeof(WalRecordHeader))) { return false; }
+  memcpy(header, reader->data + reader->pos, sizeof(WalRecordHeader));
+
+  if (header->type < WAL_TABLE_WRITE || header->type > WAL_COMMIT ||
+      header->length > WAL_BUFFER_BYTES + sizeof(WalTableChange) + sizeof(Schema)) { return false; }
+  if (!fill_wal_reader(reader, sizeof(WalRecordHeader) + header->length)) { return false; }
+
+  *payload = reader->data + reader->pos + sizeof(WalRecordHeader);
+  if (checksum_record(*header, NULL, 0, *payload, header->length) != header->checksum) { return false; }
+
+  reader->pos += sizeof(WalRecordHeader) + header->length;
+  return true;
+}
+
+
+/**
+ * Funzione che apre la tabella su cui applicare un record, se non è già quella aperta.
+ * La tabella può non esistere ancora: un CREATE sulla tabella appena definita la crea.
+ */
+static FILE *open_wal_target(WalTarget *target, const char *table_name) {
+  if (target->file && strcmp(target->nome_tabella, table_name) == SUCCESS) { return target->file; }
+
+  if (target->file) { fclose(target->file); }
+  strncpy(target->nome_tabella, table_name, sizeof(target->nome_tabella) - 1);
+  target->nome_tabella[sizeof(target->nome_tabella) - 1] = '\0';
+
+  target->file = open_table_file(table_name, "r+b");                      // Cambia la versione della tabella: invalida la cache
+  if (!target->file) { target->file = open_table_file(table_name, "w+b"); }
+  if (target->file) { mark_table_dirty(table_name); }
+  return target->file;
+}
+
+
+/**
+ * Funzione che applica ai file un record del log. È la stessa per il commit e per il recupero all'avvio.
+ */
+static int apply_wal_record(const WalRecordHeader *header, const char *payload, WalTarget *target) {
+  if (header->type == WAL_COMMIT) { return SUCCESS; }
+
+  if (header->type == WAL_SCHEMA) {
+    if (header->length != sizeof(Schema)) { return FAILURE; }
+
+    FILE *file = fopen(SCHEMA_FILE, "wb");
+    if (!file) { return FAILURE; }
+    bool ok = fwrite(payload, sizeof(Schema), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+
+    pthread_mutex_lock(&wal_mutex);
+    schema_dirty = true;
+    pthread_mutex_unlock(&wal_mutex);
+    bump_schema_version();                                                // I risultati in cache potrebbero riguardare tabelle appena definite
+    return ok ? SUCCESS : FAILURE;
+  }
+
+  if (header->length < sizeof(WalTableChange)) { return FAILURE; }
+  WalTableChange change;
+  memcpy(&change, payload, sizeof(WalTableChange));
+  change.nome_tabella[sizeof(change.nome_tabella) - 1] = '\0';
+
+  FILE *file = open_wal_target(target, change.nome_tabella);
+  if (!file) { return FAILURE; }
+
+  if (header->type == WAL_RECORD_DELETED) {
+    bump_table_version(change.nome_tabella);                              // Il file della tabella non cambia, ma i suoi risultati sì
+    return mark_record_deleted(change.nome_tabella, file, (long)change.offset);
+  }
+
+  size_t length = header->length - sizeof(WalTableChange);
+  return pwrite(fileno(file), payload + sizeof(WalTableChange), length, (off_t)change.offset) == (ssize_t)length ? SUCCESS : FAILURE;
+}
+
+
+/**
+ * Funzione che confronta due id di transazione, per qsort e bsearch.
+ */
+static int compare_transactions(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+
+/**
+ * Funzione che riapplica i record del log tra start ed end.
+ * Con transaction != 0 applica solo quella transazione (il commit), altrimenti quelle in committed (il recupero).
+ *
+ * @return SUCCESS se tutti i record sono stati applicati, FAILURE altrimenti
+ */
+static int redo_wal_records(uint64_t start, uint64_t end, uint64_t transaction, const uint64_t *committed, size_t num_committed) {
+  WalReader reader = { malloc(2 * WAL_BUFFER_BYTES), 2 * WAL_BUFFER_BYTES, 0, 0, start, end };
+  if (!reader.data) { return FAILURE; }
+
+  WalTarget target = { { 0 }, NULL };
+  WalRecordHeader header;
+  const char *payload;
+  int result = SUCCESS;
+
+  while (result == SUCCESS && reader.offset + reader.pos < end) {
+    if (!read_wal_record(&reader, &header, &payload)) { result = FAILURE; break; }     // Questa parte del log è già stata letta: deve essere valida
+
+    bool wanted = transaction ? header.transaction == transaction
+                              : bsearch(&header.transaction, committed, num_committed, sizeof(uint64_t), compare_transactions) != NULL;
+    if (wanted) { result = apply_wal_record(&header, payload, &target); }
+  }
+
+  if (target.file && fclose(target.file) != 0) { result = FAILURE; }
+  free(reader.data);
+  return result;
+}
+
+
+/**
+ * Funzione che rende durevole un file con fsync. Un file che non esiste (ad esempio una mappa mai creata) va bene.
+ */
+static bool sync_path(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) { return errno == ENOENT; }
+
+  bool ok = fsync(fd) == 0;
+  close(fd);
+  return ok;
+}
+
+
+/**
+ * Funzione che apre il log e riapplica le transazioni confermate rimaste da un'esecuzione precedente.
+ * Va chiamata all'avvio, prima di leggere lo schema (vedi load_schema): anche schema.bin potrebbe essere da riapplicare.
+ *
+ * Il log viene letto due volte: la prima per trovare le transazioni che hanno il commit, fermandosi al primo record
+ * non valido, la seconda per applicarle nell'ordine in cui erano state scritte. Alla fine un checkpoint svuota il log.
+ *
+ * @return SUCCESS se il log è stato aperto e recuperato, FAILURE altrimenti
+ */
+int wal_recover() {
+  buffer = malloc(WAL_BUFFER_BYTES);
+  wal_fd = buffer ? open(WAL_FILE, O_RDWR | O_CREAT, 0644) : -1;
+  if (wal_fd < 0) {
+    printf("❌ Errore: impossibile aprire il log %s\n", WAL_FILE);
+    return FAILURE;
+  }
+  sync_path(".");                                                         // Il log appena creato deve esserci anche dopo un crash
+
+  off_t size = lseek(wal_fd, 0, SEEK_END);
+  if (size <= 0) { return SUCCESS; }
+
+  WalReader reader = { malloc(2 * WAL_BUFFER_BYTES), 2 * WAL_BUFFER_BYTES, 0, 0, 0, (uint64_t)size };
+  uint64_t *committed = NULL;
+  size_t num_committed = 0, capacity = 0;
+  uint64_t valid_end = 0;
+  WalRecordHeader header;
+  const char *payload;
+  bool ok = reader.data != NULL;
+
+  while (ok && read_wal_record(&reader, &header, &payload)) {             // Step 1: le transazioni con il commit
+    valid_end = reader.offset + reader.pos;
+    if (header.type != WAL_COMMIT) { continue; }
+
+    if (num_committed == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      uint64_t *grown = realloc(committed, capacity * sizeof(uint64_t));
+      if (!grown) { ok = false; break; }
+      committed = grown;
+    }
+    committed[num_committed++] = header.transaction;
+  }
+  free(reader.data);
+
+  if (ok && num_committed > 0) {                                          // Step 2: le riapplico
+    printf("Recupero dal log: riapplico %zu transazioni...\n", num_committed);
+    qsort(committed, num_committed, sizeof(uint64_t), compare_transactions);
+    ok = redo_wal_records(0, valid_end, 0, committed, num_committed) == SUCCESS;
+  }
+  free(committed);
+
+  if (!ok) {
+    printf("❌ Errore: impossibile riapplicare il log %s\n", WAL_FILE);
+    return FAILURE;
+  }
+
+  return wal_checkpoint();                                                // Step 3: i file sono a posto, il log si può svuotare
+}
+
+
+/**
+ * Funzione che inizia una transazione. Tutte le modifiche di un comando vanno in una sola transazione.
+ */
+void wal_begin(WalTransaction *txn) {
+  pthread_mutex_lock(&wal_mutex);
+  txn->id = next_transaction++;
+  txn->start = written_end + buffered;
+  txn->failed = wal_fd < 0 || log_failed || redo_pending;
+  open_transactions++;
+  active_transactions++;
+  pthread_mutex_unlock(&wal_mutex);
+}
+
+
+/**
+ * Funzione che aggiunge alla transazione la scrittura di length byte nella tabella, a partire da offset.
+ * La tabella non cambia fino alla wal_commit. Una scrittura più grande del buffer del log viene divisa in più record.
+ */
+void wal_log_table_write(WalTransaction *txn, const char *table_name, long offset, const void *data, size_t length) {
+  WalTableChange change;
+  memset(&change, 0, sizeof(WalTableChange));
+  strncpy(change.nome_tabella, table_name, sizeof(change.nome_tabella) - 1);
+
+  const char *bytes = data;
+  while (length > 0) {
+    size_t piece = length > WAL_BUFFER_BYTES ? WAL_BUFFER_BYTES : length;
+    change.offset = offset;
+    append_log_record(txn, WAL_TABLE_WRITE, &change, sizeof(WalTableChange), bytes, piece);
+
+    bytes += piece;
+    offset += (long)piece;
+    length -= piece;
+  }
+}
+
+
+/**
+ * Funzione che aggiunge alla transazione l'eliminazione del record in posizione position (vedi mark_record_deleted).
+ */
+void wal_log_record_deleted(WalTransaction *txn, const char *table_name, long position) {
+  WalTableChange change;
+  memset(&change, 0, sizeof(WalTableChange));
+  strncpy(change.nome_tabella, table_name, sizeof(change.nome_tabella) - 1);
+  change.offset = position;
+
+  append_log_record(txn, WAL_RECORD_DELETED, &change, sizeof(WalTableChange), NULL, 0);
+}
+
+
+/**
+ * Funzione che aggiunge alla transazione il nuovo contenuto di schema.bin.
+ */
+void wal_log_schema(WalTransaction *txn, const Schema *image) {
+  append_log_record(txn, WAL_SCHEMA, image, sizeof(Schema), NULL, 0);
+}
+
+
+/**
+ * Funzione del leader del group commit: aspetta, al massimo WAL_GROUP_COMMIT_US, che le altre transazioni aperte
+ * scrivano il loro commit, così lo stesso fdatasync rende durevoli anche loro. Va chiamata con wal_mutex bloccato.
+ */
+static void wait_for_group_commit() {
+  if (open_transactions == 0 || WAL_GROUP_COMMIT_US <= 0) { return; }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += (long)WAL_GROUP_COMMIT_US * 1000L;
+  deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+  deadline.tv_nsec %= 1000000000L;
+
+  while (open_transactions > 0) {
+    if (pthread_cond_timedwait(&commit_reached, &wal_mutex, &deadline) == ETIMEDOUT) { break; }
+  }
+}
+
+
+/**
+ * Funzione che conferma una transazione.
+ * Step 1: scrivo il record di commit
+ * Step 2: aspetto che il log sia durevole fino al commit: faccio io l'fdatasync (leader) o aspetto quello di un altro
+ * Step 3: applico le modifiche della transazione ai file, rileggendole dal log
+ * Step 4: se il log è diventato troppo grande, faccio un checkpoint
+ *
+ * @param txn La transazione da confermare
+ * @return SUCCESS se le modifiche sono durevoli e applicate, FAILURE se non è stato applicato nulla
+ */
+int wal_commit(WalTransaction *txn) {
+  append_log_record(txn, WAL_COMMIT, NULL, 0, NULL, 0);                   // Step 1: il record di commit
+
+  pthread_mutex_lock(&wal_mutex);
+  open_transactions--;
+  pthread_cond_broadcast(&commit_reached);
+
+  bool ok = !txn->failed && flush_log_buffer() == SUCCESS;
+  uint64_t end = written_end;
+
+  while (ok && synced_end < end) {                                        // Step 2: group commit
+    if (log_failed) { ok = false; break; }
+    if (syncing) {
+      pthread_cond_wait(&sync_done, &wal_mutex);                          // Un altro leader sta facendo fdatasync: forse copre anche me
+      continue;
+    }
+
+    syncing = true;
+    wait_for_group_commit();
+    ok = flush_log_buffer() == SUCCESS;                                   // Anche i commit arrivati mentre aspettavo
+    uint64_t target = written_end;
+
+    pthread_mutex_unlock(&wal_mutex);
+    bool synced = ok && fdatasync(wal_fd) == 0;
+    pthread_mutex_lock(&wal_mutex);
+
+    syncing = false;
+    if (synced) { synced_end = target; }
+    else { log_failed = true; ok = false; }
+    pthread_cond_broadcast(&sync_done);
+  }
+  pthread_mutex_unlock(&wal_mutex);
+
+  int result = FAILURE;
+  if (ok) {                                                               // Step 3: applico le modifiche
+    result = redo_wal_records(txn->start, end, txn->id, NULL, 0);
+    if (result != SUCCESS) {
+      printf("❌ Errore: modifiche confermate nel log %s ma non applicate: verranno applicate al prossimo avvio\n", WAL_FILE);
+    }
+  } else {
+    printf("❌ Errore: impossibile scrivere nel log %s, nessuna modifica applicata\n", WAL_FILE);
+  }
+
+  pthread_mutex_lock(&wal_mutex);
+  if (ok && result != SUCCESS) { redo_pending = true; }                   // Il log non si può più svuotare fino al riavvio
+  active_transactions--;
+  bool checkpoint = active_transactions == 0 && (log_failed || written_end + buffered >= WAL_CHECKPOINT_BYTES);
+  pthread_mutex_unlock(&wal_mutex);
+
+  if (checkpoint) { wal_checkpoint(); }                                   // Step 4: il checkpoint svuota il log (e se una scrittura era fallita, riparte pulito)
+  return result;
+}
+
+
+/**
+ * Funzione che annulla una transazione. I suoi record restano nel log, ma senza commit: non verranno mai applicati.
+ */
+void wal_abort(WalTransaction *txn) {
+  pthread_mutex_lock(&wal_mutex);
+  open_transactions--;
+  active_transactions--;
+  pthread_cond_broadcast(&commit_reached);
+  pthread_mutex_unlock(&wal_mutex);
+  txn->failed = true;
+}
+
+
+/**
+ * Funzione che fa un checkpoint: rende durevoli con fsync le tabelle (con le loro mappe dei record eliminati)
+ * e lo schema scritti dall'ultimo checkpoint, poi svuota il log.
+ * Non si può fare mentre una transazione è in corso: i suoi record verrebbero persi.
+ *
+ * @return SUCCESS se il log è stato svuotato, FAILURE altrimenti
+ */
+int wal_checkpoint() {
+  pthread_mutex_lock(&wal_mutex);
+  if (wal_fd < 0 || active_transactions > 0 || redo_pending) {
+    pthread_mutex_unlock(&wal_mutex);
+    return FAILURE;
+  }
+
+  bool ok = true;
+  char path[256];
+  for (int i = 0; i < num_dirty_tables; i++) {
+    snprintf(path, sizeof(path), "%s/%s.bin", TABLES_DIR, dirty_tables[i]);
+    ok = sync_path(path) && ok;
+    snprintf(path, sizeof(path), "%s/%s.del", TABLES_DIR, dirty_tables[i]);
+    ok = sync_path(path) && ok;
+  }
+  if (num_dirty_tables > 0) { ok = sync_path(TABLES_DIR) && ok; }        // Le tabelle create dall'ultimo checkpoint
+  if (schema_dirty) { ok = sync_path(SCHEMA_FILE) && ok; }
+
+  if (ok && ftruncate(wal_fd, 0) == 0 && fsync(wal_fd) == 0) {            // I record ancora nel buffer sono di transazioni annullate
+    buffered = 0;
+    written_end = synced_end = 0;
+    num_dirty_tables = 0;
+    schema_dirty = false;
+    log_failed = false;
+  } else {
+    ok = false;
+  }
+
+  pthread_mutex_unlock(&wal_mutex);
+  return ok ? SUCCESS : FAILURE;
+}
+
+
+/**
+ * Funzione che chiude il log alla fine del programma. L'ultimo checkpoint lo lascia vuoto.
+ */
+void wal_close() {
+  if (wal_fd < 0) { return; }
+
+  wal_checkpoint();
+  close(wal_fd);
+  wal_fd = -1;
+  free(buffer);
+  buffer = NULL;
+}
@@ -0,0 +1,30 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <stdint.h>
+
+// Config Header
+#include "../config.h"
+
+
+typedef struct {                                // WalTransaction: una transazione del log, dall'inizio del comando alla wal_commit
+  uint64_t id;                                  // id: numero della transazione, scritto in ogni suo record del log
+  uint64_t start;                               // start: posizione nel log da cui iniziano i suoi record
+  bool failed;                                  // failed: true se un record non è stato scritto: la wal_commit fallisce
+} WalTransaction;
+
+
+// Functions Available including the Wal
+int wal_recover();
+void wal_begin(WalTransaction *txn);
+void wal_log_table_write(WalTransaction *txn, const char *table_name, long offset, const void *data, size_t length);
+void wal_log_record_deleted(WalTransaction *txn, const char *table_name, long position);
+void wal_log_schema(WalTransaction *txn, const Schema *image);
+int wal_commit(WalTransaction *txn);
+void wal_abort(WalTransaction *txn);
+int wal_checkpoint();
+void wal_close();
+
+
+
+#endif